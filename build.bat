@@ -31,7 +31,7 @@ if defined MONGODB_AVAILABLE (
     echo Building with MongoDB support...
     REM MongoDB 4.0 uses versioned library names
     REM MongoDB 4.0 uses v_noabi namespace - add both include paths
-    g++ -std=c++17 -pthread -D_WIN32_WINNT=0x0A00 -DHAS_MONGODB -I src\Backend -I "C:\vcpkg\installed\x64-windows\include" -I "C:\vcpkg\installed\x64-windows\include\mongocxx\v_noabi" -I "C:\vcpkg\installed\x64-windows\include\bsoncxx\v_noabi" src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp -L "C:\vcpkg\installed\x64-windows\lib" "C:\vcpkg\installed\x64-windows\lib\mongocxx-v_noabi-rhi-md.lib" "C:\vcpkg\installed\x64-windows\lib\bsoncxx-v_noabi-rhi-md.lib" "C:\vcpkg\installed\x64-windows\lib\mongoc-1.0.lib" "C:\vcpkg\installed\x64-windows\lib\bson-1.0.lib" -lws2_32 -lwsock32 -o backend.exe 2>build_errors.log
+    g++ -std=c++17 -pthread -D_WIN32_WINNT=0x0A00 -DHAS_MONGODB -I src\Backend -I "C:\vcpkg\installed\x64-windows\include" -I "C:\vcpkg\installed\x64-windows\include\mongocxx\v_noabi" -I "C:\vcpkg\installed\x64-windows\include\bsoncxx\v_noabi" src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp src\Backend\UserCache.cpp src\Backend\CartSweeper.cpp src\Backend\Scheduler.cpp src\Backend\Timestamp.cpp src\Backend\UserIndex.cpp src\Backend\SlowRequestLog.cpp src\Backend\Profiler.cpp src\Backend\UserSnapshot.cpp src\Backend\Catalog.cpp src\Backend\Promotions.cpp src\Backend\ResponseEncoding.cpp src\Backend\SingleFlight.cpp src\Backend\AdmissionControl.cpp src\Backend\RequestDeadline.cpp src\Backend\UserShards.cpp src\Backend\WarmState.cpp src\Backend\HotRestart.cpp src\Backend\CompactUserStore.cpp src\Backend\ThreadAffinity.cpp src\Backend\IoUring.cpp src\Backend\StaticFiles.cpp src\Backend\QueryAnalytics.cpp -L "C:\vcpkg\installed\x64-windows\lib" "C:\vcpkg\installed\x64-windows\lib\mongocxx-v_noabi-rhi-md.lib" "C:\vcpkg\installed\x64-windows\lib\bsoncxx-v_noabi-rhi-md.lib" "C:\vcpkg\installed\x64-windows\lib\mongoc-1.0.lib" "C:\vcpkg\installed\x64-windows\lib\bson-1.0.lib" -lws2_32 -lwsock32 -o backend.exe 2>build_errors.log
     if %ERRORLEVEL% NEQ 0 (
         echo Build failed! Check build_errors.log for details.
         type build_errors.log
@@ -59,7 +59,7 @@ if defined MONGODB_AVAILABLE (
 
 REM Try g++ from PATH (without MongoDB)
 echo Building without MongoDB support...
-g++ -std=c++17 -pthread -D_WIN32_WINNT=0x0A00 -I src\Backend src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp -lws2_32 -lwsock32 -o backend.exe
+g++ -std=c++17 -pthread -D_WIN32_WINNT=0x0A00 -I src\Backend src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp src\Backend\UserCache.cpp src\Backend\CartSweeper.cpp src\Backend\Scheduler.cpp src\Backend\Timestamp.cpp src\Backend\UserIndex.cpp src\Backend\SlowRequestLog.cpp src\Backend\Profiler.cpp src\Backend\UserSnapshot.cpp src\Backend\Catalog.cpp src\Backend\Promotions.cpp src\Backend\ResponseEncoding.cpp src\Backend\SingleFlight.cpp src\Backend\AdmissionControl.cpp src\Backend\RequestDeadline.cpp src\Backend\UserShards.cpp src\Backend\WarmState.cpp src\Backend\HotRestart.cpp src\Backend\CompactUserStore.cpp src\Backend\ThreadAffinity.cpp src\Backend\IoUring.cpp src\Backend\StaticFiles.cpp src\Backend\QueryAnalytics.cpp -lws2_32 -lwsock32 -o backend.exe
 
 if exist backend.exe (
     echo.
@@ -77,7 +77,7 @@ if defined MONGODB_AVAILABLE (
       /I "C:\vcpkg\installed\x64-windows\include\bsoncxx\v_noabi" ^
       src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp ^
       src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp ^
-      src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp /link /LIBPATH:"C:\vcpkg\installed\x64-windows\lib" ^
+      src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp src\Backend\UserCache.cpp src\Backend\CartSweeper.cpp src\Backend\Scheduler.cpp src\Backend\Timestamp.cpp src\Backend\UserIndex.cpp src\Backend\SlowRequestLog.cpp src\Backend\Profiler.cpp src\Backend\UserSnapshot.cpp src\Backend\Catalog.cpp src\Backend\Promotions.cpp src\Backend\ResponseEncoding.cpp src\Backend\SingleFlight.cpp src\Backend\AdmissionControl.cpp src\Backend\RequestDeadline.cpp src\Backend\UserShards.cpp src\Backend\WarmState.cpp src\Backend\HotRestart.cpp src\Backend\CompactUserStore.cpp src\Backend\ThreadAffinity.cpp src\Backend\IoUring.cpp src\Backend\StaticFiles.cpp src\Backend\QueryAnalytics.cpp /link /LIBPATH:"C:\vcpkg\installed\x64-windows\lib" ^
       mongocxx-v_noabi-rhi-md.lib bsoncxx-v_noabi-rhi-md.lib mongoc-1.0.lib bson-1.0.lib ws2_32.lib wsock32.lib /OUT:backend.exe 2>nul
 
     if exist backend.exe (
@@ -91,7 +91,7 @@ if defined MONGODB_AVAILABLE (
 
 REM If g++ failed, try cl (MSVC)
 echo g++ not available or build failed, trying MSVC...
-cl /EHsc /std:c++17 /I src\Backend src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp /Fe:backend.exe 2>&1
+cl /EHsc /std:c++17 /I src\Backend src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp src\Backend\UserCache.cpp src\Backend\CartSweeper.cpp src\Backend\Scheduler.cpp src\Backend\Timestamp.cpp src\Backend\UserIndex.cpp src\Backend\SlowRequestLog.cpp src\Backend\Profiler.cpp src\Backend\UserSnapshot.cpp src\Backend\Catalog.cpp src\Backend\Promotions.cpp src\Backend\ResponseEncoding.cpp src\Backend\SingleFlight.cpp src\Backend\AdmissionControl.cpp src\Backend\RequestDeadline.cpp src\Backend\UserShards.cpp src\Backend\WarmState.cpp src\Backend\HotRestart.cpp src\Backend\CompactUserStore.cpp src\Backend\ThreadAffinity.cpp src\Backend\IoUring.cpp src\Backend\StaticFiles.cpp src\Backend\QueryAnalytics.cpp /Fe:backend.exe 2>&1
 
 if exist backend.exe (
     echo.
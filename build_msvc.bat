@@ -54,7 +54,7 @@ echo Compiling with MongoDB support using MSVC...
 echo.
 
 REM Build with MSVC and MongoDB (64-bit)
-cl /EHsc /std:c++17 /I src\Backend /I "C:\vcpkg\installed\x64-windows\include" /I "C:\vcpkg\installed\x64-windows\include\mongocxx\v_noabi" /I "C:\vcpkg\installed\x64-windows\include\bsoncxx\v_noabi" /D HAS_MONGODB /D _WIN32_WINNT=0x0A00 /D _WIN64 src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp /link /LIBPATH:"C:\vcpkg\installed\x64-windows\lib" mongocxx-v_noabi-rhi-md.lib bsoncxx-v_noabi-rhi-md.lib mongoc-1.0.lib bson-1.0.lib ws2_32.lib wsock32.lib /OUT:backend.exe /MACHINE:X64
+cl /EHsc /std:c++17 /I src\Backend /I "C:\vcpkg\installed\x64-windows\include" /I "C:\vcpkg\installed\x64-windows\include\mongocxx\v_noabi" /I "C:\vcpkg\installed\x64-windows\include\bsoncxx\v_noabi" /D HAS_MONGODB /D _WIN32_WINNT=0x0A00 /D _WIN64 src\Backend\main.cpp src\Backend\Server.cpp src\Backend\Cart.cpp src\Backend\LoginService.cpp src\Backend\PurchaseService.cpp src\Backend\PurchaseHistory.cpp src\Backend\SearchService.cpp src\Backend\SettingsService.cpp src\Backend\MongoDBService.cpp src\Backend\UserCache.cpp src\Backend\CartSweeper.cpp src\Backend\Scheduler.cpp src\Backend\Timestamp.cpp src\Backend\UserIndex.cpp src\Backend\SlowRequestLog.cpp src\Backend\Profiler.cpp src\Backend\UserSnapshot.cpp src\Backend\Catalog.cpp src\Backend\Promotions.cpp src\Backend\ResponseEncoding.cpp src\Backend\SingleFlight.cpp src\Backend\AdmissionControl.cpp src\Backend\RequestDeadline.cpp src\Backend\UserShards.cpp src\Backend\WarmState.cpp src\Backend\HotRestart.cpp src\Backend\CompactUserStore.cpp src\Backend\ThreadAffinity.cpp src\Backend\IoUring.cpp src\Backend\StaticFiles.cpp src\Backend\QueryAnalytics.cpp /link /LIBPATH:"C:\vcpkg\installed\x64-windows\lib" mongocxx-v_noabi-rhi-md.lib bsoncxx-v_noabi-rhi-md.lib mongoc-1.0.lib bson-1.0.lib ws2_32.lib wsock32.lib /OUT:backend.exe /MACHINE:X64
 
 if exist backend.exe (
     echo.
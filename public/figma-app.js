@@ -767,8 +767,7 @@ function initializeStore() {
         // If there's already a search query, perform the search
         performSearch(currentSearchValue);
     }
-    loadCart();
-    loadHistory();
+    loadStoreData();
 }
 
 function renderSearchResults(results) {
@@ -1150,6 +1149,47 @@ async function loadCart() {
     }
 }
 
+// Load the cart and order history in one round trip through /api/batch
+async function loadStoreData() {
+    const token = localStorage.getItem('token');
+    if (!token) {
+        renderCart([], 0);
+        return;
+    }
+
+    try {
+        const response = await fetch(`${API_BASE_URL}/batch`, {
+            method: 'POST',
+            headers: {
+                'Content-Type': 'application/json',
+                'Authorization': `Bearer ${token}`
+            },
+            body: JSON.stringify({
+                requests: [
+                    { id: 'cart', method: 'GET', path: '/api/cart' },
+                    { id: 'history', method: 'GET', path: '/api/purchase-history' }
+                ]
+            })
+        });
+        const data = await response.json();
+        if (!data.success) throw new Error(data.message || 'Batch request failed');
+
+        const results = Object.fromEntries(data.responses.map(result => [result.id, result.body]));
+        if (results.cart && results.cart.success) {
+            renderCart(results.cart.cart || [], results.cart.total || 0);
+        } else {
+            renderCart([], 0);
+        }
+        if (results.history && results.history.success) {
+            renderHistory(results.history.history || []);
+        }
+    } catch (error) {
+        console.error('Batch error, loading separately:', error);
+        loadCart();
+        loadHistory();
+    }
+}
+
 function renderCart(cart, total) {
     const cartList = document.getElementById('cart-list');
     const totalEl = document.getElementById('cart-total');
@@ -1472,6 +1512,8 @@ async function handleCheckout() {
             }, 500);
         } else {
             showMessage(data.message || 'Checkout failed', 'error');
+            // Prices changed since items were added: show the repriced cart so the user can confirm
+            if (data.code === 'PRICE_CHANGED') loadCart();
         }
     } catch (error) {
         console.error('Checkout error:', error);
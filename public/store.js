@@ -286,10 +286,58 @@ export function createStoreUI({ apiBaseUrl, getToken, onSessionExpired }) {
   };
 
   /**
-   * refreshAll - Loads catalog, cart, and history simultaneously
+   * refreshAll - Loads catalog, cart, and history in one round trip
+   * 
+   * CONNECTION TO BACKEND:
+   * - POST request to /api/batch with the three GETs; the token is checked once
+   * - Backend returns: { success: true, responses: [{ id, status, body }, ...] }
+   * - Falls back to three separate requests if the batch itself fails
+   * 
    * WHY: Refreshes all data when user clicks refresh button
    */
-  const refreshAll = () => Promise.all([fetchCatalog(), loadCart(), loadHistory()]);
+  const refreshAll = async () => {
+    let results;
+    try {
+      const response = await authFetch('/batch', {
+        method: 'POST',
+        body: JSON.stringify({
+          requests: [
+            { id: 'catalog', method: 'GET', path: '/api/catalog' },
+            { id: 'cart', method: 'GET', path: '/api/cart' },
+            { id: 'history', method: 'GET', path: '/api/purchase-history' }
+          ]
+        })
+      });
+      const data = await response.json();
+      if (!data.success) throw new Error(data.message || 'Batch request failed');
+      results = Object.fromEntries(data.responses.map(result => [result.id, result]));
+    } catch (error) {
+      console.error('Batch error, loading separately:', error);
+      return Promise.all([fetchCatalog(), loadCart(), loadHistory()]);
+    }
+
+    const { catalog, cart, history } = results;
+    if (catalog.body.success) {
+      state.catalog = catalog.body.items;
+      renderCatalog();
+    } else {
+      setMessage('Unable to load catalog.', 'error');
+    }
+    if (cart.status === 401 || history.status === 401) {
+      onSessionExpired?.();
+      return;
+    }
+    if (cart.body.success) {
+      renderCart(cart.body.cart || [], cart.body.total || 0);
+    } else {
+      setMessage(cart.body.message || 'Failed to fetch cart.', 'error');
+    }
+    if (history.body.success) {
+      renderHistory(history.body.history || []);
+    } else {
+      setMessage(history.body.message || 'Failed to fetch purchase history.', 'error');
+    }
+  };
 
   /**
    * clearCart - Clears user's cart via backend API
@@ -354,6 +402,8 @@ export function createStoreUI({ apiBaseUrl, getToken, onSessionExpired }) {
         await loadHistory(); // Refresh history (should include new order)
       } else {
         setMessage(data.message || 'Checkout failed.', 'error');
+        // Prices changed since items were added: show the repriced cart so the user can confirm
+        if (data.code === 'PRICE_CHANGED') await loadCart();
       }
     } catch (error) {
       console.error('Checkout error:', error);
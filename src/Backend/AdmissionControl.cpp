@@ -0,0 +1,184 @@
+/**
+ * AdmissionControl - Implementation
+ */
+
+#include "AdmissionControl.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+bool startsWith(const std::string& value, const char* prefix) {
+    return value.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+}
+
+} // namespace
+
+void AdmissionConfig::sizeQueues(size_t workerThreads) {
+    size_t spare = workerThreads > maxLimit ? workerThreads - maxLimit : 0;
+    size_t reserved = std::min(spare, std::max<size_t>(1, spare / 4));
+    size_t shared = spare - reserved;
+
+    unsigned long long weightTotal = 0;
+    for (size_t i = 1; i < REQUEST_CLASS_COUNT; ++i) weightTotal += weights[i];
+
+    queueCapacity[0] = reserved;
+    for (size_t i = 1; i < REQUEST_CLASS_COUNT; ++i) {
+        queueCapacity[i] = weightTotal == 0 ? 0 : static_cast<size_t>(shared * weights[i] / weightTotal);
+    }
+}
+
+AdmissionController::AdmissionController()
+    : limit(0), inFlight(0), completionsSinceBackoff(0) {
+    for (size_t i = 0; i < REQUEST_CLASS_COUNT; ++i) {
+        credit[i] = 0;
+        admitted[i] = 0;
+        shed[i] = 0;
+    }
+    configure(AdmissionConfig());
+}
+
+void AdmissionController::configure(const AdmissionConfig& newConfig) {
+    std::lock_guard<std::mutex> lock(mutex);
+    config = newConfig;
+    config.minLimit = std::max<size_t>(1, config.minLimit);
+    config.maxLimit = std::max(config.minLimit, config.maxLimit);
+    limit = static_cast<double>(std::min(config.maxLimit, std::max(config.minLimit, config.initialLimit)));
+    dispatchLocked();
+}
+
+const AdmissionConfig& AdmissionController::getConfig() const {
+    return config;
+}
+
+RequestClass AdmissionController::classify(const std::string& method, const std::string& path) {
+    if (!startsWith(path, "/api/")) {
+        return RequestClass::Static;
+    }
+    if (path == "/api/health" || startsWith(path, "/api/admin/") || startsWith(path, "/api/debug/")) {
+        return RequestClass::Exempt;
+    }
+    if ((method == "POST" && path == "/api/cart/checkout") || path == "/api/login" || path == "/api/signup") {
+        return RequestClass::Critical;
+    }
+    if (startsWith(path, "/api/cart") || path == "/api/me" || path == "/api/profile" ||
+        path == "/api/purchase-history" || path == "/api/batch") {
+        return RequestClass::Cart;
+    }
+    return RequestClass::Browse;
+}
+
+const char* AdmissionController::className(RequestClass requestClass) {
+    switch (requestClass) {
+        case RequestClass::Critical: return "critical";
+        case RequestClass::Cart: return "cart";
+        case RequestClass::Browse: return "browse";
+        case RequestClass::Static: return "static";
+        default: return "exempt";
+    }
+}
+
+bool AdmissionController::hasWaiters() const {
+    for (size_t i = 0; i < REQUEST_CLASS_COUNT; ++i) {
+        if (!queues[i].empty()) return true;
+    }
+    return false;
+}
+
+// Admit waiters while there is room, picking classes by smooth weighted round robin
+void AdmissionController::dispatchLocked() {
+    while (static_cast<double>(inFlight) < limit && hasWaiters()) {
+        long long total = 0;
+        size_t best = REQUEST_CLASS_COUNT;
+        for (size_t i = 0; i < REQUEST_CLASS_COUNT; ++i) {
+            if (queues[i].empty()) continue;
+            credit[i] += config.weights[i];
+            total += config.weights[i];
+            if (best == REQUEST_CLASS_COUNT || credit[i] > credit[best]) best = i;
+        }
+        credit[best] -= total;
+
+        Waiter* waiter = queues[best].front();
+        queues[best].pop_front();
+        waiter->admitted = true;
+        inFlight++;
+        admitted[best]++;
+        waiter->wakeup.notify_one();
+    }
+}
+
+bool AdmissionController::acquire(RequestClass requestClass, long long maxWaitMs) {
+    if (requestClass == RequestClass::Exempt) {
+        return true;
+    }
+    size_t index = static_cast<size_t>(requestClass);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!config.enabled) {
+        inFlight++;
+        admitted[index]++;
+        return true;
+    }
+    if (static_cast<double>(inFlight) < limit && !hasWaiters()) {
+        inFlight++;
+        admitted[index]++;
+        return true;
+    }
+    if (queues[index].size() >= config.queueCapacity[index]) {
+        shed[index]++;
+        return false;
+    }
+
+    long long waitMs = config.maxWaitMs[index];
+    if (maxWaitMs >= 0 && maxWaitMs < waitMs) {
+        waitMs = maxWaitMs;
+    }
+
+    Waiter waiter;
+    queues[index].push_back(&waiter);
+    bool admittedInTime = waiter.wakeup.wait_for(lock, std::chrono::milliseconds(waitMs),
+                                                 [&waiter] { return waiter.admitted; });
+    if (!admittedInTime) {
+        auto& queue = queues[index];
+        queue.erase(std::find(queue.begin(), queue.end(), &waiter));
+        shed[index]++;
+        return false;
+    }
+    return true;
+}
+
+void AdmissionController::release(long long serviceUs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (inFlight > 0) inFlight--;
+
+    if (config.enabled) {
+        completionsSinceBackoff++;
+        if (serviceUs > config.latencyTargetMs * 1000) {
+            // At most one decrease per limit's worth of completions, so one slow burst backs off once
+            if (completionsSinceBackoff >= static_cast<size_t>(limit)) {
+                limit = std::max(static_cast<double>(config.minLimit), limit * config.backoff);
+                completionsSinceBackoff = 0;
+            }
+        } else if (static_cast<double>(inFlight + 1) >= limit || hasWaiters()) {
+            // Only grow while the limit is what holds requests back
+            limit = std::min(static_cast<double>(config.maxLimit), limit + 1.0 / limit);
+        }
+    }
+    dispatchLocked();
+}
+
+AdmissionStats AdmissionController::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    AdmissionStats stats;
+    stats.limit = limit;
+    stats.inFlight = inFlight;
+    for (size_t i = 0; i < REQUEST_CLASS_COUNT; ++i) {
+        AdmissionClassStats entry;
+        entry.name = className(static_cast<RequestClass>(i));
+        entry.queued = queues[i].size();
+        entry.admitted = admitted[i];
+        entry.shed = shed[i];
+        stats.classes.push_back(entry);
+    }
+    return stats;
+}
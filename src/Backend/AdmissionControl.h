@@ -0,0 +1,115 @@
+/**
+ * AdmissionControl - priority-aware admission of requests under overload
+ * Requests are classified by route into priority classes. At most `limit`
+ * requests run at once; the rest wait in per-class queues that are drained by
+ * smooth weighted round robin, so checkout keeps flowing while catalog and
+ * static traffic queue. Lower classes get shorter queues and shorter waits,
+ * so they are shed first. The limit itself adapts AIMD-style: it grows by
+ * one per limit's worth of fast completions and backs off multiplicatively
+ * when requests take longer than the latency target.
+ */
+
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Highest priority first
+enum class RequestClass {
+    Critical,   // checkout, login, signup
+    Cart,       // cart, profile, purchase history, batch
+    Browse,     // catalog, search
+    Static,     // files from ./public
+    Exempt      // health checks and admin endpoints are never queued or shed
+};
+
+static const size_t REQUEST_CLASS_COUNT = 4; // classes that are admitted (all but Exempt)
+
+struct AdmissionConfig {
+    bool enabled;
+    size_t initialLimit;
+    size_t minLimit;
+    size_t maxLimit;
+    long long latencyTargetMs;           // completions slower than this shrink the limit
+    double backoff;                      // multiplicative decrease, e.g. 0.9
+    unsigned int weights[REQUEST_CLASS_COUNT];
+    size_t queueCapacity[REQUEST_CLASS_COUNT];
+    long long maxWaitMs[REQUEST_CLASS_COUNT];
+
+    // Queue capacities as sizeQueues() sets them for the default 64 HTTP workers
+    AdmissionConfig()
+        : enabled(true), initialLimit(16), minLimit(2), maxLimit(32), latencyTargetMs(250), backoff(0.9),
+          weights{8, 4, 2, 1}, queueCapacity{8, 13, 6, 3}, maxWaitMs{5000, 2000, 1000, 500} {}
+
+    /**
+     * Size the queues from the HTTP workers left over once maxLimit requests run. Every
+     * waiter blocks a worker, so the queues together never hold more than the spare workers,
+     * and a quarter of them (at least one) is reserved for the critical class; the other
+     * classes split the rest by weight. Otherwise low-priority waiters could occupy every
+     * worker and a checkout would sit unread in the server's task queue.
+     */
+    void sizeQueues(size_t workerThreads);
+};
+
+struct AdmissionClassStats {
+    std::string name;
+    size_t queued;
+    unsigned long long admitted;
+    unsigned long long shed;
+};
+
+struct AdmissionStats {
+    double limit;
+    size_t inFlight;
+    std::vector<AdmissionClassStats> classes;
+};
+
+class AdmissionController {
+private:
+    struct Waiter {
+        bool admitted;
+        std::condition_variable wakeup;
+
+        Waiter() : admitted(false) {}
+    };
+
+    mutable std::mutex mutex;
+    AdmissionConfig config;
+    double limit;
+    size_t inFlight;
+    size_t completionsSinceBackoff;
+    std::deque<Waiter*> queues[REQUEST_CLASS_COUNT];
+    long long credit[REQUEST_CLASS_COUNT];  // smooth weighted round robin state
+    unsigned long long admitted[REQUEST_CLASS_COUNT];
+    unsigned long long shed[REQUEST_CLASS_COUNT];
+
+    bool hasWaiters() const;
+    void dispatchLocked();
+
+public:
+    AdmissionController();
+
+    void configure(const AdmissionConfig& newConfig);
+    const AdmissionConfig& getConfig() const;
+
+    static RequestClass classify(const std::string& method, const std::string& path);
+    static const char* className(RequestClass requestClass);
+
+    /**
+     * Wait for a slot for a request of the given class, at most the class's
+     * max wait or maxWaitMs, whichever is shorter (e.g. the request's remaining deadline)
+     * @return false if the request was shed (its queue was full or it waited too long)
+     */
+    bool acquire(RequestClass requestClass, long long maxWaitMs = -1);
+
+    // Return the slot taken by acquire(); serviceUs feeds the adaptive limit
+    void release(long long serviceUs);
+
+    AdmissionStats getStats() const;
+};
+
+#endif // ADMISSION_CONTROL_H
@@ -1,10 +1,19 @@
 #include "Cart.h"
 
 #include <algorithm>
+#include <chrono>
+#include <utility>
 
-Cart::Cart() = default;
+Cart::Cart() : lastTouchedMs(0), version(0) {}
 Cart::~Cart() = default;
 
+void Cart::touch() {
+  version++;
+  lastTouchedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()
+  ).count();
+}
+
 CartItem* Cart::findItem(const std::string& productId) {
   auto it = std::find_if(
     items.begin(),
@@ -32,6 +41,7 @@ void Cart::addItem(const CartItem& item) {
   } else if (item.quantity > 0) {
     items.push_back(item);
   }
+  touch();
 }
 
 bool Cart::updateQuantity(const std::string& productId, unsigned int quantity) {
@@ -46,6 +56,7 @@ bool Cart::updateQuantity(const std::string& productId, unsigned int quantity) {
   }
 
   existing->quantity = quantity;
+  touch();
   return true;
 }
 
@@ -59,11 +70,36 @@ bool Cart::removeItem(const std::string& productId) {
     ),
     items.end()
   );
-  return items.size() != originalSize;
+  if (items.size() == originalSize) {
+    return false;
+  }
+  touch();
+  return true;
 }
 
 void Cart::clear() {
   items.clear();
+  touch();
+}
+
+void Cart::applyPrices(const std::vector<double>& prices, const std::vector<bool>& available) {
+  if (prices.size() != items.size() || available.size() != items.size()) {
+    return;
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (!available[i]) {
+      continue;
+    }
+    if (kept != i) {
+      items[kept] = std::move(items[i]);
+    }
+    items[kept].price = prices[i];
+    kept++;
+  }
+  items.resize(kept);
+  version++;
 }
 
 bool Cart::isEmpty() const {
@@ -82,4 +118,27 @@ const std::vector<CartItem>& Cart::getItems() const {
   return items;
 }
 
+long long Cart::getVersion() const {
+  return version;
+}
+
+void Cart::setVersion(long long newVersion) {
+  version = newVersion;
+}
+
+long long Cart::getLastTouched() const {
+  return lastTouchedMs;
+}
+
+void Cart::setLastTouched(long long epochMs) {
+  lastTouchedMs = epochMs;
+}
+
+bool Cart::isAbandoned(long long cutoffMs) const {
+  if (items.empty() || lastTouchedMs <= 0) {
+    return false;
+  }
+  return lastTouchedMs < cutoffMs;
+}
+
 
@@ -5,6 +5,7 @@
 #ifndef CART_H
 #define CART_H
 
+#include <climits>
 #include <string>
 #include <vector>
 
@@ -13,15 +14,16 @@ struct CartItem {
   std::string name;
   double price;
   unsigned int quantity;
+  unsigned int catalogSlot; // interned catalog position (CatalogSnapshot), UINT_MAX = unknown
 
   CartItem()
-    : productId(""), name(""), price(0.0), quantity(0) {}
+    : productId(""), name(""), price(0.0), quantity(0), catalogSlot(UINT_MAX) {}
 
   CartItem(const std::string& id,
            const std::string& displayName,
            double unitPrice,
            unsigned int qty = 1U)
-    : productId(id), name(displayName), price(unitPrice), quantity(qty) {}
+    : productId(id), name(displayName), price(unitPrice), quantity(qty), catalogSlot(UINT_MAX) {}
 
   double subtotal() const {
     return price * static_cast<double>(quantity);
@@ -31,22 +33,42 @@ struct CartItem {
 class Cart {
 private:
   std::vector<CartItem> items;
+  long long lastTouchedMs; // wall-clock ms of the last mutation, 0 = unknown
+  long long version;       // bumped by every change to the lines, never reset
 
   CartItem* findItem(const std::string& productId);
   const CartItem* findItem(const std::string& productId) const;
+  void touch();
 
 public:
   Cart();
   ~Cart();
+  Cart(const Cart&) = default;
+  Cart(Cart&&) = default;
+  Cart& operator=(const Cart&) = default;
+  Cart& operator=(Cart&&) = default;
 
   void addItem(const CartItem& item);
   bool updateQuantity(const std::string& productId, unsigned int quantity);
   bool removeItem(const std::string& productId);
   void clear();
   bool isEmpty() const;
+  // Set every line's price from a parallel array and drop lines marked unavailable.
+  // Not a customer change, so the last-touched time is kept.
+  void applyPrices(const std::vector<double>& prices, const std::vector<bool>& available);
 
   double getTotal() const;
   const std::vector<CartItem>& getItems() const;
+
+  // Change counter for conditional GETs; copied with the cart, so an emptied cart keeps counting
+  long long getVersion() const;
+  void setVersion(long long newVersion);
+
+  // Cart lifecycle - mutations stamp the last-touched time
+  long long getLastTouched() const;
+  void setLastTouched(long long epochMs);
+  // True if the cart has items and was last touched before cutoffMs
+  bool isAbandoned(long long cutoffMs) const;
 };
 
 #endif // CART_H
\ No newline at end of file
@@ -0,0 +1,141 @@
+/**
+ * CartSweeper - Implementation
+ */
+
+#include "CartSweeper.h"
+#include <iomanip>
+#include <sstream>
+
+CartArchive::CartArchive(size_t capacity) : capacity(capacity) {
+}
+
+void CartArchive::setCapacity(size_t newCapacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = newCapacity;
+    while (entries.size() > capacity) {
+        entries.pop_front();
+    }
+}
+
+void CartArchive::add(const std::string& userId, const Cart& cart, long long expiredAtMs) {
+    if (capacity == 0) return;
+
+    ArchivedCart entry;
+    entry.userId = userId;
+    entry.lastTouchedMs = cart.getLastTouched();
+    entry.expiredAtMs = expiredAtMs;
+    entry.items = encodeItems(cart.getItems());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back(std::move(entry));
+    while (entries.size() > capacity) {
+        entries.pop_front();
+    }
+}
+
+size_t CartArchive::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+std::vector<ArchivedCart> CartArchive::recent(size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<ArchivedCart> result;
+    for (auto it = entries.rbegin(); it != entries.rend() && result.size() < limit; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+std::string CartArchive::encodeItems(const std::vector<CartItem>& items) {
+    // Names are not stored - they can be looked up from the catalog by productId
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    for (const auto& item : items) {
+        oss << item.productId << '*' << item.quantity << '@' << item.price << ';';
+    }
+    return oss.str();
+}
+
+std::vector<CartItem> CartArchive::decodeItems(const std::string& encoded) {
+    std::vector<CartItem> items;
+    size_t start = 0;
+    while (start < encoded.size()) {
+        size_t end = encoded.find(';', start);
+        if (end == std::string::npos) end = encoded.size();
+        std::string token = encoded.substr(start, end - start);
+        start = end + 1;
+
+        size_t star = token.find('*');
+        size_t at = token.find('@', star == std::string::npos ? 0 : star);
+        if (star == std::string::npos || at == std::string::npos) continue;
+        try {
+            CartItem item(token.substr(0, star), "",
+                          std::stod(token.substr(at + 1)),
+                          static_cast<unsigned int>(std::stoul(token.substr(star + 1, at - star - 1))));
+            items.push_back(item);
+        } catch (...) {
+            // Skip malformed entries
+        }
+    }
+    return items;
+}
+
+CartSweeper::CartSweeper()
+    : nextPassAtMs(0), expiredTotal(0), batchCount(0), passCount(0) {
+}
+
+CartSweeper::~CartSweeper() = default;
+
+void CartSweeper::configure(const CartSweeperConfig& newConfig) {
+    std::lock_guard<std::mutex> lock(mutex);
+    config = newConfig;
+}
+
+CartSweeperConfig CartSweeper::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return config;
+}
+
+void CartSweeper::setBatchFunction(BatchFunction batch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    batchFunction = std::move(batch);
+}
+
+bool CartSweeper::tick(long long now) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!batchFunction || config.expiryMs <= 0 || now < nextPassAtMs) return false;
+    }
+    if (runBatch(now)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        nextPassAtMs = now + config.passIntervalMs;
+    }
+    return true;
+}
+
+bool CartSweeper::runBatch(long long now) {
+    BatchFunction batch;
+    CartSweeperConfig current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch = batchFunction;
+        current = config;
+    }
+    if (!batch || current.expiryMs <= 0) return true;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(current.sliceBudgetUs);
+    size_t expired = 0;
+    bool passDone = batch(now - current.expiryMs, current.batchSize, deadline, expired);
+
+    expiredTotal += expired;
+    batchCount++;
+    if (passDone) passCount++;
+    return passDone;
+}
+
+long long CartSweeper::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
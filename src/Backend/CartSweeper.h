@@ -0,0 +1,118 @@
+/**
+ * CartSweeper - expires carts that have not been touched for a configurable period
+ * Works incrementally: each batch examines a bounded number of users and stops
+ * early once its time slice is used up, so the sweep never holds the user store
+ * lock long enough to stall request handlers. Driven by the server's Scheduler,
+ * which calls tick() every batchPauseMs.
+ */
+
+#ifndef CART_SWEEPER_H
+#define CART_SWEEPER_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Cart.h"
+
+struct CartSweeperConfig {
+    long long expiryMs;       // carts untouched for longer than this are expired (0 disables)
+    size_t batchSize;         // users examined per batch
+    long long sliceBudgetUs;  // time budget for a single batch
+    long long batchPauseMs;   // scheduler period - pause between batches of the same pass
+    long long passIntervalMs; // pause between full passes
+    bool archive;             // keep expired carts in the archive instead of dropping them
+    size_t archiveCapacity;   // oldest archived carts are discarded beyond this
+
+    CartSweeperConfig()
+        : expiryMs(72LL * 60 * 60 * 1000), batchSize(100), sliceBudgetUs(2000),
+          batchPauseMs(50), passIntervalMs(60 * 1000), archive(false), archiveCapacity(10000) {}
+};
+
+// Expired cart kept for recovery / analytics, items packed into one string
+struct ArchivedCart {
+    std::string userId;
+    long long lastTouchedMs;
+    long long expiredAtMs;
+    std::string items; // "productId*quantity@price;..." (see CartArchive::encodeItems)
+};
+
+class CartArchive {
+private:
+    mutable std::mutex mutex;
+    std::deque<ArchivedCart> entries; // oldest first
+    size_t capacity;
+
+public:
+    explicit CartArchive(size_t capacity = 10000);
+
+    void setCapacity(size_t capacity);
+    void add(const std::string& userId, const Cart& cart, long long expiredAtMs);
+    size_t size() const;
+
+    /**
+     * Most recently archived carts, newest first
+     */
+    std::vector<ArchivedCart> recent(size_t limit) const;
+
+    static std::string encodeItems(const std::vector<CartItem>& items);
+    static std::vector<CartItem> decodeItems(const std::string& encoded);
+};
+
+class CartSweeper {
+public:
+    /**
+     * Expire one batch of carts
+     * @param cutoffMs carts last touched before this wall-clock time are expired
+     * @param batchSize maximum number of users to examine
+     * @param sliceDeadline stop examining users after this point
+     * @param expired incremented for every cart expired
+     * @return true if the pass is complete (no users left after this batch)
+     */
+    using BatchFunction = std::function<bool(long long cutoffMs,
+                                             size_t batchSize,
+                                             std::chrono::steady_clock::time_point sliceDeadline,
+                                             size_t& expired)>;
+
+private:
+    CartSweeperConfig config;
+    BatchFunction batchFunction;
+    mutable std::mutex mutex;
+    long long nextPassAtMs; // passes are spaced passIntervalMs apart
+    std::atomic<unsigned long long> expiredTotal;
+    std::atomic<unsigned long long> batchCount;
+    std::atomic<unsigned long long> passCount;
+
+public:
+    CartSweeper();
+    ~CartSweeper();
+
+    void configure(const CartSweeperConfig& config);
+    CartSweeperConfig getConfig() const;
+
+    void setBatchFunction(BatchFunction batch);
+
+    /**
+     * Periodic entry point: runs one batch unless the sweeper is waiting
+     * for the next pass (or expiry is disabled)
+     * @return true if a batch ran
+     */
+    bool tick(long long nowMs);
+
+    /**
+     * Run a single batch synchronously against the given clock
+     * @return true if the batch completed a pass
+     */
+    bool runBatch(long long nowMs);
+
+    unsigned long long expired() const { return expiredTotal.load(); }
+    unsigned long long batches() const { return batchCount.load(); }
+    unsigned long long passes() const { return passCount.load(); }
+
+    static long long nowMs();
+};
+
+#endif // CART_SWEEPER_H
@@ -0,0 +1,175 @@
+/**
+ * Catalog - Implementation
+ */
+
+#include "Catalog.h"
+#include "Cart.h"
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_set>
+#include <utility>
+
+const unsigned int CatalogSnapshot::NO_SLOT = UINT_MAX;
+
+namespace {
+// Prices are dollars and cents; smaller differences are float noise, not a change
+const double PRICE_EPSILON = 0.005;
+
+const char CATALOG_MAGIC[4] = {'C', 'A', 'T', 'L'};
+const unsigned char CATALOG_FORMAT_VERSION = 1;
+
+void writeVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void writeString(std::string& out, const std::string& value) {
+    writeVarint(out, value.size());
+    out.append(value);
+}
+
+bool readVarint(const std::string& in, size_t& pos, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) return false;
+        unsigned char byte = static_cast<unsigned char>(in[pos++]);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool readString(const std::string& in, size_t& pos, std::string& value) {
+    std::uint64_t length;
+    if (!readVarint(in, pos, length) || length > in.size() - pos) return false;
+    value.assign(in, pos, static_cast<size_t>(length));
+    pos += static_cast<size_t>(length);
+    return true;
+}
+}
+
+CatalogSnapshot::CatalogSnapshot(std::vector<CatalogItem> items, unsigned long long generation)
+    : items(std::move(items)), generation(generation) {
+    slots.reserve(this->items.size());
+    for (size_t i = 0; i < this->items.size(); ++i) {
+        slots.emplace(this->items[i].id, static_cast<unsigned int>(i));
+    }
+}
+
+const std::vector<CatalogItem>& CatalogSnapshot::getItems() const {
+    return items;
+}
+
+size_t CatalogSnapshot::size() const {
+    return items.size();
+}
+
+unsigned long long CatalogSnapshot::getGeneration() const {
+    return generation;
+}
+
+unsigned int CatalogSnapshot::slotOf(const std::string& productId) const {
+    auto it = slots.find(productId);
+    return it != slots.end() ? it->second : NO_SLOT;
+}
+
+unsigned int CatalogSnapshot::resolve(const std::string& productId, unsigned int hint) const {
+    if (hint < items.size() && items[hint].id == productId) {
+        return hint;
+    }
+    return slotOf(productId);
+}
+
+const CatalogItem& CatalogSnapshot::at(unsigned int slot) const {
+    return items[slot];
+}
+
+std::shared_ptr<const CatalogSnapshot> CatalogSnapshot::withPrice(unsigned int slot, double price) const {
+    auto updated = std::make_shared<CatalogSnapshot>(*this);
+    updated->items[slot].price = price;
+    updated->generation = generation + 1;
+    return updated;
+}
+
+void CatalogSnapshot::reprice(const std::vector<CartItem>& lines, RepriceResult& result) const {
+    result = RepriceResult();
+    result.prices.resize(lines.size());
+    result.available.resize(lines.size());
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const CartItem& line = lines[i];
+        unsigned int slot = resolve(line.productId, line.catalogSlot);
+        bool available = slot != NO_SLOT;
+        double price = available ? items[slot].price : line.price;
+        result.prices[i] = price;
+        result.available[i] = available;
+
+        if (!available || std::fabs(price - line.price) >= PRICE_EPSILON) {
+            PriceChange change;
+            change.productId = line.productId;
+            change.name = line.name;
+            change.oldPrice = line.price;
+            change.newPrice = price;
+            change.available = available;
+            result.changes.push_back(change);
+        }
+        if (available) {
+            result.total += price * static_cast<double>(line.quantity);
+        }
+    }
+}
+
+std::string CatalogCodec::encode(const std::vector<CatalogItem>& items) {
+    std::string out(CATALOG_MAGIC, sizeof(CATALOG_MAGIC));
+    out.push_back(static_cast<char>(CATALOG_FORMAT_VERSION));
+    writeVarint(out, items.size());
+    for (const auto& item : items) {
+        writeString(out, item.id);
+        writeString(out, item.name);
+        writeString(out, item.description);
+        std::uint64_t bits;
+        std::memcpy(&bits, &item.price, sizeof(bits));
+        for (int i = 0; i < 8; ++i) {
+            out.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+        }
+    }
+    return out;
+}
+
+bool CatalogCodec::decode(const std::string& bytes, std::vector<CatalogItem>& items) {
+    items.clear();
+    if (bytes.size() < sizeof(CATALOG_MAGIC) + 1 ||
+        bytes.compare(0, sizeof(CATALOG_MAGIC), CATALOG_MAGIC, sizeof(CATALOG_MAGIC)) != 0 ||
+        static_cast<unsigned char>(bytes[sizeof(CATALOG_MAGIC)]) != CATALOG_FORMAT_VERSION) {
+        return false;
+    }
+
+    size_t pos = sizeof(CATALOG_MAGIC) + 1;
+    std::uint64_t count;
+    // Every item takes at least 11 bytes, which bounds what a corrupt count can allocate
+    if (!readVarint(bytes, pos, count) || count > (bytes.size() - pos) / 11) return false;
+
+    std::vector<CatalogItem> decoded(static_cast<size_t>(count));
+    std::unordered_set<std::string> ids;
+    ids.reserve(decoded.size());
+    for (auto& item : decoded) {
+        if (!readString(bytes, pos, item.id) || !readString(bytes, pos, item.name) ||
+            !readString(bytes, pos, item.description) || bytes.size() - pos < 8) {
+            return false;
+        }
+        std::uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+            bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[pos++])) << (8 * i);
+        }
+        std::memcpy(&item.price, &bits, sizeof(item.price));
+        if (!ids.insert(item.id).second) return false;
+    }
+    if (pos != bytes.size()) return false;
+    items.swap(decoded);
+    return true;
+}
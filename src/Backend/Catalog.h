@@ -0,0 +1,96 @@
+/**
+ * Catalog - immutable snapshot of the product catalog and checkout repricing
+ * Product ids are interned to slots that stay stable across snapshots, so a cart
+ * line remembers its slot and repricing a cart is one pass over the snapshot's
+ * array instead of a string lookup per line.
+ * CatalogCodec reads and writes catalogs as a binary file (CATALOG_FILE).
+ */
+
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct CartItem;
+
+// Catalog item structure
+struct CatalogItem {
+    std::string id;
+    std::string name;
+    double price;
+    std::string description;
+
+    CatalogItem() : id(""), name(""), price(0.0), description("") {}
+    CatalogItem(const std::string& itemId, const std::string& itemName,
+                double itemPrice, const std::string& itemDesc = "")
+        : id(itemId), name(itemName), price(itemPrice), description(itemDesc) {}
+};
+
+// A cart line whose catalog price differs from the price it was added at
+struct PriceChange {
+    std::string productId;
+    std::string name;
+    double oldPrice;
+    double newPrice;
+    bool available; // false if the product is no longer in the catalog
+
+    PriceChange() : oldPrice(0.0), newPrice(0.0), available(true) {}
+};
+
+// Result of repricing a cart; prices/available are parallel to the cart lines
+struct RepriceResult {
+    std::vector<double> prices;
+    std::vector<bool> available;
+    std::vector<PriceChange> changes;
+    double total; // current-price total of the available lines
+
+    RepriceResult() : total(0.0) {}
+};
+
+class CatalogSnapshot {
+private:
+    std::vector<CatalogItem> items;
+    std::unordered_map<std::string, unsigned int> slots; // product id -> index into items
+    unsigned long long generation;
+
+public:
+    static const unsigned int NO_SLOT;
+
+    CatalogSnapshot(std::vector<CatalogItem> items, unsigned long long generation);
+
+    const std::vector<CatalogItem>& getItems() const;
+    size_t size() const;
+    unsigned long long getGeneration() const; // bumped by every published change
+
+    // Slot of a product id, or NO_SLOT
+    unsigned int slotOf(const std::string& productId) const;
+    // Slot of a product using a remembered slot when it still matches, else a lookup
+    unsigned int resolve(const std::string& productId, unsigned int hint) const;
+    const CatalogItem& at(unsigned int slot) const;
+
+    // New snapshot with one price changed; slots are unchanged
+    std::shared_ptr<const CatalogSnapshot> withPrice(unsigned int slot, double price) const;
+
+    // Price every cart line against this snapshot in one pass
+    void reprice(const std::vector<CartItem>& lines, RepriceResult& result) const;
+};
+
+class CatalogCodec {
+public:
+    /**
+     * Encode as "CATL", a format version and the item count, then each item's
+     * length-prefixed id, name and description and its price (little-endian double)
+     */
+    static std::string encode(const std::vector<CatalogItem>& items);
+
+    /**
+     * @return false if the bytes are truncated, corrupt or another format version,
+     *         or two items share an id
+     */
+    static bool decode(const std::string& bytes, std::vector<CatalogItem>& items);
+};
+
+#endif // CATALOG_H
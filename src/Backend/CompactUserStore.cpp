@@ -0,0 +1,446 @@
+/**
+ * CompactUserStore - Implementation
+ */
+
+#include "CompactUserStore.h"
+#include "UserIndex.h"
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const size_t INLINE_CAPACITY = 7;
+const size_t MAX_FIELD_LENGTH = (1u << 23) - 1;
+const size_t MIN_BUCKETS = 16;
+const size_t COMPACT_MIN_GARBAGE = 64 * 1024;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+char lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// The email index key is the trimmed, lowercase address (UserIndex::normalizeEmail)
+void trim(const char*& data, size_t& size) {
+    while (size > 0 && isSpace(data[0])) {
+        data++;
+        size--;
+    }
+    while (size > 0 && isSpace(data[size - 1])) size--;
+}
+
+bool isInline(unsigned char tag) {
+    return (tag & 0x80) != 0;
+}
+
+// Where a packed string's characters live: in the record itself, or in the blob
+struct Span {
+    const char* data;
+    size_t size;
+};
+
+Span spanOf(const unsigned char* bytes, unsigned char tag, const std::string& blob) {
+    if (isInline(tag)) {
+        return Span{reinterpret_cast<const char*>(bytes), static_cast<size_t>(tag & 0x7f)};
+    }
+    std::uint64_t offset = 0;
+    for (int i = 0; i < 5; ++i) {
+        offset |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+    }
+    size_t size = bytes[5] | (static_cast<size_t>(bytes[6]) << 8) | (static_cast<size_t>(tag & 0x7f) << 16);
+    return Span{blob.data() + offset, size};
+}
+
+bool isPristine(long long cartVersion, long long cartTouched) {
+    return cartVersion == 0 && cartTouched == 0;
+}
+
+} // namespace
+
+CompactUserStore::CompactUserStore() : garbage(0) {}
+
+// --- Packed strings -------------------------------------------------------
+
+CompactUserStore::PackedString CompactUserStore::pack(const std::string& value) {
+    PackedString packed;
+    std::memset(&packed, 0, sizeof(packed));
+    if (value.size() <= INLINE_CAPACITY) {
+        std::memcpy(packed.bytes, value.data(), value.size());
+        packed.tag = static_cast<unsigned char>(0x80 | value.size());
+        return packed;
+    }
+    if (value.size() > MAX_FIELD_LENGTH) {
+        throw std::length_error("CompactUserStore: profile field longer than 8 MB");
+    }
+
+    std::uint64_t offset = blob.size();
+    blob.append(value);
+    for (int i = 0; i < 5; ++i) {
+        packed.bytes[i] = static_cast<unsigned char>((offset >> (8 * i)) & 0xff);
+    }
+    packed.bytes[5] = static_cast<unsigned char>(value.size() & 0xff);
+    packed.bytes[6] = static_cast<unsigned char>((value.size() >> 8) & 0xff);
+    packed.tag = static_cast<unsigned char>((value.size() >> 16) & 0x7f);
+    return packed;
+}
+
+std::string CompactUserStore::view(const PackedString& value) const {
+    Span span = spanOf(value.bytes, value.tag, blob);
+    return std::string(span.data, span.size);
+}
+
+bool CompactUserStore::fieldEquals(const PackedString& packed, const char* data, size_t size) const {
+    Span span = spanOf(packed.bytes, packed.tag, blob);
+    return span.size == size && std::memcmp(span.data, data, size) == 0;
+}
+
+void CompactUserStore::release(const PackedString& value) {
+    if (!isInline(value.tag)) {
+        garbage += spanOf(value.bytes, value.tag, blob).size;
+    }
+}
+
+void CompactUserStore::writeProfile(Record& record, const UserProfile& profile) {
+    record.fields[ID] = pack(profile.id);
+    record.fields[USERNAME] = pack(profile.username);
+    record.fields[EMAIL] = pack(profile.email);
+    record.fields[PASSWORD] = pack(profile.password);
+    record.fields[FULL_NAME] = pack(profile.fullName);
+    record.fields[BIO] = pack(profile.bio);
+}
+
+bool CompactUserStore::profileEquals(const Record& record, const UserProfile& profile) const {
+    const std::string* values[FIELD_COUNT] = {&profile.id,       &profile.username, &profile.email,
+                                              &profile.password, &profile.fullName, &profile.bio};
+    for (int field = 0; field < FIELD_COUNT; ++field) {
+        if (!fieldEquals(record.fields[field], values[field]->data(), values[field]->size())) return false;
+    }
+    return true;
+}
+
+// Overwritten long fields leave holes in the blob; rewrite it once they are half of it
+void CompactUserStore::compactIfWasteful() {
+    if (garbage < COMPACT_MIN_GARBAGE || garbage * 2 < blob.size()) return;
+
+    std::string old;
+    old.swap(blob);
+    blob.reserve(old.size() - garbage);
+    for (auto& record : records) {
+        for (auto& field : record.fields) {
+            if (isInline(field.tag)) continue;
+            Span span = spanOf(field.bytes, field.tag, old);
+            field = pack(std::string(span.data, span.size));
+        }
+    }
+    garbage = 0;
+}
+
+// --- Slot tables ----------------------------------------------------------
+
+size_t CompactUserStore::hashOf(Field field, const char* data, size_t size) const {
+    if (field == EMAIL) trim(data, size);
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        char c = field == EMAIL ? lower(data[i]) : data[i];
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+bool CompactUserStore::keyMatches(Field field, std::uint32_t slot, const char* data, size_t size) const {
+    const PackedString& packed = records[slot].fields[field];
+    if (field != EMAIL) return fieldEquals(packed, data, size);
+
+    Span stored = spanOf(packed.bytes, packed.tag, blob);
+    trim(stored.data, stored.size);
+    trim(data, size);
+    if (stored.size != size) return false;
+    for (size_t i = 0; i < size; ++i) {
+        if (lower(stored.data[i]) != lower(data[i])) return false;
+    }
+    return true;
+}
+
+CompactUserStore::SlotTable& CompactUserStore::tableFor(Field field) {
+    return field == USERNAME ? byUsername : (field == ID ? byId : byEmail);
+}
+
+const CompactUserStore::SlotTable& CompactUserStore::tableFor(Field field) const {
+    return field == USERNAME ? byUsername : (field == ID ? byId : byEmail);
+}
+
+bool CompactUserStore::findSlot(Field field, const std::string& key, std::uint32_t& slot) const {
+    const SlotTable& table = tableFor(field);
+    if (table.count == 0 || key.empty()) return false;
+
+    size_t mask = table.buckets.size() - 1;
+    for (size_t i = hashOf(field, key.data(), key.size()) & mask;; i = (i + 1) & mask) {
+        std::uint32_t bucket = table.buckets[i];
+        if (bucket == 0) return false;
+        if (keyMatches(field, bucket - 1, key.data(), key.size())) {
+            slot = bucket - 1;
+            return true;
+        }
+    }
+}
+
+void CompactUserStore::rehash(Field field, size_t bucketCount) {
+    SlotTable& table = tableFor(field);
+    std::vector<std::uint32_t> old;
+    old.swap(table.buckets);
+    table.buckets.assign(bucketCount, 0);
+    size_t mask = bucketCount - 1;
+    for (std::uint32_t bucket : old) {
+        if (bucket == 0) continue;
+        Span key = spanOf(records[bucket - 1].fields[field].bytes, records[bucket - 1].fields[field].tag, blob);
+        size_t i = hashOf(field, key.data, key.size) & mask;
+        while (table.buckets[i] != 0) i = (i + 1) & mask;
+        table.buckets[i] = bucket;
+    }
+}
+
+// A later user with the same key takes the entry over, like UserIndex::add
+void CompactUserStore::indexSlot(Field field, std::uint32_t slot) {
+    const PackedString& packed = records[slot].fields[field];
+    Span key = spanOf(packed.bytes, packed.tag, blob);
+    if (field == EMAIL) trim(key.data, key.size);
+    if (key.size == 0) return;
+
+    SlotTable& table = tableFor(field);
+    if ((table.count + 1) * 10 > table.buckets.size() * 7) {
+        rehash(field, table.buckets.empty() ? MIN_BUCKETS : table.buckets.size() * 2);
+    }
+    size_t mask = table.buckets.size() - 1;
+    for (size_t i = hashOf(field, key.data, key.size) & mask;; i = (i + 1) & mask) {
+        std::uint32_t bucket = table.buckets[i];
+        if (bucket == 0) {
+            table.buckets[i] = slot + 1;
+            table.count++;
+            return;
+        }
+        if (keyMatches(field, bucket - 1, key.data, key.size)) {
+            table.buckets[i] = slot + 1;
+            return;
+        }
+    }
+}
+
+// Remove the slot's entry (if the key still points at it) with backward-shift deletion
+void CompactUserStore::unindexSlot(Field field, std::uint32_t slot) {
+    SlotTable& table = tableFor(field);
+    if (table.count == 0) return;
+    const PackedString& packed = records[slot].fields[field];
+    Span key = spanOf(packed.bytes, packed.tag, blob);
+
+    size_t mask = table.buckets.size() - 1;
+    size_t hole = hashOf(field, key.data, key.size) & mask;
+    for (;; hole = (hole + 1) & mask) {
+        if (table.buckets[hole] == 0) return;
+        if (table.buckets[hole] == slot + 1) break;
+    }
+    table.buckets[hole] = 0;
+    table.count--;
+
+    for (size_t next = (hole + 1) & mask; table.buckets[next] != 0; next = (next + 1) & mask) {
+        const PackedString& moved = records[table.buckets[next] - 1].fields[field];
+        Span movedKey = spanOf(moved.bytes, moved.tag, blob);
+        size_t home = hashOf(field, movedKey.data, movedKey.size) & mask;
+        // Leave entries whose home lies cyclically in (hole, next]
+        bool stays = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+        if (!stays) {
+            table.buckets[hole] = table.buckets[next];
+            table.buckets[next] = 0;
+            hole = next;
+        }
+    }
+}
+
+// --- Carts and histories --------------------------------------------------
+
+void CompactUserStore::storeSideData(std::uint32_t slot, const UserRef& user) {
+    const Cart& cart = user->getCart();
+    if (cart.isEmpty()) {
+        records[slot].cartVersion = cart.getVersion();
+        records[slot].cartTouched = cart.getLastTouched();
+        carts.erase(slot);
+    } else {
+        records[slot].cartVersion = 0;
+        records[slot].cartTouched = 0;
+        carts[slot] = user->shareCart();
+    }
+    if (user->getHistory()) {
+        histories[slot] = user->shareHistory();
+    } else {
+        histories.erase(slot);
+    }
+}
+
+bool CompactUserStore::sideDataEquals(std::uint32_t slot, const UserRef& user) const {
+    const Cart& expected = user->getCart();
+    auto cart = carts.find(slot);
+    if (cart == carts.end()) {
+        if (!expected.isEmpty() || records[slot].cartVersion != expected.getVersion() ||
+            records[slot].cartTouched != expected.getLastTouched()) {
+            return false;
+        }
+    } else if (cart->second.get() != &expected) {
+        return false;
+    }
+    auto history = histories.find(slot);
+    return history == histories.end() ? user->getHistory() == nullptr : history->second.get() == user->getHistory();
+}
+
+void CompactUserStore::overwrite(std::uint32_t slot, const UserRef& user) {
+    const UserProfile& profile = user->getProfile();
+    if (!profileEquals(records[slot], profile)) {
+        unindexSlot(USERNAME, slot);
+        unindexSlot(ID, slot);
+        unindexSlot(EMAIL, slot);
+        for (const auto& field : records[slot].fields) {
+            release(field);
+        }
+        writeProfile(records[slot], profile);
+        indexSlot(USERNAME, slot);
+        indexSlot(ID, slot);
+        indexSlot(EMAIL, slot);
+        compactIfWasteful();
+    }
+    records[slot].version = user->getVersion();
+    storeSideData(slot, user);
+}
+
+// --- Public API -----------------------------------------------------------
+
+size_t CompactUserStore::size() const {
+    return records.size();
+}
+
+void CompactUserStore::clear() {
+    records.clear();
+    blob.clear();
+    garbage = 0;
+    byUsername = SlotTable();
+    byId = SlotTable();
+    byEmail = SlotTable();
+    carts.clear();
+    histories.clear();
+}
+
+bool CompactUserStore::insert(const UserRef& user) {
+    const UserProfile& profile = user->getProfile();
+    std::uint32_t existing;
+    if (findSlot(USERNAME, profile.username, existing) || findSlot(ID, profile.id, existing)) {
+        return false;
+    }
+    put(user);
+    return true;
+}
+
+void CompactUserStore::put(const UserRef& user) {
+    std::uint32_t slot;
+    if (findSlot(ID, user->getProfile().id, slot)) {
+        overwrite(slot, user);
+        return;
+    }
+
+    slot = static_cast<std::uint32_t>(records.size());
+    Record record;
+    writeProfile(record, user->getProfile());
+    record.version = user->getVersion();
+    record.cartVersion = 0;
+    record.cartTouched = 0;
+    records.push_back(record);
+    storeSideData(slot, user);
+    indexSlot(USERNAME, slot);
+    indexSlot(ID, slot);
+    indexSlot(EMAIL, slot);
+}
+
+bool CompactUserStore::replace(const UserRef& expected, const UserRef& updated) {
+    std::uint32_t slot;
+    if (!findSlot(ID, expected->getProfile().id, slot)) return false;
+    const Record& record = records[slot];
+    if (record.version != expected->getVersion() || !sideDataEquals(slot, expected) ||
+        !profileEquals(record, expected->getProfile())) {
+        return false;
+    }
+    overwrite(slot, updated);
+    return true;
+}
+
+UserRef CompactUserStore::findByUsername(const std::string& username) const {
+    std::uint32_t slot;
+    return findSlot(USERNAME, username, slot) ? atSlot(slot) : nullptr;
+}
+
+UserRef CompactUserStore::findById(const std::string& userId) const {
+    std::uint32_t slot;
+    return findSlot(ID, userId, slot) ? atSlot(slot) : nullptr;
+}
+
+UserRef CompactUserStore::findByEmail(const std::string& email) const {
+    std::uint32_t slot;
+    return findSlot(EMAIL, UserIndex::normalizeEmail(email), slot) ? atSlot(slot) : nullptr;
+}
+
+bool CompactUserStore::containsUsername(const std::string& username) const {
+    std::uint32_t slot;
+    return findSlot(USERNAME, username, slot);
+}
+
+size_t CompactUserStore::slotCount() const {
+    return records.size();
+}
+
+UserRef CompactUserStore::atSlot(size_t slot) const {
+    const Record& record = records[slot];
+    auto profile = std::make_shared<UserProfile>();
+    profile->id = view(record.fields[ID]);
+    profile->username = view(record.fields[USERNAME]);
+    profile->email = view(record.fields[EMAIL]);
+    profile->password = view(record.fields[PASSWORD]);
+    profile->fullName = view(record.fields[FULL_NAME]);
+    profile->bio = view(record.fields[BIO]);
+
+    std::uint32_t key = static_cast<std::uint32_t>(slot);
+    auto stored = carts.find(key);
+    std::shared_ptr<const Cart> cart;
+    if (stored != carts.end()) {
+        cart = stored->second;
+    } else if (isPristine(record.cartVersion, record.cartTouched)) {
+        cart = UserSnapshot::emptyCart();
+    } else {
+        // Rebuilt for the snapshot only; the store keeps the two counters
+        auto empty = std::make_shared<Cart>();
+        empty->setVersion(record.cartVersion);
+        empty->setLastTouched(record.cartTouched);
+        cart = std::move(empty);
+    }
+    auto history = histories.find(key);
+    return std::make_shared<const UserSnapshot>(std::move(profile), std::move(cart),
+                                                history != histories.end() ? history->second : nullptr,
+                                                record.version);
+}
+
+const Cart* CompactUserStore::cartAt(size_t slot) const {
+    auto it = carts.find(static_cast<std::uint32_t>(slot));
+    return it != carts.end() ? it->second.get() : nullptr;
+}
+
+CompactUserStoreStats CompactUserStore::getStats() const {
+    CompactUserStoreStats stats;
+    stats.users = records.size();
+    stats.carts = carts.size();
+    stats.histories = histories.size();
+    stats.recordBytes = records.capacity() * sizeof(Record);
+    stats.blobBytes = blob.capacity();
+    stats.garbageBytes = garbage;
+    stats.indexBytes = (byUsername.buckets.capacity() + byId.buckets.capacity() + byEmail.buckets.capacity()) *
+                       sizeof(std::uint32_t);
+    return stats;
+}
@@ -0,0 +1,129 @@
+/**
+ * CompactUserStore - packed in-memory user table
+ * Holds users as fixed-size records instead of one snapshot (and half a dozen
+ * heap strings) per account. Profile fields of up to 7 bytes are stored inline
+ * in the record; longer ones are offsets into the store's string blob. Lookups
+ * by username, id and case-insensitive email go through open-addressed tables
+ * of record slots. Carts with items and purchase histories live in side tables;
+ * an empty cart is just its version and last-touched time in the record, so a
+ * user with an empty cart who never bought anything costs only the record, the
+ * blob bytes and three index slots.
+ * Lookups build a UserSnapshot on demand, sharing the stored cart and history.
+ * Not synchronized - callers hold the lock that guards the store (or own it, as
+ * a user shard does).
+ */
+
+#ifndef COMPACT_USER_STORE_H
+#define COMPACT_USER_STORE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "UserSnapshot.h"
+
+struct CompactUserStoreStats {
+    size_t users;
+    size_t carts;          // users with items in their cart (side table)
+    size_t histories;      // users with purchase history
+    size_t recordBytes;    // capacity of the record array
+    size_t blobBytes;      // long profile fields, including garbage
+    size_t garbageBytes;   // blob bytes of overwritten fields, reclaimed by compaction
+    size_t indexBytes;     // the three lookup tables
+};
+
+class CompactUserStore {
+private:
+    // 8 bytes: up to 7 chars inline (tag = 0x80 | length), or a 40-bit blob offset
+    // plus a 23-bit length (tag holds the length's top 7 bits)
+    struct PackedString {
+        unsigned char bytes[7];
+        unsigned char tag;
+    };
+
+    enum Field { ID, USERNAME, EMAIL, PASSWORD, FULL_NAME, BIO, FIELD_COUNT };
+
+    struct Record {
+        PackedString fields[FIELD_COUNT];
+        long long version;
+        long long cartVersion;  // the empty cart's version and last-touched time; a cart
+        long long cartTouched;  // with items is in the side table instead
+    };
+
+    // Open-addressed (linear probing) table of slot + 1; 0 marks an empty bucket
+    struct SlotTable {
+        std::vector<std::uint32_t> buckets;
+        size_t count = 0;
+    };
+
+    std::vector<Record> records;
+    std::string blob;
+    size_t garbage;
+    SlotTable byUsername;
+    SlotTable byId;
+    SlotTable byEmail; // keyed by the trimmed, lowercase email
+    std::unordered_map<std::uint32_t, std::shared_ptr<const Cart>> carts;
+    std::unordered_map<std::uint32_t, std::shared_ptr<const PurchaseSegment>> histories;
+
+    PackedString pack(const std::string& value);
+    std::string view(const PackedString& value) const; // copy of the field
+    bool fieldEquals(const PackedString& packed, const char* data, size_t size) const;
+    void release(const PackedString& value);
+    void writeProfile(Record& record, const UserProfile& profile);
+    bool profileEquals(const Record& record, const UserProfile& profile) const;
+    void compactIfWasteful();
+
+    size_t hashOf(Field field, const char* data, size_t size) const;
+    bool keyMatches(Field field, std::uint32_t slot, const char* data, size_t size) const;
+    SlotTable& tableFor(Field field);
+    const SlotTable& tableFor(Field field) const;
+    bool findSlot(Field field, const std::string& key, std::uint32_t& slot) const;
+    void indexSlot(Field field, std::uint32_t slot);
+    void unindexSlot(Field field, std::uint32_t slot);
+    void rehash(Field field, size_t bucketCount);
+
+    void storeSideData(std::uint32_t slot, const UserRef& user);
+    bool sideDataEquals(std::uint32_t slot, const UserRef& user) const;
+    void overwrite(std::uint32_t slot, const UserRef& user);
+
+public:
+    CompactUserStore();
+
+    size_t size() const;
+    void clear();
+
+    /**
+     * Add a new user
+     * @return false if the username or id is already taken
+     */
+    bool insert(const UserRef& user);
+
+    /**
+     * Insert, or overwrite the user with the same id
+     */
+    void put(const UserRef& user);
+
+    /**
+     * Replace `expected` with `updated` unless another writer changed the user first - a
+     * compare-and-swap by value, since every lookup builds a fresh snapshot. Renames and
+     * email changes move the user's index entries.
+     * @return false if the stored user no longer matches `expected`
+     */
+    bool replace(const UserRef& expected, const UserRef& updated);
+
+    // Snapshot lookups; nullptr if there is no such user
+    UserRef findByUsername(const std::string& username) const;
+    UserRef findById(const std::string& userId) const;
+    UserRef findByEmail(const std::string& email) const; // case-insensitive
+    bool containsUsername(const std::string& username) const;
+
+    // Slots number users in insertion order and never change (users are not removed)
+    size_t slotCount() const;
+    UserRef atSlot(size_t slot) const;
+    const Cart* cartAt(size_t slot) const; // nullptr when the user's cart is empty
+
+    CompactUserStoreStats getStats() const;
+};
+
+#endif // COMPACT_USER_STORE_H
@@ -0,0 +1,298 @@
+/**
+ * HotRestart - Implementation
+ */
+
+#include "HotRestart.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace {
+
+#if !defined(_WIN32)
+const char SOCKET_TAG = 'S';
+const char STATE_TAG = 'W';
+
+bool makeAddress(const std::string& path, sockaddr_un& addr) {
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = ::recv(fd, data, size, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        data += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// One tag byte carrying the descriptor as SCM_RIGHTS ancillary data
+bool sendDescriptor(int conn, int fd) {
+    char tag = SOCKET_TAG;
+    iovec iov;
+    iov.iov_base = &tag;
+    iov.iov_len = 1;
+
+    union {
+        cmsghdr align;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    std::memset(&control, 0, sizeof(control));
+
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    return ::sendmsg(conn, &msg, MSG_NOSIGNAL) == 1;
+}
+
+bool receiveDescriptor(int conn, int& fd) {
+    char tag = 0;
+    iovec iov;
+    iov.iov_base = &tag;
+    iov.iov_len = 1;
+
+    union {
+        cmsghdr align;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    std::memset(&control, 0, sizeof(control));
+
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    if (::recvmsg(conn, &msg, 0) != 1 || tag != SOCKET_TAG) return false;
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) return false;
+    std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return true;
+}
+#endif
+
+} // namespace
+
+HotRestart::HotRestart() : controlFd(-1), replacementFd(-1), handedOff(false), stopping(false) {}
+
+HotRestart::~HotRestart() {
+    stop();
+#if !defined(_WIN32)
+    if (replacementFd >= 0) ::close(replacementFd);
+#endif
+}
+
+bool HotRestart::isSupported() {
+#if !defined(_WIN32)
+    return true;
+#else
+    return false;
+#endif
+}
+
+const unsigned long long HotRestart::MAX_STATE_BYTES = 1ULL << 30;
+
+bool HotRestart::takeOver(const std::string& socketPath, int& listenFd, int& stateFd) {
+    listenFd = -1;
+    stateFd = -1;
+#if !defined(_WIN32)
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, addr)) return false;
+    int conn = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (conn < 0) return false;
+    ::fcntl(conn, F_SETFD, FD_CLOEXEC);
+    if (::connect(conn, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        !receiveDescriptor(conn, listenFd)) {
+        // No server is running (or a stale socket file was left behind)
+        ::close(conn);
+        listenFd = -1;
+        return false;
+    }
+    stateFd = conn;
+    return true;
+#else
+    (void)socketPath;
+    return false;
+#endif
+}
+
+bool HotRestart::receiveState(int stateFd, long long timeoutMs, std::string& state) {
+    state.clear();
+#if !defined(_WIN32)
+    if (stateFd < 0) return false;
+
+    // The old server sends its state only after it has drained
+    timeval timeout;
+    timeout.tv_sec = static_cast<time_t>(timeoutMs / 1000);
+    timeout.tv_usec = static_cast<suseconds_t>((timeoutMs % 1000) * 1000);
+    ::setsockopt(stateFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    bool received = false;
+    char header[9];
+    if (readAll(stateFd, header, sizeof(header)) && header[0] == STATE_TAG) {
+        std::uint64_t size = 0;
+        for (int i = 0; i < 8; ++i) {
+            size |= static_cast<std::uint64_t>(static_cast<unsigned char>(header[1 + i])) << (8 * i);
+        }
+        // The length comes from the peer, so bound it before allocating
+        if (size <= MAX_STATE_BYTES) {
+            std::string bytes(static_cast<size_t>(size), '\0');
+            if (readAll(stateFd, &bytes[0], bytes.size())) {
+                state.swap(bytes);
+                received = true;
+            }
+        }
+    }
+    ::close(stateFd);
+    return received;
+#else
+    (void)stateFd;
+    (void)timeoutMs;
+    return false;
+#endif
+}
+
+bool HotRestart::serve(const std::string& path, int listenFd, std::function<void()> onHandoff) {
+#if !defined(_WIN32)
+    sockaddr_un addr;
+    if (!makeAddress(path, addr)) return false;
+
+    // A deep backlog holds the connections that arrive while the socket changes hands
+    ::listen(listenFd, SOMAXCONN);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    ::unlink(path.c_str()); // left by the server we took over from, or by a crash
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 1) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    socketPath = path;
+    controlFd = fd;
+    stopping.store(false);
+    acceptor = std::thread(&HotRestart::acceptLoop, this, listenFd, onHandoff);
+    return true;
+#else
+    (void)path;
+    (void)listenFd;
+    (void)onHandoff;
+    return false;
+#endif
+}
+
+void HotRestart::acceptLoop(int listenFd, std::function<void()> onHandoff) {
+#if !defined(_WIN32)
+    while (!stopping.load()) {
+        pollfd entry;
+        entry.fd = controlFd;
+        entry.events = POLLIN;
+        entry.revents = 0;
+        if (::poll(&entry, 1, 200) <= 0) continue;
+
+        int conn = ::accept(controlFd, nullptr, nullptr);
+        if (conn < 0) continue;
+        if (!sendDescriptor(conn, listenFd)) {
+            ::close(conn);
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            replacementFd = conn;
+        }
+        handedOff.store(true);
+        std::cout << "Hot restart: listening socket handed to a new process, draining" << std::endl;
+        onHandoff();
+        break;
+    }
+    // The path now belongs to the replacement, which rebinds it
+    ::close(controlFd);
+    controlFd = -1;
+#else
+    (void)listenFd;
+    (void)onHandoff;
+#endif
+}
+
+bool HotRestart::wasHandedOff() const {
+    return handedOff.load();
+}
+
+bool HotRestart::sendState(const std::string& state) {
+#if !defined(_WIN32)
+    std::lock_guard<std::mutex> lock(mutex);
+    if (replacementFd < 0) return false;
+    if (state.size() > MAX_STATE_BYTES) {
+        // The replacement would reject it; closing tells it to start cold now
+        ::close(replacementFd);
+        replacementFd = -1;
+        return false;
+    }
+
+    char header[9];
+    header[0] = STATE_TAG;
+    std::uint64_t size = state.size();
+    for (int i = 0; i < 8; ++i) {
+        header[1 + i] = static_cast<char>((size >> (8 * i)) & 0xff);
+    }
+    bool sent = writeAll(replacementFd, header, sizeof(header)) && writeAll(replacementFd, state.data(), state.size());
+    ::close(replacementFd);
+    replacementFd = -1;
+    return sent;
+#else
+    (void)state;
+    return false;
+#endif
+}
+
+void HotRestart::stop() {
+    stopping.store(true);
+    if (acceptor.joinable()) {
+        acceptor.join();
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * HotRestart - hand the listening socket and warm state to a replacement process
+ * A running server accepts handoff requests on a Unix domain socket. A new
+ * binary started with hot restart enabled connects to it and receives the
+ * listening TCP socket itself (SCM_RIGHTS), so the port never closes and
+ * connections that arrive meanwhile wait in the accept backlog. The replacement
+ * starts accepting at once; the old server stops accepting, drains the requests
+ * it is serving, and sends its warm state before exiting. POSIX only; elsewhere
+ * no handoff happens.
+ */
+
+#ifndef HOT_RESTART_H
+#define HOT_RESTART_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class HotRestart {
+private:
+    std::string socketPath;
+    int controlFd;            // Unix socket this server accepts handoff requests on
+    int replacementFd;        // connection from the process that took the listening socket
+    std::atomic<bool> handedOff;
+    std::atomic<bool> stopping;
+    std::thread acceptor;
+    std::mutex mutex;
+
+    void acceptLoop(int listenFd, std::function<void()> onHandoff);
+
+public:
+    HotRestart();
+    ~HotRestart();
+
+    static bool isSupported();
+
+    // Largest warm state a replacement accepts; a bigger length header is treated as corrupt
+    static const unsigned long long MAX_STATE_BYTES;
+
+    /**
+     * Replacement side: ask the server on socketPath for its listening socket. Returns as
+     * soon as the socket arrives, so the caller can start accepting; the old server sends
+     * its warm state on stateFd once it has drained (see receiveState)
+     * @return false if no server answered (listenFd and stateFd are -1)
+     */
+    static bool takeOver(const std::string& socketPath, int& listenFd, int& stateFd);
+
+    /**
+     * Replacement side: wait up to timeoutMs for the warm state on stateFd, then close it
+     * @return false (state left empty) if the old server died, timed out, or announced
+     *         more than MAX_STATE_BYTES
+     */
+    static bool receiveState(int stateFd, long long timeoutMs, std::string& state);
+
+    /**
+     * Running side: accept one handoff request on socketPath for listenFd. onHandoff
+     * runs on the acceptor thread once the socket has been sent and should make the
+     * server stop accepting connections so it can drain.
+     */
+    bool serve(const std::string& socketPath, int listenFd, std::function<void()> onHandoff);
+
+    // A replacement holds the listening socket and is waiting for sendState()
+    bool wasHandedOff() const;
+
+    // Send the warm state to the replacement and close the connection
+    bool sendState(const std::string& state);
+
+    // Stop accepting handoff requests
+    void stop();
+};
+
+#endif // HOT_RESTART_H
@@ -0,0 +1,252 @@
+/**
+ * IoUring - Implementation
+ */
+
+#include "IoUring.h"
+#include <cerrno>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAS_IO_URING 1
+#endif
+#endif
+
+#ifdef HAS_IO_URING
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+#endif
+
+#ifdef HAS_IO_URING
+namespace {
+
+const unsigned RING_ENTRIES = 4;
+const unsigned FILE_SLOT = 0; // the ring's only registered file slot
+
+int setup(unsigned entries, io_uring_params& params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+}
+
+int registerWith(int ringFd, unsigned opcode, const void* arg, unsigned args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, arg, args));
+}
+
+int enter(int ringFd, unsigned toSubmit, unsigned minComplete) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete,
+                                    IORING_ENTER_GETEVENTS, nullptr, 0));
+}
+
+// One empty slot for OPENAT to open into, so the linked READ can name the file before it exists
+bool registerFileSlot(int ringFd) {
+    io_uring_rsrc_register sparse;
+    std::memset(&sparse, 0, sizeof(sparse));
+    sparse.nr = 1;
+    sparse.flags = IORING_RSRC_REGISTER_SPARSE;
+    if (registerWith(ringFd, IORING_REGISTER_FILES2, &sparse, sizeof(sparse)) == 0) return true;
+    int empty = -1; // kernels before 5.19 take a -1 descriptor as an empty slot
+    return registerWith(ringFd, IORING_REGISTER_FILES, &empty, 1) == 0;
+}
+
+bool probeOpcodes() {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int ringFd = setup(RING_ENTRIES, params);
+    if (ringFd < 0) return false;
+
+    const unsigned ops = 256;
+    std::vector<char> storage(sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    bool supported = registerWith(ringFd, IORING_REGISTER_PROBE, probe, ops) == 0;
+    const unsigned needed[] = {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_CLOSE};
+    for (unsigned op : needed) {
+        supported = supported && op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    }
+    supported = supported && registerFileSlot(ringFd);
+    ::close(ringFd);
+    return supported;
+}
+
+} // namespace
+#endif
+
+IoUring::IoUring()
+    : ringFd(-1), sqRing(nullptr), cqRing(nullptr), sqes(nullptr), sqRingBytes(0), cqRingBytes(0),
+      sqesBytes(0), sqHead(nullptr), sqTail(nullptr), sqMask(nullptr), sqArray(nullptr), cqHead(nullptr),
+      cqTail(nullptr), cqMask(nullptr), cqes(nullptr), buffer(nullptr), bufferBytes(0), fixedBuffer(false),
+      enters(0) {}
+
+IoUring::~IoUring() {
+    close();
+}
+
+bool IoUring::isSupported() {
+#ifdef HAS_IO_URING
+    static const bool supported = probeOpcodes();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool IoUring::open(size_t bytes) {
+    close();
+#ifdef HAS_IO_URING
+    if (bytes == 0 || !isSupported()) return false;
+
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ringFd = setup(RING_ENTRIES, params);
+    if (ringFd < 0) return false;
+
+    sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+    }
+    sqRing = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                  IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        close();
+        return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                      IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            close();
+            return false;
+        }
+    }
+    sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        sqes = nullptr;
+        close();
+        return false;
+    }
+
+    char* sq = static_cast<char*>(sqRing);
+    char* cq = static_cast<char*>(cqRing);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = cq + params.cq_off.cqes;
+
+    if (!registerFileSlot(ringFd)) {
+        close();
+        return false;
+    }
+
+    // Page-aligned, so registering it pins whole pages
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        close();
+        return false;
+    }
+    buffer = static_cast<char*>(memory);
+    bufferBytes = bytes;
+    iovec region;
+    region.iov_base = buffer;
+    region.iov_len = bufferBytes;
+    fixedBuffer = registerWith(ringFd, IORING_REGISTER_BUFFERS, &region, 1) == 0;
+    return true;
+#else
+    (void)bytes;
+    return false;
+#endif
+}
+
+void IoUring::close() {
+#ifdef HAS_IO_URING
+    if (buffer) munmap(buffer, bufferBytes);
+    if (sqes) munmap(sqes, sqesBytes);
+    if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingBytes);
+    if (sqRing) munmap(sqRing, sqRingBytes);
+    if (ringFd >= 0) ::close(ringFd);
+#endif
+    ringFd = -1;
+    sqRing = cqRing = sqes = nullptr;
+    cqes = nullptr;
+    buffer = nullptr;
+    bufferBytes = 0;
+    fixedBuffer = false;
+}
+
+long IoUring::readFile(const std::string& path, const char*& data) {
+    data = nullptr;
+#ifdef HAS_IO_URING
+    if (ringFd < 0) return -EBADF;
+
+    // The three entries are hard-linked: each starts only when the previous one completes,
+    // and a failed open or read does not cancel the CLOSE that frees the slot
+    unsigned tail = *sqTail;
+    io_uring_sqe* entries = static_cast<io_uring_sqe*>(sqes);
+    for (unsigned i = 0; i < 3; ++i) {
+        unsigned index = (tail + i) & *sqMask;
+        io_uring_sqe* sqe = &entries[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = i;
+        sqArray[index] = index;
+        if (i == 0) {
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<unsigned long long>(path.c_str());
+            sqe->open_flags = O_RDONLY; // O_CLOEXEC is invalid for a slot, which never enters the fd table
+            sqe->file_index = FILE_SLOT + 1;
+            sqe->flags = IOSQE_IO_HARDLINK;
+        } else if (i == 1) {
+            sqe->opcode = fixedBuffer ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            sqe->fd = FILE_SLOT;
+            sqe->addr = reinterpret_cast<unsigned long long>(buffer);
+            sqe->len = static_cast<unsigned>(bufferBytes);
+            sqe->buf_index = 0;
+            sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+        } else {
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->file_index = FILE_SLOT + 1;
+        }
+    }
+    __atomic_store_n(sqTail, tail + 3, __ATOMIC_RELEASE);
+
+    int results[3] = {-ECANCELED, -ECANCELED, -ECANCELED};
+    unsigned completed = 0;
+    while (completed < 3) {
+        unsigned unsubmitted = tail + 3 - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        enters++;
+        if (enter(ringFd, unsubmitted, 3 - completed) < 0 && errno != EINTR) {
+            close(); // entries may still be in flight; a fresh ring is the only clean state
+            return -EIO;
+        }
+        unsigned head = *cqHead;
+        unsigned ready = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        for (; head != ready; ++head) {
+            const io_uring_cqe* cqe = static_cast<const io_uring_cqe*>(cqes) + (head & *cqMask);
+            if (cqe->user_data < 3) results[cqe->user_data] = cqe->res;
+            completed++;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    if (results[0] < 0) return results[0];
+    if (results[1] < 0) return results[1];
+    data = buffer;
+    return results[1];
+#else
+    (void)path;
+    return -ENOSYS;
+#endif
+}
@@ -0,0 +1,77 @@
+/**
+ * IoUring - a minimal io_uring ring for whole-file reads
+ * Talks to the kernel through the raw io_uring_setup / io_uring_register /
+ * io_uring_enter syscalls (no liburing). readFile() submits a hard-linked
+ * chain - OPENAT into a registered (direct) file slot, READ_FIXED into a
+ * registered buffer, CLOSE of the slot - and reaps all three completions in a
+ * single io_uring_enter, where the read(2) path needs open, fstat, read and
+ * close. A ring belongs to one thread at a time.
+ * Linux 5.15+ only: elsewhere, or when the kernel, seccomp or
+ * /proc/sys/kernel/io_uring_disabled refuses it, isSupported() is false and
+ * callers keep their ordinary file path.
+ */
+
+#ifndef IO_URING_H
+#define IO_URING_H
+
+#include <cstddef>
+#include <string>
+
+class IoUring {
+private:
+    int ringFd;
+    void* sqRing;
+    void* cqRing;
+    void* sqes;
+    size_t sqRingBytes;
+    size_t cqRingBytes;
+    size_t sqesBytes;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    void* cqes;
+    char* buffer;
+    size_t bufferBytes;
+    bool fixedBuffer; // buffer is registered with the ring (READ_FIXED); otherwise plain READ
+    size_t enters;
+
+    void close();
+
+public:
+    IoUring();
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * True if this kernel accepts a ring and supports every opcode readFile() uses.
+     * Probed once per process.
+     */
+    static bool isSupported();
+
+    /**
+     * Create the ring with a read buffer of bufferBytes. Registering the buffer counts
+     * against RLIMIT_MEMLOCK; if that is refused the ring reads into it unregistered.
+     * @return false if io_uring is unavailable (the object stays closed)
+     */
+    bool open(size_t bufferBytes);
+
+    bool isOpen() const { return ringFd >= 0; }
+    bool hasFixedBuffer() const { return fixedBuffer; }
+    size_t getBufferSize() const { return bufferBytes; }
+    size_t getEnters() const { return enters; }
+
+    /**
+     * Read the start of a file, relative to the working directory, into the ring's buffer.
+     * @return bytes read (getBufferSize() means the file may be longer), or -errno from
+     *         the open or read: -ENOENT, -EISDIR, ... A ring error closes the ring.
+     */
+    long readFile(const std::string& path, const char*& data);
+};
+
+#endif // IO_URING_H
@@ -13,6 +13,9 @@
 #include "MongoDBService.h"
 #include "Cart.h"
 #include "PurchaseHistory.h"
+#include "User.h"
+#include "UserSnapshot.h"
+#include "RequestDeadline.h"
 #include <iostream>
 #include <sstream>
 #include <chrono>
@@ -28,6 +31,14 @@
 #include <mongocxx/database.hpp>
 #include <mongocxx/collection.hpp>
 #include <mongocxx/options/find.hpp>
+#include <mongocxx/options/insert.hpp>
+#include <mongocxx/options/find_one_and_update.hpp>
+#include <mongocxx/options/delete.hpp>
+#include <mongocxx/options/update.hpp>
+#include <mongocxx/options/index.hpp>
+#include <mongocxx/read_preference.hpp>
+#include <mongocxx/write_concern.hpp>
+#include <mongocxx/exception/operation_exception.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/builder/basic/array.hpp>
@@ -42,25 +53,22 @@ using bsoncxx::builder::basic::make_array;
 using bsoncxx::builder::basic::kvp;
 #endif
 
-// Forward declaration of User struct (defined in Server.cpp)
-struct User {
-    std::string id;
-    std::string username;
-    std::string email;
-    std::string password;
-    Cart cart;
-    PurchaseHistory history;
-    std::string fullName;
-    std::string bio;
-};
-
 #ifdef HAS_MONGODB
 static mongocxx::instance instance{};
 static mongocxx::client* client = nullptr;
 static mongocxx::database* db = nullptr;
 #endif
 
-MongoDBService::MongoDBService() : connected(false), connectionString(""), databaseName("") {
+MongoDBService::MongoDBService() : connected(false), uniqueUserIndexes(false), connectionString(""), databaseName("") {
+    // Default policy table - each path only pays for the consistency it needs
+    setOperationPolicy(MongoOperation::UserCreate,  OperationPolicy("majority", true,  "primary", 5000));
+    setOperationPolicy(MongoOperation::UserRead,    OperationPolicy("1",        false, "primary", 2000));
+    setOperationPolicy(MongoOperation::UserUpdate,  OperationPolicy("majority", false, "primary", 5000));
+    setOperationPolicy(MongoOperation::CartWrite,   OperationPolicy("1",        false, "primary", 1000));
+    setOperationPolicy(MongoOperation::OrderInsert, OperationPolicy("majority", true,  "primary", 5000));
+    setOperationPolicy(MongoOperation::HistoryRead, OperationPolicy("1",        false, "secondaryPreferred", 2000));
+    setOperationPolicy(MongoOperation::TokenWrite,  OperationPolicy("1",        false, "primary", 1000));
+    setOperationPolicy(MongoOperation::TokenRead,   OperationPolicy("1",        false, "primary", 1000));
 }
 
 MongoDBService::~MongoDBService() {
@@ -85,6 +93,26 @@ bool MongoDBService::connect(const std::string& connStr, const std::string& dbNa
         auto ping_cmd = make_document(kvp("ping", 1));
         auto result = admin.run_command(ping_cmd.view());
         
+        // Index used by the abandoned cart sweeper
+        try {
+            (*db)["users"].create_index(make_document(kvp("cartUpdatedAt", 1)));
+        } catch (const std::exception& e) {
+            std::cerr << "MongoDB: Could not create cartUpdatedAt index - " << e.what() << std::endl;
+        }
+        
+        // Unique indexes let profile updates detect username/email conflicts on write
+        try {
+            mongocxx::options::index uniqueOpts;
+            uniqueOpts.unique(true);
+            (*db)["users"].create_index(make_document(kvp("username", 1)), uniqueOpts);
+            (*db)["users"].create_index(make_document(kvp("email", 1)), uniqueOpts);
+            uniqueUserIndexes = true;
+        } catch (const std::exception& e) {
+            uniqueUserIndexes = false;
+            std::cerr << "MongoDB: Could not create unique username/email indexes, "
+                      << "falling back to lookups before profile updates - " << e.what() << std::endl;
+        }
+        
         connected = true;
         std::cout << "✅ MongoDB: Connected successfully to " << dbName << std::endl;
         return true;
@@ -104,6 +132,161 @@ bool MongoDBService::isConnected() const {
     return connected;
 }
 
+bool MongoDBService::hasUniqueUserIndexes() const {
+    return uniqueUserIndexes;
+}
+
+void MongoDBService::setOperationPolicy(MongoOperation operation, const OperationPolicy& policy) {
+    if (operation == MongoOperation::Count) return;
+    policies[static_cast<size_t>(operation)] = policy;
+}
+
+const OperationPolicy& MongoDBService::getOperationPolicy(MongoOperation operation) const {
+    if (operation == MongoOperation::Count) {
+        static const OperationPolicy defaultPolicy;
+        return defaultPolicy;
+    }
+    return policies[static_cast<size_t>(operation)];
+}
+
+const char* MongoDBService::operationName(MongoOperation operation) {
+    switch (operation) {
+        case MongoOperation::UserCreate:  return "USER_CREATE";
+        case MongoOperation::UserRead:    return "USER_READ";
+        case MongoOperation::UserUpdate:  return "USER_UPDATE";
+        case MongoOperation::CartWrite:   return "CART_WRITE";
+        case MongoOperation::OrderInsert: return "ORDER_INSERT";
+        case MongoOperation::HistoryRead: return "HISTORY_READ";
+        case MongoOperation::TokenWrite:  return "TOKEN_WRITE";
+        case MongoOperation::TokenRead:   return "TOKEN_READ";
+        default:                          return "";
+    }
+}
+
+bool MongoDBService::parseOperationPolicy(const std::string& spec, OperationPolicy& policy) {
+    OperationPolicy parsed = policy;
+    std::stringstream ss(spec);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        size_t eq = field.find('=');
+        if (eq == std::string::npos) {
+            // Allow stray separators / whitespace-only fields
+            if (field.find_first_not_of(" \t") == std::string::npos) continue;
+            return false;
+        }
+        std::string key = field.substr(0, eq);
+        std::string value = field.substr(eq + 1);
+        key.erase(0, key.find_first_not_of(" \t"));
+        key.erase(key.find_last_not_of(" \t") + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t") + 1);
+
+        if (key == "w") {
+            if (value != "1" && value != "majority") return false;
+            parsed.writeConcern = value;
+        } else if (key == "j" || key == "journal") {
+            if (value == "true" || value == "1") {
+                parsed.journal = true;
+            } else if (value == "false" || value == "0") {
+                parsed.journal = false;
+            } else {
+                return false;
+            }
+        } else if (key == "read" || key == "readPreference") {
+            if (value != "primary" && value != "primaryPreferred" && value != "secondary" &&
+                value != "secondaryPreferred" && value != "nearest") {
+                return false;
+            }
+            parsed.readPreference = value;
+        } else if (key == "maxTimeMS") {
+            if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 9) {
+                return false;
+            }
+            parsed.maxTimeMS = std::stoi(value);
+        } else {
+            return false;
+        }
+    }
+    policy = parsed;
+    return true;
+}
+
+#ifdef HAS_MONGODB
+// Translate an OperationPolicy into driver options
+// The operation's maxTimeMS, cut down to what is left of the calling request's deadline
+// (at least 1 ms, so an expired request fails fast instead of running without a limit)
+static long long effectiveMaxTimeMS(const OperationPolicy& policy) {
+    long long limit = policy.maxTimeMS;
+    if (RequestDeadline::active()) {
+        long long remaining = std::max<long long>(1, RequestDeadline::remainingMs());
+        if (limit <= 0 || remaining < limit) {
+            limit = remaining;
+        }
+    }
+    return limit;
+}
+
+static mongocxx::write_concern makeWriteConcern(const OperationPolicy& policy) {
+    mongocxx::write_concern wc;
+    if (policy.writeConcern == "majority") {
+        wc.acknowledge_level(mongocxx::write_concern::level::k_majority);
+    } else {
+        wc.nodes(1);
+    }
+    wc.journal(policy.journal);
+    long long maxTimeMS = effectiveMaxTimeMS(policy);
+    if (maxTimeMS > 0) {
+        wc.timeout(std::chrono::milliseconds(maxTimeMS));
+    }
+    return wc;
+}
+
+static mongocxx::read_preference makeReadPreference(const OperationPolicy& policy) {
+    using mode = mongocxx::read_preference::read_mode;
+    mongocxx::read_preference rp;
+    if (policy.readPreference == "primaryPreferred") {
+        rp.mode(mode::k_primary_preferred);
+    } else if (policy.readPreference == "secondary") {
+        rp.mode(mode::k_secondary);
+    } else if (policy.readPreference == "secondaryPreferred") {
+        rp.mode(mode::k_secondary_preferred);
+    } else if (policy.readPreference == "nearest") {
+        rp.mode(mode::k_nearest);
+    } else {
+        rp.mode(mode::k_primary);
+    }
+    return rp;
+}
+
+static mongocxx::options::find makeFindOptions(const OperationPolicy& policy) {
+    mongocxx::options::find opts;
+    opts.read_preference(makeReadPreference(policy));
+    long long maxTimeMS = effectiveMaxTimeMS(policy);
+    if (maxTimeMS > 0) {
+        opts.max_time(std::chrono::milliseconds(maxTimeMS));
+    }
+    return opts;
+}
+
+static mongocxx::options::insert makeInsertOptions(const OperationPolicy& policy) {
+    mongocxx::options::insert opts;
+    opts.write_concern(makeWriteConcern(policy));
+    return opts;
+}
+
+static mongocxx::options::delete_options makeDeleteOptions(const OperationPolicy& policy) {
+    mongocxx::options::delete_options opts;
+    opts.write_concern(makeWriteConcern(policy));
+    return opts;
+}
+
+static mongocxx::options::update makeUpdateOptions(const OperationPolicy& policy) {
+    mongocxx::options::update opts;
+    opts.write_concern(makeWriteConcern(policy));
+    return opts;
+}
+#endif
+
 #ifdef HAS_MONGODB
 // Helper function to safely get string from BSON element
 static std::string safeGetString(const bsoncxx::document::view& doc, const char* key, const std::string& defaultValue = "") {
@@ -256,6 +439,87 @@ static std::string safeGetId(const bsoncxx::document::view& doc) {
         return "";
     }
 }
+// Helper function to safely get an integer field (int32/int64/double) from a document
+static long long safeGetInt64(const bsoncxx::document::view& doc, const char* key, long long defaultValue = 0) {
+    try {
+        auto it = doc.find(key);
+        if (it == doc.end()) {
+            return defaultValue;
+        }
+        auto elem = *it;
+        if (elem.type() == bsoncxx::type::k_int64) {
+            return elem.get_int64().value;
+        } else if (elem.type() == bsoncxx::type::k_int32) {
+            return elem.get_int32().value;
+        } else if (elem.type() == bsoncxx::type::k_double) {
+            return static_cast<long long>(elem.get_double().value);
+        }
+        return defaultValue;
+    } catch (...) {
+        return defaultValue;
+    }
+}
+
+// Helper function to safely get a date field as epoch milliseconds
+static long long safeGetDateMs(const bsoncxx::document::view& doc, const char* key, long long defaultValue = 0) {
+    try {
+        auto it = doc.find(key);
+        if (it == doc.end()) {
+            return defaultValue;
+        }
+        auto elem = *it;
+        if (elem.type() == bsoncxx::type::k_date) {
+            return elem.get_date().value.count();
+        }
+        return safeGetInt64(doc, key, defaultValue);
+    } catch (...) {
+        return defaultValue;
+    }
+}
+
+// Match a user document, and unless expected is ANY_VERSION only while the given version
+// counter still holds that value. Documents written before the counter existed have no
+// field and count as version 0.
+static bsoncxx::document::value versionedUserFilter(const std::string& userId, const char* field,
+                                                    long long expected) {
+    if (expected == MongoDBService::ANY_VERSION) {
+        return make_document(kvp("_id", userId));
+    }
+    if (expected == 0) {
+        return make_document(kvp("_id", userId),
+                             kvp(field, make_document(kvp("$in", make_array(static_cast<int64_t>(0),
+                                                                            bsoncxx::types::b_null{})))));
+    }
+    return make_document(kvp("_id", userId), kvp(field, static_cast<int64_t>(expected)));
+}
+
+// Apply an update to a user document and bump its version in the same round trip.
+// The new version is reported back so callers can write through to the user cache.
+// Returns false when no document matches the filter, e.g. its version moved on.
+static bool runVersionedUserUpdate(mongocxx::collection& users_collection, bsoncxx::document::view filter,
+                                   bsoncxx::document::view update, const OperationPolicy& policy,
+                                   long long* newVersion, long long* newCartVersion = nullptr) {
+    mongocxx::options::find_one_and_update opts;
+    opts.write_concern(makeWriteConcern(policy));
+    opts.return_document(mongocxx::options::return_document::k_after);
+    opts.projection(make_document(kvp("version", 1), kvp("cartVersion", 1)));
+    long long maxTimeMS = effectiveMaxTimeMS(policy);
+    if (maxTimeMS > 0) {
+        opts.max_time(std::chrono::milliseconds(maxTimeMS));
+    }
+
+    auto result = users_collection.find_one_and_update(filter, update, opts);
+    if (!result) {
+        return false;
+    }
+    if (newVersion) {
+        *newVersion = safeGetInt64(result->view(), "version");
+    }
+    if (newCartVersion) {
+        *newCartVersion = safeGetInt64(result->view(), "cartVersion");
+    }
+    return true;
+}
 #endif
 
 bool MongoDBService::createUser(const std::string& username, const std::string& email,
@@ -268,10 +532,11 @@ bool MongoDBService::createUser(const std::string& username, const std::string&
 #ifdef HAS_MONGODB
     try {
         auto users_collection = (*db)["users"];
+        auto readOpts = makeFindOptions(getOperationPolicy(MongoOperation::UserRead));
         
         // Check if username already exists
         auto usernameFilter = make_document(kvp("username", username));
-        auto existingByUsername = users_collection.find_one(usernameFilter.view());
+        auto existingByUsername = users_collection.find_one(usernameFilter.view(), readOpts);
         if (existingByUsername) {
             return false; // Username already exists
         }
@@ -288,7 +553,7 @@ bool MongoDBService::createUser(const std::string& username, const std::string&
         
         // Check if email already exists - use same simple logic as username
         auto emailFilter = make_document(kvp("email", normalizedEmail));
-        auto existingByEmail = users_collection.find_one(emailFilter.view());
+        auto existingByEmail = users_collection.find_one(emailFilter.view(), readOpts);
         if (existingByEmail) {
             std::cerr << "MongoDB createUser: Email '" << normalizedEmail << "' already exists in database (direct query)" << std::endl;
             return false; // Email already exists
@@ -297,7 +562,7 @@ bool MongoDBService::createUser(const std::string& username, const std::string&
         // Debug: Also check if there are any emails that match when lowercased (in case some weren't normalized)
         // This is a safety check - iterate through all users and check emails
         std::cerr << "MongoDB createUser: Direct query found nothing, checking all users via iteration..." << std::endl;
-        auto allUsersCursor = users_collection.find({});
+        auto allUsersCursor = users_collection.find({}, readOpts);
         int userCount = 0;
         for (auto it = allUsersCursor.begin(); it != allUsersCursor.end(); ++it) {
             userCount++;
@@ -323,14 +588,14 @@ bool MongoDBService::createUser(const std::string& username, const std::string&
         
         // Final check right before insertion - double-check email doesn't exist
         // This prevents race conditions where email was added between our check and now
-        auto finalEmailCheck = users_collection.find_one(make_document(kvp("email", normalizedEmail)).view());
+        auto finalEmailCheck = users_collection.find_one(make_document(kvp("email", normalizedEmail)).view(), readOpts);
         if (finalEmailCheck) {
             std::cerr << "MongoDB createUser: Final check - Email '" << normalizedEmail << "' exists! Aborting creation." << std::endl;
             return false;
         }
         
         // Also check username one more time
-        auto finalUsernameCheck = users_collection.find_one(make_document(kvp("username", username)).view());
+        auto finalUsernameCheck = users_collection.find_one(make_document(kvp("username", username)).view(), readOpts);
         if (finalUsernameCheck) {
             std::cerr << "MongoDB createUser: Final check - Username '" << username << "' exists! Aborting creation." << std::endl;
             return false;
@@ -352,7 +617,8 @@ bool MongoDBService::createUser(const std::string& username, const std::string&
         );
         
         try {
-            users_collection.insert_one(user_doc.view());
+            users_collection.insert_one(user_doc.view(),
+                                        makeInsertOptions(getOperationPolicy(MongoOperation::UserCreate)));
             std::cerr << "MongoDB createUser: Successfully created user with email '" << normalizedEmail << "'" << std::endl;
             return true;
         } catch (const std::exception& e) {
@@ -379,7 +645,8 @@ bool MongoDBService::findUserByUsername(const std::string& username, User& user)
     try {
         auto users_collection = (*db)["users"];
         auto filter = make_document(kvp("username", username));
-        auto result = users_collection.find_one(filter.view());
+        auto result = users_collection.find_one(filter.view(),
+                                                makeFindOptions(getOperationPolicy(MongoOperation::UserRead)));
         
         if (!result) return false;
         
@@ -390,6 +657,7 @@ bool MongoDBService::findUserByUsername(const std::string& username, User& user)
         user.password = safeGetString(doc, "password");
         user.fullName = safeGetString(doc, "fullName");
         user.bio = safeGetString(doc, "bio");
+        user.version = safeGetInt64(doc, "version");
         
         // Load cart - use safe access to avoid uninitialized element errors
         try {
@@ -413,6 +681,8 @@ bool MongoDBService::findUserByUsername(const std::string& username, User& user)
                 } catch (...) {}
             }
         } catch (...) {}
+        user.cart.setLastTouched(safeGetDateMs(doc, "cartUpdatedAt"));
+        user.cart.setVersion(safeGetInt64(doc, "cartVersion"));
         
         // Load purchase history - use safe access to avoid uninitialized element errors
         try {
@@ -467,13 +737,14 @@ bool MongoDBService::findUserByEmail(const std::string& email, User& user) {
         std::cerr << "MongoDB findUserByEmail: Searching for email '" << lowerEmail << "' (input: '" << email << "')" << std::endl;
         
         // Simple direct query - same as username checking
+        auto readOpts = makeFindOptions(getOperationPolicy(MongoOperation::UserRead));
         auto filter = make_document(kvp("email", lowerEmail));
-        auto result = users_collection.find_one(filter.view());
+        auto result = users_collection.find_one(filter.view(), readOpts);
         
         if (!result) {
             // Debug: If not found, check all users to see if there's a case mismatch
             // This handles cases where emails weren't normalized when stored
-            auto allUsersCursor = users_collection.find({});
+            auto allUsersCursor = users_collection.find({}, readOpts);
             for (auto it = allUsersCursor.begin(); it != allUsersCursor.end(); ++it) {
                 auto tempDoc = *it;
                 std::string existingEmail = safeGetString(tempDoc, "email");
@@ -484,7 +755,7 @@ bool MongoDBService::findUserByEmail(const std::string& email, User& user) {
                         // Found a match! Query again by _id to get proper result object
                         std::string foundId = safeGetId(tempDoc);
                         if (!foundId.empty()) {
-                            result = users_collection.find_one(make_document(kvp("_id", foundId)).view());
+                            result = users_collection.find_one(make_document(kvp("_id", foundId)).view(), readOpts);
                             std::cerr << "MongoDB findUserByEmail: Found email via iteration: stored='" << existingEmail 
                                       << "' query='" << lowerEmail << "'" << std::endl;
                             break;
@@ -508,6 +779,7 @@ bool MongoDBService::findUserByEmail(const std::string& email, User& user) {
         user.password = safeGetString(doc, "password");
         user.fullName = safeGetString(doc, "fullName");
         user.bio = safeGetString(doc, "bio");
+        user.version = safeGetInt64(doc, "version");
         
         // Load cart using safe access
         try {
@@ -531,6 +803,8 @@ bool MongoDBService::findUserByEmail(const std::string& email, User& user) {
                 } catch (...) {}
             }
         } catch (...) {}
+        user.cart.setLastTouched(safeGetDateMs(doc, "cartUpdatedAt"));
+        user.cart.setVersion(safeGetInt64(doc, "cartVersion"));
         
         // Load purchase history using safe access
         try {
@@ -581,8 +855,9 @@ bool MongoDBService::emailExists(const std::string& email) {
         std::transform(lowerEmail.begin(), lowerEmail.end(), lowerEmail.begin(), ::tolower);
         
         // Simple direct query - same as username checking
+        auto readOpts = makeFindOptions(getOperationPolicy(MongoOperation::UserRead));
         auto filter = make_document(kvp("email", lowerEmail));
-        auto result = users_collection.find_one(filter.view());
+        auto result = users_collection.find_one(filter.view(), readOpts);
         
         if (result) {
             std::cerr << "MongoDB emailExists: Email '" << lowerEmail << "' EXISTS in database" << std::endl;
@@ -590,7 +865,7 @@ bool MongoDBService::emailExists(const std::string& email) {
         }
         
         // Fallback: check all users via iteration (in case email wasn't normalized when stored)
-        auto allUsersCursor = users_collection.find({});
+        auto allUsersCursor = users_collection.find({}, readOpts);
         for (auto it = allUsersCursor.begin(); it != allUsersCursor.end(); ++it) {
             auto doc = *it;
             std::string existingEmail = safeGetString(doc, "email");
@@ -628,16 +903,18 @@ bool MongoDBService::findUserById(const std::string& userId, User& user) {
     try {
         auto users_collection = (*db)["users"];
         
+        auto readOpts = makeFindOptions(getOperationPolicy(MongoOperation::UserRead));
+        
         // Try querying as string first (how we store it)
         auto filter = make_document(kvp("_id", userId));
-        auto result = users_collection.find_one(filter.view());
+        auto result = users_collection.find_one(filter.view(), readOpts);
         
         // If not found, try as ObjectId (in case MongoDB converted it)
         if (!result && userId.length() == 24) {
             try {
                 bsoncxx::oid oid(userId);
                 auto oidFilter = make_document(kvp("_id", oid));
-                result = users_collection.find_one(oidFilter.view());
+                result = users_collection.find_one(oidFilter.view(), readOpts);
             } catch (...) {
                 // Not a valid ObjectId, continue
             }
@@ -712,6 +989,7 @@ bool MongoDBService::findUserById(const std::string& userId, User& user) {
         user.password = safeGetString(doc, "password");
         user.fullName = safeGetString(doc, "fullName");
         user.bio = safeGetString(doc, "bio");
+        user.version = safeGetInt64(doc, "version");
         
         // Validate required fields
         if (user.username.empty() || user.email.empty()) {
@@ -742,6 +1020,8 @@ bool MongoDBService::findUserById(const std::string& userId, User& user) {
                 } catch (...) {}
             }
         } catch (...) {}
+        user.cart.setLastTouched(safeGetDateMs(doc, "cartUpdatedAt"));
+        user.cart.setVersion(safeGetInt64(doc, "cartVersion"));
         
         // Load purchase history - use safe access to avoid uninitialized element errors
         try {
@@ -776,7 +1056,7 @@ bool MongoDBService::findUserById(const std::string& userId, User& user) {
 #endif
 }
 
-bool MongoDBService::updateUser(const std::string& userId, const User& user) {
+bool MongoDBService::updateUser(const std::string& userId, const User& user, long long* newVersion) {
     if (!connected) return false;
 #ifdef HAS_MONGODB
     if (!db) return false;
@@ -822,13 +1102,13 @@ bool MongoDBService::updateUser(const std::string& userId, const User& user) {
                 kvp("bio", user.bio),
                 kvp("cart", cart_array_builder.extract()),
                 kvp("purchaseHistory", history_array_builder.extract())
-            ))
+            )),
+            kvp("$inc", make_document(kvp("version", static_cast<int64_t>(1))))
         );
         
-        auto filter = make_document(kvp("_id", userId));
-        auto result = users_collection.update_one(filter.view(), update_doc.view());
-        
-        return result && result->modified_count() > 0;
+        auto filter = versionedUserFilter(userId, "version", ANY_VERSION);
+        return runVersionedUserUpdate(users_collection, filter.view(), update_doc.view(),
+                                      getOperationPolicy(MongoOperation::UserUpdate), newVersion);
     } catch (const std::exception& e) {
         std::cerr << "MongoDB updateUser error: " << e.what() << std::endl;
         return false;
@@ -838,6 +1118,91 @@ bool MongoDBService::updateUser(const std::string& userId, const User& user) {
 #endif
 }
 
+#ifdef HAS_MONGODB
+// Which unique index a duplicate key error (E11000) came from: "username", "email" or ""
+static std::string duplicateKeyField(const mongocxx::operation_exception& e) {
+    if (e.raw_server_error()) {
+        auto view = e.raw_server_error()->view();
+        auto keyPattern = view["keyPattern"];
+        if (keyPattern && keyPattern.type() == bsoncxx::type::k_document) {
+            if (keyPattern.get_document().view()["username"]) return "username";
+            if (keyPattern.get_document().view()["email"]) return "email";
+        }
+    }
+    std::string message = e.what();
+    if (message.find("username") != std::string::npos) return "username";
+    if (message.find("email") != std::string::npos) return "email";
+    return "";
+}
+#endif
+
+bool MongoDBService::updateUserProfile(const std::string& userId, const UserProfile& user, long long expectedVersion,
+                                       std::string& conflictField, long long* newVersion) {
+    conflictField.clear();
+    if (!connected) return false;
+#ifdef HAS_MONGODB
+    if (!db) return false;
+#endif
+    
+#ifdef HAS_MONGODB
+    try {
+        auto users_collection = (*db)["users"];
+        
+        std::string normalizedEmail = user.email;
+        normalizedEmail.erase(0, normalizedEmail.find_first_not_of(" \t\n\r"));
+        normalizedEmail.erase(normalizedEmail.find_last_not_of(" \t\n\r") + 1);
+        std::transform(normalizedEmail.begin(), normalizedEmail.end(), normalizedEmail.begin(), ::tolower);
+        
+        // Without the unique indexes the database cannot reject duplicates, so fall back to
+        // one lookup covering both fields
+        if (!uniqueUserIndexes) {
+            auto readOpts = makeFindOptions(getOperationPolicy(MongoOperation::UserRead));
+            readOpts.projection(make_document(kvp("username", 1)));
+            auto filter = make_document(
+                kvp("_id", make_document(kvp("$ne", userId))),
+                kvp("$or", make_array(
+                    make_document(kvp("username", user.username)),
+                    make_document(kvp("email", normalizedEmail))
+                ))
+            );
+            auto existing = users_collection.find_one(filter.view(), readOpts);
+            if (existing) {
+                conflictField = safeGetString(existing->view(), "username") == user.username ? "username" : "email";
+                return false;
+            }
+        }
+        
+        // Only the profile fields - cart and history are left untouched
+        auto update_doc = make_document(
+            kvp("$set", make_document(
+                kvp("username", user.username),
+                kvp("email", normalizedEmail),
+                kvp("password", user.password),
+                kvp("fullName", user.fullName),
+                kvp("bio", user.bio)
+            )),
+            kvp("$inc", make_document(kvp("version", static_cast<int64_t>(1))))
+        );
+        
+        auto filter = versionedUserFilter(userId, "version", expectedVersion);
+        return runVersionedUserUpdate(users_collection, filter.view(), update_doc.view(),
+                                      getOperationPolicy(MongoOperation::UserUpdate), newVersion);
+    } catch (const mongocxx::operation_exception& e) {
+        if (e.code().value() == 11000) {
+            conflictField = duplicateKeyField(e);
+            return false;
+        }
+        std::cerr << "MongoDB updateUserProfile error: " << e.what() << std::endl;
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "MongoDB updateUserProfile error: " << e.what() << std::endl;
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
 bool MongoDBService::getCart(const std::string& userId, std::vector<CartItem>& cart) {
     if (!connected) return false;
 #ifdef HAS_MONGODB
@@ -860,7 +1225,7 @@ bool MongoDBService::getCart(const std::string& userId, std::vector<CartItem>& c
 #endif
 }
 
-bool MongoDBService::updateCart(const std::string& userId, const std::vector<CartItem>& cart) {
+bool MongoDBService::getCartVersion(const std::string& userId, long long& cartVersion) {
     if (!connected) return false;
 #ifdef HAS_MONGODB
     if (!db) return false;
@@ -868,17 +1233,54 @@ bool MongoDBService::updateCart(const std::string& userId, const std::vector<Car
     
 #ifdef HAS_MONGODB
     try {
-        User user;
-        if (!findUserById(userId, user)) return false;
+        auto readOpts = makeFindOptions(getOperationPolicy(MongoOperation::UserRead));
+        readOpts.projection(make_document(kvp("cartVersion", 1)));
+        auto result = (*db)["users"].find_one(make_document(kvp("_id", userId)), readOpts);
+        if (!result) return false;
+        cartVersion = safeGetInt64(result->view(), "cartVersion");
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "MongoDB getCartVersion error: " << e.what() << std::endl;
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+bool MongoDBService::updateCart(const std::string& userId, const std::vector<CartItem>& cart,
+                                long long expectedVersion, long long* newVersion, long long* newCartVersion) {
+    if (!connected) return false;
+#ifdef HAS_MONGODB
+    if (!db) return false;
+#endif
+    
+#ifdef HAS_MONGODB
+    try {
+        auto users_collection = (*db)["users"];
         
-        // Update cart
-        user.cart.clear();
+        // Write only the cart field - no need to read and rewrite the whole user document
+        auto cart_array_builder = bsoncxx::builder::basic::array{};
         for (const auto& item : cart) {
-            user.cart.addItem(item);
+            cart_array_builder.append(make_document(
+                kvp("productId", item.productId),
+                kvp("name", item.name),
+                kvp("price", item.price),
+                kvp("quantity", static_cast<int32_t>(item.quantity))
+            ));
         }
         
-        // Save back to MongoDB
-        return updateUser(userId, user);
+        auto update_doc = make_document(
+            kvp("$set", make_document(
+                kvp("cart", cart_array_builder.extract()),
+                kvp("cartUpdatedAt", bsoncxx::types::b_date{std::chrono::system_clock::now()})
+            )),
+            kvp("$inc", make_document(kvp("version", static_cast<int64_t>(1)), kvp("cartVersion", static_cast<int64_t>(1))))
+        );
+        
+        auto filter = versionedUserFilter(userId, "version", expectedVersion);
+        return runVersionedUserUpdate(users_collection, filter.view(), update_doc.view(),
+                                      getOperationPolicy(MongoOperation::CartWrite), newVersion, newCartVersion);
     } catch (const std::exception& e) {
         std::cerr << "MongoDB updateCart error: " << e.what() << std::endl;
         return false;
@@ -888,7 +1290,8 @@ bool MongoDBService::updateCart(const std::string& userId, const std::vector<Car
 #endif
 }
 
-bool MongoDBService::clearCart(const std::string& userId) {
+bool MongoDBService::clearCart(const std::string& userId, long long expectedVersion, long long* newVersion,
+                               long long* newCartVersion) {
     if (!connected) return false;
 #ifdef HAS_MONGODB
     if (!db) return false;
@@ -896,11 +1299,19 @@ bool MongoDBService::clearCart(const std::string& userId) {
     
 #ifdef HAS_MONGODB
     try {
-        User user;
-        if (!findUserById(userId, user)) return false;
+        auto users_collection = (*db)["users"];
+        auto empty_array = bsoncxx::builder::basic::array{};
+        auto update_doc = make_document(
+            kvp("$set", make_document(
+                kvp("cart", empty_array.extract()),
+                kvp("cartUpdatedAt", bsoncxx::types::b_date{std::chrono::system_clock::now()})
+            )),
+            kvp("$inc", make_document(kvp("version", static_cast<int64_t>(1)), kvp("cartVersion", static_cast<int64_t>(1))))
+        );
         
-        user.cart.clear();
-        return updateUser(userId, user);
+        auto filter = versionedUserFilter(userId, "version", expectedVersion);
+        return runVersionedUserUpdate(users_collection, filter.view(), update_doc.view(),
+                                      getOperationPolicy(MongoOperation::CartWrite), newVersion, newCartVersion);
     } catch (const std::exception& e) {
         std::cerr << "MongoDB clearCart error: " << e.what() << std::endl;
         return false;
@@ -910,8 +1321,108 @@ bool MongoDBService::clearCart(const std::string& userId) {
 #endif
 }
 
+bool MongoDBService::expireAbandonedCarts(long long cutoffMs, size_t batchLimit, bool archive,
+                                          std::vector<std::string>& expiredUserIds) {
+    if (!connected) return true;
+#ifdef HAS_MONGODB
+    if (!db) return true;
+#endif
+    
+#ifdef HAS_MONGODB
+    try {
+        auto users_collection = (*db)["users"];
+        const OperationPolicy& policy = getOperationPolicy(MongoOperation::CartWrite);
+        auto now = bsoncxx::types::b_date{std::chrono::system_clock::now()};
+        
+        // Carts written before cartUpdatedAt existed start ageing from now
+        users_collection.update_many(
+            make_document(
+                kvp("cartUpdatedAt", make_document(kvp("$exists", false))),
+                kvp("cart.0", make_document(kvp("$exists", true)))
+            ),
+            make_document(kvp("$set", make_document(kvp("cartUpdatedAt", now)))),
+            makeUpdateOptions(policy)
+        );
+        
+        auto opts = makeFindOptions(policy);
+        opts.limit(static_cast<int64_t>(batchLimit));
+        opts.projection(make_document(kvp("cart", 1), kvp("cartUpdatedAt", 1)));
+        auto filter = make_document(
+            kvp("cartUpdatedAt", make_document(kvp("$lt", bsoncxx::types::b_date{std::chrono::milliseconds(cutoffMs)}))),
+            kvp("cart.0", make_document(kvp("$exists", true)))
+        );
+        
+        size_t examined = 0;
+        auto cursor = users_collection.find(filter.view(), opts);
+        for (auto&& doc : cursor) {
+            examined++;
+            std::string userId = safeGetId(doc);
+            if (userId.empty()) continue;
+            auto lastTouched = bsoncxx::types::b_date{std::chrono::milliseconds(safeGetDateMs(doc, "cartUpdatedAt"))};
+            
+            if (archive) {
+                auto cartIt = doc.find("cart");
+                if (cartIt != doc.end() && (*cartIt).type() == bsoncxx::type::k_array) {
+                    (*db)["abandoned_carts"].insert_one(make_document(
+                        kvp("userId", userId),
+                        kvp("cart", (*cartIt).get_array()),
+                        kvp("cartUpdatedAt", lastTouched),
+                        kvp("expiredAt", now)
+                    ), makeInsertOptions(policy));
+                }
+            }
+            
+            // Only expire if the cart was not touched since it was selected
+            auto result = users_collection.update_one(
+                make_document(kvp("_id", userId), kvp("cartUpdatedAt", lastTouched)),
+                make_document(
+                    kvp("$set", make_document(
+                        kvp("cart", bsoncxx::builder::basic::array{}.extract()),
+                        kvp("cartUpdatedAt", now)
+                    )),
+                    kvp("$inc", make_document(kvp("version", static_cast<int64_t>(1)), kvp("cartVersion", static_cast<int64_t>(1))))
+                ),
+                makeUpdateOptions(policy)
+            );
+            if (result && result->modified_count() == 1) {
+                expiredUserIds.push_back(userId);
+            }
+        }
+        return examined < batchLimit;
+    } catch (const std::exception& e) {
+        std::cerr << "MongoDB expireAbandonedCarts error: " << e.what() << std::endl;
+        return true;
+    }
+#else
+    return true;
+#endif
+}
+
+#ifdef HAS_MONGODB
+// Order lines for the orders collection and the matching records for the user's embedded history
+static void appendPurchaseArrays(const std::vector<PurchaseRecord>& purchases,
+                                 bsoncxx::builder::basic::array& items, bsoncxx::builder::basic::array& history) {
+    for (const auto& purchase : purchases) {
+        items.append(make_document(
+            kvp("productId", purchase.id),  // Use productId for frontend compatibility
+            kvp("id", purchase.id),         // Keep id for backward compatibility
+            kvp("name", purchase.name),
+            kvp("price", purchase.price),
+            kvp("quantity", static_cast<int32_t>(purchase.quantity)),
+            kvp("subtotal", purchase.price * static_cast<double>(purchase.quantity))
+        ));
+        history.append(make_document(
+            kvp("id", purchase.id),
+            kvp("name", purchase.name),
+            kvp("price", purchase.price),
+            kvp("quantity", static_cast<int32_t>(purchase.quantity))
+        ));
+    }
+}
+#endif
+
 bool MongoDBService::addPurchase(const std::string& userId, const std::vector<PurchaseRecord>& purchases,
-                                 const std::string& orderId, double total) {
+                                 const std::string& orderId, double total, long long* newVersion) {
     if (!connected) return false;
 #ifdef HAS_MONGODB
     if (!db) return false;
@@ -919,27 +1430,13 @@ bool MongoDBService::addPurchase(const std::string& userId, const std::vector<Pu
     
 #ifdef HAS_MONGODB
     try {
-        User user;
-        if (!findUserById(userId, user)) return false;
-        
-        // Add purchases to history
-        for (const auto& purchase : purchases) {
-            user.history.recordPurchase(purchase);
-        }
+        const OperationPolicy& policy = getOperationPolicy(MongoOperation::OrderInsert);
         
-        // Also save as a separate order document
+        // Save as a separate order document
         auto orders_collection = (*db)["orders"];
         auto items_array_builder = bsoncxx::builder::basic::array{};
-        for (const auto& purchase : purchases) {
-            items_array_builder.append(make_document(
-                kvp("productId", purchase.id),  // Use productId for frontend compatibility
-                kvp("id", purchase.id),         // Keep id for backward compatibility
-                kvp("name", purchase.name),
-                kvp("price", purchase.price),
-                kvp("quantity", static_cast<int32_t>(purchase.quantity)),
-                kvp("subtotal", purchase.price * static_cast<double>(purchase.quantity))
-            ));
-        }
+        auto history_array_builder = bsoncxx::builder::basic::array{};
+        appendPurchaseArrays(purchases, items_array_builder, history_array_builder);
         
         auto order_doc = make_document(
             kvp("_id", orderId),
@@ -949,10 +1446,19 @@ bool MongoDBService::addPurchase(const std::string& userId, const std::vector<Pu
             kvp("timestamp", bsoncxx::types::b_date{std::chrono::system_clock::now()})
         );
         
-        orders_collection.insert_one(order_doc.view());
+        orders_collection.insert_one(order_doc.view(), makeInsertOptions(policy));
+        
+        // Append to the user's embedded history with the same durability as the order
+        auto users_collection = (*db)["users"];
+        auto update_doc = make_document(
+            kvp("$push", make_document(
+                kvp("purchaseHistory", make_document(kvp("$each", history_array_builder.extract())))
+            )),
+            kvp("$inc", make_document(kvp("version", static_cast<int64_t>(1))))
+        );
         
-        // Update user document
-        return updateUser(userId, user);
+        auto filter = versionedUserFilter(userId, "version", ANY_VERSION);
+        return runVersionedUserUpdate(users_collection, filter.view(), update_doc.view(), policy, newVersion);
     } catch (const std::exception& e) {
         std::cerr << "MongoDB addPurchase error: " << e.what() << std::endl;
         return false;
@@ -962,6 +1468,71 @@ bool MongoDBService::addPurchase(const std::string& userId, const std::vector<Pu
 #endif
 }
 
+bool MongoDBService::checkoutCart(const std::string& userId, long long expectedCartVersion,
+                                  const std::vector<PurchaseRecord>& purchases, const std::string& orderId,
+                                  double total, long long* newVersion, long long* newCartVersion) {
+    if (!connected) return false;
+#ifdef HAS_MONGODB
+    if (!db) return false;
+#endif
+    
+#ifdef HAS_MONGODB
+    bool orderInserted = false;
+    try {
+        const OperationPolicy& policy = getOperationPolicy(MongoOperation::OrderInsert);
+        auto orders_collection = (*db)["orders"];
+        auto items_array_builder = bsoncxx::builder::basic::array{};
+        auto history_array_builder = bsoncxx::builder::basic::array{};
+        appendPurchaseArrays(purchases, items_array_builder, history_array_builder);
+        
+        auto order_doc = make_document(
+            kvp("_id", orderId),
+            kvp("userId", userId),
+            kvp("items", items_array_builder.extract()),
+            kvp("total", total),
+            kvp("timestamp", bsoncxx::types::b_date{std::chrono::system_clock::now()})
+        );
+        orders_collection.insert_one(order_doc.view(), makeInsertOptions(policy));
+        orderInserted = true;
+        
+        // Record the history and empty the cart in one update, only while the cart is
+        // still the one that was priced
+        auto users_collection = (*db)["users"];
+        auto filter = versionedUserFilter(userId, "cartVersion", expectedCartVersion);
+        auto update_doc = make_document(
+            kvp("$push", make_document(
+                kvp("purchaseHistory", make_document(kvp("$each", history_array_builder.extract())))
+            )),
+            kvp("$set", make_document(
+                kvp("cart", bsoncxx::builder::basic::array{}.extract()),
+                kvp("cartUpdatedAt", bsoncxx::types::b_date{std::chrono::system_clock::now()})
+            )),
+            kvp("$inc", make_document(kvp("version", static_cast<int64_t>(1)), kvp("cartVersion", static_cast<int64_t>(1))))
+        );
+        if (runVersionedUserUpdate(users_collection, filter.view(), update_doc.view(), policy, newVersion,
+                                   newCartVersion)) {
+            return true;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "MongoDB checkoutCart error: " << e.what() << std::endl;
+    }
+    
+    // The cart changed after it was priced (or the update failed): withdraw the order so
+    // nothing is recorded for a cart that was not charged
+    if (orderInserted) {
+        try {
+            (*db)["orders"].delete_one(make_document(kvp("_id", orderId)).view(),
+                                       makeDeleteOptions(getOperationPolicy(MongoOperation::OrderInsert)));
+        } catch (const std::exception& e) {
+            std::cerr << "MongoDB checkoutCart error withdrawing order " << orderId << ": " << e.what() << std::endl;
+        }
+    }
+    return false;
+#else
+    return false;
+#endif
+}
+
 bool MongoDBService::getPurchaseHistory(const std::string& userId, std::vector<std::string>& historyJson) {
     if (!connected) {
         std::cerr << "MongoDB getPurchaseHistory: Not connected to MongoDB" << std::endl;
@@ -987,7 +1558,7 @@ bool MongoDBService::getPurchaseHistory(const std::string& userId, std::vector<s
         
         // Use find() to get cursor - limit to prevent memory issues
         try {
-            mongocxx::options::find opts;
+            mongocxx::options::find opts = makeFindOptions(getOperationPolicy(MongoOperation::HistoryRead));
             opts.limit(100); // Limit to 100 orders to prevent memory issues
             
             auto cursor = orders_collection.find(filter.view(), opts);
@@ -1038,7 +1609,8 @@ bool MongoDBService::saveToken(const std::string& token, const std::string& user
         
         // Remove old token if exists
         auto delete_filter = make_document(kvp("token", token));
-        tokens_collection.delete_one(delete_filter.view());
+        const OperationPolicy& policy = getOperationPolicy(MongoOperation::TokenWrite);
+        tokens_collection.delete_one(delete_filter.view(), makeDeleteOptions(policy));
         
         // Insert new token
         auto token_doc = make_document(
@@ -1047,7 +1619,7 @@ bool MongoDBService::saveToken(const std::string& token, const std::string& user
             kvp("createdAt", bsoncxx::types::b_date{std::chrono::system_clock::now()})
         );
         
-        auto insert_result = tokens_collection.insert_one(token_doc.view());
+        auto insert_result = tokens_collection.insert_one(token_doc.view(), makeInsertOptions(policy));
         if (insert_result) {
             std::cerr << "MongoDB saveToken: Successfully saved token for userId '" << userId << "'" << std::endl;
             return true;
@@ -1081,7 +1653,8 @@ std::string MongoDBService::getUserIdFromToken(const std::string& token) {
         auto tokens_collection = (*db)["tokens"];
         auto filter = make_document(kvp("token", token));
         std::cerr << "MongoDB getUserIdFromToken: Looking up token (length: " << token.length() << ")" << std::endl;
-        auto result = tokens_collection.find_one(filter.view());
+        auto result = tokens_collection.find_one(filter.view(),
+                                                 makeFindOptions(getOperationPolicy(MongoOperation::TokenRead)));
         
         if (!result) {
             // Token not found - this is normal for invalid tokens
@@ -11,16 +11,47 @@
 
 // Forward declarations
 struct User;
+struct UserProfile;
 struct CartItem;
 struct PurchaseRecord;
 
+// Operation classes that can be tuned independently in mongodb_config.txt
+enum class MongoOperation {
+    UserCreate,   // createUser insert
+    UserRead,     // findUserBy*, emailExists
+    UserUpdate,   // updateUser (profile changes)
+    CartWrite,    // updateCart, clearCart
+    OrderInsert,  // addPurchase (orders collection + user history)
+    HistoryRead,  // getPurchaseHistory
+    TokenWrite,   // saveToken
+    TokenRead,    // getUserIdFromToken
+    Count
+};
+
+// Consistency/durability settings applied to a single operation class
+struct OperationPolicy {
+    std::string writeConcern;   // "1" (primary ack) or "majority"
+    bool journal;               // wait for the journal commit
+    std::string readPreference; // primary, primaryPreferred, secondary, secondaryPreferred, nearest
+    int maxTimeMS;              // server-side time limit (wtimeout for writes), 0 = none
+
+    OperationPolicy() : writeConcern("1"), journal(false), readPreference("primary"), maxTimeMS(0) {}
+    OperationPolicy(const std::string& w, bool j, const std::string& read, int maxTime)
+        : writeConcern(w), journal(j), readPreference(read), maxTimeMS(maxTime) {}
+};
+
 class MongoDBService {
 private:
     bool connected;
+    bool uniqueUserIndexes;
     std::string connectionString;
     std::string databaseName;
+    OperationPolicy policies[static_cast<size_t>(MongoOperation::Count)];
 
 public:
+    // Expected version for writes that apply whatever the document's current version
+    static const long long ANY_VERSION = -1;
+
     MongoDBService();
     ~MongoDBService();
 
@@ -38,24 +69,84 @@ public:
      */
     bool isConnected() const;
 
+    /**
+     * Per-operation read preference / write concern policy
+     * Defaults: orders and account creation wait for majority + journal,
+     * cart and token writes are acknowledged by the primary only, and
+     * order history reads may be served by secondaries.
+     */
+    void setOperationPolicy(MongoOperation operation, const OperationPolicy& policy);
+    const OperationPolicy& getOperationPolicy(MongoOperation operation) const;
+
+    /**
+     * Config key suffix for an operation (e.g. "TOKEN_WRITE" for MONGODB_POLICY_TOKEN_WRITE)
+     */
+    static const char* operationName(MongoOperation operation);
+
+    /**
+     * Parse a policy spec such as "w=majority,j=true,read=secondaryPreferred,maxTimeMS=2000"
+     * Fields not present in the spec keep their current value in `policy`.
+     * @return false if any field is unknown or has an invalid value
+     */
+    static bool parseOperationPolicy(const std::string& spec, OperationPolicy& policy);
+
     // User operations
     bool createUser(const std::string& username, const std::string& email, 
                    const std::string& password, const std::string& userId);
     bool findUserByUsername(const std::string& username, User& user);
     bool findUserByEmail(const std::string& email, User& user);
     bool findUserById(const std::string& userId, User& user);
-    bool updateUser(const std::string& userId, const User& user);
+    // Writes to the user document bump its `version`; pass newVersion to receive the new value
+    bool updateUser(const std::string& userId, const User& user, long long* newVersion = nullptr);
+    /**
+     * Save profile fields (username, email, password, fullName, bio) in one conditional update.
+     * Uniqueness comes from the unique username/email indexes: on a duplicate key the update
+     * fails and conflictField is set to "username" or "email". The update also fails, with
+     * conflictField empty, once the document has moved past expectedVersion.
+     */
+    bool updateUserProfile(const std::string& userId, const UserProfile& user, long long expectedVersion,
+                           std::string& conflictField, long long* newVersion = nullptr);
+    // False if the unique username/email indexes could not be built (e.g. existing duplicates)
+    bool hasUniqueUserIndexes() const;
     // Simple check if email exists (faster than loading full user)
     bool emailExists(const std::string& email);
 
     // Cart operations
     bool getCart(const std::string& userId, std::vector<CartItem>& cart);
-    bool updateCart(const std::string& userId, const std::vector<CartItem>& cart);
-    bool clearCart(const std::string& userId);
+    /**
+     * Cart writes also bump the user's cartVersion and report it through newCartVersion.
+     * They only apply while the user document is still at expectedVersion (the version the
+     * cart was read at) and return false otherwise; pass ANY_VERSION to write unconditionally.
+     */
+    bool updateCart(const std::string& userId, const std::vector<CartItem>& cart, long long expectedVersion,
+                    long long* newVersion = nullptr, long long* newCartVersion = nullptr);
+    bool clearCart(const std::string& userId, long long expectedVersion, long long* newVersion = nullptr,
+                   long long* newCartVersion = nullptr);
+    // Read only the cartVersion field (no cart decoding) for conditional GETs
+    bool getCartVersion(const std::string& userId, long long& cartVersion);
+
+    /**
+     * Expire up to batchLimit non-empty carts last written before cutoffMs
+     * Each cart is cleared with a conditional update on cartUpdatedAt, so a cart
+     * touched after it was selected is left alone. With archive set, the expired
+     * items are copied to the abandoned_carts collection first.
+     * @return true if the pass is complete (fewer than batchLimit candidates found)
+     */
+    bool expireAbandonedCarts(long long cutoffMs, size_t batchLimit, bool archive,
+                              std::vector<std::string>& expiredUserIds);
 
     // Purchase history operations
     bool addPurchase(const std::string& userId, const std::vector<PurchaseRecord>& purchases,
-                    const std::string& orderId, double total);
+                    const std::string& orderId, double total, long long* newVersion = nullptr);
+    /**
+     * Check out a priced cart: insert the order, then append it to the user's history and
+     * empty the cart in one update that only applies while cartVersion is still
+     * expectedCartVersion. If the cart changed in between, the order is withdrawn and
+     * false is returned, so a cart is never emptied without being charged.
+     */
+    bool checkoutCart(const std::string& userId, long long expectedCartVersion,
+                      const std::vector<PurchaseRecord>& purchases, const std::string& orderId, double total,
+                      long long* newVersion = nullptr, long long* newCartVersion = nullptr);
     bool getPurchaseHistory(const std::string& userId, std::vector<std::string>& historyJson);
 
     // Token operations
@@ -0,0 +1,231 @@
+/**
+ * Profiler - Implementation
+ */
+
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+namespace {
+
+std::atomic<bool> profiling(false); // a profile() call is in progress
+
+#if defined(__linux__)
+const int MAX_DEPTH = 64;
+const int SKIP_FRAMES = 2;          // onSigprof + the kernel's signal trampoline
+const size_t MAX_SAMPLES = 200000;
+
+struct Sample {
+    std::atomic<int> depth;         // 0 until the frames are written
+    void* frames[MAX_DEPTH];
+};
+
+// Shared with the signal handler: set up before the timer is armed and torn down
+// only after it is deleted and in-flight handlers have drained
+std::unique_ptr<Sample[]> sampleBuffer;
+std::atomic<Sample*> samples(nullptr);
+std::atomic<size_t> capacity(0);
+std::atomic<size_t> nextSample(0);
+std::atomic<size_t> droppedSamples(0);
+bool handlerInstalled = false;
+
+// Async-signal-safe: no allocation, no locks. backtrace() is safe once libgcc's
+// unwinder has been loaded, which profile() forces before arming the timer.
+void onSigprof(int, siginfo_t*, void*) {
+    Sample* buffer = samples.load(std::memory_order_acquire);
+    if (!buffer) return;
+    int savedErrno = errno;
+    size_t index = nextSample.fetch_add(1, std::memory_order_relaxed);
+    if (index < capacity.load(std::memory_order_relaxed)) {
+        Sample& sample = buffer[index];
+        int depth = backtrace(sample.frames, MAX_DEPTH);
+        sample.depth.store(depth > 0 ? depth : -1, std::memory_order_release);
+    } else {
+        droppedSamples.fetch_add(1, std::memory_order_relaxed);
+    }
+    errno = savedErrno;
+}
+
+std::string symbolize(void* address, bool isReturnAddress) {
+    // Return addresses point after the call; look up the call instruction instead
+    void* lookup = isReturnAddress ? static_cast<char*>(address) - 1 : address;
+    Dl_info info;
+    if (dladdr(lookup, &info) && info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = (status == 0 && demangled) ? demangled : info.dli_sname;
+        std::free(demangled);
+        return name;
+    }
+
+    char buffer[64];
+    if (dladdr(lookup, &info) && info.dli_fname) {
+        std::string module = info.dli_fname;
+        size_t slash = module.find_last_of('/');
+        if (slash != std::string::npos) module = module.substr(slash + 1);
+        std::snprintf(buffer, sizeof(buffer), "+0x%lx",
+                      static_cast<unsigned long>(static_cast<char*>(lookup) - static_cast<char*>(info.dli_fbase)));
+        return module + buffer;
+    }
+    std::snprintf(buffer, sizeof(buffer), "0x%lx", reinterpret_cast<unsigned long>(lookup));
+    return buffer;
+}
+
+std::string foldSamples(size_t count) {
+    std::unordered_map<void*, std::string> names;
+    std::map<std::string, size_t> stacks;
+    std::string key;
+    for (size_t i = 0; i < count; ++i) {
+        Sample& sample = sampleBuffer[i];
+        int depth = sample.depth.load(std::memory_order_acquire);
+        if (depth <= SKIP_FRAMES) continue;
+
+        // backtrace() is leaf-first; folded stacks are root-first
+        key.clear();
+        for (int frame = depth - 1; frame >= SKIP_FRAMES; --frame) {
+            void* address = sample.frames[frame];
+            auto it = names.find(address);
+            if (it == names.end()) {
+                it = names.emplace(address, symbolize(address, frame > SKIP_FRAMES)).first;
+            }
+            if (!key.empty()) key += ';';
+            key += it->second;
+        }
+        stacks[key]++;
+    }
+
+    std::string folded;
+    for (const auto& stack : stacks) {
+        folded += stack.first;
+        folded += ' ';
+        folded += std::to_string(stack.second);
+        folded += '\n';
+    }
+    return folded;
+}
+#endif
+
+} // namespace
+
+bool Profiler::isSupported() {
+#if defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Profiler::isRunning() {
+    return profiling.load();
+}
+
+bool Profiler::profile(int seconds, int frequencyHz, ProfileResult& result) {
+    result = ProfileResult();
+    if (seconds < 1 || seconds > MAX_SECONDS) {
+        result.error = "seconds must be between 1 and " + std::to_string(MAX_SECONDS);
+        return false;
+    }
+    if (frequencyHz < 1 || frequencyHz > MAX_FREQUENCY_HZ) {
+        result.error = "hz must be between 1 and " + std::to_string(MAX_FREQUENCY_HZ);
+        return false;
+    }
+    if (!isSupported()) {
+        result.error = "CPU profiling is not supported on this platform";
+        return false;
+    }
+
+    bool expected = false;
+    if (!profiling.compare_exchange_strong(expected, true)) {
+        result.error = "A profile is already running";
+        return false;
+    }
+
+#if defined(__linux__)
+    // Every busy core advances the process CPU clock, so size for all of them
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t wanted = static_cast<size_t>(seconds) * frequencyHz * cores;
+    sampleBuffer.reset(new Sample[std::min(wanted, MAX_SAMPLES)]());
+    capacity.store(std::min(wanted, MAX_SAMPLES));
+    nextSample.store(0);
+    droppedSamples.store(0);
+
+    // Load the unwinder now - its first use allocates, which a signal handler must not do
+    void* warmup[4];
+    backtrace(warmup, 4);
+
+    // The handler stays installed once set: a SIGPROF still pending after the timer
+    // is deleted must not hit the default action, which terminates the process
+    if (!handlerInstalled) {
+        struct sigaction action = {};
+        action.sa_sigaction = onSigprof;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) {
+            result.error = "Could not install SIGPROF handler";
+            sampleBuffer.reset();
+            profiling.store(false);
+            return false;
+        }
+        handlerInstalled = true;
+    }
+
+    struct sigevent event = {};
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = SIGPROF;
+    timer_t timer;
+    if (timer_create(CLOCK_PROCESS_CPUTIME_ID, &event, &timer) != 0) {
+        result.error = "Could not create CPU-time timer";
+        sampleBuffer.reset();
+        profiling.store(false);
+        return false;
+    }
+
+    long long intervalNs = 1000000000LL / frequencyHz;
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = static_cast<time_t>(intervalNs / 1000000000LL);
+    spec.it_interval.tv_nsec = static_cast<long>(intervalNs % 1000000000LL);
+    spec.it_value = spec.it_interval;
+
+    samples.store(sampleBuffer.get(), std::memory_order_release);
+    auto started = std::chrono::steady_clock::now();
+    timer_settime(timer, 0, &spec, nullptr);
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    timer_delete(timer);
+    samples.store(nullptr, std::memory_order_release);
+    result.durationMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count());
+
+    // Let handlers that loaded the buffer before it was unpublished finish writing
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    size_t taken = std::min(nextSample.load(), capacity.load());
+    result.folded = foldSamples(taken);
+    result.samples = taken;
+    result.dropped = droppedSamples.load();
+    result.frequencyHz = frequencyHz;
+
+    capacity.store(0);
+    sampleBuffer.reset();
+    profiling.store(false);
+    return true;
+#else
+    profiling.store(false);
+    return false;
+#endif
+}
@@ -0,0 +1,48 @@
+/**
+ * Profiler - in-process sampling CPU profiler
+ * A POSIX CPU-time timer (timer_create on CLOCK_PROCESS_CPUTIME_ID) delivers
+ * SIGPROF at a fixed frequency while the process is burning CPU. The signal
+ * handler captures the interrupted thread's stack into a buffer allocated before
+ * sampling starts - it never allocates or locks. Once the window closes the
+ * stacks are symbolized and returned as folded stacks ("root;caller;leaf count")
+ * for flamegraph.pl / speedscope.
+ * Linux only; symbol names for the backend's own functions need the binary to be
+ * linked with -rdynamic, otherwise frames show as "module+0xoffset".
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+
+struct ProfileResult {
+    std::string folded;        // one "frame;frame;frame count" line per unique stack
+    size_t samples;            // stacks captured
+    size_t dropped;            // signals that arrived with the buffer full
+    int durationMs;
+    int frequencyHz;
+    std::string error;         // set when profile() returns false
+
+    ProfileResult() : samples(0), dropped(0), durationMs(0), frequencyHz(0) {}
+};
+
+class Profiler {
+public:
+    static const int MAX_SECONDS = 60;
+    static const int MAX_FREQUENCY_HZ = 1000;
+    static const int DEFAULT_FREQUENCY_HZ = 99; // off the 100Hz beat of periodic work
+
+    static bool isSupported();
+
+    /**
+     * Sample the whole process for `seconds`; blocks the calling thread for that long.
+     * Only one profile runs at a time.
+     * @return false with result.error set if arguments are out of range, a profile is
+     *         already running, or the platform has no CPU-time timers
+     */
+    static bool profile(int seconds, int frequencyHz, ProfileResult& result);
+
+    static bool isRunning();
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,297 @@
+/**
+ * Promotions - Implementation
+ */
+
+#include "Promotions.h"
+#include "Cart.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include <utility>
+
+namespace {
+
+double roundCents(double value) {
+    return std::round(value * 100.0) / 100.0;
+}
+
+long long fileMtime(const std::string& filePath) {
+    struct stat info;
+    if (stat(filePath.c_str(), &info) != 0) {
+        return -1;
+    }
+    return static_cast<long long>(info.st_mtime);
+}
+
+bool parseNumber(const std::map<std::string, std::string>& fields, const std::string& key, double& value) {
+    auto it = fields.find(key);
+    if (it == fields.end()) return false;
+    try {
+        size_t used = 0;
+        value = std::stod(it->second, &used);
+        return used == it->second.size() && std::isfinite(value);
+    } catch (...) {
+        return false;
+    }
+}
+
+// Last threshold whose minimum the subtotal reaches, or nullptr
+const PromotionRules::Threshold* reached(const std::vector<PromotionRules::Threshold>& thresholds, double subtotal) {
+    auto it = std::upper_bound(thresholds.begin(), thresholds.end(), subtotal,
+                               [](double value, const PromotionRules::Threshold& threshold) {
+                                   return value < threshold.minSubtotal;
+                               });
+    return it == thresholds.begin() ? nullptr : &*(it - 1);
+}
+
+// Sort by minimum and carry the best value forward, so a lookup only needs the last reached entry
+void compileThresholds(std::vector<PromotionRules::Threshold>& thresholds) {
+    std::stable_sort(thresholds.begin(), thresholds.end(),
+                     [](const PromotionRules::Threshold& a, const PromotionRules::Threshold& b) {
+                         return a.minSubtotal < b.minSubtotal;
+                     });
+    for (size_t i = 1; i < thresholds.size(); ++i) {
+        if (thresholds[i - 1].value > thresholds[i].value) {
+            thresholds[i].value = thresholds[i - 1].value;
+            thresholds[i].rule = thresholds[i - 1].rule;
+        }
+    }
+}
+
+} // namespace
+
+PromotionEngine::PromotionEngine()
+    : rules(std::make_shared<const PromotionRules>()), loadedMtime(-1), reloads(0) {
+}
+
+std::shared_ptr<const PromotionRules> PromotionEngine::compile(const std::string& text, const CatalogSnapshot& catalog,
+                                                               std::vector<std::string>& errors) {
+    auto compiled = std::make_shared<PromotionRules>();
+    PromotionRules::SkuEntry none = {0.0, 0, 0, 0};
+    compiled->skus.assign(catalog.size(), none);
+
+    std::vector<std::pair<unsigned int, PromotionRules::Deal>> deals;
+    std::istringstream input(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream tokens(line);
+        std::string type;
+        if (!(tokens >> type)) continue;
+
+        std::string where = "line " + std::to_string(lineNumber) + ": ";
+        if (type != "percent_off" && type != "buy_x_get_y" && type != "cart_threshold") {
+            errors.push_back(where + "unknown rule type '" + type + "'");
+            continue;
+        }
+
+        std::map<std::string, std::string> fields;
+        std::string token;
+        bool malformed = false;
+        while (tokens >> token) {
+            size_t eq = token.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                malformed = true;
+                break;
+            }
+            fields[token.substr(0, eq)] = token.substr(eq + 1);
+        }
+
+        if (malformed) {
+            errors.push_back(where + "expected key=value, got '" + token + "'");
+            continue;
+        }
+        std::string id = fields.count("id") ? fields["id"] : "rule" + std::to_string(lineNumber);
+        unsigned int ruleIndex = static_cast<unsigned int>(compiled->ruleIds.size());
+
+        if (type == "percent_off" || type == "buy_x_get_y") {
+            unsigned int slot = fields.count("sku") ? catalog.slotOf(fields["sku"]) : CatalogSnapshot::NO_SLOT;
+            if (slot == CatalogSnapshot::NO_SLOT) {
+                errors.push_back(where + "unknown or missing sku");
+                continue;
+            }
+
+            if (type == "percent_off") {
+                double percent = 0;
+                if (!parseNumber(fields, "percent", percent) || percent <= 0 || percent > 100) {
+                    errors.push_back(where + "percent must be in (0, 100]");
+                    continue;
+                }
+                PromotionRules::SkuEntry& entry = compiled->skus[slot];
+                if (percent > entry.percent) {
+                    entry.percent = percent;
+                    entry.percentRule = ruleIndex;
+                }
+            } else {
+                double buy = 0;
+                double get = 0;
+                if (!parseNumber(fields, "buy", buy) || !parseNumber(fields, "get", get) ||
+                    buy < 1 || get < 1 || buy > 1000 || get > 1000 || buy != std::floor(buy) || get != std::floor(get)) {
+                    errors.push_back(where + "buy and get must be whole numbers from 1 to 1000");
+                    continue;
+                }
+                PromotionRules::Deal deal = {static_cast<unsigned int>(buy), static_cast<unsigned int>(get), ruleIndex};
+                deals.push_back(std::make_pair(slot, deal));
+            }
+        } else {
+            double minSubtotal = 0;
+            double value = 0;
+            if (!parseNumber(fields, "min", minSubtotal) || minSubtotal < 0) {
+                errors.push_back(where + "min must be a non-negative amount");
+                continue;
+            }
+            if (parseNumber(fields, "amount", value) && value > 0) {
+                compiled->amountThresholds.push_back({minSubtotal, value, ruleIndex});
+            } else if (parseNumber(fields, "percent", value) && value > 0 && value <= 100) {
+                compiled->percentThresholds.push_back({minSubtotal, value, ruleIndex});
+            } else {
+                errors.push_back(where + "cart_threshold needs amount > 0 or percent in (0, 100]");
+                continue;
+            }
+        }
+        compiled->ruleIds.push_back(id);
+    }
+
+    // Group deals by SKU so each catalog slot points at one contiguous range
+    std::stable_sort(deals.begin(), deals.end(),
+                     [](const std::pair<unsigned int, PromotionRules::Deal>& a,
+                        const std::pair<unsigned int, PromotionRules::Deal>& b) { return a.first < b.first; });
+    compiled->deals.reserve(deals.size());
+    for (const auto& deal : deals) {
+        PromotionRules::SkuEntry& entry = compiled->skus[deal.first];
+        if (entry.dealBegin == entry.dealEnd) {
+            entry.dealBegin = static_cast<unsigned int>(compiled->deals.size());
+        }
+        compiled->deals.push_back(deal.second);
+        entry.dealEnd = static_cast<unsigned int>(compiled->deals.size());
+    }
+
+    compileThresholds(compiled->amountThresholds);
+    compileThresholds(compiled->percentThresholds);
+    return compiled;
+}
+
+void PromotionEngine::publish(const std::string& text, const CatalogSnapshot& catalog, std::vector<std::string>& errors) {
+    std::shared_ptr<const PromotionRules> compiled = compile(text, catalog, errors);
+    std::atomic_store(&rules, compiled);
+    reloads.fetch_add(1);
+}
+
+bool PromotionEngine::load(const std::string& filePath, const CatalogSnapshot& catalog, std::vector<std::string>& errors) {
+    std::lock_guard<std::mutex> lock(loadMutex);
+    path = filePath;
+    loadedMtime = fileMtime(filePath);
+    if (loadedMtime < 0) {
+        publish("", catalog, errors);
+        return true;
+    }
+
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        errors.push_back("cannot read " + filePath);
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    publish(contents.str(), catalog, errors);
+    return true;
+}
+
+bool PromotionEngine::reloadIfChanged(const CatalogSnapshot& catalog, std::vector<std::string>& errors) {
+    std::string filePath;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (path.empty() || fileMtime(path) == loadedMtime) {
+            return false;
+        }
+        filePath = path;
+    }
+    return load(filePath, catalog, errors);
+}
+
+std::shared_ptr<const PromotionRules> PromotionEngine::current() const {
+    return std::atomic_load(&rules);
+}
+
+unsigned long long PromotionEngine::getReloads() const {
+    return reloads.load();
+}
+
+void PromotionEngine::evaluate(const std::vector<CartItem>& lines, const CatalogSnapshot& catalog,
+                               PromotionResult& result) const {
+    evaluate(current(), lines, catalog, result);
+}
+
+void PromotionEngine::evaluate(const std::shared_ptr<const PromotionRules>& rules, const std::vector<CartItem>& lines,
+                               const CatalogSnapshot& catalog, PromotionResult& result) {
+    result.subtotal = 0.0;
+    result.discount = 0.0;
+    result.applied.clear();
+    result.rules = rules;
+    const PromotionRules& compiled = *rules;
+
+    // SKU rules: best single rule per line
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const CartItem& line = lines[i];
+        double lineTotal = line.subtotal();
+        result.subtotal += lineTotal;
+
+        unsigned int slot = catalog.resolve(line.productId, line.catalogSlot);
+        if (slot >= compiled.skus.size()) continue;
+        const PromotionRules::SkuEntry& entry = compiled.skus[slot];
+
+        double best = 0.0;
+        unsigned int bestRule = 0;
+        if (entry.percent > 0) {
+            best = lineTotal * entry.percent / 100.0;
+            bestRule = entry.percentRule;
+        }
+        for (unsigned int d = entry.dealBegin; d < entry.dealEnd; ++d) {
+            const PromotionRules::Deal& deal = compiled.deals[d];
+            unsigned int freeUnits = (line.quantity / (deal.buy + deal.get)) * deal.get;
+            double saving = line.price * static_cast<double>(freeUnits);
+            if (saving > best) {
+                best = saving;
+                bestRule = deal.rule;
+            }
+        }
+
+        best = roundCents(best);
+        if (best > 0) {
+            result.discount += best;
+            result.applied.push_back({bestRule, static_cast<int>(i), best});
+        }
+    }
+
+    // Cart thresholds on the discounted subtotal
+    double discounted = result.subtotal - result.discount;
+    double best = 0.0;
+    unsigned int bestRule = 0;
+    if (const PromotionRules::Threshold* amount = reached(compiled.amountThresholds, discounted)) {
+        best = std::min(amount->value, discounted);
+        bestRule = amount->rule;
+    }
+    if (const PromotionRules::Threshold* percent = reached(compiled.percentThresholds, discounted)) {
+        double saving = discounted * percent->value / 100.0;
+        if (saving > best) {
+            best = saving;
+            bestRule = percent->rule;
+        }
+    }
+    best = roundCents(best);
+    if (best > 0) {
+        result.discount += best;
+        result.applied.push_back({bestRule, -1, best});
+    }
+
+    result.subtotal = roundCents(result.subtotal);
+    result.discount = roundCents(result.discount);
+    result.total = roundCents(std::max(0.0, result.subtotal - result.discount));
+}
@@ -0,0 +1,123 @@
+/**
+ * Promotions - compiled promotion and discount rules
+ * Rules are read from a text file and compiled into flat tables: one entry per
+ * catalog slot for SKU rules, and sorted threshold lists for cart rules. A cart is
+ * priced in a single pass over its lines plus a binary search per threshold list,
+ * so evaluation cost does not grow with the number of active rules.
+ *
+ * Rules file format, one rule per line ('#' starts a comment):
+ *   percent_off    id=SPRING10 sku=ITEM002 percent=10
+ *   buy_x_get_y    id=MICE3X2  sku=ITEM002 buy=2 get=1
+ *   cart_threshold id=SAVE20   min=200 amount=20
+ *   cart_threshold id=BIG5     min=500 percent=5
+ * A line gets the better of its SKU rules (they do not stack), then the best cart
+ * threshold reached by the discounted subtotal is applied on top.
+ */
+
+#ifndef PROMOTIONS_H
+#define PROMOTIONS_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Catalog.h"
+
+struct CartItem;
+
+// Immutable compiled rule set; published whole and never modified
+class PromotionRules {
+public:
+    struct SkuEntry {
+        double percent;             // best percent-off for the SKU, 0 = none
+        unsigned int percentRule;   // rule index of that percent-off
+        unsigned int dealBegin;     // buy-X-get-Y deals for the SKU: deals[dealBegin, dealEnd)
+        unsigned int dealEnd;
+    };
+
+    struct Deal {
+        unsigned int buy;
+        unsigned int get;
+        unsigned int rule;
+    };
+
+    struct Threshold {
+        double minSubtotal;
+        double value;               // best amount / percent of any threshold up to this one
+        unsigned int rule;
+    };
+
+    std::vector<SkuEntry> skus;     // indexed by catalog slot
+    std::vector<Deal> deals;
+    std::vector<Threshold> amountThresholds;  // sorted by minSubtotal
+    std::vector<Threshold> percentThresholds; // sorted by minSubtotal
+    std::vector<std::string> ruleIds;
+
+    size_t ruleCount() const { return ruleIds.size(); }
+};
+
+struct AppliedPromotion {
+    unsigned int rule;      // index into PromotionRules::ruleIds
+    int line;               // cart line index, -1 for cart-level rules
+    double discount;
+};
+
+struct PromotionResult {
+    double subtotal;        // before discounts
+    double discount;
+    double total;
+    std::vector<AppliedPromotion> applied;
+    std::shared_ptr<const PromotionRules> rules; // keeps rule ids valid for the caller
+
+    PromotionResult() : subtotal(0.0), discount(0.0), total(0.0) {}
+
+    const std::string& ruleId(const AppliedPromotion& promotion) const { return rules->ruleIds[promotion.rule]; }
+};
+
+class PromotionEngine {
+private:
+    std::shared_ptr<const PromotionRules> rules; // accessed only through std::atomic_load/store
+    std::mutex loadMutex;                        // serializes loaders; readers never take it
+    std::string path;
+    long long loadedMtime;
+    std::atomic<unsigned long long> reloads;
+
+public:
+    PromotionEngine();
+
+    /**
+     * Parse and compile rules against a catalog snapshot
+     * @param errors - Receives one message per rejected line
+     * @return Compiled rules (lines with errors are skipped)
+     */
+    static std::shared_ptr<const PromotionRules> compile(const std::string& text, const CatalogSnapshot& catalog,
+                                                         std::vector<std::string>& errors);
+
+    // Compile and publish rules from text; readers switch over without blocking
+    void publish(const std::string& text, const CatalogSnapshot& catalog, std::vector<std::string>& errors);
+
+    /**
+     * Load rules from a file and remember it for reloadIfChanged()
+     * A missing file publishes an empty rule set
+     * @return false if the file exists but cannot be read
+     */
+    bool load(const std::string& filePath, const CatalogSnapshot& catalog, std::vector<std::string>& errors);
+
+    // Reload the remembered file if its modification time changed; true if reloaded
+    bool reloadIfChanged(const CatalogSnapshot& catalog, std::vector<std::string>& errors);
+
+    std::shared_ptr<const PromotionRules> current() const;
+    unsigned long long getReloads() const;
+
+    /**
+     * Price cart lines (at their stored prices) with the current rules
+     * The catalog resolves lines to their SKU slots
+     */
+    void evaluate(const std::vector<CartItem>& lines, const CatalogSnapshot& catalog, PromotionResult& result) const;
+
+    static void evaluate(const std::shared_ptr<const PromotionRules>& rules, const std::vector<CartItem>& lines,
+                         const CatalogSnapshot& catalog, PromotionResult& result);
+};
+
+#endif // PROMOTIONS_H
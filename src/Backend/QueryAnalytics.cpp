@@ -0,0 +1,177 @@
+/**
+ * QueryAnalytics - Implementation
+ */
+
+#include "QueryAnalytics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+size_t roundUp(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    return size;
+}
+
+bool byCount(const QueryCount& a, const QueryCount& b) {
+    if (a.count != b.count) return a.count > b.count;
+    return a.query < b.query;
+}
+
+} // namespace
+
+QueryAnalytics::QueryAnalytics(size_t ringCapacity, size_t sketchSize)
+    : slots(new Slot[roundUp(ringCapacity)]), mask(roundUp(ringCapacity) - 1), enqueuePos(0), dequeuePos(0),
+      recorded(0), dropped(0), skipped(0), sketchCapacity(std::max<size_t>(1, sketchSize)), aggregated(0) {
+    for (size_t i = 0; i <= mask; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    counters.reserve(sketchCapacity);
+}
+
+bool QueryAnalytics::record(const std::string& normalizedQuery) {
+    if (normalizedQuery.empty() || normalizedQuery.size() > MAX_QUERY_BYTES) {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    size_t position = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots[position & mask];
+        long long lag = static_cast<long long>(slot->sequence.load(std::memory_order_acquire) - position);
+        if (lag == 0) {
+            if (enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if (lag < 0) {
+            // Still holds the query from one lap ago: the consumer is behind
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->length = static_cast<unsigned char>(normalizedQuery.size());
+    normalizedQuery.copy(slot->text, normalizedQuery.size());
+    slot->sequence.store(position + 1, std::memory_order_release);
+    recorded.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t QueryAnalytics::aggregate() {
+    std::lock_guard<std::mutex> drainLock(drainMutex);
+    std::vector<std::string> batch;
+    for (;;) {
+        Slot& slot = slots[dequeuePos & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break; // empty, or still being written
+        batch.emplace_back(slot.text, slot.length);
+        slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        dequeuePos++;
+    }
+    if (batch.empty()) return 0;
+
+    std::lock_guard<std::mutex> lock(sketchMutex);
+    for (const auto& query : batch) {
+        offer(query, 1);
+    }
+    return batch.size();
+}
+
+void QueryAnalytics::offer(const std::string& query, unsigned long long weight) {
+    aggregated += weight;
+    auto it = index.find(query);
+    if (it != index.end()) {
+        counters[it->second].count += weight;
+        return;
+    }
+    if (counters.size() < sketchCapacity) {
+        index[query] = counters.size();
+        counters.push_back(Counter{query, weight, 0});
+        return;
+    }
+    // Space-Saving: the new query takes over the smallest counter and inherits its count as error
+    size_t smallest = 0;
+    for (size_t i = 1; i < counters.size(); ++i) {
+        if (counters[i].count < counters[smallest].count) smallest = i;
+    }
+    Counter& counter = counters[smallest];
+    index.erase(counter.query);
+    index[query] = smallest;
+    counter.query = query;
+    counter.error = counter.count;
+    counter.count += weight;
+}
+
+std::vector<QueryCount> QueryAnalytics::top(size_t n) const {
+    std::vector<QueryCount> result;
+    {
+        std::lock_guard<std::mutex> lock(sketchMutex);
+        result.reserve(counters.size());
+        for (const auto& counter : counters) {
+            result.push_back(QueryCount(counter.query, counter.count, counter.error));
+        }
+    }
+    std::sort(result.begin(), result.end(), byCount);
+    if (result.size() > n) result.resize(n);
+    return result;
+}
+
+void QueryAnalytics::seed(const std::vector<QueryCount>& queries) {
+    std::lock_guard<std::mutex> lock(sketchMutex);
+    for (const auto& query : queries) {
+        if (query.query.empty() || query.query.size() > MAX_QUERY_BYTES || query.count == 0) continue;
+        offer(query.query, query.count);
+    }
+}
+
+QueryAnalyticsStats QueryAnalytics::getStats() const {
+    QueryAnalyticsStats stats;
+    stats.recorded = recorded.load(std::memory_order_relaxed);
+    stats.dropped = dropped.load(std::memory_order_relaxed);
+    stats.skipped = skipped.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(sketchMutex);
+    stats.aggregated = aggregated;
+    stats.tracked = counters.size();
+    stats.capacity = sketchCapacity;
+    return stats;
+}
+
+bool QueryAnalytics::save(const std::string& path, size_t n) const {
+    std::vector<QueryCount> queries = top(n);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        for (const auto& query : queries) {
+            // One query per line
+            if (query.query.find_first_of("\r\n") != std::string::npos) continue;
+            file << query.count << '\t' << query.query << '\n';
+        }
+        if (!file.flush()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+#if defined(_WIN32)
+    std::remove(path.c_str()); // rename does not replace an existing file on Windows
+#endif
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool QueryAnalytics::load(const std::string& path, std::vector<QueryCount>& queries) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    queries.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos || tab == 0 || tab + 1 == line.size() ||
+            line.find_first_not_of("0123456789") != tab) {
+            continue;
+        }
+        unsigned long long count = std::strtoull(line.c_str(), nullptr, 10);
+        if (count > 0) queries.push_back(QueryCount(line.substr(tab + 1), count));
+    }
+    return true;
+}
@@ -0,0 +1,119 @@
+/**
+ * QueryAnalytics - which searches users run, and how often
+ * HTTP workers record each normalized query into a bounded lock-free ring
+ * (a slot claims a sequence number with one CAS; a full ring drops the query
+ * rather than blocking the request). A background job drains the ring into a
+ * Space-Saving sketch, which keeps the heaviest hitters of an unbounded stream
+ * in a fixed number of counters: a tracked query's count overestimates its
+ * true count by at most its error. The top queries can be saved and loaded
+ * again at startup, so popularity survives restarts.
+ */
+
+#ifndef QUERY_ANALYTICS_H
+#define QUERY_ANALYTICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct QueryCount {
+    std::string query;
+    unsigned long long count;  // upper bound on the true count
+    unsigned long long error;  // count - error is a lower bound
+
+    QueryCount() : count(0), error(0) {}
+    QueryCount(const std::string& query, unsigned long long count, unsigned long long error = 0)
+        : query(query), count(count), error(error) {}
+};
+
+struct QueryAnalyticsStats {
+    unsigned long long recorded;   // queries put in the ring
+    unsigned long long dropped;    // ring full
+    unsigned long long skipped;    // empty, or longer than MAX_QUERY_BYTES
+    unsigned long long aggregated; // queries folded into the sketch (including loaded counts)
+    size_t tracked;                // queries the sketch holds
+    size_t capacity;               // queries it can hold
+};
+
+class QueryAnalytics {
+public:
+    static const size_t MAX_QUERY_BYTES = 96;
+
+private:
+    static const size_t CACHE_LINE = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence; // == position: free for that push; position + 1: holds a query
+        unsigned char length;
+        char text[MAX_QUERY_BYTES];
+    };
+
+    struct Counter {
+        std::string query;
+        unsigned long long count;
+        unsigned long long error;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(CACHE_LINE) std::atomic<size_t> enqueuePos;
+    alignas(CACHE_LINE) size_t dequeuePos; // guarded by drainMutex
+    std::mutex drainMutex;
+
+    std::atomic<unsigned long long> recorded;
+    std::atomic<unsigned long long> dropped;
+    std::atomic<unsigned long long> skipped;
+
+    mutable std::mutex sketchMutex;
+    std::vector<Counter> counters;
+    std::unordered_map<std::string, size_t> index; // query -> position in counters
+    size_t sketchCapacity;
+    unsigned long long aggregated;
+
+    void offer(const std::string& query, unsigned long long weight); // caller holds sketchMutex
+
+public:
+    // The ring is rounded up to a power of two
+    explicit QueryAnalytics(size_t ringCapacity = 4096, size_t sketchCapacity = 512);
+
+    QueryAnalytics(const QueryAnalytics&) = delete;
+    QueryAnalytics& operator=(const QueryAnalytics&) = delete;
+
+    /**
+     * Record one search; safe from any number of threads, never blocks or allocates.
+     * @return false if the query was dropped (ring full) or skipped (empty or too long)
+     */
+    bool record(const std::string& normalizedQuery);
+
+    /**
+     * Fold everything recorded so far into the sketch (the background job)
+     * @return number of queries drained
+     */
+    size_t aggregate();
+
+    // Most frequent queries, highest count first
+    std::vector<QueryCount> top(size_t n) const;
+
+    // Add counts carried over from a previous run
+    void seed(const std::vector<QueryCount>& queries);
+
+    QueryAnalyticsStats getStats() const;
+
+    /**
+     * Write the top n queries to path as "count<TAB>query" lines, replacing the file
+     * only once the new one is complete
+     */
+    bool save(const std::string& path, size_t n) const;
+
+    /**
+     * Read a file written by save(); malformed lines are skipped
+     * @return false if the file cannot be opened
+     */
+    static bool load(const std::string& path, std::vector<QueryCount>& queries);
+};
+
+#endif // QUERY_ANALYTICS_H
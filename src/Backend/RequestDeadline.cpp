@@ -0,0 +1,118 @@
+/**
+ * RequestDeadline - Implementation
+ */
+
+#include "RequestDeadline.h"
+#include <climits>
+
+namespace {
+
+struct DeadlineState {
+    bool active;
+    RequestDeadline::TimePoint deadline;
+    const char* exceededAt;
+};
+
+thread_local DeadlineState currentDeadline = {};
+
+} // namespace
+
+void RequestDeadline::start(long long budgetMs) {
+    if (budgetMs <= 0) {
+        clear();
+        return;
+    }
+    startAt(std::chrono::steady_clock::now() + std::chrono::milliseconds(budgetMs));
+}
+
+void RequestDeadline::startAt(TimePoint deadline) {
+    currentDeadline.active = true;
+    currentDeadline.deadline = deadline;
+    currentDeadline.exceededAt = nullptr;
+}
+
+void RequestDeadline::clear() {
+    currentDeadline.active = false;
+    currentDeadline.exceededAt = nullptr;
+}
+
+bool RequestDeadline::active() {
+    return currentDeadline.active;
+}
+
+RequestDeadline::TimePoint RequestDeadline::at() {
+    return currentDeadline.deadline;
+}
+
+long long RequestDeadline::remainingMs() {
+    if (!currentDeadline.active) {
+        return LLONG_MAX;
+    }
+    // Rounded up, so waiting this long always reaches the deadline
+    auto left = std::chrono::ceil<std::chrono::milliseconds>(currentDeadline.deadline -
+                                                             std::chrono::steady_clock::now()).count();
+    return left > 0 ? left : 0;
+}
+
+bool RequestDeadline::expired() {
+    return currentDeadline.active && std::chrono::steady_clock::now() >= currentDeadline.deadline;
+}
+
+bool RequestDeadline::check(const char* stage) {
+    if (!expired()) {
+        return true;
+    }
+    if (currentDeadline.exceededAt == nullptr) {
+        currentDeadline.exceededAt = stage;
+    }
+    return false;
+}
+
+const char* RequestDeadline::exceededAt() {
+    return currentDeadline.active ? currentDeadline.exceededAt : nullptr;
+}
+
+DeadlinePolicy::DeadlinePolicy() : defaultMs(10000) {}
+
+bool DeadlinePolicy::configure(long long defaultBudgetMs, const std::map<std::string, long long>& routeBudgetsMs) {
+    std::vector<Route> compiled;
+    for (const auto& entry : routeBudgetsMs) {
+        size_t space = entry.first.find(' ');
+        Route route;
+        route.method = entry.first.substr(0, space);
+        try {
+            route.pattern = std::regex(entry.first.substr(space + 1));
+        } catch (const std::regex_error&) {
+            return false;
+        }
+        route.budgetMs = entry.second;
+        compiled.push_back(route);
+    }
+    defaultMs = defaultBudgetMs;
+    routes = compiled;
+    return true;
+}
+
+long long DeadlinePolicy::getDefaultMs() const {
+    return defaultMs;
+}
+
+long long DeadlinePolicy::budgetFor(const std::string& method, const std::string& path,
+                                    const std::string& timeoutHeader) const {
+    long long budget = defaultMs;
+    for (const auto& route : routes) {
+        if (route.method == method && std::regex_match(path, route.pattern)) {
+            budget = route.budgetMs;
+            break;
+        }
+    }
+
+    if (!timeoutHeader.empty() && timeoutHeader.find_first_not_of("0123456789") == std::string::npos &&
+        timeoutHeader.size() <= 12) {
+        long long requested = std::stoll(timeoutHeader);
+        if (requested > 0 && (budget <= 0 || requested < budget)) {
+            budget = requested;
+        }
+    }
+    return budget;
+}
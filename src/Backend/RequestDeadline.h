@@ -0,0 +1,77 @@
+/**
+ * RequestDeadline - per-request deadlines carried with the request's thread
+ * Each request gets a deadline when it arrives, from its route's default budget
+ * or a shorter X-Request-Timeout-Ms header sent by the client. Handlers check it
+ * between stages and stop once it has passed, and MongoDB queries are given the
+ * time that is left as their maxTimeMS, so a request the client gave up on does
+ * not keep holding a worker and a database operation.
+ */
+
+#ifndef REQUEST_DEADLINE_H
+#define REQUEST_DEADLINE_H
+
+#include <chrono>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+class RequestDeadline {
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // Deadline for the calling thread, budgetMs from now (<= 0 clears it)
+    static void start(long long budgetMs);
+
+    // Adopt a deadline taken from another thread (batch sub-requests run on the batch pool)
+    static void startAt(TimePoint deadline);
+
+    static void clear();
+    static bool active();
+    static TimePoint at();
+
+    // Milliseconds left, 0 once expired, LLONG_MAX when the thread has no deadline
+    static long long remainingMs();
+    static bool expired();
+
+    /**
+     * Check the deadline between stages
+     * @return false once it has passed; the first stage that saw it is remembered
+     */
+    static bool check(const char* stage);
+
+    // Stage whose check() failed for the current request, or nullptr
+    static const char* exceededAt();
+};
+
+class DeadlinePolicy {
+private:
+    struct Route {
+        std::string method;
+        std::regex pattern;
+        long long budgetMs;
+    };
+
+    long long defaultMs;
+    std::vector<Route> routes;
+
+public:
+    DeadlinePolicy();
+
+    /**
+     * Set the default budget and per-route budgets keyed "METHOD /path-regex"
+     * (as parsed by SlowRequestLog::parseRouteBudgets)
+     * @return false if a pattern is not a valid regex (the policy is left unchanged)
+     */
+    bool configure(long long defaultBudgetMs, const std::map<std::string, long long>& routeBudgetsMs);
+
+    long long getDefaultMs() const;
+
+    /**
+     * Budget for a request: the route's default, lowered (never raised) by a
+     * positive X-Request-Timeout-Ms value
+     */
+    long long budgetFor(const std::string& method, const std::string& path, const std::string& timeoutHeader) const;
+};
+
+#endif // REQUEST_DEADLINE_H
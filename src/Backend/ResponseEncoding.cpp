@@ -0,0 +1,121 @@
+/**
+ * ResponseEncoding - Implementation
+ */
+
+#include "ResponseEncoding.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(start, end - start + 1);
+}
+
+std::string lower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+// Encoding for a media range, or false if it names nothing we can produce
+bool encodingFor(const std::string& mediaRange, BodyEncoding& encoding) {
+    if (mediaRange == "application/msgpack" || mediaRange == "application/x-msgpack" ||
+        mediaRange == "application/vnd.msgpack") {
+        encoding = BodyEncoding::MsgPack;
+        return true;
+    }
+    if (mediaRange == "application/cbor") {
+        encoding = BodyEncoding::Cbor;
+        return true;
+    }
+    if (mediaRange == "application/json" || mediaRange == "application/*" || mediaRange == "*/*") {
+        encoding = BodyEncoding::Json;
+        return true;
+    }
+    return false;
+}
+
+std::string toBytes(const std::vector<std::uint8_t>& bytes) {
+    return std::string(bytes.begin(), bytes.end());
+}
+
+} // namespace
+
+const std::string& EncodedBodies::get(BodyEncoding encoding) const {
+    switch (encoding) {
+        case BodyEncoding::MsgPack: return msgpack;
+        case BodyEncoding::Cbor: return cbor;
+        default: return json;
+    }
+}
+
+BodyEncoding ResponseEncoding::negotiate(const std::string& accept) {
+    BodyEncoding best = BodyEncoding::Json;
+    double bestQuality = 0.0;
+
+    size_t start = 0;
+    while (start <= accept.size()) {
+        size_t comma = accept.find(',', start);
+        std::string range = accept.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = comma == std::string::npos ? accept.size() + 1 : comma + 1;
+
+        double quality = 1.0;
+        size_t semicolon = range.find(';');
+        std::string mediaRange = lower(trim(range.substr(0, semicolon)));
+        while (semicolon != std::string::npos) {
+            size_t next = range.find(';', semicolon + 1);
+            std::string param = trim(range.substr(semicolon + 1, next == std::string::npos ? std::string::npos
+                                                                                          : next - semicolon - 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                quality = std::atof(param.c_str() + 2);
+            }
+            semicolon = next;
+        }
+
+        BodyEncoding encoding;
+        if (quality > bestQuality && encodingFor(mediaRange, encoding)) {
+            best = encoding;
+            bestQuality = quality;
+        }
+    }
+    return best;
+}
+
+const char* ResponseEncoding::contentType(BodyEncoding encoding) {
+    switch (encoding) {
+        case BodyEncoding::MsgPack: return "application/msgpack";
+        case BodyEncoding::Cbor: return "application/cbor";
+        default: return "application/json";
+    }
+}
+
+std::string ResponseEncoding::encode(const nlohmann::json& body, BodyEncoding encoding) {
+    switch (encoding) {
+        case BodyEncoding::MsgPack: return toBytes(nlohmann::json::to_msgpack(body));
+        case BodyEncoding::Cbor: return toBytes(nlohmann::json::to_cbor(body));
+        default: return body.dump();
+    }
+}
+
+EncodedBodies ResponseEncoding::encodeAll(const nlohmann::json& body) {
+    EncodedBodies bodies;
+    bodies.json = encode(body, BodyEncoding::Json);
+    bodies.msgpack = encode(body, BodyEncoding::MsgPack);
+    bodies.cbor = encode(body, BodyEncoding::Cbor);
+    return bodies;
+}
+
+bool ResponseEncoding::transcode(const std::string& jsonText, BodyEncoding encoding, std::string& out) {
+    nlohmann::json body = nlohmann::json::parse(jsonText, nullptr, false);
+    if (body.is_discarded()) {
+        return false;
+    }
+    out = encode(body, encoding);
+    return true;
+}
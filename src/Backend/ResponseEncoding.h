@@ -0,0 +1,49 @@
+/**
+ * ResponseEncoding - content negotiation for JSON, MessagePack and CBOR bodies
+ * Every API response has one schema; clients that send
+ * Accept: application/msgpack or application/cbor get it in that binary encoding.
+ */
+
+#ifndef RESPONSE_ENCODING_H
+#define RESPONSE_ENCODING_H
+
+#include <string>
+#include "json.hpp"
+
+enum class BodyEncoding {
+    Json,
+    MsgPack,
+    Cbor
+};
+
+// One response body pre-encoded in every supported encoding
+struct EncodedBodies {
+    std::string json;
+    std::string msgpack;
+    std::string cbor;
+
+    const std::string& get(BodyEncoding encoding) const;
+};
+
+class ResponseEncoding {
+public:
+    /**
+     * Pick the encoding for an Accept header (q-values honoured, JSON by default)
+     * Among equally preferred types the first one listed wins.
+     */
+    static BodyEncoding negotiate(const std::string& accept);
+
+    static const char* contentType(BodyEncoding encoding);
+
+    static std::string encode(const nlohmann::json& body, BodyEncoding encoding);
+
+    static EncodedBodies encodeAll(const nlohmann::json& body);
+
+    /**
+     * Re-encode a JSON text body
+     * @return false if the text is not valid JSON (out is left unchanged)
+     */
+    static bool transcode(const std::string& jsonText, BodyEncoding encoding, std::string& out);
+};
+
+#endif // RESPONSE_ENCODING_H
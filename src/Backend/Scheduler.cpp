@@ -0,0 +1,372 @@
+/**
+ * Scheduler - Implementation
+ */
+
+#include "Scheduler.h"
+#include "Timestamp.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+bool parseNumber(const std::string& text, int& value) {
+    if (text.empty() || text.size() > 4) return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    return true;
+}
+
+// Parse one cron field ("*", "*/n", "a", "a-b", "a-b/n", comma separated) into a bit mask
+bool parseCronField(const std::string& field, int minValue, int maxValue, uint64_t& mask, bool& restricted) {
+    mask = 0;
+    restricted = field != "*";
+    std::stringstream ss(field);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) return false;
+
+        int step = 1;
+        size_t slash = item.find('/');
+        if (slash != std::string::npos) {
+            if (!parseNumber(item.substr(slash + 1), step) || step < 1) return false;
+            item = item.substr(0, slash);
+        }
+
+        int low = minValue;
+        int high = maxValue;
+        if (item != "*") {
+            size_t dash = item.find('-');
+            if (dash == std::string::npos) {
+                if (!parseNumber(item, low)) return false;
+                high = slash == std::string::npos ? low : maxValue;
+            } else if (!parseNumber(item.substr(0, dash), low) || !parseNumber(item.substr(dash + 1), high)) {
+                return false;
+            }
+        }
+        if (low < minValue || high > maxValue || low > high) return false;
+
+        for (int v = low; v <= high; v += step) {
+            mask |= (1ULL << v);
+        }
+    }
+    return mask != 0;
+}
+
+bool hasBit(uint64_t mask, unsigned bit) {
+    return (mask >> bit) & 1ULL;
+}
+
+} // namespace
+
+Scheduler::Scheduler() : random(std::random_device{}()), nextId(1), running(false) {
+}
+
+Scheduler::~Scheduler() {
+    stop();
+}
+
+Scheduler::JobId Scheduler::scheduleFixedRate(const std::string& name, long long intervalMs, Task task,
+                                              long long jitterMs, long long initialDelayMs) {
+    if (intervalMs <= 0 || !task) return 0;
+
+    auto job = std::make_shared<Job>();
+    job->kind = JobKind::FixedRate;
+    job->task = std::move(task);
+    job->intervalMs = intervalMs;
+    job->jitterMs = jitterMs > 0 ? jitterMs : 0;
+    job->cancelled = false;
+    job->stats.name = name;
+    job->stats.schedule = "every " + std::to_string(intervalMs) + "ms";
+
+    long long delay = initialDelayMs >= 0 ? initialDelayMs : intervalMs;
+    return addJob(job, Clock::now() + std::chrono::milliseconds(delay));
+}
+
+Scheduler::JobId Scheduler::scheduleCron(const std::string& name, const std::string& expression, Task task,
+                                         long long jitterMs) {
+    CronSpec spec;
+    if (!task || !parseCron(expression, spec)) return 0;
+
+    long long now = nowEpochMs();
+    long long next = nextCronTime(spec, now);
+    if (next < 0) return 0;
+
+    auto job = std::make_shared<Job>();
+    job->kind = JobKind::Cron;
+    job->task = std::move(task);
+    job->intervalMs = 0;
+    job->cron = spec;
+    job->jitterMs = jitterMs > 0 ? jitterMs : 0;
+    job->cancelled = false;
+    job->stats.name = name;
+    job->stats.schedule = "cron " + expression;
+
+    return addJob(job, Clock::now() + std::chrono::milliseconds(next - now));
+}
+
+Scheduler::JobId Scheduler::addJob(std::shared_ptr<Job> job, Clock::time_point firstBase) {
+    std::lock_guard<std::mutex> lock(mutex);
+    job->id = nextId++;
+    arm(*job, firstBase);
+    jobs[job->id] = job;
+    timers.push(HeapEntry{job->nextDue, job->id});
+    timerWake.notify_one();
+    return job->id;
+}
+
+bool Scheduler::cancel(JobId id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) return false;
+    it->second->cancelled = true;
+    jobs.erase(it); // stale heap entries are skipped when they come due
+    return true;
+}
+
+void Scheduler::start(size_t workerCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return;
+    running = true;
+    if (workerCount == 0) workerCount = 1;
+    timerThread = std::thread(&Scheduler::timerLoop, this);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&Scheduler::workerLoop, this);
+    }
+}
+
+void Scheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    timerWake.notify_all();
+    workWake.notify_all();
+    if (timerThread.joinable()) timerThread.join();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+
+    // Jobs queued but not started will be re-armed from their base time on restart
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& job : ready) {
+        job->stats.running = false;
+        if (!job->cancelled) {
+            timers.push(HeapEntry{job->nextDue, job->id});
+        }
+    }
+    ready.clear();
+}
+
+bool Scheduler::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+std::vector<JobStats> Scheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = Clock::now();
+    std::vector<JobStats> result;
+    result.reserve(jobs.size());
+    for (const auto& pair : jobs) {
+        JobStats s = pair.second->stats;
+        s.nextRunInMs = s.running ? -1 : std::max<long long>(0,
+            std::chrono::duration_cast<std::chrono::milliseconds>(pair.second->nextDue - now).count());
+        result.push_back(s);
+    }
+    return result;
+}
+
+void Scheduler::timerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        if (timers.empty()) {
+            timerWake.wait(lock);
+            continue;
+        }
+
+        HeapEntry next = timers.top();
+        if (next.due > Clock::now()) {
+            timerWake.wait_until(lock, next.due);
+            continue;
+        }
+        timers.pop();
+
+        auto it = jobs.find(next.id);
+        if (it == jobs.end() || it->second->stats.running || it->second->nextDue != next.due) {
+            continue; // cancelled, or a stale entry
+        }
+        it->second->stats.running = true;
+        ready.push_back(it->second);
+        workWake.notify_one();
+    }
+}
+
+void Scheduler::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        workWake.wait(lock, [this] { return !running || !ready.empty(); });
+        if (!running) return;
+
+        std::shared_ptr<Job> job = ready.front();
+        ready.pop_front();
+
+        lock.unlock();
+        execute(job);
+        lock.lock();
+    }
+}
+
+void Scheduler::execute(const std::shared_ptr<Job>& job) {
+    auto startedAt = Clock::now();
+    bool failed = false;
+    try {
+        job->task();
+    } catch (const std::exception& e) {
+        failed = true;
+        std::cerr << "Scheduler: job '" << job->stats.name << "' failed: " << e.what() << std::endl;
+    } catch (...) {
+        failed = true;
+        std::cerr << "Scheduler: job '" << job->stats.name << "' failed" << std::endl;
+    }
+    auto finishedAt = Clock::now();
+    long long runUs = std::chrono::duration_cast<std::chrono::microseconds>(finishedAt - startedAt).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    JobStats& stats = job->stats;
+    stats.runs++;
+    if (failed) stats.failures++;
+    stats.lastRunUs = runUs;
+    stats.totalRunUs += runUs;
+    if (runUs > stats.maxRunUs) stats.maxRunUs = runUs;
+    stats.running = false;
+
+    if (!job->cancelled) {
+        scheduleNext(*job, startedAt, finishedAt);
+    }
+    if (!job->cancelled) {
+        timers.push(HeapEntry{job->nextDue, job->id});
+        timerWake.notify_one();
+    }
+}
+
+void Scheduler::scheduleNext(Job& job, Clock::time_point startedAt, Clock::time_point finishedAt) {
+    if (job.kind == JobKind::FixedRate) {
+        // Fixed rate: keep the original cadence, skipping slots that passed while running
+        auto interval = std::chrono::milliseconds(job.intervalMs);
+        auto base = job.nextBase + interval;
+        if (base <= finishedAt) {
+            job.stats.overruns++;
+            auto behind = finishedAt - base;
+            base += interval * (behind / interval + 1);
+        }
+        arm(job, base);
+        return;
+    }
+
+    // Cron: next match after now; an overrun if a matching minute passed during the run
+    long long nowMs = nowEpochMs();
+    long long runMs = std::chrono::duration_cast<std::chrono::milliseconds>(finishedAt - startedAt).count();
+    long long missed = nextCronTime(job.cron, nowMs - runMs);
+    if (missed >= 0 && missed <= nowMs) {
+        job.stats.overruns++;
+    }
+    long long next = nextCronTime(job.cron, nowMs);
+    if (next < 0) {
+        job.cancelled = true;
+        jobs.erase(job.id);
+        return;
+    }
+    arm(job, finishedAt + std::chrono::milliseconds(next - nowMs));
+}
+
+void Scheduler::arm(Job& job, Clock::time_point base) {
+    job.nextBase = base;
+    job.nextDue = base;
+    if (job.jitterMs > 0) {
+        std::uniform_int_distribution<long long> jitter(0, job.jitterMs);
+        job.nextDue += std::chrono::milliseconds(jitter(random));
+    }
+}
+
+bool Scheduler::parseCron(const std::string& expression, CronSpec& spec) {
+    std::stringstream ss(expression);
+    std::vector<std::string> fields;
+    std::string field;
+    while (ss >> field) {
+        fields.push_back(field);
+    }
+    if (fields.size() != 5) return false;
+
+    CronSpec parsed;
+    uint64_t mask = 0;
+    bool restricted = false;
+
+    if (!parseCronField(fields[0], 0, 59, mask, restricted)) return false;
+    parsed.minutes = mask;
+    if (!parseCronField(fields[1], 0, 23, mask, restricted)) return false;
+    parsed.hours = static_cast<uint32_t>(mask);
+    if (!parseCronField(fields[2], 1, 31, mask, parsed.dayRestricted)) return false;
+    parsed.days = static_cast<uint32_t>(mask);
+    if (!parseCronField(fields[3], 1, 12, mask, restricted)) return false;
+    parsed.months = static_cast<uint16_t>(mask);
+    if (!parseCronField(fields[4], 0, 7, mask, parsed.weekdayRestricted)) return false;
+    if (mask & (1ULL << 7)) mask |= 1ULL; // 7 is also Sunday
+    parsed.weekdays = static_cast<uint8_t>(mask & 0x7F);
+
+    spec = parsed;
+    return true;
+}
+
+long long Scheduler::nextCronTime(const CronSpec& spec, long long afterEpochMs) {
+    const long long minutesPerDay = 24 * 60;
+    long long minute = (afterEpochMs >= 0 ? afterEpochMs / 60000 : (afterEpochMs - 59999) / 60000) + 1;
+    long long limit = minute + 4LL * 366 * minutesPerDay;
+
+    while (minute < limit) {
+        long long day = minute >= 0 ? minute / minutesPerDay : (minute - minutesPerDay + 1) / minutesPerDay;
+        long long year;
+        unsigned month, dayOfMonth;
+        Timestamp::civilFromDays(day, year, month, dayOfMonth);
+
+        if (!hasBit(spec.months, month)) {
+            // Jump to the first day of the next month
+            minute = (month == 12 ? Timestamp::daysFromCivil(year + 1, 1, 1)
+                                  : Timestamp::daysFromCivil(year, month + 1, 1)) * minutesPerDay;
+            continue;
+        }
+
+        unsigned weekday = static_cast<unsigned>(((day % 7) + 11) % 7); // 1970-01-01 was a Thursday
+        bool dayMatch = hasBit(spec.days, dayOfMonth);
+        bool weekdayMatch = hasBit(spec.weekdays, weekday);
+        // Classic cron: if both day fields are restricted, either may match
+        bool matches = (spec.dayRestricted && spec.weekdayRestricted) ? (dayMatch || weekdayMatch)
+                                                                      : (dayMatch && weekdayMatch);
+        if (!matches) {
+            minute = (day + 1) * minutesPerDay;
+            continue;
+        }
+
+        long long minuteOfDay = minute - day * minutesPerDay;
+        unsigned hour = static_cast<unsigned>(minuteOfDay / 60);
+        if (!hasBit(spec.hours, hour)) {
+            minute = day * minutesPerDay + (hour + 1) * 60;
+            continue;
+        }
+        if (!hasBit(spec.minutes, static_cast<unsigned>(minuteOfDay % 60))) {
+            minute++;
+            continue;
+        }
+        return minute * 60000;
+    }
+    return -1;
+}
+
+long long Scheduler::nowEpochMs() {
+    return Timestamp::nowMs();
+}
@@ -0,0 +1,154 @@
+/**
+ * Scheduler - runs periodic maintenance jobs on a small dedicated thread pool
+ * A timer thread keeps a min-heap of due times and hands due jobs to the worker
+ * threads, so maintenance never borrows HTTP request threads. Supports fixed-rate
+ * and cron-style jobs with optional jitter, detects overruns and keeps per-job
+ * runtime metrics.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Parsed 5-field cron expression: minute hour day-of-month month day-of-week (UTC)
+struct CronSpec {
+    uint64_t minutes;  // bits 0-59
+    uint32_t hours;    // bits 0-23
+    uint32_t days;     // bits 1-31
+    uint16_t months;   // bits 1-12
+    uint8_t weekdays;  // bits 0-6, Sunday = 0
+    bool dayRestricted;
+    bool weekdayRestricted;
+
+    CronSpec()
+        : minutes(0), hours(0), days(0), months(0), weekdays(0),
+          dayRestricted(false), weekdayRestricted(false) {}
+};
+
+// Runtime metrics for one job
+struct JobStats {
+    std::string name;
+    std::string schedule;
+    unsigned long long runs;
+    unsigned long long failures;  // task threw
+    unsigned long long overruns;  // a run outlasted its period, missed slots were skipped
+    long long lastRunUs;
+    long long maxRunUs;
+    long long totalRunUs;
+    long long nextRunInMs;        // -1 while the job is executing
+    bool running;
+
+    JobStats()
+        : runs(0), failures(0), overruns(0), lastRunUs(0), maxRunUs(0),
+          totalRunUs(0), nextRunInMs(0), running(false) {}
+};
+
+class Scheduler {
+public:
+    using Task = std::function<void()>;
+    using JobId = unsigned long long;
+    using Clock = std::chrono::steady_clock;
+
+private:
+    enum class JobKind { FixedRate, Cron };
+
+    struct Job {
+        JobId id;
+        JobKind kind;
+        Task task;
+        long long intervalMs;
+        CronSpec cron;
+        long long jitterMs;
+        Clock::time_point nextBase; // due time before jitter
+        Clock::time_point nextDue;
+        bool cancelled;
+        JobStats stats;
+    };
+
+    struct HeapEntry {
+        Clock::time_point due;
+        JobId id;
+        bool operator>(const HeapEntry& other) const { return due > other.due; }
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable timerWake;
+    std::condition_variable workWake;
+    std::map<JobId, std::shared_ptr<Job>> jobs;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> timers;
+    std::deque<std::shared_ptr<Job>> ready;
+    std::thread timerThread;
+    std::vector<std::thread> workers;
+    std::mt19937 random;
+    JobId nextId;
+    bool running;
+
+    void timerLoop();
+    void workerLoop();
+    void execute(const std::shared_ptr<Job>& job);
+    void scheduleNext(Job& job, Clock::time_point startedAt, Clock::time_point finishedAt);
+    void arm(Job& job, Clock::time_point base);
+    JobId addJob(std::shared_ptr<Job> job, Clock::time_point firstBase);
+
+public:
+    Scheduler();
+    ~Scheduler();
+
+    /**
+     * Run `task` every intervalMs (first run after initialDelayMs, default one interval)
+     * Runs never overlap: if a run outlasts the interval the missed slots are skipped
+     * and counted as overruns.
+     * @param jitterMs each run is delayed by a random 0..jitterMs to spread load
+     * @return job id, or 0 if intervalMs is not positive
+     */
+    JobId scheduleFixedRate(const std::string& name, long long intervalMs, Task task,
+                            long long jitterMs = 0, long long initialDelayMs = -1);
+
+    /**
+     * Run `task` at the times matched by a 5-field cron expression (evaluated in UTC)
+     * @return job id, or 0 if the expression is invalid
+     */
+    JobId scheduleCron(const std::string& name, const std::string& expression, Task task,
+                       long long jitterMs = 0);
+
+    /**
+     * Remove a job (a run already in progress is allowed to finish)
+     */
+    bool cancel(JobId id);
+
+    /**
+     * Start the timer thread and `workerCount` worker threads
+     */
+    void start(size_t workerCount = 2);
+
+    /**
+     * Stop all threads, waiting for running jobs to finish
+     */
+    void stop();
+
+    bool isRunning() const;
+    std::vector<JobStats> stats() const;
+
+    // Cron helpers (public for tests)
+    static bool parseCron(const std::string& expression, CronSpec& spec);
+    /**
+     * @return first matching time strictly after afterEpochMs, or -1 if none within ~4 years
+     */
+    static long long nextCronTime(const CronSpec& spec, long long afterEpochMs);
+    static long long nowEpochMs();
+};
+
+#endif // SCHEDULER_H
@@ -6,6 +6,8 @@
 #include "SearchService.h"
 #include <algorithm>
 #include <cctype>
+#include <unordered_set>
+#include <utility>
 
 // Static catalog definition (matches frontend SAMPLE_PRODUCTS)
 const CatalogItem SearchService::CATALOG[] = {
@@ -28,28 +30,25 @@ const CatalogItem SearchService::CATALOG[] = {
 
 const size_t SearchService::CATALOG_SIZE = sizeof(CATALOG) / sizeof(CATALOG[0]);
 
-SearchService::SearchService() = default;
+SearchService::SearchService()
+    : catalog(std::make_shared<const CatalogSnapshot>(std::vector<CatalogItem>(CATALOG, CATALOG + CATALOG_SIZE), 1)),
+      cacheCapacity(0), cacheHits(0), cacheMisses(0), cacheWarmed(0) {
+}
+
 SearchService::~SearchService() = default;
 
-std::vector<CatalogItem> SearchService::searchCatalog(const std::string& query) const {
-    std::vector<CatalogItem> results;
-    
-    // Normalize query (trim and lowercase)
+std::string SearchService::normalizeQuery(const std::string& query) {
     std::string normalizedQuery = query;
     normalizedQuery.erase(0, normalizedQuery.find_first_not_of(" \t\n\r"));
     normalizedQuery.erase(normalizedQuery.find_last_not_of(" \t\n\r") + 1);
-    
-    if (normalizedQuery.empty()) {
-        return results; // Return empty if query is empty
-    }
-
-    // Convert to lowercase for case-insensitive search
-    std::transform(normalizedQuery.begin(), normalizedQuery.end(), 
+    std::transform(normalizedQuery.begin(), normalizedQuery.end(),
                    normalizedQuery.begin(), ::tolower);
+    return normalizedQuery;
+}
 
-    // Search through catalog
-    for (size_t i = 0; i < CATALOG_SIZE; ++i) {
-        const CatalogItem& item = CATALOG[i];
+std::vector<CatalogItem> SearchService::scan(const CatalogSnapshot& snapshot, const std::string& normalizedQuery) {
+    std::vector<CatalogItem> results;
+    for (const CatalogItem& item : snapshot.getItems()) {
         
         // Convert item fields to lowercase for comparison
         std::string lowerName = item.name;
@@ -68,27 +67,156 @@ std::vector<CatalogItem> SearchService::searchCatalog(const std::string& query)
             results.push_back(item);
         }
     }
+    return results;
+}
+
+std::vector<CatalogItem> SearchService::searchCatalog(const std::string& query) const {
+    // Normalize query (trim and lowercase)
+    std::string normalizedQuery = normalizeQuery(query);
+    if (normalizedQuery.empty()) {
+        return std::vector<CatalogItem>(); // Return empty if query is empty
+    }
+
+    auto current = getCatalog();
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(normalizedQuery);
+        if (it != cache.end() && it->second.generation == current->getGeneration()) {
+            cacheHits++;
+            cacheLru.splice(cacheLru.begin(), cacheLru, it->second.lruPosition);
+            return it->second.results;
+        }
+        if (cacheCapacity > 0) {
+            cacheMisses++;
+        }
+    }
 
+    // Search through catalog
+    std::vector<CatalogItem> results = scan(*current, normalizedQuery);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    remember(normalizedQuery, current->getGeneration(), results);
     return results;
 }
 
-std::vector<CatalogItem> SearchService::getAllCatalogItems() const {
-    std::vector<CatalogItem> items;
-    items.reserve(CATALOG_SIZE);
-    
-    for (size_t i = 0; i < CATALOG_SIZE; ++i) {
-        items.push_back(CATALOG[i]);
+void SearchService::remember(const std::string& normalizedQuery, unsigned long long generation,
+                             const std::vector<CatalogItem>& results) const {
+    if (cacheCapacity == 0) {
+        return;
+    }
+    auto it = cache.find(normalizedQuery);
+    if (it != cache.end()) {
+        // A newer generation may already be cached by a concurrent search
+        if (it->second.generation <= generation) {
+            it->second.generation = generation;
+            it->second.results = results;
+        }
+        cacheLru.splice(cacheLru.begin(), cacheLru, it->second.lruPosition);
+        return;
+    }
+    cacheLru.push_front(normalizedQuery);
+    CachedResults entry;
+    entry.generation = generation;
+    entry.results = results;
+    entry.lruPosition = cacheLru.begin();
+    cache.emplace(normalizedQuery, std::move(entry));
+    while (cache.size() > cacheCapacity) {
+        cache.erase(cacheLru.back());
+        cacheLru.pop_back();
+    }
+}
+
+void SearchService::setCacheCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheCapacity = capacity;
+    while (cache.size() > cacheCapacity) {
+        cache.erase(cacheLru.back());
+        cacheLru.pop_back();
     }
-    
-    return items;
 }
 
-const CatalogItem* SearchService::getItemById(const std::string& itemId) const {
-    for (size_t i = 0; i < CATALOG_SIZE; ++i) {
-        if (CATALOG[i].id == itemId) {
-            return &CATALOG[i];
+size_t SearchService::warmCache(const std::vector<std::string>& queries) {
+    size_t capacity;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        capacity = cacheCapacity;
+    }
+    // Only the most popular that fit; least popular of those first, so the most popular
+    // end up most recently used
+    std::vector<std::string> selected;
+    for (const auto& query : queries) {
+        if (selected.size() >= capacity) {
+            break;
+        }
+        std::string normalizedQuery = normalizeQuery(query);
+        if (!normalizedQuery.empty()) {
+            selected.push_back(normalizedQuery);
         }
     }
-    return nullptr;
+    auto current = getCatalog();
+    for (auto it = selected.rbegin(); it != selected.rend(); ++it) {
+        std::vector<CatalogItem> results = scan(*current, *it);
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        remember(*it, current->getGeneration(), results);
+        cacheWarmed++;
+    }
+    return selected.size();
 }
 
+SearchCacheStats SearchService::getCacheStats() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    SearchCacheStats stats;
+    stats.entries = cache.size();
+    stats.capacity = cacheCapacity;
+    stats.hits = cacheHits;
+    stats.misses = cacheMisses;
+    stats.warmed = cacheWarmed;
+    return stats;
+}
+
+std::vector<CatalogItem> SearchService::getAllCatalogItems() const {
+    return getCatalog()->getItems();
+}
+
+bool SearchService::getItemById(const std::string& itemId, CatalogItem& item) const {
+    auto current = getCatalog();
+    unsigned int slot = current->slotOf(itemId);
+    if (slot == CatalogSnapshot::NO_SLOT) {
+        return false;
+    }
+    item = current->at(slot);
+    return true;
+}
+
+std::shared_ptr<const CatalogSnapshot> SearchService::getCatalog() const {
+    std::lock_guard<std::mutex> lock(catalogMutex);
+    return catalog;
+}
+
+bool SearchService::setItemPrice(const std::string& itemId, double price) {
+    if (!(price >= 0.0)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(catalogMutex);
+    unsigned int slot = catalog->slotOf(itemId);
+    if (slot == CatalogSnapshot::NO_SLOT) {
+        return false;
+    }
+    catalog = catalog->withPrice(slot, price);
+    return true;
+}
+
+bool SearchService::replaceCatalog(std::vector<CatalogItem> items) {
+    if (items.empty()) {
+        return false;
+    }
+    std::unordered_set<std::string> ids;
+    ids.reserve(items.size());
+    for (const auto& item : items) {
+        if (!(item.price >= 0.0) || !ids.insert(item.id).second) {
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(catalogMutex);
+    catalog = std::make_shared<const CatalogSnapshot>(std::move(items), catalog->getGeneration() + 1);
+    return true;
+}
@@ -6,28 +6,50 @@
 #ifndef SEARCH_SERVICE_H
 #define SEARCH_SERVICE_H
 
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include "Catalog.h"
 
-// Catalog item structure
-struct CatalogItem {
-    std::string id;
-    std::string name;
-    double price;
-    std::string description;
-
-    CatalogItem() : id(""), name(""), price(0.0), description("") {}
-    CatalogItem(const std::string& itemId, const std::string& itemName, 
-                double itemPrice, const std::string& itemDesc = "")
-        : id(itemId), name(itemName), price(itemPrice), description(itemDesc) {}
+struct SearchCacheStats {
+    size_t entries;
+    size_t capacity;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long warmed; // entries computed ahead of traffic by warmCache()
 };
 
 class SearchService {
 private:
-    // Static catalog (matches routes/search.js)
+    // Seed catalog (matches routes/search.js)
     static const CatalogItem CATALOG[];
     static const size_t CATALOG_SIZE;
 
+    // Live catalog; price changes publish a new snapshot
+    mutable std::mutex catalogMutex;
+    std::shared_ptr<const CatalogSnapshot> catalog;
+
+    // Results of recent queries, each valid for the catalog generation it was computed against
+    struct CachedResults {
+        unsigned long long generation;
+        std::vector<CatalogItem> results;
+        std::list<std::string>::iterator lruPosition;
+    };
+    mutable std::mutex cacheMutex;
+    mutable std::unordered_map<std::string, CachedResults> cache; // normalized query -> results
+    mutable std::list<std::string> cacheLru; // most recently used at the front
+    size_t cacheCapacity;
+    mutable unsigned long long cacheHits;
+    mutable unsigned long long cacheMisses;
+    unsigned long long cacheWarmed;
+
+    static std::vector<CatalogItem> scan(const CatalogSnapshot& snapshot, const std::string& normalizedQuery);
+    void remember(const std::string& normalizedQuery, unsigned long long generation,
+                  const std::vector<CatalogItem>& results) const; // caller holds cacheMutex
+
 public:
     SearchService();
     ~SearchService();
@@ -40,6 +62,25 @@ public:
      */
     std::vector<CatalogItem> searchCatalog(const std::string& query) const;
 
+    /**
+     * The form searchCatalog() matches and caches a query in: trimmed and lowercased
+     */
+    static std::string normalizeQuery(const std::string& query);
+
+    /**
+     * Keep the results of up to capacity recent queries (0, the default, disables the cache).
+     * Entries from an older catalog generation are recomputed on their next use.
+     */
+    void setCacheCapacity(size_t capacity);
+
+    /**
+     * Compute and cache results for queries ahead of traffic (e.g. yesterday's most popular)
+     * @return number of queries cached
+     */
+    size_t warmCache(const std::vector<std::string>& queries);
+
+    SearchCacheStats getCacheStats() const;
+
     /**
      * Get all catalog items
      * @return Vector of all catalog items
@@ -49,9 +90,28 @@ public:
     /**
      * Get catalog item by ID
      * @param itemId - Item ID to find
-     * @return Pointer to catalog item, or nullptr if not found
+     * @param item - Receives a copy of the current catalog entry
+     * @return true if the item exists
+     */
+    bool getItemById(const std::string& itemId, CatalogItem& item) const;
+
+    /**
+     * Current catalog snapshot; it stays valid (and unchanged) for as long as it is held
+     */
+    std::shared_ptr<const CatalogSnapshot> getCatalog() const;
+
+    /**
+     * Change an item's price by publishing a new catalog snapshot
+     * @return false if the item does not exist or the price is negative
+     */
+    bool setItemPrice(const std::string& itemId, double price);
+
+    /**
+     * Replace the whole catalog (e.g. one loaded from CATALOG_FILE). Carts that
+     * hold items missing from the new catalog see them as unavailable at checkout.
+     * @return false if items is empty, has a negative price or repeats an id
      */
-    const CatalogItem* getItemById(const std::string& itemId) const;
+    bool replaceCatalog(std::vector<CatalogItem> items);
 };
 
 #endif // SEARCH_SERVICE_H
@@ -13,6 +13,26 @@
 #include "SearchService.h"
 #include "SettingsService.h"
 #include "MongoDBService.h"
+#include "User.h"
+#include "UserSnapshot.h"
+#include "Catalog.h"
+#include "Promotions.h"
+#include "UserCache.h"
+#include "CompactUserStore.h"
+#include "CartSweeper.h"
+#include "Timestamp.h"
+#include "SlowRequestLog.h"
+#include "Profiler.h"
+#include "ResponseEncoding.h"
+#include "SingleFlight.h"
+#include "AdmissionControl.h"
+#include "RequestDeadline.h"
+#include "UserShards.h"
+#include "HotRestart.h"
+#include "WarmState.h"
+#include "ThreadAffinity.h"
+#include "StaticFiles.h"
+#include "QueryAnalytics.h"
 #include <iostream>
 #include <sstream>
 #include <map>
@@ -20,6 +40,11 @@
 #include <ctime>
 #include <iomanip>
 #include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 
 // Include HTTP and JSON libraries
 #define HAS_HTTPLIB
@@ -93,26 +118,38 @@ namespace SimpleJSON {
     }
 }
 
-// In-memory user storage (replace with MongoDB in production)
-struct User {
-    std::string id;
-    std::string username;
-    std::string email;
-    std::string password; // In production, hash this with bcrypt
-    Cart cart;
-    PurchaseHistory history;
-    std::string fullName;
-    std::string bio;
-};
-
 // Global state (in production, use database)
-std::map<std::string, User> users; // username -> User (fallback if MongoDB not available)
+CompactUserStore users; // packed users, by username, id or email (fallback if MongoDB not available)
 std::map<std::string, std::string> tokens; // token -> userId (fallback if MongoDB not available)
+std::mutex usersMutex; // guards users and tokens - handlers run on the HTTP worker pool
+// USER_SHARDS mode: each shard thread owns its users' carts, history and sessions; users is then
+// only the directory of usernames and emails, and tokens is unused
+UserShards userShards;
 PurchaseService purchaseService;
 SearchService searchService;
 SettingsService settingsService;
 MongoDBService mongoService; // MongoDB service (optional)
+UserCache userCache; // Read-through cache of decoded MongoDB users (userId -> User)
+CartSweeper cartSweeper; // Background expiry of abandoned carts
+CartArchive cartArchive; // Expired in-memory carts (when CART_ARCHIVE_EXPIRED=true)
+SlowRequestLog slowRequestLog; // Per-route latency SLOs and the over-budget request log
+PromotionEngine promotions; // Compiled discount rules, swapped whole on reload
+long long promotionsReloadMs = 10 * 1000; // how often the rules file is checked for changes
+// /api/catalog in every response encoding, re-encoded once per catalog generation
+std::mutex catalogBodiesMutex;
+std::shared_ptr<const EncodedBodies> catalogBodies;
+unsigned long long catalogBodiesGeneration = 0;
+SingleFlight readFlights; // coalesces identical concurrent catalog, search and history reads
+AdmissionController admission; // priority classes and the adaptive concurrency limit in front of the handlers
+DeadlinePolicy deadlinePolicy; // per-route request deadlines, lowered by X-Request-Timeout-Ms
+QueryAnalytics queryAnalytics; // normalized search queries, folded into the most popular in the background
+bool queryAnalyticsEnabled = true;
+std::string queryTopFile = "top_queries.txt"; // most popular queries, saved periodically and used to warm the search cache
+size_t queryTopCount = 100;
+long long queryTopSaveMs = 60 * 1000;
+StaticFiles staticFiles; // ./public through io_uring (STATIC_FILES_IO_URING=true); otherwise httplib's mount point
 std::string JWT_SECRET = "your-secret-key-change-in-production";
+std::string ADMIN_TOKEN = ""; // Bearer token for /api/admin/* (empty = localhost only)
 
 // Helper function to read MongoDB config from file
 std::string readMongoConfig(const std::string& key, const std::string& defaultValue = "") {
@@ -143,17 +180,615 @@ std::string readMongoConfig(const std::string& key, const std::string& defaultVa
     return defaultValue;
 }
 
-Server::Server(int port) : port(port) {
+#ifdef HAS_JSON
+// Normalize a stored order timestamp to ISO-8601: ISO strings, epoch milliseconds and
+// extended JSON ({"$date": ...}, {"$numberLong": "..."}) all come out the same way
+std::string normalizeTimestamp(const json& value) {
+    if (value.is_object()) {
+        if (value.contains("$date")) return normalizeTimestamp(value["$date"]);
+        if (value.contains("$numberLong") && value["$numberLong"].is_string()) {
+            try {
+                return Timestamp::formatIso8601(std::stoll(value["$numberLong"].get<std::string>()));
+            } catch (...) {}
+        }
+    } else if (value.is_number()) {
+        return Timestamp::formatIso8601(value.get<long long>());
+    } else if (value.is_string()) {
+        const std::string& text = value.get_ref<const std::string&>();
+        long long epochMs = 0;
+        if (Timestamp::parseIso8601(text, epochMs)) {
+            return Timestamp::formatIso8601(epochMs);
+        }
+        return text;
+    }
+    return Timestamp::now();
+}
+#endif
+
+// Find an in-memory user by id (caller holds usersMutex). With user shards this is
+// the directory entry: identity fields only, not carts or history.
+UserRef findInMemoryUser(const std::string& userId) {
+    return users.findById(userId);
+}
+
+// Publish `updated` unless another writer replaced `expected` first - a
+// compare-and-swap on the user's record
+bool publishInMemoryUser(const UserRef& expected, const UserRef& updated) {
+    std::lock_guard<std::mutex> lock(usersMutex);
+    return users.replace(expected, updated);
+}
+
+// Derive a new snapshot from the user's current one and publish it, retrying when a
+// concurrent writer got there first. `change` runs outside the lock and may run more
+// than once; it returns nullptr to leave the user unchanged.
+// @return the published snapshot, the unchanged current one, or nullptr if no such user
+template <typename Change>
+UserRef updateInMemoryUser(const std::string& userId, Change change) {
+    // The owning shard is the only writer, so `change` runs once and never has to retry
+    if (userShards.enabled()) {
+        return userShards.update(userId, change);
+    }
+    for (;;) {
+        UserRef current;
+        {
+            std::lock_guard<std::mutex> lock(usersMutex);
+            current = findInMemoryUser(userId);
+        }
+        if (!current) return nullptr;
+
+        UserRef updated = change(current);
+        if (!updated) return current;
+        if (publishInMemoryUser(current, updated)) return updated;
+    }
+}
+
+// Store a session token in memory, on its shard in USER_SHARDS mode (caller holds usersMutex)
+void storeToken(const std::string& token, const std::string& userId) {
+    if (userShards.enabled()) {
+        userShards.addSession(token, userId);
+    } else {
+        tokens[token] = userId;
+    }
+}
+
+// Remember a token in the in-memory map (fallback lookup when MongoDB misses)
+void rememberToken(const std::string& token, const std::string& userId) {
+    std::lock_guard<std::mutex> lock(usersMutex);
+    storeToken(token, userId);
+}
+
+// Look up an in-memory session token
+bool lookupToken(const std::string& token, std::string& userId) {
+    if (userShards.enabled()) {
+        return userShards.findSession(token, userId);
+    }
+    std::lock_guard<std::mutex> lock(usersMutex);
+    auto it = tokens.find(token);
+    if (it == tokens.end()) return false;
+    userId = it->second;
+    return true;
+}
+
+// Load a user from MongoDB through the read-through user cache
+bool loadMongoUser(const std::string& userId, UserRef& user) {
+    if (userCache.get(userId, user)) {
+        return true;
+    }
+    User decoded;
+    if (!mongoService.findUserById(userId, decoded)) {
+        return false;
+    }
+    user = UserSnapshot::fromUser(std::move(decoded));
+    userCache.put(user);
+    return true;
+}
+
+// Current snapshot of a user from MongoDB (through the cache) or the in-memory store
+bool loadUser(const std::string& userId, UserRef& user) {
+    if (mongoService.isConnected()) {
+        return loadMongoUser(userId, user);
+    }
+    if (userShards.enabled()) {
+        return userShards.find(userId, user);
+    }
+    std::lock_guard<std::mutex> lock(usersMutex);
+    user = findInMemoryUser(userId);
+    return user != nullptr;
+}
+
+// Load the promotion rules file (or reload it if it changed) and report rejected rules
+void loadPromotions(const std::string& filePath, bool onlyIfChanged) {
+    std::vector<std::string> errors;
+    auto catalog = searchService.getCatalog();
+    bool loaded = onlyIfChanged ? promotions.reloadIfChanged(*catalog, errors)
+                                : promotions.load(filePath, *catalog, errors);
+    for (const auto& error : errors) {
+        std::cout << "WARNING: promotions: " << error << std::endl;
+    }
+    if (loaded) {
+        std::cout << "Promotions: " << promotions.current()->ruleCount() << " rules active" << std::endl;
+    }
+}
+
+// Whole file as bytes; false if it cannot be read
+static bool readBinaryFile(const std::string& path, std::string& bytes) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) return false;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    bytes = contents.str();
+    return true;
+}
+
+// Replace the built-in catalog with a binary one (datagen --format binary)
+void loadCatalogFile(const std::string& filePath) {
+    std::string bytes;
+    std::vector<CatalogItem> items;
+    if (!readBinaryFile(filePath, bytes)) {
+        std::cout << "WARNING: Could not read CATALOG_FILE " << filePath << ", keeping the built-in catalog" << std::endl;
+    } else if (!CatalogCodec::decode(bytes, items) || !searchService.replaceCatalog(std::move(items))) {
+        std::cout << "WARNING: Ignoring unreadable CATALOG_FILE " << filePath << std::endl;
+    } else {
+        std::cout << "Catalog: " << searchService.getCatalog()->size() << " items from " << filePath << std::endl;
+    }
+}
+
+// Add the users in a warm state file (datagen --format binary) to the in-memory store;
+// users whose id or username is already taken are skipped
+void loadSeedUsers(const std::string& filePath) {
+    std::string bytes;
+    WarmState seed;
+    if (!readBinaryFile(filePath, bytes) || !WarmStateCodec::decode(bytes, seed)) {
+        std::cout << "WARNING: Could not read SEED_USERS_FILE " << filePath << std::endl;
+        return;
+    }
+    size_t added = 0;
+    std::lock_guard<std::mutex> lock(usersMutex);
+    for (const auto& user : seed.users) {
+        if (userShards.enabled()) {
+            // The directory only needs the identity fields
+            if (!users.insert(UserSnapshot::create(user->getProfile()))) continue;
+            userShards.insert(user);
+        } else if (!users.insert(user)) {
+            continue;
+        }
+        added++;
+    }
+    std::cout << "Seed users: " << added << " of " << seed.users.size() << " loaded from " << filePath << std::endl;
+}
+
+// Cart-level and per-line promotion fields for cart / order responses
+std::string promotionsJson(const PromotionResult& pricing, const std::vector<CartItem>& lines) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "\"subtotal\":" << pricing.subtotal
+        << ",\"discount\":" << pricing.discount
+        << ",\"promotions\":[";
+    for (size_t i = 0; i < pricing.applied.size(); ++i) {
+        const AppliedPromotion& promotion = pricing.applied[i];
+        if (i > 0) oss << ",";
+        oss << "{\"id\":\"" << SimpleJSON::escape(pricing.ruleId(promotion)) << "\"";
+        if (promotion.line >= 0) oss << ",\"productId\":\"" << lines[promotion.line].productId << "\"";
+        oss << ",\"discount\":" << promotion.discount << "}";
+    }
+    oss << "]";
+    return oss.str();
+}
+
+// Purchase records for everything in a cart
+std::vector<PurchaseRecord> purchaseRecordsFor(const Cart& cart) {
+    std::vector<PurchaseRecord> records;
+    records.reserve(cart.getItems().size());
+    for (const auto& item : cart.getItems()) {
+        records.push_back(PurchaseRecord(item.productId, item.name, item.price, item.quantity));
+    }
+    return records;
+}
+
+// A fresh empty cart to replace a swept or checked-out one; building a new Cart releases the
+// old item storage, and the bumped version keeps ETags and cart CAS moving forward
+Cart emptiedCart(const Cart& cart) {
+    Cart emptied;
+    emptied.setVersion(cart.getVersion() + 1);
+    return emptied;
+}
+
+// Write a user mutated from `base` through to the cache. Only a write that took the document
+// exactly one version past base is published, and the entry keeps its original load time;
+// after a failed write, or one that skipped versions, the entry is dropped instead.
+void writeThroughUser(const UserRef& base, const UserRef& updated, bool saved, long long newVersion) {
+    if (saved && newVersion == base->getVersion() + 1 &&
+        userCache.writeThrough(base, updated->withVersion(newVersion))) {
+        return;
+    }
+    userCache.invalidate(base->getId());
+}
+
+// Outcome of a version-conditional cart write to MongoDB
+enum class MongoCartWrite { Saved, Unchanged, NotFound, Failed, DeadlineExceeded };
+
+// Conditional writes that lost a race reload the user and try again this many times
+static const int MONGO_WRITE_ATTEMPTS = 3;
+
+// Edit the cart of the user's current MongoDB snapshot and save it only if the document is
+// still at that snapshot's version. When another writer got there first the cached copy is
+// dropped and the edit reruns on a fresh load. `change` edits a copy of the cart and
+// returns false to leave it unchanged; it may run more than once.
+template <typename Change>
+MongoCartWrite updateMongoCart(const std::string& userId, Change change) {
+    for (int attempt = 0; attempt < MONGO_WRITE_ATTEMPTS; attempt++) {
+        UserRef user;
+        bool found = loadMongoUser(userId, user);
+        if (!RequestDeadline::check("load-user")) return MongoCartWrite::DeadlineExceeded;
+        if (!found) return MongoCartWrite::NotFound;
+
+        Cart cart = user->getCart();
+        if (!change(cart)) return MongoCartWrite::Unchanged;
+
+        long long version = 0;
+        long long cartVersion = 0;
+        if (mongoService.updateCart(userId, cart.getItems(), user->getVersion(), &version, &cartVersion)) {
+            cart.setVersion(cartVersion);
+            writeThroughUser(user, user->withCart(std::move(cart)), true, version);
+            return MongoCartWrite::Saved;
+        }
+        userCache.invalidate(userId);
+    }
+    return MongoCartWrite::Failed;
+}
+
+// Expire one batch of abandoned in-memory carts, resuming after the last slot examined
+bool sweepInMemoryCarts(long long cutoffMs, size_t batchSize,
+                        std::chrono::steady_clock::time_point sliceDeadline, size_t& expired) {
+    static size_t cursor = 0; // only touched by the sweeper thread
+    bool archive = cartSweeper.getConfig().archive;
+    long long now = CartSweeper::nowMs();
+
+    std::lock_guard<std::mutex> lock(usersMutex);
+    size_t examined = 0;
+    while (cursor < users.slotCount() && examined < batchSize) {
+        // Users whose cart never held an item have none stored
+        const Cart* cart = users.cartAt(cursor);
+        if (cart && cart->isAbandoned(cutoffMs)) {
+            UserRef user = users.atSlot(cursor);
+            if (archive) {
+                cartArchive.add(user->getId(), *cart, now);
+            }
+            // Swapping the cart makes concurrent cart writers based on the old snapshot retry
+            users.replace(user, user->withCart(emptiedCart(*cart)));
+            expired++;
+        }
+        cursor++;
+        examined++;
+        if (std::chrono::steady_clock::now() >= sliceDeadline) break;
+    }
+
+    if (cursor >= users.slotCount()) {
+        cursor = 0;
+        return true;
+    }
+    return false;
+}
+
+// Expire one batch of abandoned carts on one shard, on the shard's own thread. Shards take
+// turns batch by batch and each resumes after its last slot examined, so requests routed to
+// a shard wait behind at most one bounded batch.
+bool sweepShardedCarts(long long cutoffMs, size_t batchSize,
+                       std::chrono::steady_clock::time_point sliceDeadline, size_t& expired) {
+    // Only touched by the sweeper thread
+    static size_t shard = 0;
+    static std::vector<size_t> cursors;   // next slot to examine, per shard
+    static std::vector<bool> passDone;    // shard has been swept to the end this pass
+    if (cursors.size() != userShards.getShardCount()) {
+        cursors.assign(userShards.getShardCount(), 0);
+        passDone.assign(userShards.getShardCount(), false);
+        shard = 0;
+    }
+    bool archive = cartSweeper.getConfig().archive;
+    long long now = CartSweeper::nowMs();
+
+    size_t& cursor = cursors[shard];
+    bool wrapped = false;
+    userShards.visitUsers(shard, [&](CompactUserStore& owned) {
+        size_t examined = 0;
+        while (cursor < owned.slotCount() && examined < batchSize) {
+            const Cart* cart = owned.cartAt(cursor);
+            if (cart && cart->isAbandoned(cutoffMs)) {
+                UserRef user = owned.atSlot(cursor);
+                if (archive) {
+                    cartArchive.add(user->getId(), *cart, now);
+                }
+                owned.replace(user, user->withCart(emptiedCart(*cart)));
+                expired++;
+            }
+            cursor++;
+            examined++;
+            if (std::chrono::steady_clock::now() >= sliceDeadline) break;
+        }
+        if (cursor >= owned.slotCount()) {
+            cursor = 0;
+            wrapped = true;
+        }
+    });
+    if (wrapped) passDone[shard] = true;
+    shard = (shard + 1) % cursors.size();
+
+    if (std::find(passDone.begin(), passDone.end(), false) != passDone.end()) return false;
+    passDone.assign(passDone.size(), false);
+    return true;
+}
+
+// Expire one batch of abandoned carts in MongoDB and drop them from the user cache
+bool sweepMongoCarts(long long cutoffMs, size_t batchSize,
+                     std::chrono::steady_clock::time_point, size_t& expired) {
+    std::vector<std::string> expiredIds;
+    bool done = mongoService.expireAbandonedCarts(cutoffMs, batchSize, cartSweeper.getConfig().archive, expiredIds);
+    for (const auto& id : expiredIds) {
+        userCache.invalidate(id);
+    }
+    expired += expiredIds.size();
+    return done;
+}
+
+// Everything a replacement process needs to start warm: in-memory users and sessions
+// (from their shards in USER_SHARDS mode) and the unexpired user cache entries
+WarmState exportWarmState() {
+    WarmState state;
+    if (userShards.enabled()) {
+        for (size_t shard = 0; shard < userShards.getShardCount(); ++shard) {
+            userShards.visitUsers(shard, [&state](CompactUserStore& owned) {
+                for (size_t slot = 0; slot < owned.slotCount(); ++slot) state.users.push_back(owned.atSlot(slot));
+            });
+            userShards.visitSessions(shard, [&state](std::unordered_map<std::string, std::string>& owned) {
+                state.sessions.insert(state.sessions.end(), owned.begin(), owned.end());
+            });
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(usersMutex);
+        for (size_t slot = 0; slot < users.slotCount(); ++slot) state.users.push_back(users.atSlot(slot));
+        state.sessions.assign(tokens.begin(), tokens.end());
+    }
+    for (const auto& entry : userCache.snapshot()) {
+        state.cachedUsers.push_back(CachedUserState{entry.first, entry.second});
+    }
+    return state;
+}
+
+// Merge the in-memory users, sessions and cached users handed over by the previous process.
+// This server has been serving since it took the socket, so anything it already holds is
+// newer and is kept.
+void importWarmState(const WarmState& state) {
+    std::lock_guard<std::mutex> lock(usersMutex);
+    if (!mongoService.isConnected()) {
+        for (const auto& user : state.users) {
+            if (userShards.enabled()) {
+                // The directory only needs the identity fields
+                if (users.insert(UserSnapshot::create(user->getProfile()))) {
+                    userShards.insert(user);
+                }
+            } else {
+                users.insert(user);
+            }
+        }
+    }
+    for (const auto& session : state.sessions) {
+        storeToken(session.first, session.second);
+    }
+    for (const auto& cached : state.cachedUsers) {
+        userCache.restore(cached.user, cached.ageMs);
+    }
+}
+
+Server::Server(int port) : port(port), schedulerThreads(2), batchWorkers(4), httpThreads(64),
+      hotRestartEnabled(false), hotRestartDrainMs(30000) {
     // Try to connect to MongoDB
     std::string mongoConnStr = readMongoConfig("MONGODB_CONNECTION_STRING", "");
     std::string mongoDbName = readMongoConfig("MONGODB_DATABASE_NAME", "community_store");
-    
+
+    // Per-operation consistency policies, e.g. MONGODB_POLICY_TOKEN_WRITE=w=1,j=false,maxTimeMS=500
+    for (size_t i = 0; i < static_cast<size_t>(MongoOperation::Count); ++i) {
+        MongoOperation operation = static_cast<MongoOperation>(i);
+        std::string key = std::string("MONGODB_POLICY_") + MongoDBService::operationName(operation);
+        std::string spec = readMongoConfig(key, "");
+        if (spec.empty()) continue;
+
+        OperationPolicy policy = mongoService.getOperationPolicy(operation);
+        if (MongoDBService::parseOperationPolicy(spec, policy)) {
+            mongoService.setOperationPolicy(operation, policy);
+        } else {
+            std::cout << "WARNING: Ignoring invalid " << key << " value '" << spec << "'" << std::endl;
+        }
+    }
+
+    // User cache limits - the TTL bounds staleness when several instances share a database
+    std::string cacheCapacity = readMongoConfig("USER_CACHE_CAPACITY", "10000");
+    std::string cacheTtl = readMongoConfig("USER_CACHE_TTL_MS", "3000");
+    try {
+        userCache.configure(std::stoul(cacheCapacity), std::stoll(cacheTtl));
+    } catch (...) {
+        std::cout << "WARNING: Invalid USER_CACHE_CAPACITY / USER_CACHE_TTL_MS, using defaults" << std::endl;
+    }
+
+    // Abandoned cart expiry, e.g. CART_EXPIRY_HOURS=72 (0 disables the sweeper)
+    CartSweeperConfig sweepConfig;
+    try {
+        sweepConfig.expiryMs = static_cast<long long>(std::stod(readMongoConfig("CART_EXPIRY_HOURS", "72")) * 60 * 60 * 1000);
+        sweepConfig.batchSize = std::stoul(readMongoConfig("CART_SWEEP_BATCH_SIZE", "100"));
+        sweepConfig.sliceBudgetUs = std::stoll(readMongoConfig("CART_SWEEP_SLICE_US", "2000"));
+        sweepConfig.batchPauseMs = std::stoll(readMongoConfig("CART_SWEEP_PAUSE_MS", "50"));
+        sweepConfig.passIntervalMs = std::stoll(readMongoConfig("CART_SWEEP_INTERVAL_S", "60")) * 1000;
+        sweepConfig.archiveCapacity = std::stoul(readMongoConfig("CART_ARCHIVE_CAPACITY", "10000"));
+    } catch (...) {
+        std::cout << "WARNING: Invalid CART_* sweeper setting, using defaults" << std::endl;
+        sweepConfig = CartSweeperConfig();
+    }
+    sweepConfig.archive = readMongoConfig("CART_ARCHIVE_EXPIRED", "false") == "true";
+    cartSweeper.configure(sweepConfig);
+    cartArchive.setCapacity(sweepConfig.archiveCapacity);
+
+    // Maintenance scheduler and admin endpoints
+    try {
+        schedulerThreads = std::stoul(readMongoConfig("SCHEDULER_THREADS", "2"));
+    } catch (...) {
+        std::cout << "WARNING: Invalid SCHEDULER_THREADS, using 2" << std::endl;
+    }
+    ADMIN_TOKEN = readMongoConfig("ADMIN_TOKEN", "");
+    try {
+        batchWorkers = std::stoul(readMongoConfig("BATCH_WORKERS", "4"));
+    } catch (...) {
+        std::cout << "WARNING: Invalid BATCH_WORKERS, using 4" << std::endl;
+    }
+
+    // Admission control: the concurrency limit adapts between the min and max, which default to
+    // half the HTTP threads so the other half can always read and classify new requests; the
+    // queues are sized so waiters never take the last of those, keeping room for checkout
+    AdmissionConfig admissionConfig;
+    try {
+        httpThreads = std::max<size_t>(4, std::stoul(readMongoConfig("HTTP_THREADS", "64")));
+        admissionConfig.enabled = readMongoConfig("ADMISSION_CONTROL", "true") == "true";
+        admissionConfig.maxLimit = std::stoul(readMongoConfig("ADMISSION_MAX_LIMIT", std::to_string(httpThreads / 2)));
+        admissionConfig.minLimit = std::stoul(readMongoConfig("ADMISSION_MIN_LIMIT", "2"));
+        admissionConfig.initialLimit = admissionConfig.maxLimit / 2;
+        admissionConfig.latencyTargetMs = std::stoll(readMongoConfig("ADMISSION_LATENCY_TARGET_MS", "250"));
+    } catch (...) {
+        std::cout << "WARNING: Invalid HTTP_THREADS / ADMISSION_* setting, using defaults" << std::endl;
+        httpThreads = 64;
+        admissionConfig = AdmissionConfig();
+    }
+    admissionConfig.sizeQueues(httpThreads);
+    admission.configure(admissionConfig);
+
+    // CPU sets per thread group, e.g. CPU_AFFINITY_WORKERS=0-13 (Linux; unset = threads float)
+    std::vector<int>* affinityTargets[] = {&workerCpus, &ioCpus, &maintenanceCpus, &shardCpus};
+    const char* affinityKeys[] = {"CPU_AFFINITY_WORKERS", "CPU_AFFINITY_IO", "CPU_AFFINITY_MAINTENANCE",
+                                  "CPU_AFFINITY_SHARDS"};
+    for (size_t i = 0; i < 4; ++i) {
+        std::string cpuList = readMongoConfig(affinityKeys[i], "");
+        if (cpuList.empty()) continue;
+        if (!ThreadAffinity::isSupported()) {
+            std::cout << "WARNING: " << affinityKeys[i] << " is not supported on this platform" << std::endl;
+        } else if (!ThreadAffinity::parseCpuList(cpuList, *affinityTargets[i]) ||
+                   !ThreadAffinity::allowed(*affinityTargets[i])) {
+            std::cout << "WARNING: Ignoring invalid " << affinityKeys[i] << " value '" << cpuList
+                      << "' (CPUs must exist and be allowed for this process)" << std::endl;
+            affinityTargets[i]->clear();
+        }
+    }
+
+    // Static files through io_uring (Linux 5.15+); anything that does not fit the buffer keeps the mmap path
+    size_t staticBufferKb = StaticFiles::DEFAULT_BUFFER_BYTES / 1024;
+    try {
+        staticBufferKb = std::stoul(readMongoConfig("STATIC_FILES_BUFFER_KB", std::to_string(staticBufferKb)));
+    } catch (...) {
+        std::cout << "WARNING: Invalid STATIC_FILES_BUFFER_KB, using " << staticBufferKb << std::endl;
+    }
+    bool staticIoUring = readMongoConfig("STATIC_FILES_IO_URING", "false") == "true";
+    staticFiles.configure("./public", staticIoUring, staticBufferKb * 1024);
+    if (staticIoUring && !staticFiles.isIoUringActive()) {
+        std::cout << "WARNING: io_uring is not available, serving static files through mmap" << std::endl;
+    }
+
+    // Latency SLOs, e.g. SLOW_REQUEST_ROUTE_BUDGETS=POST /api/cart/checkout:1000,GET /api/search:200
+    SlowRequestLogConfig sloConfig;
+    try {
+        sloConfig.defaultBudgetMs = std::stoll(readMongoConfig("SLOW_REQUEST_BUDGET_MS", "500"));
+        sloConfig.objective = std::stod(readMongoConfig("SLO_OBJECTIVE", "0.99"));
+        sloConfig.ringCapacity = std::stoul(readMongoConfig("SLOW_LOG_CAPACITY", "256"));
+        sloConfig.maxFileBytes = std::stoul(readMongoConfig("SLOW_LOG_MAX_BYTES", "10485760"));
+        sloConfig.maxFiles = std::stoul(readMongoConfig("SLOW_LOG_MAX_FILES", "3"));
+    } catch (...) {
+        std::cout << "WARNING: Invalid SLOW_REQUEST_* / SLOW_LOG_* setting, using defaults" << std::endl;
+        sloConfig = SlowRequestLogConfig();
+    }
+    std::string routeBudgets = readMongoConfig("SLOW_REQUEST_ROUTE_BUDGETS", "");
+    if (!SlowRequestLog::parseRouteBudgets(routeBudgets, sloConfig.routeBudgetsMs)) {
+        std::cout << "WARNING: Ignoring invalid SLOW_REQUEST_ROUTE_BUDGETS value '" << routeBudgets << "'" << std::endl;
+    }
+    sloConfig.filePath = readMongoConfig("SLOW_LOG_FILE", "slow_requests.log");
+    slowRequestLog.configure(sloConfig);
+
+    // Request deadlines (0 = none by default), e.g. DEADLINE_ROUTE_BUDGETS=POST /api/cart/checkout:15000
+    long long deadlineDefaultMs = 10000;
+    try {
+        deadlineDefaultMs = std::stoll(readMongoConfig("DEADLINE_DEFAULT_MS", "10000"));
+    } catch (...) {
+        std::cout << "WARNING: Invalid DEADLINE_DEFAULT_MS, using 10000" << std::endl;
+    }
+    std::map<std::string, long long> deadlineRoutes;
+    std::string deadlineRouteBudgets = readMongoConfig("DEADLINE_ROUTE_BUDGETS", "");
+    if (!SlowRequestLog::parseRouteBudgets(deadlineRouteBudgets, deadlineRoutes) ||
+        !deadlinePolicy.configure(deadlineDefaultMs, deadlineRoutes)) {
+        std::cout << "WARNING: Ignoring invalid DEADLINE_ROUTE_BUDGETS value '" << deadlineRouteBudgets << "'" << std::endl;
+        deadlinePolicy.configure(deadlineDefaultMs, std::map<std::string, long long>());
+    }
+
+    // Hot restart: a new process started with the same config takes over the listening socket
+    hotRestartEnabled = readMongoConfig("HOT_RESTART", "false") == "true";
+    hotRestartSocket = readMongoConfig("HOT_RESTART_SOCKET", "backend.handoff.sock");
+    try {
+        hotRestartDrainMs = std::stoll(readMongoConfig("HOT_RESTART_DRAIN_TIMEOUT_MS", "30000"));
+    } catch (...) {
+        std::cout << "WARNING: Invalid HOT_RESTART_DRAIN_TIMEOUT_MS, using 30000" << std::endl;
+    }
+    if (hotRestartEnabled && !HotRestart::isSupported()) {
+        std::cout << "WARNING: HOT_RESTART is not supported on this platform" << std::endl;
+        hotRestartEnabled = false;
+    }
+
+    // Promotion rules, reloaded when the file changes (PROMOTIONS_RELOAD_S=0 disables)
+    try {
+        promotionsReloadMs = std::stoll(readMongoConfig("PROMOTIONS_RELOAD_S", "10")) * 1000;
+    } catch (...) {
+        std::cout << "WARNING: Invalid PROMOTIONS_RELOAD_S, using 10" << std::endl;
+    }
+    // A generated catalog replaces the built-in one before promotions are checked against it
+    std::string catalogFile = readMongoConfig("CATALOG_FILE", "");
+    if (!catalogFile.empty()) {
+        loadCatalogFile(catalogFile);
+    }
+    loadPromotions(readMongoConfig("PROMOTIONS_FILE", "promotions.txt"), false);
+
+    // Search analytics; the last run's most popular queries are searched once now, against the
+    // final catalog, so the first requests after a deploy hit the search cache
+    size_t searchCacheCapacity = 1024;
+    try {
+        searchCacheCapacity = std::stoul(readMongoConfig("SEARCH_CACHE_CAPACITY", "1024"));
+        queryTopCount = std::stoul(readMongoConfig("QUERY_TOP_N", "100"));
+        queryTopSaveMs = std::stoll(readMongoConfig("QUERY_TOP_SAVE_S", "60")) * 1000;
+    } catch (...) {
+        std::cout << "WARNING: Invalid SEARCH_CACHE_CAPACITY / QUERY_TOP_* setting, using defaults" << std::endl;
+        searchCacheCapacity = 1024;
+        queryTopCount = 100;
+        queryTopSaveMs = 60 * 1000;
+    }
+    searchService.setCacheCapacity(searchCacheCapacity);
+    queryAnalyticsEnabled = readMongoConfig("QUERY_ANALYTICS", "true") == "true";
+    queryTopFile = readMongoConfig("QUERY_TOP_FILE", "top_queries.txt");
+    std::vector<QueryCount> topQueries;
+    if (queryAnalyticsEnabled && !queryTopFile.empty() && QueryAnalytics::load(queryTopFile, topQueries)) {
+        queryAnalytics.seed(topQueries);
+        std::vector<std::string> queries;
+        for (const auto& query : topQueries) {
+            queries.push_back(query.query);
+        }
+        size_t warmed = searchService.warmCache(queries);
+        std::cout << "Search cache: warmed " << warmed << " of " << topQueries.size()
+                  << " popular queries from " << queryTopFile << std::endl;
+    }
+
     // If no config file, try default local MongoDB connection
     if (mongoConnStr.empty()) {
         mongoConnStr = "mongodb://localhost:27017";
         std::cout << "MongoDB: No config file found. Trying default local connection: " << mongoConnStr << std::endl;
     }
     
+    // This thread goes on to accept connections; MongoDB driver threads started while
+    // connecting inherit its CPU set
+    if (!ioCpus.empty() && !ThreadAffinity::pinCurrentThread(ioCpus)) {
+        std::cout << "WARNING: Could not pin I/O threads to CPUs " << ThreadAffinity::formatCpuList(ioCpus) << std::endl;
+        ioCpus.clear();
+    }
+
     if (!mongoConnStr.empty()) {
         // Replace <db_password> placeholder if present
         size_t pos = mongoConnStr.find("<db_password>");
@@ -176,27 +811,217 @@ Server::Server(int port) : port(port) {
         std::cout << "To enable MongoDB, create mongodb_config.txt with your connection string." << std::endl;
     }
     
+    // Shared-nothing user shards for in-memory storage (USER_SHARDS=auto for one per core)
+    if (!mongoService.isConnected()) {
+        std::string shardSetting = readMongoConfig("USER_SHARDS", "0");
+        size_t shardCount = 0;
+        try {
+            shardCount = shardSetting == "auto" ? std::max(1u, std::thread::hardware_concurrency())
+                                                : std::stoul(shardSetting);
+        } catch (...) {
+            std::cout << "WARNING: Invalid USER_SHARDS, not sharding users" << std::endl;
+        }
+        if (shardCount > 0) {
+            // Each calling thread gets its own queue to every shard: HTTP and batch workers,
+            // scheduler threads and this one
+            userShards.start(shardCount, httpThreads + batchWorkers + schedulerThreads + 1, shardCpus);
+            std::cout << "User shards: " << userShards.getShardCount() << std::endl;
+        }
+    }
+
     // Initialize with test users (only if MongoDB not connected)
     if (!mongoService.isConnected()) {
-        User testUser;
+        UserProfile testUser;
         testUser.id = "1";
         testUser.username = "testuser";
         testUser.email = "test@example.com";
         testUser.password = "testpass";
-        users["testuser"] = testUser;
+        UserRef created = UserSnapshot::create(testUser);
+        users.insert(created);
+        if (userShards.enabled()) {
+            userShards.insert(created);
+        }
+    }
+
+    // Generated users for load tests (datagen --format binary)
+    std::string seedUsersFile = readMongoConfig("SEED_USERS_FILE", "");
+    if (!seedUsersFile.empty() && !mongoService.isConnected()) {
+        loadSeedUsers(seedUsersFile);
+    }
+
+    if (mongoService.isConnected()) {
+        cartSweeper.setBatchFunction(sweepMongoCarts);
+    } else if (userShards.enabled()) {
+        cartSweeper.setBatchFunction(sweepShardedCarts);
+    } else {
+        cartSweeper.setBatchFunction(sweepInMemoryCarts);
+    }
+    scheduleMaintenance();
+}
+
+void Server::scheduleMaintenance() {
+    // Cart sweep: one time-sliced batch per tick, passes spaced by CART_SWEEP_INTERVAL_S
+    CartSweeperConfig sweepConfig = cartSweeper.getConfig();
+    if (sweepConfig.expiryMs > 0) {
+        scheduler.scheduleFixedRate("cart-sweep", std::max<long long>(sweepConfig.batchPauseMs, 1), [] {
+            cartSweeper.tick(CartSweeper::nowMs());
+        }, sweepConfig.batchPauseMs / 4);
+    }
+
+    // Pick up edits to the promotions file without a restart
+    if (promotionsReloadMs > 0) {
+        scheduler.scheduleFixedRate("promotions-reload", promotionsReloadMs, [] {
+            loadPromotions("", true);
+        }, promotionsReloadMs / 2);
+    }
+
+    // Fold recorded searches into the popularity sketch, and save the most popular for the next start
+    if (queryAnalyticsEnabled) {
+        scheduler.scheduleFixedRate("query-analytics", 1000, [] {
+            queryAnalytics.aggregate();
+        });
+        if (!queryTopFile.empty() && queryTopSaveMs > 0) {
+            scheduler.scheduleFixedRate("query-top-save", queryTopSaveMs, [] {
+                if (!queryAnalytics.save(queryTopFile, queryTopCount)) {
+                    std::cout << "WARNING: Could not write " << queryTopFile << std::endl;
+                }
+            });
+        }
+    }
+
+    // Drop expired user cache entries so idle users do not pin memory until evicted
+    if (mongoService.isConnected()) {
+        scheduler.scheduleFixedRate("user-cache-purge", 30 * 1000, [] {
+            userCache.purgeExpired();
+        }, 5 * 1000);
+    }
+}
+
+// Catalog response document for one snapshot of the live catalog (the one search and
+// checkout price against)
+static json catalogDocument(const CatalogSnapshot& catalog) {
+    json items = json::array();
+    for (const auto& item : catalog.getItems()) {
+        items.push_back({{"id", item.id}, {"name", item.name}, {"price", item.price}, {"description", item.description}});
+    }
+    return {{"success", true}, {"items", items}};
+}
+
+// The catalog bodies for the current catalog generation; a price change or catalog load
+// publishes a new generation, which the first request after it encodes while concurrent
+// catalog requests wait for it
+static std::shared_ptr<const EncodedBodies> currentCatalogBodies() {
+    auto catalog = searchService.getCatalog();
+    {
+        std::lock_guard<std::mutex> lock(catalogBodiesMutex);
+        if (catalogBodies && catalogBodiesGeneration >= catalog->getGeneration()) {
+            return catalogBodies;
+        }
+    }
+    readFlights.run("catalog:" + std::to_string(catalog->getGeneration()), [&catalog] {
+        auto bodies = std::make_shared<const EncodedBodies>(ResponseEncoding::encodeAll(catalogDocument(*catalog)));
+        std::lock_guard<std::mutex> lock(catalogBodiesMutex);
+        if (!catalogBodies || catalogBodiesGeneration < catalog->getGeneration()) {
+            catalogBodies = bodies;
+            catalogBodiesGeneration = catalog->getGeneration();
+        }
+        return std::string();
+    });
+    std::lock_guard<std::mutex> lock(catalogBodiesMutex);
+    return catalogBodies;
+}
+
+// Weak comparison of an If-None-Match header against one entity tag ("*" matches anything)
+static bool etagMatches(const std::string& ifNoneMatch, const std::string& etag) {
+    auto opaque = [](std::string tag) {
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+        return tag.compare(0, 2, "W/") == 0 ? tag.substr(2) : tag;
+    };
+    std::string wanted = opaque(etag);
+    std::istringstream candidates(ifNoneMatch);
+    std::string candidate;
+    while (std::getline(candidates, candidate, ',')) {
+        candidate = opaque(candidate);
+        if (candidate == "*" || candidate == wanted) return true;
+    }
+    return false;
+}
+
+// Body for a request whose deadline passed; the post-routing handler sends it as a 504
+static std::string deadlineExceeded() {
+    std::map<std::string, std::string> response;
+    response["success"] = "false";
+    response["code"] = "DEADLINE_EXCEEDED";
+    response["message"] = "Request deadline exceeded";
+    return SimpleJSON::stringify(response);
+}
+
+// A JSON text body in the requested encoding; for the small bodies built as text, such as errors
+static std::string encodedText(const std::string& jsonText, BodyEncoding encoding) {
+    std::string encoded;
+    if (encoding == BodyEncoding::Json || !ResponseEncoding::transcode(jsonText, encoding, encoded)) {
+        return jsonText;
+    }
+    return encoded;
+}
+
+// Single-flight key of a user's purchase history in one encoding
+static std::string historyFlightKey(const std::string& userId, BodyEncoding encoding) {
+    return std::string("history:") + ResponseEncoding::contentType(encoding) + ":" + userId;
+}
+
+#ifdef HAS_HTTPLIB
+// Admission slot held by the request running on this HTTP worker, returned by the post-routing handler
+thread_local bool admissionHeld = false;
+thread_local std::chrono::steady_clock::time_point admissionStart;
+std::unique_ptr<httplib::ThreadPool> batchPool; // runs /api/batch sub-requests; null = run them inline
+
+// An httplib::Server that can adopt a listening socket inherited from another process,
+// and give up its own without shutting it down (the replacement process shares it)
+class HandoffServer : public httplib::Server {
+public:
+    void adopt(int fd) {
+        svr_sock_ = fd;
+    }
+
+    int listeningSocket() const {
+        return static_cast<int>(svr_sock_.load());
+    }
+
+    // The accept loop notices on its next idle tick; in-flight requests still drain
+    void release() {
+        svr_sock_.exchange(INVALID_SOCKET);
     }
+};
+
+// Re-encode a handler's JSON body as MessagePack or CBOR when the Accept header asks for it
+static httplib::Server::Handler negotiated(httplib::Server::Handler handler) {
+    return [handler](const httplib::Request& req, httplib::Response& res) {
+        handler(req, res);
+        res.set_header("Vary", "Accept");
+        BodyEncoding encoding = ResponseEncoding::negotiate(req.get_header_value("Accept"));
+        if (encoding == BodyEncoding::Json || res.get_header_value("Content-Type") != "application/json") {
+            return;
+        }
+        std::string encoded;
+        if (ResponseEncoding::transcode(res.body, encoding, encoded)) {
+            res.set_content(std::move(encoded), ResponseEncoding::contentType(encoding));
+        }
+    };
 }
+#endif
 
 void Server::start() {
 #ifdef HAS_HTTPLIB
     // Full HTTP server implementation using cpp-httplib
-    httplib::Server svr;
+    HandoffServer svr;
 
     // CORS headers for all responses
     svr.set_default_headers({
         {"Access-Control-Allow-Origin", "*"},
-        {"Access-Control-Allow-Methods", "GET, POST, PATCH, DELETE, OPTIONS"},
-        {"Access-Control-Allow-Headers", "Content-Type, Authorization"}
+        {"Access-Control-Allow-Methods", "GET, POST, PUT, PATCH, DELETE, OPTIONS"},
+        {"Access-Control-Allow-Headers", "Content-Type, Authorization, X-Request-Timeout-Ms"}
     });
 
     // Handle OPTIONS requests for CORS preflight
@@ -204,45 +1029,108 @@ void Server::start() {
         return;
     });
 
-    // Serve static files from public directory
-    svr.set_mount_point("/", "./public");
+    // Enough workers that requests waiting for admission never stop new ones from being read
+    size_t workers = httpThreads;
+    std::vector<int> cpus = workerCpus;
+    svr.new_task_queue = [workers, cpus] {
+        // Worker threads inherit the CPU set of the thread that creates them
+        ScopedAffinity placement(cpus);
+        return new httplib::ThreadPool(workers);
+    };
+
+    // Time every request against its route's SLO; only over-budget requests are logged.
+    // Admission control runs first: under overload low-priority requests wait or are shed with a 503.
+    // The request's deadline starts on arrival, so time spent queued for admission counts against it.
+    svr.set_pre_routing_handler([](const httplib::Request& req, httplib::Response& res) {
+        SlowRequestLog::begin();
+        RequestDeadline::start(deadlinePolicy.budgetFor(req.method, req.path,
+                                                        req.get_header_value("X-Request-Timeout-Ms")));
+        RequestClass requestClass = AdmissionController::classify(req.method, req.path);
+        bool admitted = admission.acquire(requestClass, RequestDeadline::remainingMs());
+        if (admitted && RequestDeadline::expired()) {
+            // Exempt requests never took a slot, so there is nothing to return
+            if (requestClass != RequestClass::Exempt) {
+                admission.release(0);
+            }
+            admitted = false;
+        }
+        if (!admitted) {
+            if (!RequestDeadline::check("admission")) {
+                res.set_content(deadlineExceeded(), "application/json");
+                return httplib::Server::HandlerResponse::Handled;
+            }
+            res.status = 503;
+            res.set_header("Retry-After", "1");
+            res.set_content("{\"success\":false,\"message\":\"Server is busy, please try again\"}", "application/json");
+            return httplib::Server::HandlerResponse::Handled;
+        }
+        admissionStart = std::chrono::steady_clock::now();
+        admissionHeld = requestClass != RequestClass::Exempt;
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
+    svr.set_post_routing_handler([](const httplib::Request& req, httplib::Response& res) {
+        if (admissionHeld) {
+            admissionHeld = false;
+            admission.release(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - admissionStart).count());
+        }
+        if (const char* stage = RequestDeadline::exceededAt()) {
+            res.status = 504;
+            res.set_header("X-Deadline-Exceeded-At", stage);
+        }
+        RequestDeadline::clear();
+        slowRequestLog.finish(req.method, req.matched_route, req.path, res.status,
+                              req.body.size(), res.body.size());
+    });
+
+    // Encode the catalog before the first request needs it
+    currentCatalogBodies();
+
+    // Serve static files from public directory (through io_uring, the catch-all route registered last)
+    if (!staticFiles.isIoUringActive()) {
+        svr.set_mount_point("/", "./public");
+    }
 
     // Health check
-    svr.Get("/api/health", [this](const httplib::Request&, httplib::Response& res) {
+    svr.Get("/api/health", negotiated([this](const httplib::Request&, httplib::Response& res) {
         std::ostringstream oss;
         oss << "{\"success\":true,\"message\":\"Server is running\",\"port\":" << port << "}";
         res.set_content(oss.str(), "application/json");
-    });
+    }));
 
     // Public endpoints
-    svr.Post("/api/signup", [this](const httplib::Request& req, httplib::Response& res) {
+    svr.Post("/api/signup", negotiated([this](const httplib::Request& req, httplib::Response& res) {
         res.set_content(this->handleSignup(req.body), "application/json");
-    });
+    }));
 
-    svr.Post("/api/login", [this](const httplib::Request& req, httplib::Response& res) {
+    svr.Post("/api/login", negotiated([this](const httplib::Request& req, httplib::Response& res) {
         res.set_content(this->handleLogin(req.body), "application/json");
-    });
+    }));
 
-    svr.Get("/api/catalog", [this](const httplib::Request&, httplib::Response& res) {
-        res.set_content(this->handleGetCatalog(), "application/json");
-    });
+    svr.Get("/api/catalog", negotiated([](const httplib::Request& req, httplib::Response& res) {
+        BodyEncoding encoding = ResponseEncoding::negotiate(req.get_header_value("Accept"));
+        res.set_content(currentCatalogBodies()->get(encoding), ResponseEncoding::contentType(encoding));
+    }));
 
-    svr.Get("/api/search", [this](const httplib::Request& req, httplib::Response& res) {
+    svr.Get("/api/search", negotiated([this](const httplib::Request& req, httplib::Response& res) {
         std::string query = req.get_param_value("q");
         res.set_content(this->handleSearch(query), "application/json");
-    });
+    }));
 
     // Protected endpoints - require authentication
     auto authenticate = [this](const httplib::Request& req) -> std::string {
         std::string authHeader = req.get_header_value("Authorization");
+        std::string userId;
         if (authHeader.find("Bearer ") == 0) {
             std::string token = authHeader.substr(7);
-            return this->getUserIdFromToken(token);
+            userId = this->getUserIdFromToken(token);
         }
-        return "";
+        SlowRequestLog::setUser(userId);
+        SlowRequestLog::mark("auth");
+        return userId;
     };
 
-    svr.Get("/api/me", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    svr.Get("/api/me", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
@@ -250,19 +1138,29 @@ void Server::start() {
             return;
         }
         res.set_content(this->handleGetProfile(userId), "application/json");
-    });
+    }));
 
-    svr.Get("/api/cart", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    // Carts are polled often: If-None-Match is answered from the cart version, before the body is built
+    svr.Get("/api/cart", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
             res.set_content("{\"success\":false,\"message\":\"Access token required\"}", "application/json");
             return;
         }
+        std::string etag;
+        if (this->getCartETag(userId, etag)) {
+            res.set_header("ETag", etag);
+            res.set_header("Cache-Control", "private, no-cache");
+            if (etagMatches(req.get_header_value("If-None-Match"), etag)) {
+                res.status = 304;
+                return;
+            }
+        }
         res.set_content(this->handleGetCart(userId), "application/json");
-    });
+    }));
 
-    svr.Post("/api/cart", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    svr.Post("/api/cart", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
@@ -271,9 +1169,9 @@ void Server::start() {
         }
         res.status = 201;
         res.set_content(this->handleAddToCart(req.body, userId), "application/json");
-    });
+    }));
 
-    svr.Patch("/api/cart/.*", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    svr.Patch("/api/cart/.*", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
@@ -287,9 +1185,9 @@ void Server::start() {
         std::string qtyStr = SimpleJSON::parseString(req.body, "quantity");
         unsigned int quantity = qtyStr.empty() ? 1 : std::stoi(qtyStr);
         res.set_content(this->handleUpdateCart(productId, quantity, userId), "application/json");
-    });
+    }));
 
-    svr.Delete("/api/cart/.*", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    svr.Delete("/api/cart/.*", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
@@ -300,9 +1198,9 @@ void Server::start() {
         size_t lastSlash = path.find_last_of('/');
         std::string productId = (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : "";
         res.set_content(this->handleRemoveFromCart(productId, userId), "application/json");
-    });
+    }));
 
-    svr.Post("/api/cart/clear", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    svr.Post("/api/cart/clear", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
@@ -310,9 +1208,9 @@ void Server::start() {
             return;
         }
         res.set_content(this->handleClearCart(userId), "application/json");
-    });
+    }));
 
-    svr.Post("/api/cart/checkout", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    svr.Post("/api/cart/checkout", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
@@ -320,19 +1218,21 @@ void Server::start() {
             return;
         }
         res.set_content(this->handleCheckout(req.body, userId), "application/json");
-    });
+    }));
 
-    svr.Get("/api/purchase-history", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    svr.Get("/api/purchase-history", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
             res.set_content("{\"success\":false,\"message\":\"Access token required\"}", "application/json");
             return;
         }
-        res.set_content(this->handleGetPurchaseHistory(userId), "application/json");
-    });
+        // Encoded straight from the history document, so negotiated() has nothing to transcode
+        BodyEncoding encoding = ResponseEncoding::negotiate(req.get_header_value("Accept"));
+        res.set_content(this->handleGetPurchaseHistory(userId, encoding), ResponseEncoding::contentType(encoding));
+    }));
 
-    svr.Patch("/api/profile", [this, authenticate](const httplib::Request& req, httplib::Response& res) {
+    svr.Patch("/api/profile", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
         std::string userId = authenticate(req);
         if (userId.empty()) {
             res.status = 401;
@@ -340,7 +1240,131 @@ void Server::start() {
             return;
         }
         res.set_content(this->handleUpdateProfile(req.body, userId), "application/json");
-    });
+    }));
+
+    // Several independent GETs in one round trip; the token is resolved once for all of them
+    svr.Post("/api/batch", negotiated([this, authenticate](const httplib::Request& req, httplib::Response& res) {
+        std::string userId = authenticate(req);
+        int status = 200;
+        std::string body = this->handleBatch(req.body, userId, status);
+        res.status = status;
+        res.set_content(body, "application/json");
+    }));
+
+    // Admin endpoints - require ADMIN_TOKEN, or a localhost client when no token is configured
+    auto authorizeAdmin = [](const httplib::Request& req) -> bool {
+        if (ADMIN_TOKEN.empty()) {
+            return req.remote_addr == "127.0.0.1" || req.remote_addr == "::1";
+        }
+        return req.get_header_value("Authorization") == "Bearer " + ADMIN_TOKEN;
+    };
+
+    svr.Get("/api/admin/stats", negotiated([this, authorizeAdmin](const httplib::Request& req, httplib::Response& res) {
+        if (!authorizeAdmin(req)) {
+            res.status = 403;
+            res.set_content("{\"success\":false,\"message\":\"Admin access required\"}", "application/json");
+            return;
+        }
+        res.set_content(this->handleGetStats(), "application/json");
+    }));
+
+    svr.Get("/api/admin/slow-requests", negotiated([this, authorizeAdmin](const httplib::Request& req, httplib::Response& res) {
+        if (!authorizeAdmin(req)) {
+            res.status = 403;
+            res.set_content("{\"success\":false,\"message\":\"Admin access required\"}", "application/json");
+            return;
+        }
+        size_t limit = 50;
+        try {
+            if (req.has_param("limit")) limit = std::stoul(req.get_param_value("limit"));
+        } catch (...) {
+        }
+        res.set_content(this->handleGetSlowRequests(limit), "application/json");
+    }));
+
+    svr.Get("/api/admin/search-queries", negotiated([this, authorizeAdmin](const httplib::Request& req, httplib::Response& res) {
+        if (!authorizeAdmin(req)) {
+            res.status = 403;
+            res.set_content("{\"success\":false,\"message\":\"Admin access required\"}", "application/json");
+            return;
+        }
+        size_t limit = 50;
+        try {
+            if (req.has_param("limit")) limit = std::stoul(req.get_param_value("limit"));
+        } catch (...) {
+        }
+        res.set_content(this->handleGetSearchQueries(limit), "application/json");
+    }));
+
+    // Change a catalog price; carts keep the old price until checkout reprices them
+    svr.Put("/api/admin/catalog/.*/price", negotiated([this, authorizeAdmin](const httplib::Request& req, httplib::Response& res) {
+        if (!authorizeAdmin(req)) {
+            res.status = 403;
+            res.set_content("{\"success\":false,\"message\":\"Admin access required\"}", "application/json");
+            return;
+        }
+        // Extract productId from path like /api/admin/catalog/ITEM001/price
+        std::string path = req.path.substr(0, req.path.find_last_of('/'));
+        size_t lastSlash = path.find_last_of('/');
+        std::string productId = (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : "";
+        res.set_content(this->handleSetItemPrice(productId, req.body), "application/json");
+    }));
+
+    // Sampling CPU profile of the whole process, returned as folded stacks for flamegraph tools.
+    // Blocks this worker for the requested window.
+    svr.Get("/api/debug/profile", negotiated([authorizeAdmin](const httplib::Request& req, httplib::Response& res) {
+        if (!authorizeAdmin(req)) {
+            res.status = 403;
+            res.set_content("{\"success\":false,\"message\":\"Admin access required\"}", "application/json");
+            return;
+        }
+        int seconds = 10;
+        int frequencyHz = Profiler::DEFAULT_FREQUENCY_HZ;
+        try {
+            if (req.has_param("seconds")) seconds = std::stoi(req.get_param_value("seconds"));
+            if (req.has_param("hz")) frequencyHz = std::stoi(req.get_param_value("hz"));
+        } catch (...) {
+            seconds = 0;
+        }
+
+        ProfileResult profile;
+        if (!Profiler::profile(seconds, frequencyHz, profile)) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = profile.error;
+            res.status = !Profiler::isSupported() ? 501 : (Profiler::isRunning() ? 409 : 400);
+            res.set_content(SimpleJSON::stringify(response), "application/json");
+            return;
+        }
+        res.set_header("X-Profile-Samples", std::to_string(profile.samples));
+        res.set_header("X-Profile-Dropped", std::to_string(profile.dropped));
+        res.set_header("X-Profile-Duration-Ms", std::to_string(profile.durationMs));
+        res.set_header("X-Profile-Frequency-Hz", std::to_string(profile.frequencyHz));
+        res.set_content(profile.folded, "text/plain");
+    }));
+
+    // The mount point is checked before every route, costing API requests a stat() of ./public;
+    // matched last, this only runs for paths no API route claimed
+    if (staticFiles.isIoUringActive()) {
+        svr.Get(".*", [](const httplib::Request& req, httplib::Response& res) {
+            StaticFile file = staticFiles.lookup(req.path);
+            switch (file.status) {
+            case StaticFileStatus::Loaded:
+                res.set_content(std::move(file.body), httplib::detail::find_content_type(
+                                                          file.path, {}, "application/octet-stream"));
+                break;
+            case StaticFileStatus::Mapped:
+                res.set_file_content(file.path);
+                break;
+            case StaticFileStatus::Directory:
+                res.set_redirect(req.path + "/", 301);
+                break;
+            case StaticFileStatus::NotFound:
+                res.status = 404;
+                break;
+            }
+        });
+    }
 
     std::cout << "========================================" << std::endl;
     std::cout << "C++ Backend Server Starting" << std::endl;
@@ -349,7 +1373,76 @@ void Server::start() {
     std::cout << "Open http://localhost:" << port << " in your browser" << std::endl;
     std::cout << "========================================" << std::endl;
     
-    svr.listen("0.0.0.0", port);
+    // Hot restart: take the listening socket from a server already running with this config,
+    // or bind a fresh one. Accepting starts at once; the old server's warm state arrives once
+    // it has drained and is merged in the background.
+    int inheritedSocket = -1;
+    int warmStateSocket = -1;
+    std::thread warmImport;
+    if (hotRestartEnabled && HotRestart::takeOver(hotRestartSocket, inheritedSocket, warmStateSocket)) {
+        svr.adopt(inheritedSocket);
+        std::cout << "Hot restart: took over the listening socket" << std::endl;
+        long long drainMs = hotRestartDrainMs;
+        warmImport = std::thread([warmStateSocket, drainMs] {
+            std::string warmBytes;
+            WarmState warm;
+            if (!HotRestart::receiveState(warmStateSocket, drainMs, warmBytes)) {
+                std::cout << "WARNING: Hot restart: no warm state received, continuing cold" << std::endl;
+            } else if (!WarmStateCodec::decode(warmBytes, warm)) {
+                std::cout << "WARNING: Hot restart: discarding unreadable warm state" << std::endl;
+            } else {
+                importWarmState(warm);
+                std::cout << "Hot restart: imported " << warm.users.size() << " users, " << warm.sessions.size()
+                          << " sessions, " << warm.cachedUsers.size() << " cached users" << std::endl;
+            }
+        });
+    } else if (!svr.bind_to_port("0.0.0.0", port)) {
+        std::cout << "ERROR: Could not listen on port " << port << std::endl;
+        return;
+    }
+
+    HotRestart hotRestart;
+    int listenSocket = svr.listeningSocket();
+    if (hotRestartEnabled) {
+        // An idle tick lets the accept loop see a handoff without the socket being shut down
+        svr.set_idle_interval(0, 100000);
+        if (!hotRestart.serve(hotRestartSocket, listenSocket, [&svr] { svr.release(); })) {
+            std::cout << "WARNING: Hot restart: could not listen on " << hotRestartSocket << std::endl;
+        }
+    }
+
+    {
+        ScopedAffinity placement(maintenanceCpus);
+        scheduler.start(schedulerThreads);
+    }
+    if (batchWorkers > 0) {
+        ScopedAffinity placement(workerCpus);
+        batchPool.reset(new httplib::ThreadPool(batchWorkers));
+    }
+    svr.listen_after_bind();
+    hotRestart.stop();
+    if (warmImport.joinable()) {
+        warmImport.join();
+    }
+    if (batchPool) {
+        batchPool->shutdown();
+    }
+    scheduler.stop();
+    if (queryAnalyticsEnabled && !queryTopFile.empty()) {
+        queryAnalytics.aggregate();
+        queryAnalytics.save(queryTopFile, queryTopCount);
+    }
+
+    // Drained: nothing changes the state any more, so the replacement gets a consistent copy
+    if (hotRestart.wasHandedOff()) {
+        WarmState warm = exportWarmState();
+        if (!hotRestart.sendState(WarmStateCodec::encode(warm))) {
+            std::cout << "WARNING: Hot restart: could not send warm state" << std::endl;
+        }
+        httplib::detail::close_socket(listenSocket);
+        std::cout << "Hot restart: handed off " << warm.users.size() << " users and " << warm.sessions.size()
+                  << " sessions, exiting" << std::endl;
+    }
 #else
     // Placeholder when httplib.h is not available
     std::cout << "========================================" << std::endl;
@@ -388,9 +1481,10 @@ std::string Server::getUserIdFromToken(const std::string& token) {
     }
     
     // Fallback to in-memory storage
-    if (tokens.find(token) != tokens.end()) {
+    std::string userId;
+    if (lookupToken(token, userId)) {
         std::cerr << "Server getUserIdFromToken: Found userId from in-memory storage" << std::endl;
-        return tokens[token];
+        return userId;
     }
     
     std::cerr << "Server getUserIdFromToken: Token not found in MongoDB or in-memory storage" << std::endl;
@@ -488,14 +1582,9 @@ std::string Server::handleSignup(const std::string& body) {
             mongoService.saveToken(token, userId);
         }
         // Also save to in-memory as fallback
-        tokens[token] = userId;
+        rememberToken(token, userId);
         
         // Build response
-        User newUser;
-        newUser.id = userId;
-        newUser.username = username;
-        newUser.email = email;
-        
 #ifdef HAS_JSON
         json response;
         response["success"] = true;
@@ -518,7 +1607,8 @@ std::string Server::handleSignup(const std::string& body) {
 #endif
     } else {
         // In-memory storage fallback
-    if (users.find(username) != users.end()) {
+        std::lock_guard<std::mutex> lock(usersMutex);
+    if (users.containsUsername(username)) {
         std::map<std::string, std::string> response;
         response["success"] = "false";
         response["message"] = "Username already exists";
@@ -526,30 +1616,28 @@ std::string Server::handleSignup(const std::string& body) {
     }
 
         // Check if email exists (case-insensitive)
-        std::string lowerEmail = email;
-        std::transform(lowerEmail.begin(), lowerEmail.end(), lowerEmail.begin(), ::tolower);
-    for (const auto& pair : users) {
-            std::string existingLower = pair.second.email;
-            std::transform(existingLower.begin(), existingLower.end(), existingLower.begin(), ::tolower);
-            if (existingLower == lowerEmail) {
+        if (users.findByEmail(email)) {
             std::map<std::string, std::string> response;
             response["success"] = "false";
             response["message"] = "Email already exists";
             return SimpleJSON::stringify(response);
         }
-    }
 
     // Create new user
-    User newUser;
+    UserProfile newUser;
     newUser.id = std::to_string(users.size() + 1);
     newUser.username = username;
     newUser.email = email;
     newUser.password = password; // TODO: Hash with bcrypt in production
-    users[username] = newUser;
+    UserRef created = UserSnapshot::create(newUser);
+    users.insert(created);
+    if (userShards.enabled()) {
+        userShards.insert(created);
+    }
 
     // Generate token (simplified - use JWT library in production)
     std::string token = "token_" + username + "_" + std::to_string(time(nullptr));
-    tokens[token] = newUser.id;
+    storeToken(token, newUser.id);
 
 #ifdef HAS_JSON
     // Use nlohmann/json for nested user object
@@ -613,13 +1701,17 @@ std::string Server::handleLogin(const std::string& body) {
         }
         
         if (found && user.password == password) {
+            UserRef snapshot = UserSnapshot::fromUser(std::move(user));
+            userCache.put(snapshot);
+            const UserProfile& profile = snapshot->getProfile();
+            
             // Generate token and save to MongoDB
-            std::string token = "token_" + user.username + "_" + std::to_string(time(nullptr));
+            std::string token = "token_" + profile.username + "_" + std::to_string(time(nullptr));
             if (mongoService.isConnected()) {
-                mongoService.saveToken(token, user.id);
+                mongoService.saveToken(token, profile.id);
             }
             // Also save to in-memory as fallback
-            tokens[token] = user.id;
+            rememberToken(token, profile.id);
             
 #ifdef HAS_JSON
             json response;
@@ -627,18 +1719,18 @@ std::string Server::handleLogin(const std::string& body) {
             response["message"] = "Login successful";
             response["token"] = token;
             response["user"] = json::object();
-            response["user"]["id"] = user.id;
-            response["user"]["username"] = user.username;
-            response["user"]["email"] = user.email;
+            response["user"]["id"] = profile.id;
+            response["user"]["username"] = profile.username;
+            response["user"]["email"] = profile.email;
             return response.dump();
 #else
             std::map<std::string, std::string> response;
             response["success"] = "true";
             response["message"] = "Login successful";
             response["token"] = token;
-            response["user_id"] = user.id;
-            response["username"] = user.username;
-            response["email"] = user.email;
+            response["user_id"] = profile.id;
+            response["username"] = profile.username;
+            response["email"] = profile.email;
             return SimpleJSON::stringify(response);
 #endif
         }
@@ -650,13 +1742,15 @@ std::string Server::handleLogin(const std::string& body) {
         return SimpleJSON::stringify(response);
     } else {
         // In-memory storage fallback
+        std::lock_guard<std::mutex> lock(usersMutex);
     // Try LoginService first (for test users)
     LoginService loginService;
     LoginResult result = loginService.authenticate(username, password);
 
     // Also check database users
-    if (!result.success && users.find(username) != users.end()) {
-        if (users[username].password == password) {
+    UserRef stored = users.findByUsername(username);
+    if (!result.success && stored) {
+        if (stored->getProfile().password == password) {
             result.success = true;
             result.message = "Login successful";
             result.username = username;
@@ -668,12 +1762,12 @@ std::string Server::handleLogin(const std::string& body) {
         std::string token = "token_" + username + "_" + std::to_string(time(nullptr));
         std::string userId = result.username;
         std::string email = "";
-        if (users.find(username) != users.end()) {
-            userId = users[username].id;
-            email = users[username].email;
+        if (stored) {
+            userId = stored->getId();
+            email = stored->getProfile().email;
         }
 
-        tokens[token] = userId;
+        storeToken(token, userId);
 
 #ifdef HAS_JSON
         // Use nlohmann/json for nested user object
@@ -718,27 +1812,15 @@ std::string Server::handleGetCart(const std::string& userId) {
         return SimpleJSON::stringify(response);
     }
     
-    User user;
-    bool found = false;
-    
-    // Use MongoDB if connected
-    if (mongoService.isConnected()) {
-        found = mongoService.findUserById(userId, user);
-        if (!found) {
-            std::cerr << "handleGetCart: User not found in MongoDB for userId: " << userId << std::endl;
+    UserRef user;
+    if (!loadUser(userId, user)) {
+        // A load cut short by the deadline is not a missing user
+        if (!RequestDeadline::check("load-user")) {
+            return deadlineExceeded();
         }
-    } else {
-        // In-memory storage fallback
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-                user = pair.second;
-                found = true;
-            break;
-            }
+        if (mongoService.isConnected()) {
+            std::cerr << "handleGetCart: User not found in MongoDB for userId: " << userId << std::endl;
         }
-    }
-
-    if (!found) {
         std::map<std::string, std::string> response;
         response["success"] = "false";
         response["message"] = "User not found";
@@ -749,7 +1831,8 @@ std::string Server::handleGetCart(const std::string& userId) {
     std::ostringstream oss;
     oss << "{\"success\":true,\"cart\":[";
     bool first = true;
-    for (const auto& item : user.cart.getItems()) {
+    const Cart& cart = user->getCart();
+    for (const auto& item : cart.getItems()) {
         if (!first) oss << ",";
         oss << "{\"productId\":\"" << item.productId
             << "\",\"name\":\"" << SimpleJSON::escape(item.name)
@@ -757,10 +1840,41 @@ std::string Server::handleGetCart(const std::string& userId) {
             << ",\"quantity\":" << item.quantity << "}";
         first = false;
     }
-    oss << "],\"total\":" << std::fixed << std::setprecision(2) << user.cart.getTotal() << "}";
+
+    // Active promotions, priced at the cart's stored prices (checkout reprices first)
+    PromotionResult pricing;
+    promotions.evaluate(cart.getItems(), *searchService.getCatalog(), pricing);
+    oss << "]," << promotionsJson(pricing, cart.getItems())
+        << ",\"total\":" << std::fixed << std::setprecision(2) << pricing.total << "}";
     return oss.str();
 }
 
+// Weak validator for GET /api/cart: the user, their cart version, and the promotion rules that price it.
+// The server start time keeps tags from a previous run (with other rules) from matching.
+bool Server::getCartETag(const std::string& userId, std::string& etag) {
+    static const long long serverEpoch = CartSweeper::nowMs();
+    long long cartVersion = 0;
+    if (mongoService.isConnected()) {
+        // A cached user answers without MongoDB; otherwise read just the version, not the cart
+        UserRef cached;
+        if (userCache.get(userId, cached)) {
+            cartVersion = cached->getCart().getVersion();
+        } else if (!mongoService.getCartVersion(userId, cartVersion)) {
+            return false;
+        }
+    } else {
+        UserRef user;
+        if (!loadUser(userId, user)) return false;
+        cartVersion = user->getCart().getVersion();
+    }
+
+    std::ostringstream oss;
+    oss << "W/\"" << std::hex << std::hash<std::string>()(userId) << std::dec
+        << "-" << cartVersion << "-" << serverEpoch << "." << promotions.getReloads() << "\"";
+    etag = oss.str();
+    return true;
+}
+
 std::string Server::handleAddToCart(const std::string& body, const std::string& userId) {
     std::string productId = SimpleJSON::parseString(body, "productId");
     std::string qtyStr = SimpleJSON::parseString(body, "quantity");
@@ -769,99 +1883,96 @@ std::string Server::handleAddToCart(const std::string& body, const std::string&
     if (quantity > 99) quantity = 99;
 
     // Get product from search service (catalog)
-    const CatalogItem* product = searchService.getItemById(productId);
-    if (!product) {
+    auto catalog = searchService.getCatalog();
+    unsigned int slot = catalog->slotOf(productId);
+    if (slot == CatalogSnapshot::NO_SLOT) {
         std::map<std::string, std::string> response;
         response["success"] = "false";
         response["message"] = "Product not found";
         return SimpleJSON::stringify(response);
     }
 
+    // The line keeps its catalog slot so checkout can reprice it without a lookup
+    const CatalogItem& product = catalog->at(slot);
+    CartItem cartItem(productId, product.name, product.price, quantity);
+    cartItem.catalogSlot = slot;
+
     // Use MongoDB if connected
     if (mongoService.isConnected()) {
-        User user;
-        if (!mongoService.findUserById(userId, user)) {
+        // Add to cart and save it to MongoDB
+        MongoCartWrite write = updateMongoCart(userId, [&cartItem](Cart& cart) {
+            cart.addItem(cartItem);
+            return true;
+        });
+        if (write == MongoCartWrite::DeadlineExceeded) {
+            return deadlineExceeded();
+        }
+        if (write == MongoCartWrite::NotFound) {
             std::map<std::string, std::string> response;
             response["success"] = "false";
             response["message"] = "User not found";
             return SimpleJSON::stringify(response);
         }
-        
-        // Add to cart
-        CartItem cartItem(productId, product->name, product->price, quantity);
-        user.cart.addItem(cartItem);
-        
-        // Save cart to MongoDB
-        std::vector<CartItem> cartItems = user.cart.getItems();
-        mongoService.updateCart(userId, cartItems);
     } else {
         // In-memory storage fallback
-    User* user = nullptr;
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-            user = &pair.second;
-            break;
+        UserRef updated = updateInMemoryUser(userId, [&cartItem](const UserRef& user) {
+            Cart cart = user->getCart();
+            cart.addItem(cartItem);
+            return user->withCart(std::move(cart));
+        });
+        if (!updated) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = "User not found";
+            return SimpleJSON::stringify(response);
         }
     }
 
-    if (!user) {
-        std::map<std::string, std::string> response;
-        response["success"] = "false";
-        response["message"] = "User not found";
-        return SimpleJSON::stringify(response);
-    }
-
-    // Add to cart
-    CartItem cartItem(productId, product->name, product->price, quantity);
-    user->cart.addItem(cartItem);
-    }
-
     return handleGetCart(userId);
 }
 
 std::string Server::handleUpdateCart(const std::string& productId, unsigned int quantity, const std::string& userId) {
     // Use MongoDB if connected
     if (mongoService.isConnected()) {
-        User user;
-        if (!mongoService.findUserById(userId, user)) {
+        // Edit the cart and save it to MongoDB
+        MongoCartWrite write = updateMongoCart(userId, [&](Cart& cart) {
+            return cart.updateQuantity(productId, quantity);
+        });
+        if (write == MongoCartWrite::DeadlineExceeded) {
+            return deadlineExceeded();
+        }
+        if (write == MongoCartWrite::NotFound) {
             std::map<std::string, std::string> response;
             response["success"] = "false";
             response["message"] = "User not found";
             return SimpleJSON::stringify(response);
         }
-
-        if (!user.cart.updateQuantity(productId, quantity)) {
+        if (write == MongoCartWrite::Unchanged) {
             std::map<std::string, std::string> response;
             response["success"] = "false";
             response["message"] = "Item not found in cart";
             return SimpleJSON::stringify(response);
         }
-        
-        // Save cart to MongoDB
-        std::vector<CartItem> cartItems = user.cart.getItems();
-        mongoService.updateCart(userId, cartItems);
     } else {
         // In-memory storage fallback
-    User* user = nullptr;
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-            user = &pair.second;
-            break;
+        bool itemFound = false;
+        UserRef updated = updateInMemoryUser(userId, [&](const UserRef& user) -> UserRef {
+            Cart cart = user->getCart();
+            itemFound = cart.updateQuantity(productId, quantity);
+            return itemFound ? user->withCart(std::move(cart)) : nullptr;
+        });
+
+        if (!updated) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = "User not found";
+            return SimpleJSON::stringify(response);
         }
-    }
-
-    if (!user) {
-        std::map<std::string, std::string> response;
-        response["success"] = "false";
-        response["message"] = "User not found";
-        return SimpleJSON::stringify(response);
-    }
-
-    if (!user->cart.updateQuantity(productId, quantity)) {
-        std::map<std::string, std::string> response;
-        response["success"] = "false";
-        response["message"] = "Item not found in cart";
-        return SimpleJSON::stringify(response);
+        if (!itemFound) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = "Item not found in cart";
+            return SimpleJSON::stringify(response);
         }
     }
 
@@ -871,46 +1982,45 @@ std::string Server::handleUpdateCart(const std::string& productId, unsigned int
 std::string Server::handleRemoveFromCart(const std::string& productId, const std::string& userId) {
     // Use MongoDB if connected
     if (mongoService.isConnected()) {
-        User user;
-        if (!mongoService.findUserById(userId, user)) {
+        // Edit the cart and save it to MongoDB
+        MongoCartWrite write = updateMongoCart(userId, [&](Cart& cart) {
+            return cart.removeItem(productId);
+        });
+        if (write == MongoCartWrite::DeadlineExceeded) {
+            return deadlineExceeded();
+        }
+        if (write == MongoCartWrite::NotFound) {
             std::map<std::string, std::string> response;
             response["success"] = "false";
             response["message"] = "User not found";
             return SimpleJSON::stringify(response);
         }
-
-        if (!user.cart.removeItem(productId)) {
+        if (write == MongoCartWrite::Unchanged) {
             std::map<std::string, std::string> response;
             response["success"] = "false";
             response["message"] = "Item not found in cart";
             return SimpleJSON::stringify(response);
         }
-        
-        // Save cart to MongoDB
-        std::vector<CartItem> cartItems = user.cart.getItems();
-        mongoService.updateCart(userId, cartItems);
     } else {
         // In-memory storage fallback
-    User* user = nullptr;
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-            user = &pair.second;
-            break;
+        bool itemFound = false;
+        UserRef updated = updateInMemoryUser(userId, [&](const UserRef& user) -> UserRef {
+            Cart cart = user->getCart();
+            itemFound = cart.removeItem(productId);
+            return itemFound ? user->withCart(std::move(cart)) : nullptr;
+        });
+
+        if (!updated) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = "User not found";
+            return SimpleJSON::stringify(response);
         }
-    }
-
-    if (!user) {
-        std::map<std::string, std::string> response;
-        response["success"] = "false";
-        response["message"] = "User not found";
-        return SimpleJSON::stringify(response);
-    }
-
-    if (!user->cart.removeItem(productId)) {
-        std::map<std::string, std::string> response;
-        response["success"] = "false";
-        response["message"] = "Item not found in cart";
-        return SimpleJSON::stringify(response);
+        if (!itemFound) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = "Item not found in cart";
+            return SimpleJSON::stringify(response);
         }
     }
 
@@ -920,45 +2030,33 @@ std::string Server::handleRemoveFromCart(const std::string& productId, const std
 std::string Server::handleClearCart(const std::string& userId) {
     // Use MongoDB if connected
     if (mongoService.isConnected()) {
-        mongoService.clearCart(userId);
+        long long version = 0;
+        long long cartVersion = 0;
+        bool saved = mongoService.clearCart(userId, MongoDBService::ANY_VERSION, &version, &cartVersion);
+        UserRef user;
+        if (userCache.get(userId, user)) {
+            Cart emptied;
+            emptied.setVersion(cartVersion);
+            writeThroughUser(user, user->withCart(std::move(emptied)), saved, version);
+        }
     } else {
         // In-memory storage fallback
-    User* user = nullptr;
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-            user = &pair.second;
-            break;
-        }
-    }
-
-    if (!user) {
-        std::map<std::string, std::string> response;
-        response["success"] = "false";
-        response["message"] = "User not found";
-        return SimpleJSON::stringify(response);
-    }
-
-    user->cart.clear();
-    }
-    
-    return "{\"success\":true,\"cart\":[],\"total\":0}";
-}
-
-std::string Server::handleGetCatalog() {
-    std::ostringstream oss;
-    oss << "{\"success\":true,\"items\":[";
-    auto items = purchaseService.getAvailableItems();
-    bool first = true;
-    for (const auto& item : items) {
-        if (!first) oss << ",";
-        oss << "{\"id\":\"" << item.id
-            << "\",\"name\":\"" << SimpleJSON::escape(item.name)
-            << "\",\"price\":" << item.price
-            << ",\"description\":\"\"}";
-        first = false;
+        UserRef updated = updateInMemoryUser(userId, [](const UserRef& user) {
+            return user->withCart(emptiedCart(user->getCart()));
+        });
+        if (!updated) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = "User not found";
+            return SimpleJSON::stringify(response);
+        }
     }
-    oss << "]}";
-    return oss.str();
+    
+    return "{\"success\":true,\"cart\":[],\"total\":0}";
+}
+
+std::string Server::handleGetCatalog() {
+    return currentCatalogBodies()->json;
 }
 
 std::string Server::handleSearch(const std::string& query) {
@@ -969,30 +2067,56 @@ std::string Server::handleSearch(const std::string& query) {
         return SimpleJSON::stringify(response);
     }
 
-    std::ostringstream oss;
-    oss << "{\"success\":true,\"query\":\"" << SimpleJSON::escape(query) << "\",\"results\":[";
-    auto results = searchService.searchCatalog(query);
-    bool first = true;
-    
-    for (const auto& item : results) {
-        if (!first) oss << ",";
-        oss << "{\"id\":\"" << item.id
-            << "\",\"name\":\"" << SimpleJSON::escape(item.name)
-            << "\",\"price\":" << item.price
-            << ",\"description\":\"" << SimpleJSON::escape(item.description) << "\"}";
-        first = false;
+    std::string normalizedQuery = SearchService::normalizeQuery(query);
+    if (queryAnalyticsEnabled) {
+        queryAnalytics.record(normalizedQuery);
     }
-    oss << "]}";
-    return oss.str();
+
+    // A popular query searched by many clients at once is computed once; queries that differ
+    // only in case or spacing have the same results, and each response echoes its own query
+    std::string results = readFlights.run("search:" + normalizedQuery, [&query] {
+        std::ostringstream oss;
+        oss << "[";
+        auto items = searchService.searchCatalog(query);
+        bool first = true;
+
+        for (const auto& item : items) {
+            if (!first) oss << ",";
+            oss << "{\"id\":\"" << item.id
+                << "\",\"name\":\"" << SimpleJSON::escape(item.name)
+                << "\",\"price\":" << item.price
+                << ",\"description\":\"" << SimpleJSON::escape(item.description) << "\"}";
+            first = false;
+        }
+        oss << "]";
+        return oss.str();
+    });
+    return "{\"success\":true,\"query\":\"" + SimpleJSON::escape(query) + "\",\"results\":" + results + "}";
+}
+
+std::string Server::handleGetPurchaseHistory(const std::string& userId, BodyEncoding encoding) {
+    // Several tabs loading the same history share one read (checkout forgets the key)
+    std::string history = readFlights.run(historyFlightKey(userId, encoding), [this, &userId, encoding] {
+        return buildPurchaseHistory(userId, encoding);
+    });
+    // The read was cut short by the deadline of whichever request started it; one with time left reads again
+    if (history == encodedText(deadlineExceeded(), encoding) && RequestDeadline::check("load-history")) {
+        history = buildPurchaseHistory(userId, encoding);
+    }
+    return history;
 }
 
-std::string Server::handleGetPurchaseHistory(const std::string& userId) {
+std::string Server::buildPurchaseHistory(const std::string& userId, BodyEncoding encoding) {
     std::cerr << "Server handleGetPurchaseHistory: Requested for userId: " << userId << std::endl;
     // Use MongoDB if connected
     if (mongoService.isConnected()) {
         std::cerr << "Server handleGetPurchaseHistory: MongoDB is connected" << std::endl;
         std::vector<std::string> historyJson;
-        if (mongoService.getPurchaseHistory(userId, historyJson)) {
+        bool loaded = mongoService.getPurchaseHistory(userId, historyJson);
+        if (!RequestDeadline::check("load-history")) {
+            return encodedText(deadlineExceeded(), encoding);
+        }
+        if (loaded) {
             std::cerr << "Server handleGetPurchaseHistory: Got " << historyJson.size() << " orders from MongoDB" << std::endl;
             if (!historyJson.empty()) {
                 // Transform MongoDB order format to frontend-expected format
@@ -1002,6 +2126,9 @@ std::string Server::handleGetPurchaseHistory(const std::string& userId) {
                 response["history"] = json::array();
                 
                 for (const auto& orderJson : historyJson) {
+                    if (!RequestDeadline::check("render")) {
+                        return encodedText(deadlineExceeded(), encoding);
+                    }
                     try {
                         json mongoOrder = json::parse(orderJson);
                         json frontendOrder;
@@ -1022,31 +2149,11 @@ std::string Server::handleGetPurchaseHistory(const std::string& userId) {
                             frontendOrder["orderId"] = "ORD_" + userId + "_" + std::to_string(time(nullptr));
                         }
                         
-                        // Convert timestamp to purchasedAt (MongoDB date format)
+                        // Convert timestamp to purchasedAt (ISO-8601 whatever format MongoDB returned)
                         if (mongoOrder.contains("timestamp")) {
-                            if (mongoOrder["timestamp"].is_string()) {
-                                // ISO string format
-                                frontendOrder["purchasedAt"] = mongoOrder["timestamp"];
-                            } else if (mongoOrder["timestamp"].is_object() && mongoOrder["timestamp"].contains("$date")) {
-                                // MongoDB extended JSON format: {"$date": "ISO-string"} or {"$date": number}
-                                auto dateValue = mongoOrder["timestamp"]["$date"];
-                                if (dateValue.is_string()) {
-                                    frontendOrder["purchasedAt"] = dateValue.get<std::string>();
-                                } else if (dateValue.is_number()) {
-                                    // Unix timestamp in milliseconds
-                                    frontendOrder["purchasedAt"] = dateValue.get<int64_t>();
-                                } else {
-                                    frontendOrder["purchasedAt"] = std::to_string(time(nullptr) * 1000);
-                                }
-                            } else if (mongoOrder["timestamp"].is_number()) {
-                                // Direct timestamp number
-                                frontendOrder["purchasedAt"] = mongoOrder["timestamp"].get<int64_t>();
-                            } else {
-                                // Fallback to current time
-                                frontendOrder["purchasedAt"] = std::to_string(time(nullptr) * 1000); // milliseconds
-                            }
+                            frontendOrder["purchasedAt"] = normalizeTimestamp(mongoOrder["timestamp"]);
                         } else {
-                            frontendOrder["purchasedAt"] = std::to_string(time(nullptr) * 1000); // milliseconds
+                            frontendOrder["purchasedAt"] = Timestamp::now();
                         }
                         
                         // Transform items array to frontend format
@@ -1097,7 +2204,7 @@ std::string Server::handleGetPurchaseHistory(const std::string& userId) {
                 if (response["history"].empty()) {
                     std::cerr << "Warning: Purchase history is empty for user: " << userId << std::endl;
                 }
-                return response.dump();
+                return ResponseEncoding::encode(response, encoding);
 #else
                 // Fallback: combine JSON strings manually (basic transformation)
                 std::ostringstream oss;
@@ -1122,7 +2229,7 @@ std::string Server::handleGetPurchaseHistory(const std::string& userId) {
                     first = false;
                 }
                 oss << "]}";
-                return oss.str();
+                return encodedText(oss.str(), encoding);
 #endif
             } else {
                 // No history found but query succeeded
@@ -1131,28 +2238,21 @@ std::string Server::handleGetPurchaseHistory(const std::string& userId) {
         } else {
             std::cerr << "Error: Failed to get purchase history for user: " << userId << std::endl;
         }
-        return "{\"success\":true,\"history\":[]}";
+        return encodedText("{\"success\":true,\"history\":[]}", encoding);
     }
     
     // In-memory storage fallback
-    User* user = nullptr;
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-            user = &pair.second;
-            break;
-        }
-    }
-
-    if (!user) {
+    UserRef user;
+    if (!loadUser(userId, user)) {
         std::map<std::string, std::string> response;
         response["success"] = "false";
         response["message"] = "User not found";
-        return SimpleJSON::stringify(response);
+        return encodedText(SimpleJSON::stringify(response), encoding);
     }
 
 #ifdef HAS_JSON
     // Get purchase history
-    const auto& purchases = user->history.getPurchases();
+    const PurchaseSegment* purchases = user->getHistory();
     
     json response;
     response["success"] = true;
@@ -1160,14 +2260,14 @@ std::string Server::handleGetPurchaseHistory(const std::string& userId) {
     
     // Group purchases by order (for now, treat all as one order)
     // In production with MongoDB, we'd have proper order documents
-    if (!purchases.empty()) {
+    if (purchases && purchases->size() > 0) {
         json order;
         order["orderId"] = "ORD_" + userId + "_" + std::to_string(time(nullptr));
-        order["purchasedAt"] = std::to_string(time(nullptr));
+        order["purchasedAt"] = Timestamp::now();
         order["items"] = json::array();
         double total = 0.0;
         
-        for (const auto& purchase : purchases) {
+        purchases->forEach([&order, &total](const PurchaseRecord& purchase) {
             json item;
             item["productId"] = purchase.id;
             item["name"] = purchase.name;
@@ -1175,39 +2275,27 @@ std::string Server::handleGetPurchaseHistory(const std::string& userId) {
             item["quantity"] = purchase.quantity;
             order["items"].push_back(item);
             total += purchase.subtotal();
-        }
+        });
         
         order["total"] = total;
         response["history"].push_back(order);
     }
     
-    return response.dump();
+    return ResponseEncoding::encode(response, encoding);
 #else
     // Fallback for SimpleJSON
     std::ostringstream oss;
     oss << "{\"success\":true,\"history\":[]}";
-    return oss.str();
+    return encodedText(oss.str(), encoding);
 #endif
 }
 
 std::string Server::handleCheckout(const std::string& body, const std::string& userId) {
-    User user;
-    bool found = false;
-    
-    // Use MongoDB if connected
-    if (mongoService.isConnected()) {
-        found = mongoService.findUserById(userId, user);
-    } else {
-        // In-memory storage fallback
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-                user = pair.second;
-                found = true;
-            break;
-            }
-        }
+    UserRef user;
+    bool found = loadUser(userId, user);
+    if (!RequestDeadline::check("load-user")) {
+        return deadlineExceeded();
     }
-
     if (!found) {
         std::map<std::string, std::string> response;
         response["success"] = "false";
@@ -1215,8 +2303,10 @@ std::string Server::handleCheckout(const std::string& body, const std::string& u
         return SimpleJSON::stringify(response);
     }
 
+    SlowRequestLog::mark("load-user");
+
     // Check if cart is empty
-    if (user.cart.isEmpty()) {
+    if (user->getCart().isEmpty()) {
         std::map<std::string, std::string> response;
         response["success"] = "false";
         response["message"] = "Cart is empty";
@@ -1243,50 +2333,140 @@ std::string Server::handleCheckout(const std::string& body, const std::string& u
         return SimpleJSON::stringify(response);
     }
 
+    // Price changes since the items were added must be confirmed by the client, either by
+    // checking out again (the cart now holds the current prices) or up front with
+    // "acceptPriceChanges": true
+    bool acceptPriceChanges = checkoutData.contains("acceptPriceChanges") &&
+                              checkoutData["acceptPriceChanges"].is_boolean() &&
+                              checkoutData["acceptPriceChanges"].get<bool>();
+
     // Generate order ID
     std::string orderId = "ORD_" + userId + "_" + std::to_string(time(nullptr));
 
-    // Get cart items
-    const auto& cartItems = user.cart.getItems();
-    double total = user.cart.getTotal();
-
-    // Create purchase records for history
+    // Reprice every line against one catalog snapshot, then apply the active promotions;
+    // the charged total is the discounted current one
+    auto catalog = searchService.getCatalog();
+    auto rules = promotions.current();
+    RepriceResult pricing;
+    PromotionResult discounts;
+    Cart checkedOut;
     std::vector<PurchaseRecord> purchaseRecords;
-    for (const auto& item : cartItems) {
-        purchaseRecords.push_back(PurchaseRecord(item.productId, item.name, item.price, item.quantity));
-    }
+    bool needsConfirmation = false;
 
     // Save to MongoDB if connected
     if (mongoService.isConnected()) {
-        // Save purchase to MongoDB (this also updates user history)
-        bool purchaseSaved = mongoService.addPurchase(userId, purchaseRecords, orderId, total);
-        if (!purchaseSaved) {
+        // The cart is charged and emptied only while it is still the one that was priced; if
+        // it changed in between, reload the user and price it again
+        bool saved = false;
+        for (int attempt = 0; attempt < MONGO_WRITE_ATTEMPTS && !saved; attempt++) {
+            if (attempt > 0) {
+                userCache.invalidate(userId);
+                found = loadMongoUser(userId, user);
+                if (!RequestDeadline::check("load-user")) {
+                    return deadlineExceeded();
+                }
+                if (!found || user->getCart().isEmpty()) {
+                    std::map<std::string, std::string> response;
+                    response["success"] = "false";
+                    response["message"] = found ? "Cart is empty" : "User not found";
+                    return SimpleJSON::stringify(response);
+                }
+            }
+
+            catalog->reprice(user->getCart().getItems(), pricing);
+            checkedOut = user->getCart();
+            checkedOut.applyPrices(pricing.prices, pricing.available);
+            PromotionEngine::evaluate(rules, checkedOut.getItems(), *catalog, discounts);
+            SlowRequestLog::mark("reprice");
+
+            // Last point to give up: once the purchase is written the checkout runs to completion
+            if (!RequestDeadline::check("reprice")) {
+                return deadlineExceeded();
+            }
+
+            long long version = 0;
+            long long cartVersion = 0;
+            needsConfirmation = !pricing.changes.empty() && !acceptPriceChanges;
+            if (needsConfirmation || checkedOut.isEmpty()) {
+                // Store the repriced cart so the next checkout charges what the client confirmed
+                saved = mongoService.updateCart(userId, checkedOut.getItems(), user->getVersion(), &version,
+                                                &cartVersion);
+                checkedOut.setVersion(cartVersion);
+                writeThroughUser(user, user->withCart(checkedOut), saved, version);
+            } else {
+                // Save the purchase (order and user history) and empty the cart
+                purchaseRecords = purchaseRecordsFor(checkedOut);
+                saved = mongoService.checkoutCart(userId, user->getCart().getVersion(), purchaseRecords, orderId,
+                                                  discounts.total, &version, &cartVersion);
+                Cart emptied;
+                emptied.setVersion(cartVersion);
+                writeThroughUser(user, user->withPurchases(purchaseRecords)->withCart(std::move(emptied)), saved,
+                                 version);
+            }
+        }
+        if (!saved) {
             std::map<std::string, std::string> response;
             response["success"] = "false";
             response["message"] = "Failed to save purchase";
             return SimpleJSON::stringify(response);
         }
-        
-        // Clear cart in MongoDB
-        bool cartCleared = mongoService.clearCart(userId);
-        if (!cartCleared) {
-            std::cerr << "Warning: Failed to clear cart after checkout" << std::endl;
-        }
     } else {
-        // In-memory storage fallback
-    // Record purchases in history
-        user.history.recordPurchases(purchaseRecords);
-
-    // Clear cart
-        user.cart.clear();
-        
-        // Update in-memory user
-        for (auto& pair : users) {
-            if (pair.second.id == userId) {
-                pair.second = user;
-                break;
+        // In-memory storage fallback: price and record the cart that is current when the
+        // swap succeeds, so items added by a concurrent request are not lost
+        bool cartWasEmpty = false;
+        UserRef published = updateInMemoryUser(userId, [&](const UserRef& current) -> UserRef {
+            cartWasEmpty = current->getCart().isEmpty();
+            if (cartWasEmpty) return nullptr;
+
+            catalog->reprice(current->getCart().getItems(), pricing);
+            checkedOut = current->getCart();
+            checkedOut.applyPrices(pricing.prices, pricing.available);
+            PromotionEngine::evaluate(rules, checkedOut.getItems(), *catalog, discounts);
+            needsConfirmation = !pricing.changes.empty() && !acceptPriceChanges;
+            if (needsConfirmation || checkedOut.isEmpty()) {
+                return current->withCart(checkedOut);
             }
+            purchaseRecords = purchaseRecordsFor(checkedOut);
+            return current->withPurchases(purchaseRecords)->withCart(emptiedCart(current->getCart()));
+        });
+        if (!published || cartWasEmpty) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = published ? "Cart is empty" : "User not found";
+            return SimpleJSON::stringify(response);
+        }
+    }
+    SlowRequestLog::mark("persist");
+    // A history read already in flight may predate this order; later reads must not join it
+    for (BodyEncoding encoding : {BodyEncoding::Json, BodyEncoding::MsgPack, BodyEncoding::Cbor}) {
+        readFlights.forget(historyFlightKey(userId, encoding));
+    }
+
+    json priceChanges = json::array();
+    for (const auto& change : pricing.changes) {
+        json entry;
+        entry["productId"] = change.productId;
+        entry["name"] = change.name;
+        entry["oldPrice"] = change.oldPrice;
+        entry["available"] = change.available;
+        if (change.available) {
+            entry["newPrice"] = change.newPrice;
         }
+        priceChanges.push_back(entry);
+    }
+
+    if (needsConfirmation || checkedOut.isEmpty()) {
+        json response;
+        response["success"] = false;
+        response["code"] = "PRICE_CHANGED";
+        response["message"] = checkedOut.isEmpty()
+            ? "The items in your cart are no longer available"
+            : "Some prices changed since you added them to your cart. Please review the new total and check out again.";
+        response["priceChanges"] = priceChanges;
+        response["subtotal"] = discounts.subtotal;
+        response["discount"] = discounts.discount;
+        response["total"] = discounts.total;
+        return response.dump();
     }
 
     // Build response with order details
@@ -1295,11 +2475,26 @@ std::string Server::handleCheckout(const std::string& body, const std::string& u
     response["message"] = "Checkout successful";
     response["order"] = json::object();
     response["order"]["orderId"] = orderId;
-    response["order"]["purchasedAt"] = std::to_string(time(nullptr));
-    response["order"]["total"] = total;
+    response["order"]["purchasedAt"] = Timestamp::now();
+    response["order"]["subtotal"] = discounts.subtotal;
+    response["order"]["discount"] = discounts.discount;
+    response["order"]["total"] = discounts.total;
+    response["order"]["promotions"] = json::array();
+    for (const auto& promotion : discounts.applied) {
+        json applied;
+        applied["id"] = discounts.ruleId(promotion);
+        if (promotion.line >= 0) {
+            applied["productId"] = checkedOut.getItems()[promotion.line].productId;
+        }
+        applied["discount"] = promotion.discount;
+        response["order"]["promotions"].push_back(applied);
+    }
     response["order"]["items"] = json::array();
+    if (!priceChanges.empty()) {
+        response["order"]["priceChanges"] = priceChanges;
+    }
     
-    for (const auto& item : cartItems) {
+    for (const auto& item : checkedOut.getItems()) {
         json orderItem;
         orderItem["productId"] = item.productId;
         orderItem["name"] = item.name;
@@ -1334,31 +2529,193 @@ std::string Server::handleCheckout(const std::string& body, const std::string& u
 #endif
 }
 
-std::string Server::handleGetProfile(const std::string& userId) {
-    User user;
-    bool found = false;
-    
-    // Use MongoDB if connected
-    if (mongoService.isConnected()) {
-        found = mongoService.findUserById(userId, user);
-    } else {
-        // In-memory storage fallback
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-                user = pair.second;
-                found = true;
-            break;
-            }
+std::string Server::handleSetItemPrice(const std::string& productId, const std::string& body) {
+    std::string priceStr = SimpleJSON::parseString(body, "price");
+    double price = -1.0;
+    try {
+        if (!priceStr.empty()) price = std::stod(priceStr);
+    } catch (...) {
+    }
+
+    std::map<std::string, std::string> response;
+    if (!(price >= 0.0) || price > 1e9) {
+        response["success"] = "false";
+        response["message"] = "A non-negative price is required";
+        return SimpleJSON::stringify(response);
+    }
+    if (!searchService.setItemPrice(productId, price)) {
+        response["success"] = "false";
+        response["message"] = "Product not found";
+        return SimpleJSON::stringify(response);
+    }
+
+    std::ostringstream oss;
+    oss << "{\"success\":true,\"productId\":\"" << SimpleJSON::escape(productId)
+        << "\",\"price\":" << std::fixed << std::setprecision(2) << price
+        << ",\"catalogGeneration\":" << searchService.getCatalog()->getGeneration() << "}";
+    return oss.str();
+}
+
+static const size_t MAX_BATCH_REQUESTS = 16;
+
+std::string Server::handleBatch(const std::string& body, const std::string& userId, int& status) {
+    struct SubRequest {
+        std::string id;
+        std::string method;
+        std::string target;
+        int status;
+        std::string body;
+    };
+
+    std::map<std::string, std::string> response;
+    json request = json::parse(body, nullptr, false);
+    if (request.is_discarded() || !request.is_object() || !request.contains("requests") ||
+        !request["requests"].is_array()) {
+        status = 400;
+        response["success"] = "false";
+        response["message"] = "Expected {\"requests\": [{\"id\", \"method\", \"path\"}, ...]}";
+        return SimpleJSON::stringify(response);
+    }
+    const json& items = request["requests"];
+    if (items.empty() || items.size() > MAX_BATCH_REQUESTS) {
+        status = 400;
+        response["success"] = "false";
+        response["message"] = "A batch holds 1 to " + std::to_string(MAX_BATCH_REQUESTS) + " requests";
+        return SimpleJSON::stringify(response);
+    }
+
+    std::vector<SubRequest> subRequests(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        const json& item = items[i];
+        SubRequest& sub = subRequests[i];
+        sub.id = std::to_string(i);
+        sub.method = "GET";
+        sub.status = 0;
+        if (!item.is_object() || !item.contains("path") || !item["path"].is_string()) {
+            status = 400;
+            response["success"] = "false";
+            response["message"] = "Request " + sub.id + " needs a \"path\"";
+            return SimpleJSON::stringify(response);
+        }
+        sub.target = item["path"].get<std::string>();
+        if (item.contains("id") && item["id"].is_string()) sub.id = item["id"].get<std::string>();
+        if (item.contains("method") && item["method"].is_string()) sub.method = item["method"].get<std::string>();
+    }
+
+    // Fan out to the batch pool and run the first sub-request on this thread meanwhile
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    size_t remaining = subRequests.size() - 1;
+    // Every sub-request runs under the batch's deadline, on whichever thread picks it up
+    bool hasDeadline = RequestDeadline::active();
+    RequestDeadline::TimePoint deadline = RequestDeadline::at();
+    auto adoptDeadline = [hasDeadline, deadline] {
+        if (hasDeadline) {
+            RequestDeadline::startAt(deadline);
+        } else {
+            RequestDeadline::clear();
+        }
+    };
+    auto run = [this, &subRequests, &userId, &adoptDeadline](size_t i) {
+        SubRequest& sub = subRequests[i];
+        adoptDeadline();
+        try {
+            sub.body = dispatchBatchRequest(sub.method, sub.target, userId, sub.status);
+        } catch (...) {
+            sub.status = 500;
+            sub.body = "{\"success\":false,\"message\":\"Internal error\"}";
+        }
+        if (RequestDeadline::exceededAt()) {
+            sub.status = 504;
         }
+    };
+    for (size_t i = 1; i < subRequests.size(); ++i) {
+        auto task = [&run, &doneMutex, &doneCondition, &remaining, i] {
+            run(i);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) doneCondition.notify_one();
+        };
+#ifdef HAS_HTTPLIB
+        if (batchPool && batchPool->enqueue(task)) continue;
+#endif
+        task();
+    }
+    run(0);
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCondition.wait(lock, [&remaining] { return remaining == 0; });
+    }
+    SlowRequestLog::mark("batch");
+    adoptDeadline();
+    if (!RequestDeadline::check("batch")) {
+        status = 504;
+        return deadlineExceeded();
     }
 
-    if (!found) {
+    // Sub-responses are already JSON, so they are embedded as-is
+    std::ostringstream oss;
+    oss << "{\"success\":true,\"responses\":[";
+    for (size_t i = 0; i < subRequests.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << "{\"id\":\"" << SimpleJSON::escape(subRequests[i].id)
+            << "\",\"status\":" << subRequests[i].status
+            << ",\"body\":" << subRequests[i].body << "}";
+    }
+    oss << "]}";
+    return oss.str();
+}
+
+std::string Server::dispatchBatchRequest(const std::string& method, const std::string& target,
+                                         const std::string& userId, int& status) {
+    status = 200;
+    if (method != "GET") {
+        status = 405;
+        return "{\"success\":false,\"message\":\"Only GET requests can be batched\"}";
+    }
+
+    size_t queryStart = target.find('?');
+    std::string path = target.substr(0, queryStart);
+    std::multimap<std::string, std::string> params;
+#ifdef HAS_HTTPLIB
+    if (queryStart != std::string::npos) {
+        httplib::detail::parse_query_text(target.substr(queryStart + 1), params);
+    }
+#endif
+
+    if (path == "/api/health") {
+        return "{\"success\":true,\"message\":\"Server is running\",\"port\":" + std::to_string(port) + "}";
+    }
+    if (path == "/api/catalog") {
+        return handleGetCatalog();
+    }
+    if (path == "/api/search") {
+        auto query = params.find("q");
+        return handleSearch(query != params.end() ? query->second : "");
+    }
+
+    bool isProtected = path == "/api/me" || path == "/api/cart" || path == "/api/purchase-history";
+    if (isProtected && userId.empty()) {
+        status = 401;
+        return "{\"success\":false,\"message\":\"Access token required\"}";
+    }
+    if (path == "/api/me") return handleGetProfile(userId);
+    if (path == "/api/cart") return handleGetCart(userId);
+    if (path == "/api/purchase-history") return handleGetPurchaseHistory(userId, BodyEncoding::Json);
+
+    status = 404;
+    return "{\"success\":false,\"message\":\"Route cannot be batched\"}";
+}
+
+std::string Server::handleGetProfile(const std::string& userId) {
+    UserRef snapshot;
+    if (!loadUser(userId, snapshot)) {
         std::map<std::string, std::string> response;
         response["success"] = "false";
         response["message"] = "User not found";
         return SimpleJSON::stringify(response);
     }
 
+    const UserProfile& user = snapshot->getProfile();
     std::ostringstream oss;
     oss << "{\"success\":true,\"user\":{"
         << "\"id\":\"" << user.id << "\","
@@ -1375,30 +2732,24 @@ std::string Server::handleGetProfile(const std::string& userId) {
     return oss.str();
 }
 
-std::string Server::handleUpdateProfile(const std::string& body, const std::string& userId) {
-    User user;
-    bool found = false;
-    
-    // Use MongoDB if connected
-    if (mongoService.isConnected()) {
-        found = mongoService.findUserById(userId, user);
-    } else {
-        // In-memory storage fallback
-    for (auto& pair : users) {
-        if (pair.second.id == userId) {
-                user = pair.second;
-                found = true;
-            break;
-            }
-        }
-    }
+// Whether two profiles hold the same account fields
+static bool sameProfile(const UserProfile& a, const UserProfile& b) {
+    return a.username == b.username && a.email == b.email && a.password == b.password &&
+           a.fullName == b.fullName && a.bio == b.bio;
+}
 
-    if (!found) {
+std::string Server::handleUpdateProfile(const std::string& body, const std::string& userId) {
+    UserRef snapshot;
+    if (!loadUser(userId, snapshot)) {
         std::map<std::string, std::string> response;
         response["success"] = "false";
         response["message"] = "User not found";
         return SimpleJSON::stringify(response);
     }
+    SlowRequestLog::mark("load-user");
+
+    // Edit a copy of the profile only; cart and history stay shared with the snapshot
+    UserProfile user = snapshot->getProfile();
 
     // Parse request body
     std::string username = SimpleJSON::parseString(body, "username");
@@ -1416,24 +2767,9 @@ std::string Server::handleUpdateProfile(const std::string& body, const std::stri
         if (!validation.valid) {
             errors.push_back(validation.error);
         } else {
-            // Check if username already exists (MongoDB or in-memory)
-            bool usernameExists = false;
-            if (mongoService.isConnected()) {
-                User existingUser;
-                if (mongoService.findUserByUsername(validation.value, existingUser) && existingUser.id != userId) {
-                    usernameExists = true;
-                }
-            } else {
-            if (users.find(validation.value) != users.end() && users[validation.value].id != userId) {
-                    usernameExists = true;
-                }
-            }
-            if (usernameExists) {
-                errors.push_back("Username already taken");
-            } else {
-                user.username = validation.value;
-                hasUpdates = true;
-            }
+            // Uniqueness is checked by the save below
+            user.username = validation.value;
+            hasUpdates = true;
         }
     }
 
@@ -1443,33 +2779,9 @@ std::string Server::handleUpdateProfile(const std::string& body, const std::stri
         if (!validation.valid) {
             errors.push_back(validation.error);
         } else {
-            // Check if email already exists (MongoDB or in-memory)
-            // Use case-insensitive comparison
-            bool emailExists = false;
-            if (mongoService.isConnected()) {
-                User existingUser;
-                if (mongoService.findUserByEmail(validation.value, existingUser) && existingUser.id != userId) {
-                    emailExists = true;
-                }
-            } else {
-                // Case-insensitive email comparison for in-memory storage
-                std::string lowerEmail = validation.value;
-                std::transform(lowerEmail.begin(), lowerEmail.end(), lowerEmail.begin(), ::tolower);
-            for (const auto& pair : users) {
-                    std::string existingLower = pair.second.email;
-                    std::transform(existingLower.begin(), existingLower.end(), existingLower.begin(), ::tolower);
-                    if (existingLower == lowerEmail && pair.second.id != userId) {
-                    emailExists = true;
-                    break;
-                    }
-                }
-            }
-            if (emailExists) {
-                errors.push_back("Email already taken");
-            } else {
-                user.email = validation.value;
-                hasUpdates = true;
-            }
+            // Uniqueness (case-insensitive) is checked by the save below
+            user.email = validation.value;
+            hasUpdates = true;
         }
     }
 
@@ -1518,22 +2830,70 @@ std::string Server::handleUpdateProfile(const std::string& body, const std::stri
         return SimpleJSON::stringify(response);
     }
 
-    // Save updated user to MongoDB or in-memory storage
+    // Save updated user to MongoDB or in-memory storage. The save is a single conditional
+    // update: username/email conflicts come back from the unique indexes instead of being
+    // looked up beforehand.
+    std::string conflict;
     if (mongoService.isConnected()) {
-        if (!mongoService.updateUser(userId, user)) {
+        // The save only applies while the user is still at the snapshot's version. When another
+        // write got in first the edit is saved on top of a fresh load, unless that write
+        // changed the profile too.
+        bool saved = false;
+        bool profileChanged = false;
+        for (int attempt = 0; attempt < MONGO_WRITE_ATTEMPTS; attempt++) {
+            long long version = 0;
+            saved = mongoService.updateUserProfile(userId, user, snapshot->getVersion(), conflict, &version);
+            writeThroughUser(snapshot, snapshot->withProfile(user), saved, version);
+            if (saved || !conflict.empty()) break;
+
+            UserRef fresh;
+            if (!loadMongoUser(userId, fresh)) break;
+            profileChanged = !sameProfile(fresh->getProfile(), snapshot->getProfile());
+            if (profileChanged) break;
+            snapshot = fresh;
+        }
+        if (!saved && conflict.empty()) {
             std::map<std::string, std::string> response;
             response["success"] = "false";
-            response["message"] = "Failed to update user in database";
+            response["message"] = profileChanged
+                ? "Your profile was changed by another request. Please reload it and try again."
+                : "Failed to update user in database";
             return SimpleJSON::stringify(response);
         }
     } else {
         // In-memory storage fallback
-        std::string oldUsername = user.username;
-        // If username changed, remove old entry and add new one
-        if (oldUsername != user.username && users.find(oldUsername) != users.end()) {
-            users.erase(oldUsername);
+        std::lock_guard<std::mutex> lock(usersMutex);
+        UserRef current = findInMemoryUser(userId);
+        if (!current) {
+            std::map<std::string, std::string> response;
+            response["success"] = "false";
+            response["message"] = "User not found";
+            return SimpleJSON::stringify(response);
+        }
+
+        const std::string& currentUsername = current->getProfile().username;
+        UserRef emailOwner = users.findByEmail(user.email);
+        if (user.username != currentUsername && users.containsUsername(user.username)) {
+            conflict = "username";
+        } else if (emailOwner && emailOwner->getId() != current->getId()) {
+            conflict = "email";
+        } else {
+            // Swap in the new profile on top of the current snapshot so concurrent cart
+            // changes are kept
+            users.replace(current, current->withProfile(user));
+            if (userShards.enabled()) {
+                updateInMemoryUser(userId, [&user](const UserRef& owned) { return owned->withProfile(user); });
+            }
         }
-        users[user.username] = user;
+    }
+
+    SlowRequestLog::mark("persist");
+
+    if (!conflict.empty()) {
+        std::map<std::string, std::string> response;
+        response["success"] = "false";
+        response["message"] = conflict == "username" ? "Username already taken" : "Email already taken";
+        return SimpleJSON::stringify(response);
     }
 
     // Generate new token with updated username
@@ -1543,7 +2903,7 @@ std::string Server::handleUpdateProfile(const std::string& body, const std::stri
     if (mongoService.isConnected()) {
         mongoService.saveToken(token, user.id);
     } else {
-        tokens[token] = user.id;
+        rememberToken(token, user.id);
     }
 
     // Build response
@@ -1567,3 +2927,217 @@ std::string Server::handleUpdateProfile(const std::string& body, const std::stri
     oss << "}}";
     return oss.str();
 }
+
+std::string Server::handleGetStats() {
+#ifdef HAS_JSON
+    json response;
+    response["success"] = true;
+
+    response["scheduler"] = json::array();
+    for (const auto& job : scheduler.stats()) {
+        json entry;
+        entry["name"] = job.name;
+        entry["schedule"] = job.schedule;
+        entry["runs"] = job.runs;
+        entry["failures"] = job.failures;
+        entry["overruns"] = job.overruns;
+        entry["lastRunUs"] = job.lastRunUs;
+        entry["maxRunUs"] = job.maxRunUs;
+        entry["avgRunUs"] = job.runs > 0 ? job.totalRunUs / static_cast<long long>(job.runs) : 0;
+        entry["nextRunInMs"] = job.nextRunInMs;
+        entry["running"] = job.running;
+        response["scheduler"].push_back(entry);
+    }
+
+    if (!mongoService.isConnected()) {
+        CompactUserStoreStats store;
+        {
+            std::lock_guard<std::mutex> lock(usersMutex);
+            store = users.getStats();
+        }
+        response["userStore"] = {
+            {"users", store.users},
+            {"carts", store.carts},
+            {"histories", store.histories},
+            {"recordBytes", store.recordBytes},
+            {"blobBytes", store.blobBytes},
+            {"garbageBytes", store.garbageBytes},
+            {"indexBytes", store.indexBytes}
+        };
+    }
+    response["userCache"] = {
+        {"size", userCache.size()},
+        {"hits", userCache.hits()},
+        {"misses", userCache.misses()}
+    };
+    response["cartSweeper"] = {
+        {"expired", cartSweeper.expired()},
+        {"batches", cartSweeper.batches()},
+        {"passes", cartSweeper.passes()},
+        {"archived", cartArchive.size()}
+    };
+    response["promotions"] = {
+        {"rules", promotions.current()->ruleCount()},
+        {"reloads", promotions.getReloads()}
+    };
+
+    AdmissionStats admissionStats = admission.getStats();
+    json admissionClasses = json::array();
+    for (const auto& entry : admissionStats.classes) {
+        admissionClasses.push_back({
+            {"class", entry.name},
+            {"queued", entry.queued},
+            {"admitted", entry.admitted},
+            {"shed", entry.shed}
+        });
+    }
+    response["admission"] = {
+        {"enabled", admission.getConfig().enabled},
+        {"limit", admissionStats.limit},
+        {"inFlight", admissionStats.inFlight},
+        {"classes", admissionClasses}
+    };
+
+    if (userShards.enabled()) {
+        UserShardsStats shardStats = userShards.getStats();
+        json shards = json::array();
+        for (const auto& entry : shardStats.shards) {
+            shards.push_back({
+                {"users", entry.users},
+                {"userBytes", entry.userBytes},
+                {"cpu", entry.cpu},
+                {"sessions", entry.sessions},
+                {"calls", entry.calls}
+            });
+        }
+        response["userShards"] = {
+            {"producers", shardStats.producers},
+            {"overflowCalls", shardStats.overflowCalls},
+            {"shards", shards}
+        };
+    }
+
+    // Configured CPU sets, and where the process's threads actually are
+    json placement = json::array();
+    for (const auto& group : ThreadAffinity::currentPlacement()) {
+        json lastCpu = json::object();
+        for (const auto& entry : group.lastCpu) {
+            lastCpu[std::to_string(entry.first)] = entry.second;
+        }
+        placement.push_back({
+            {"cpus", group.cpus},
+            {"numaNodes", group.nodes},
+            {"threads", group.threads},
+            {"lastCpu", lastCpu}
+        });
+    }
+    response["threadPlacement"] = {
+        {"supported", ThreadAffinity::isSupported()},
+        {"workers", ThreadAffinity::formatCpuList(workerCpus)},
+        {"io", ThreadAffinity::formatCpuList(ioCpus)},
+        {"maintenance", ThreadAffinity::formatCpuList(maintenanceCpus)},
+        {"shards", ThreadAffinity::formatCpuList(shardCpus)},
+        {"threads", placement}
+    };
+
+    SearchCacheStats searchCache = searchService.getCacheStats();
+    QueryAnalyticsStats queryStats = queryAnalytics.getStats();
+    response["search"] = {
+        {"cacheEntries", searchCache.entries},
+        {"cacheCapacity", searchCache.capacity},
+        {"cacheHits", searchCache.hits},
+        {"cacheMisses", searchCache.misses},
+        {"cacheWarmed", searchCache.warmed},
+        {"queriesRecorded", queryStats.recorded},
+        {"queriesDropped", queryStats.dropped},
+        {"queriesTracked", queryStats.tracked}
+    };
+
+    StaticFilesStats staticStats = staticFiles.getStats();
+    response["staticFiles"] = {
+        {"mode", staticStats.mode},
+        {"loaded", staticStats.loaded},
+        {"mapped", staticStats.mapped},
+        {"notFound", staticStats.notFound},
+        {"ioUringEnters", staticStats.enters},
+        {"rings", staticStats.rings}
+    };
+
+    SingleFlightStats flights = readFlights.getStats();
+    response["singleFlight"] = {
+        {"executions", flights.executions},
+        {"shared", flights.shared},
+        {"inFlight", flights.inFlight}
+    };
+
+    response["slo"] = {
+        {"objective", slowRequestLog.getConfig().objective},
+        {"slowRecorded", slowRequestLog.recorded()},
+        {"logFileErrors", slowRequestLog.fileErrors()},
+        {"routes", json::array()}
+    };
+    for (const auto& route : slowRequestLog.stats(Timestamp::nowMs())) {
+        json entry;
+        entry["route"] = route.route;
+        entry["budgetMs"] = route.budgetMs;
+        entry["requests"] = route.requests;
+        entry["slow"] = route.slow;
+        entry["requests5m"] = route.requests5m;
+        entry["slow5m"] = route.slow5m;
+        entry["burnRate5m"] = route.burnRate5m;
+        entry["requests1h"] = route.requests1h;
+        entry["slow1h"] = route.slow1h;
+        entry["burnRate1h"] = route.burnRate1h;
+        response["slo"]["routes"].push_back(entry);
+    }
+    return response.dump();
+#else
+    std::map<std::string, std::string> response;
+    response["success"] = "false";
+    response["message"] = "Stats require JSON library support";
+    return SimpleJSON::stringify(response);
+#endif
+}
+
+std::string Server::handleGetSearchQueries(size_t limit) {
+#ifdef HAS_JSON
+    // Include whatever the background job has not folded in yet
+    queryAnalytics.aggregate();
+    QueryAnalyticsStats stats = queryAnalytics.getStats();
+    json response;
+    response["success"] = true;
+    response["enabled"] = queryAnalyticsEnabled;
+    response["recorded"] = stats.recorded;
+    response["dropped"] = stats.dropped;
+    response["skipped"] = stats.skipped;
+    response["tracked"] = stats.tracked;
+    response["capacity"] = stats.capacity;
+    response["queries"] = json::array();
+    for (const auto& query : queryAnalytics.top(limit)) {
+        response["queries"].push_back({{"query", query.query}, {"count", query.count}, {"error", query.error}});
+    }
+    return response.dump();
+#else
+    std::map<std::string, std::string> response;
+    response["success"] = "false";
+    response["message"] = "Search analytics require JSON library support";
+    return SimpleJSON::stringify(response);
+#endif
+}
+
+std::string Server::handleGetSlowRequests(size_t limit) {
+#ifdef HAS_JSON
+    json response;
+    response["success"] = true;
+    response["requests"] = json::array();
+    for (const auto& entry : slowRequestLog.recent(limit)) {
+        response["requests"].push_back(json::parse(SlowRequestLog::toJsonLine(entry)));
+    }
+    return response.dump();
+#else
+    std::map<std::string, std::string> response;
+    response["success"] = "false";
+    response["message"] = "Slow request log requires JSON library support";
+    return SimpleJSON::stringify(response);
+#endif
+}
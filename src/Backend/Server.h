@@ -7,17 +7,36 @@
 #define SERVER_H
 
 #include <string>
+#include <vector>
+#include "Scheduler.h"
 
 // Forward declarations
 struct User;
 struct CatalogItem;
+enum class BodyEncoding;
 
 class Server {
 private:
     int port;
+    Scheduler scheduler; // periodic maintenance jobs (cart sweep, cache purge)
+    size_t schedulerThreads;
+    size_t batchWorkers; // threads running /api/batch sub-requests (0 = run them in turn)
+    size_t httpThreads;  // HTTP worker threads; admission control keeps half of them free to read requests
+    bool hotRestartEnabled;        // take over from / hand off to another process on hotRestartSocket
+    std::string hotRestartSocket;  // Unix socket path for listening-socket handoffs
+    long long hotRestartDrainMs;   // how long a replacement waits for the old process to drain
+    std::vector<int> workerCpus;      // HTTP and batch workers (empty = not pinned)
+    std::vector<int> ioCpus;          // listener, handoff and MongoDB driver threads
+    std::vector<int> maintenanceCpus; // scheduler threads
+    std::vector<int> shardCpus;       // user shards, one CPU each in turn
     
     // Helper methods
     std::string getUserIdFromToken(const std::string& token);
+    void scheduleMaintenance();
+    bool getCartETag(const std::string& userId, std::string& etag);
+    std::string buildPurchaseHistory(const std::string& userId, BodyEncoding encoding);
+    std::string dispatchBatchRequest(const std::string& method, const std::string& target,
+                                     const std::string& userId, int& status);
 
 public:
     Server(int port = 3000);
@@ -32,11 +51,16 @@ public:
     std::string handleRemoveFromCart(const std::string& productId, const std::string& userId);
     std::string handleClearCart(const std::string& userId);
     std::string handleCheckout(const std::string& body, const std::string& userId);
-    std::string handleGetPurchaseHistory(const std::string& userId);
+    std::string handleGetPurchaseHistory(const std::string& userId, BodyEncoding encoding);
     std::string handleGetCatalog();
     std::string handleSearch(const std::string& query);
     std::string handleGetProfile(const std::string& userId);
     std::string handleUpdateProfile(const std::string& body, const std::string& userId);
+    std::string handleGetStats();
+    std::string handleGetSlowRequests(size_t limit);
+    std::string handleGetSearchQueries(size_t limit);
+    std::string handleSetItemPrice(const std::string& productId, const std::string& body);
+    std::string handleBatch(const std::string& body, const std::string& userId, int& status);
 };
 
 #endif // SERVER_H
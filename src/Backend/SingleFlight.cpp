@@ -0,0 +1,57 @@
+/**
+ * SingleFlight - Implementation
+ */
+
+#include "SingleFlight.h"
+
+SingleFlight::SingleFlight() : executions(0), shared(0) {
+}
+
+std::string SingleFlight::run(const std::string& key, const std::function<std::string()>& compute) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = calls.find(key);
+    if (it != calls.end()) {
+        std::shared_ptr<Call> call = it->second;
+        shared++;
+        call->finished.wait(lock, [&call] { return call->done; });
+        if (call->error) std::rethrow_exception(call->error);
+        return call->result;
+    }
+
+    std::shared_ptr<Call> call = std::make_shared<Call>();
+    calls[key] = call;
+    executions++;
+    lock.unlock();
+
+    try {
+        call->result = compute();
+    } catch (...) {
+        call->error = std::current_exception();
+    }
+
+    lock.lock();
+    call->done = true;
+    auto current = calls.find(key);
+    if (current != calls.end() && current->second == call) {
+        calls.erase(current);
+    }
+    call->finished.notify_all();
+    lock.unlock();
+
+    if (call->error) std::rethrow_exception(call->error);
+    return call->result;
+}
+
+void SingleFlight::forget(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    calls.erase(key);
+}
+
+SingleFlightStats SingleFlight::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    SingleFlightStats stats;
+    stats.executions = executions;
+    stats.shared = shared;
+    stats.inFlight = calls.size();
+    return stats;
+}
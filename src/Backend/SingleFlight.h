@@ -0,0 +1,57 @@
+/**
+ * SingleFlight - coalescing of identical concurrent computations
+ * Callers that ask for a key while a computation for that key is running wait
+ * for it and share its result instead of repeating the work. Nothing is kept
+ * once the computation finishes, so this never serves stale data to a caller
+ * that arrives after it completes.
+ */
+
+#ifndef SINGLE_FLIGHT_H
+#define SINGLE_FLIGHT_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct SingleFlightStats {
+    unsigned long long executions;  // computations actually run
+    unsigned long long shared;      // callers served by another caller's computation
+    size_t inFlight;                // keys being computed right now
+};
+
+class SingleFlight {
+private:
+    struct Call {
+        bool done;
+        std::string result;
+        std::exception_ptr error;
+        std::condition_variable finished;
+
+        Call() : done(false) {}
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Call>> calls;
+    unsigned long long executions;
+    unsigned long long shared;
+
+public:
+    SingleFlight();
+
+    /**
+     * Run compute for key, or wait for the run already in flight for key
+     * Exceptions thrown by compute are rethrown to every caller that shared the run.
+     */
+    std::string run(const std::string& key, const std::function<std::string()>& compute);
+
+    // Detach the in-flight run for key so later callers start a fresh one (use after a write)
+    void forget(const std::string& key);
+
+    SingleFlightStats getStats() const;
+};
+
+#endif // SINGLE_FLIGHT_H
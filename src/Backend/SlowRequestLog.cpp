@@ -0,0 +1,387 @@
+/**
+ * SlowRequestLog - Implementation
+ */
+
+#include "SlowRequestLog.h"
+#include "Timestamp.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+struct RequestTrace {
+    bool active;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point lastMark;
+    SlowRequestStage stages[SlowRequestLog::MAX_STAGES];
+    size_t stageCount;
+    std::string userId;
+};
+
+thread_local RequestTrace currentTrace = {};
+
+long long elapsedUs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+void appendEscaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+void appendMs(std::string& out, long long us) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", us / 1000.0);
+    out += buffer;
+}
+
+std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(start, end - start + 1);
+}
+
+double burnRate(unsigned long long requests, unsigned long long slow, double objective) {
+    if (requests == 0 || objective >= 1.0) return 0.0;
+    return (static_cast<double>(slow) / requests) / (1.0 - objective);
+}
+
+} // namespace
+
+SlowRequestLog::SlowRequestLog() : fileBytes(0), recordedCount(0), fileErrorCount(0) {
+    configure(SlowRequestLogConfig());
+}
+
+void SlowRequestLog::configure(const SlowRequestLogConfig& newConfig) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    config = newConfig;
+    if (config.objective <= 0.0 || config.objective >= 1.0) {
+        config.objective = 0.99;
+    }
+
+    routes.clear();
+    routeLookup.clear();
+    routes.emplace_back(new RouteState("*", config.defaultBudgetMs * 1000));
+    for (const auto& entry : config.routeBudgetsMs) {
+        routeLookup[entry.first] = routes.size();
+        routes.emplace_back(new RouteState(entry.first, entry.second * 1000));
+    }
+
+    while (ring.size() > config.ringCapacity) {
+        ring.pop_back();
+    }
+    if (file.is_open()) {
+        file.close();
+    }
+    fileBytes = 0;
+}
+
+const SlowRequestLogConfig& SlowRequestLog::getConfig() const {
+    return config;
+}
+
+bool SlowRequestLog::parseRouteBudgets(const std::string& spec, std::map<std::string, long long>& budgetsMs) {
+    std::map<std::string, long long> parsed;
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ',')) {
+        entry = trim(entry);
+        if (entry.empty()) continue;
+
+        size_t colon = entry.find_last_of(':');
+        if (colon == std::string::npos) return false;
+        std::string route = trim(entry.substr(0, colon));
+        std::string budget = trim(entry.substr(colon + 1));
+
+        size_t space = route.find(' ');
+        if (space == std::string::npos || space == 0) return false;
+        std::string method = route.substr(0, space);
+        std::string pattern = trim(route.substr(space + 1));
+        if (pattern.empty() || pattern[0] != '/') return false;
+
+        if (budget.empty() || budget.find_first_not_of("0123456789") != std::string::npos) return false;
+        long long ms = 0;
+        try {
+            ms = std::stoll(budget);
+        } catch (...) {
+            return false;
+        }
+        if (ms <= 0) return false;
+        parsed[method + " " + pattern] = ms;
+    }
+    budgetsMs = parsed;
+    return true;
+}
+
+void SlowRequestLog::begin() {
+    RequestTrace& trace = currentTrace;
+    trace.active = true;
+    trace.start = std::chrono::steady_clock::now();
+    trace.lastMark = trace.start;
+    trace.stageCount = 0;
+    trace.userId.clear();
+}
+
+void SlowRequestLog::mark(const char* stage) {
+    RequestTrace& trace = currentTrace;
+    if (!trace.active) return;
+    auto now = std::chrono::steady_clock::now();
+    if (trace.stageCount < MAX_STAGES) {
+        trace.stages[trace.stageCount++] = {stage, elapsedUs(trace.lastMark, now)};
+    } else {
+        // Out of slots - fold into the last stage so the stages still add up
+        trace.stages[MAX_STAGES - 1].durationUs += elapsedUs(trace.lastMark, now);
+    }
+    trace.lastMark = now;
+}
+
+void SlowRequestLog::setUser(const std::string& userId) {
+    RequestTrace& trace = currentTrace;
+    if (trace.active) trace.userId = userId;
+}
+
+SlowRequestLog::RouteState& SlowRequestLog::routeFor(const std::string& method, const std::string& routePattern) const {
+    if (routeLookup.empty() || routePattern.empty()) return *routes[0];
+    thread_local std::string key;
+    key.assign(method);
+    key += ' ';
+    key += routePattern;
+    auto it = routeLookup.find(key);
+    return it == routeLookup.end() ? *routes[0] : *routes[it->second];
+}
+
+void SlowRequestLog::count(RouteState& route, long long nowMs, bool isSlow) {
+    long long minute = nowMs / 60000;
+    Bucket& bucket = route.buckets[minute % WINDOW_MINUTES];
+    long long seen = bucket.minute.load(std::memory_order_relaxed);
+    if (seen != minute && bucket.minute.compare_exchange_strong(seen, minute)) {
+        bucket.requests.store(0, std::memory_order_relaxed);
+        bucket.slow.store(0, std::memory_order_relaxed);
+    }
+    route.requests.fetch_add(1, std::memory_order_relaxed);
+    bucket.requests.fetch_add(1, std::memory_order_relaxed);
+    if (isSlow) {
+        route.slow.fetch_add(1, std::memory_order_relaxed);
+        bucket.slow.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool SlowRequestLog::finish(const std::string& method, const std::string& routePattern, const std::string& path,
+                            int status, size_t requestBytes, size_t responseBytes) {
+    RequestTrace& trace = currentTrace;
+    if (!trace.active) return false;
+    trace.active = false;
+
+    auto now = std::chrono::steady_clock::now();
+    long long durationUs = elapsedUs(trace.start, now);
+    RouteState& route = routeFor(method, routePattern);
+    if (durationUs <= route.budgetUs) {
+        // Fast path: counters only
+        count(route, Timestamp::nowMs(), false);
+        return false;
+    }
+
+    std::vector<SlowRequestStage> stages(trace.stages, trace.stages + trace.stageCount);
+    stages.push_back({"handler", elapsedUs(trace.lastMark, now)});
+    return record(method, routePattern, path, status, durationUs, trace.userId,
+                  requestBytes, responseBytes, stages, Timestamp::nowMs());
+}
+
+bool SlowRequestLog::record(const std::string& method, const std::string& routePattern, const std::string& path,
+                            int status, long long durationUs, const std::string& userId,
+                            size_t requestBytes, size_t responseBytes,
+                            const std::vector<SlowRequestStage>& stages, long long nowMs) {
+    RouteState& route = routeFor(method, routePattern);
+    bool isSlow = durationUs > route.budgetUs;
+    count(route, nowMs, isSlow);
+    if (!isSlow) return false;
+
+    SlowRequest entry;
+    entry.timestampMs = nowMs;
+    entry.method = method;
+    entry.path = path;
+    entry.route = method + " " + (routePattern.empty() ? path : routePattern);
+    entry.status = status;
+    entry.durationUs = durationUs;
+    entry.budgetUs = route.budgetUs;
+    entry.userHash = userId.empty() ? "" : hashUserId(userId);
+    entry.requestBytes = requestBytes;
+    entry.responseBytes = responseBytes;
+    entry.stages = stages;
+
+    std::string line = config.filePath.empty() ? "" : toJsonLine(entry);
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    recordedCount.fetch_add(1, std::memory_order_relaxed);
+    if (config.ringCapacity > 0) {
+        if (ring.size() >= config.ringCapacity) {
+            ring.pop_back();
+        }
+        ring.push_front(std::move(entry));
+    }
+    if (!line.empty()) {
+        appendToFile(line);
+    }
+    return true;
+}
+
+std::vector<SlowRequest> SlowRequestLog::recent(size_t limit) const {
+    std::lock_guard<std::mutex> lock(logMutex);
+    size_t count = std::min(limit, ring.size());
+    return std::vector<SlowRequest>(ring.begin(), ring.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+std::vector<RouteSloStats> SlowRequestLog::stats(long long nowMs) const {
+    long long currentMinute = nowMs / 60000;
+    std::vector<RouteSloStats> result;
+    result.reserve(routes.size());
+    for (const auto& route : routes) {
+        RouteSloStats entry;
+        entry.route = route->route;
+        entry.budgetMs = route->budgetUs / 1000;
+        entry.requests = route->requests.load(std::memory_order_relaxed);
+        entry.slow = route->slow.load(std::memory_order_relaxed);
+        entry.requests5m = entry.slow5m = entry.requests1h = entry.slow1h = 0;
+        for (const auto& bucket : route->buckets) {
+            long long age = currentMinute - bucket.minute.load(std::memory_order_relaxed);
+            if (age < 0 || age >= static_cast<long long>(WINDOW_MINUTES)) continue;
+            unsigned long long requests = bucket.requests.load(std::memory_order_relaxed);
+            unsigned long long slow = bucket.slow.load(std::memory_order_relaxed);
+            entry.requests1h += requests;
+            entry.slow1h += slow;
+            if (age < 5) {
+                entry.requests5m += requests;
+                entry.slow5m += slow;
+            }
+        }
+        entry.burnRate5m = burnRate(entry.requests5m, entry.slow5m, config.objective);
+        entry.burnRate1h = burnRate(entry.requests1h, entry.slow1h, config.objective);
+        result.push_back(entry);
+    }
+    return result;
+}
+
+unsigned long long SlowRequestLog::recorded() const {
+    return recordedCount.load(std::memory_order_relaxed);
+}
+
+unsigned long long SlowRequestLog::fileErrors() const {
+    return fileErrorCount.load(std::memory_order_relaxed);
+}
+
+std::string SlowRequestLog::hashUserId(const std::string& userId) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned char c : userId) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", hash);
+    return buffer;
+}
+
+std::string SlowRequestLog::toJsonLine(const SlowRequest& entry) {
+    std::string line;
+    line.reserve(256);
+    line += "{\"timestamp\":\"";
+    line += Timestamp::formatIso8601(entry.timestampMs);
+    line += "\",\"method\":\"";
+    appendEscaped(line, entry.method);
+    line += "\",\"path\":\"";
+    appendEscaped(line, entry.path);
+    line += "\",\"route\":\"";
+    appendEscaped(line, entry.route);
+    line += "\",\"status\":";
+    line += std::to_string(entry.status);
+    line += ",\"durationMs\":";
+    appendMs(line, entry.durationUs);
+    line += ",\"budgetMs\":";
+    appendMs(line, entry.budgetUs);
+    line += ",\"user\":\"";
+    line += entry.userHash;
+    line += "\",\"requestBytes\":";
+    line += std::to_string(entry.requestBytes);
+    line += ",\"responseBytes\":";
+    line += std::to_string(entry.responseBytes);
+    line += ",\"stages\":[";
+    for (size_t i = 0; i < entry.stages.size(); ++i) {
+        if (i > 0) line += ',';
+        line += "{\"name\":\"";
+        appendEscaped(line, entry.stages[i].name ? entry.stages[i].name : "");
+        line += "\",\"ms\":";
+        appendMs(line, entry.stages[i].durationUs);
+        line += '}';
+    }
+    line += "]}";
+    return line;
+}
+
+// Caller holds logMutex
+bool SlowRequestLog::openFile() {
+    file.open(config.filePath, std::ios::out | std::ios::app);
+    if (!file.is_open()) return false;
+    file.seekp(0, std::ios::end);
+    std::streamoff size = file.tellp();
+    fileBytes = size > 0 ? static_cast<size_t>(size) : 0;
+    return true;
+}
+
+// Caller holds logMutex: path -> path.1 -> ... -> path.N (oldest dropped)
+void SlowRequestLog::rotateFile() {
+    file.close();
+    if (config.maxFiles == 0) {
+        std::remove(config.filePath.c_str());
+    } else {
+        std::remove((config.filePath + "." + std::to_string(config.maxFiles)).c_str());
+        for (size_t i = config.maxFiles; i > 1; --i) {
+            std::rename((config.filePath + "." + std::to_string(i - 1)).c_str(),
+                        (config.filePath + "." + std::to_string(i)).c_str());
+        }
+        std::rename(config.filePath.c_str(), (config.filePath + ".1").c_str());
+    }
+    fileBytes = 0;
+}
+
+// Caller holds logMutex
+void SlowRequestLog::appendToFile(const std::string& line) {
+    if (!file.is_open() && !openFile()) {
+        if (fileErrorCount.fetch_add(1, std::memory_order_relaxed) == 0) {
+            std::cerr << "SlowRequestLog: Could not open " << config.filePath << std::endl;
+        }
+        return;
+    }
+    if (config.maxFileBytes > 0 && fileBytes > 0 && fileBytes + line.size() + 1 > config.maxFileBytes) {
+        rotateFile();
+        if (!openFile()) {
+            fileErrorCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    file << line << '\n';
+    file.flush();
+    if (!file) {
+        fileErrorCount.fetch_add(1, std::memory_order_relaxed);
+        file.close();
+        return;
+    }
+    fileBytes += line.size() + 1;
+}
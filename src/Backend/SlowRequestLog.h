@@ -0,0 +1,158 @@
+/**
+ * SlowRequestLog - per-route latency SLOs with a tail-sampled slow request log
+ * Every request is timed against its route's latency budget. Only requests that
+ * exceed the budget are recorded (stage timings, hashed user id, payload sizes)
+ * into a bounded in-memory ring and an optional size-rotated JSON-lines file.
+ * Requests within budget only pay for a few clock reads and atomic counter
+ * increments, which also feed the error-budget burn rate per route.
+ */
+
+#ifndef SLOW_REQUEST_LOG_H
+#define SLOW_REQUEST_LOG_H
+
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct SlowRequestStage {
+    const char* name;   // string literal passed to mark()
+    long long durationUs;
+};
+
+struct SlowRequest {
+    long long timestampMs;
+    std::string method;
+    std::string path;
+    std::string route;      // "METHOD pattern" the request was matched against
+    int status;
+    long long durationUs;
+    long long budgetUs;
+    std::string userHash;   // hashUserId() of the authenticated user, empty if anonymous
+    size_t requestBytes;
+    size_t responseBytes;
+    std::vector<SlowRequestStage> stages;
+};
+
+struct SlowRequestLogConfig {
+    long long defaultBudgetMs;
+    std::map<std::string, long long> routeBudgetsMs; // "METHOD pattern" -> budget
+    double objective;        // fraction of requests expected within budget, e.g. 0.99
+    size_t ringCapacity;
+    std::string filePath;    // empty disables the file
+    size_t maxFileBytes;
+    size_t maxFiles;         // rotated files kept (path.1 ... path.N)
+
+    SlowRequestLogConfig()
+        : defaultBudgetMs(500), objective(0.99), ringCapacity(256),
+          maxFileBytes(10 * 1024 * 1024), maxFiles(3) {}
+};
+
+struct RouteSloStats {
+    std::string route;      // "*" collects routes without their own budget
+    long long budgetMs;
+    unsigned long long requests;
+    unsigned long long slow;
+    unsigned long long requests5m;
+    unsigned long long slow5m;
+    unsigned long long requests1h;
+    unsigned long long slow1h;
+    double burnRate5m;      // slow fraction / (1 - objective); 1.0 spends the budget exactly
+    double burnRate1h;
+};
+
+class SlowRequestLog {
+public:
+    static const size_t MAX_STAGES = 8;
+
+    SlowRequestLog();
+
+    // Not synchronized with record() - call before requests are served
+    void configure(const SlowRequestLogConfig& config);
+    const SlowRequestLogConfig& getConfig() const;
+
+    /**
+     * Parse "METHOD pattern:ms,METHOD pattern:ms", e.g. "POST /api/cart/checkout:1000,GET /api/search:200"
+     * @return false (budgets untouched) if any entry is malformed
+     */
+    static bool parseRouteBudgets(const std::string& spec, std::map<std::string, long long>& budgetsMs);
+
+    // Per-request trace for the calling thread: begin() when the request arrives,
+    // mark() after each stage (time since the previous mark), finish() once handled
+    static void begin();
+    static void mark(const char* stage);
+    static void setUser(const std::string& userId);
+
+    /**
+     * Close the calling thread's trace; time since the last mark becomes the "handler" stage
+     * @return true if the request was over budget and recorded
+     */
+    bool finish(const std::string& method, const std::string& routePattern, const std::string& path,
+                int status, size_t requestBytes, size_t responseBytes);
+
+    /**
+     * Account one request; the slow path behind finish(), usable directly with explicit timings
+     * @return true if the request was over budget and recorded
+     */
+    bool record(const std::string& method, const std::string& routePattern, const std::string& path,
+                int status, long long durationUs, const std::string& userId,
+                size_t requestBytes, size_t responseBytes,
+                const std::vector<SlowRequestStage>& stages, long long nowMs);
+
+    // Most recent slow requests, newest first
+    std::vector<SlowRequest> recent(size_t limit) const;
+    std::vector<RouteSloStats> stats(long long nowMs) const;
+    unsigned long long recorded() const;
+    unsigned long long fileErrors() const;
+
+    // Stable, non-reversible identifier for logs (FNV-1a, 16 hex digits)
+    static std::string hashUserId(const std::string& userId);
+    static std::string toJsonLine(const SlowRequest& entry);
+
+private:
+    static const size_t WINDOW_MINUTES = 60;
+
+    // One minute of counts; reset by whichever thread first sees a new minute,
+    // so totals are approximate right at minute boundaries
+    struct Bucket {
+        std::atomic<long long> minute;
+        std::atomic<unsigned long long> requests;
+        std::atomic<unsigned long long> slow;
+        Bucket() : minute(-1), requests(0), slow(0) {}
+    };
+
+    struct RouteState {
+        std::string route;
+        long long budgetUs;
+        std::atomic<unsigned long long> requests;
+        std::atomic<unsigned long long> slow;
+        Bucket buckets[WINDOW_MINUTES];
+        RouteState(const std::string& route, long long budgetUs)
+            : route(route), budgetUs(budgetUs), requests(0), slow(0) {}
+    };
+
+    SlowRequestLogConfig config;
+    // Index 0 is the "*" default route; the lookup map is read-only once configured
+    std::vector<std::unique_ptr<RouteState>> routes;
+    std::unordered_map<std::string, size_t> routeLookup;
+
+    mutable std::mutex logMutex; // guards ring and file
+    std::deque<SlowRequest> ring;
+    std::ofstream file;
+    size_t fileBytes;
+    std::atomic<unsigned long long> recordedCount;
+    std::atomic<unsigned long long> fileErrorCount;
+
+    RouteState& routeFor(const std::string& method, const std::string& routePattern) const;
+    static void count(RouteState& route, long long nowMs, bool isSlow);
+    void appendToFile(const std::string& line);
+    bool openFile();
+    void rotateFile();
+};
+
+#endif // SLOW_REQUEST_LOG_H
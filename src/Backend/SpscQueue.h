@@ -0,0 +1,77 @@
+/**
+ * SpscQueue - bounded lock-free single-producer / single-consumer ring buffer
+ * One thread pushes and one thread pops. Head and tail live on separate cache
+ * lines and each side caches the other's index, so the only shared traffic is
+ * one line per index when the cached copy runs out.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+template <typename T>
+class SpscQueue {
+private:
+    static const size_t CACHE_LINE = 64;
+
+    std::vector<T> slots;
+    size_t mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> head; // next slot to pop, written by the consumer
+    size_t cachedTail;                            // consumer's last view of tail
+
+    alignas(CACHE_LINE) std::atomic<size_t> tail; // next slot to push, written by the producer
+    size_t cachedHead;                            // producer's last view of head
+
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity)
+        : slots(roundUp(capacity)), mask(slots.size() - 1), head(0), cachedTail(0), tail(0), cachedHead(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. @return false if the queue is full
+    bool tryPush(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == slots.size()) return false;
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. @return false if the queue is empty
+    bool tryPop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either side; only a hint while the other side is running
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return slots.size();
+    }
+};
+
+#endif // SPSC_QUEUE_H
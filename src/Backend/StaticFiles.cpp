@@ -0,0 +1,116 @@
+/**
+ * StaticFiles - Implementation
+ */
+
+#include "StaticFiles.h"
+#include "IoUring.h"
+#include <cerrno>
+#include <memory>
+#include <sys/stat.h>
+
+namespace {
+
+// This thread's ring; reopened if a StaticFiles with another buffer size uses it
+thread_local std::unique_ptr<IoUring> threadRing;
+
+bool isSafePath(const std::string& urlPath) {
+    if (urlPath.empty() || urlPath[0] != '/') return false;
+    size_t start = 1;
+    while (start <= urlPath.size()) {
+        size_t end = urlPath.find('/', start);
+        if (end == std::string::npos) end = urlPath.size();
+        std::string segment = urlPath.substr(start, end - start);
+        if (segment == ".." || segment.find('\\') != std::string::npos ||
+            segment.find('\0') != std::string::npos) {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+} // namespace
+
+StaticFiles::StaticFiles()
+    : bufferBytes(DEFAULT_BUFFER_BYTES), useIoUring(false), loaded(0), mapped(0), notFound(0), enters(0),
+      rings(0), fixedBuffers(true) {}
+
+void StaticFiles::configure(const std::string& rootDirectory, bool ioUring, size_t bytes) {
+    root = rootDirectory;
+    bufferBytes = bytes;
+    useIoUring = ioUring && bytes > 0 && IoUring::isSupported();
+}
+
+bool StaticFiles::isIoUringActive() const {
+    return useIoUring;
+}
+
+StaticFileStatus StaticFiles::statPath(const std::string& path) const {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return StaticFileStatus::NotFound;
+    if ((info.st_mode & S_IFMT) == S_IFDIR) return StaticFileStatus::Directory;
+    return (info.st_mode & S_IFMT) == S_IFREG ? StaticFileStatus::Mapped : StaticFileStatus::NotFound;
+}
+
+StaticFile StaticFiles::lookup(const std::string& urlPath) {
+    StaticFile file;
+    if (!isSafePath(urlPath)) {
+        notFound++;
+        return file;
+    }
+    file.path = root + urlPath;
+    if (file.path.back() == '/') file.path += "index.html";
+
+    IoUring* ring = nullptr;
+    if (useIoUring) {
+        if (!threadRing || !threadRing->isOpen() || threadRing->getBufferSize() != bufferBytes) {
+            if (!threadRing) threadRing.reset(new IoUring());
+            if (threadRing->open(bufferBytes)) {
+                rings++;
+                if (!threadRing->hasFixedBuffer()) fixedBuffers = false;
+            }
+        }
+        if (threadRing->isOpen()) ring = threadRing.get();
+    }
+
+    if (ring) {
+        const char* data = nullptr;
+        size_t entersBefore = ring->getEnters();
+        long bytes = ring->readFile(file.path, data);
+        enters += ring->getEnters() - entersBefore;
+        if (bytes >= 0 && static_cast<size_t>(bytes) < ring->getBufferSize()) {
+            file.status = StaticFileStatus::Loaded;
+            file.body.assign(data, static_cast<size_t>(bytes));
+            loaded++;
+            return file;
+        }
+        if (bytes == -EISDIR) {
+            file.status = StaticFileStatus::Directory;
+            return file;
+        }
+        if (bytes < 0 && bytes != -EIO) {
+            notFound++;
+            return file;
+        }
+        // Fills the buffer (a large asset), or the ring failed: leave it to the mmap path
+    }
+
+    file.status = statPath(file.path);
+    if (file.status == StaticFileStatus::Mapped) {
+        mapped++;
+    } else if (file.status == StaticFileStatus::NotFound) {
+        notFound++;
+    }
+    return file;
+}
+
+StaticFilesStats StaticFiles::getStats() const {
+    StaticFilesStats stats;
+    stats.mode = !useIoUring ? "mmap" : (fixedBuffers ? "io_uring+fixed-buffers" : "io_uring");
+    stats.loaded = loaded;
+    stats.mapped = mapped;
+    stats.notFound = notFound;
+    stats.enters = enters;
+    stats.rings = rings;
+    return stats;
+}
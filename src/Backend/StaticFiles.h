@@ -0,0 +1,77 @@
+/**
+ * StaticFiles - reads ./public assets through io_uring
+ * Each HTTP worker thread gets its own IoUring the first time it serves a
+ * file, and reads the whole file with one io_uring_enter (see IoUring). Files
+ * that do not fit the ring's buffer are left to the server's mmap path
+ * (Mapped), which sends them straight from the page cache without a copy
+ * into the heap. Where io_uring is unsupported every file is Mapped.
+ */
+
+#ifndef STATIC_FILES_H
+#define STATIC_FILES_H
+
+#include <atomic>
+#include <string>
+
+enum class StaticFileStatus {
+    Loaded,    // body holds the whole file
+    Mapped,    // serve path from the file system (too large for the ring buffer, or no ring)
+    Directory, // redirect to the path with a trailing slash
+    NotFound   // missing, unreadable, or outside the root
+};
+
+struct StaticFile {
+    StaticFileStatus status;
+    std::string path; // file system path, for Mapped
+    std::string body; // for Loaded
+
+    StaticFile() : status(StaticFileStatus::NotFound) {}
+};
+
+struct StaticFilesStats {
+    std::string mode;              // "io_uring+fixed-buffers", "io_uring", or "mmap"
+    unsigned long long loaded;     // files read through a ring
+    unsigned long long mapped;     // files left to the mmap path
+    unsigned long long notFound;
+    unsigned long long enters;     // io_uring_enter calls made for those reads
+    size_t rings;                  // rings opened by worker threads
+};
+
+class StaticFiles {
+private:
+    std::string root;
+    size_t bufferBytes;
+    bool useIoUring;
+    std::atomic<unsigned long long> loaded;
+    std::atomic<unsigned long long> mapped;
+    std::atomic<unsigned long long> notFound;
+    std::atomic<unsigned long long> enters;
+    std::atomic<size_t> rings;
+    std::atomic<bool> fixedBuffers;
+
+    StaticFileStatus statPath(const std::string& path) const;
+
+public:
+    static const size_t DEFAULT_BUFFER_BYTES = 256 * 1024;
+
+    StaticFiles();
+
+    /**
+     * Serve files under root. With useIoUring false, or when the kernel does not
+     * support it, every file found is Mapped.
+     */
+    void configure(const std::string& root, bool useIoUring, size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+
+    // True when files are being read through io_uring
+    bool isIoUringActive() const;
+
+    /**
+     * Look up a request path such as "/" or "/store.js" ("/" serves index.html).
+     * Paths with "..", backslashes or NUL bytes are NotFound.
+     */
+    StaticFile lookup(const std::string& urlPath);
+
+    StaticFilesStats getStats() const;
+};
+
+#endif // STATIC_FILES_H
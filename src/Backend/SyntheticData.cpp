@@ -0,0 +1,245 @@
+/**
+ * SyntheticData - Implementation
+ */
+
+#include "SyntheticData.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+namespace {
+
+// Independent streams, so adding users does not change the catalog or the orders
+const std::uint64_t PRODUCT_STREAM = 1;
+const std::uint64_t USER_STREAM = 2;
+const std::uint64_t ORDER_STREAM = 3;
+
+// SplitMix64: tiny, fast and fully specified, unlike the std distributions,
+// whose output differs between standard libraries
+class Random {
+private:
+    std::uint64_t state;
+
+public:
+    Random(std::uint64_t seed, std::uint64_t stream, std::uint64_t index)
+        : state(seed ^ (stream * 0x9e3779b97f4a7c15ULL) ^ (index * 0xd1b54a32d192ed03ULL)) {
+        next();
+    }
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1)
+    double uniform() {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    size_t below(size_t n) {
+        return static_cast<size_t>(next() % n);
+    }
+
+    bool chance(double probability) {
+        return uniform() < probability;
+    }
+
+    // Geometric count (0, 1, 2, ...) with the given mean
+    size_t count(double mean) {
+        if (mean <= 0.0) return 0;
+        double p = 1.0 / (1.0 + mean);
+        return static_cast<size_t>(std::floor(std::log(1.0 - uniform()) / std::log(1.0 - p)));
+    }
+
+    // Standard normal (Box-Muller)
+    double normal() {
+        double u = 1.0 - uniform();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * uniform());
+    }
+};
+
+struct ProductKind {
+    const char* noun;
+    double basePrice;
+    const char* feature;
+};
+
+const ProductKind KINDS[] = {
+    {"Laptop", 999.0, "16GB RAM and a fast SSD"},
+    {"Mouse", 29.0, "long battery life"},
+    {"Keyboard", 79.0, "hot-swappable switches"},
+    {"Monitor", 299.0, "an IPS panel with wide color coverage"},
+    {"USB-C Hub", 49.0, "HDMI and an SD card reader"},
+    {"Monitor Stand", 39.0, "built-in cable management"},
+    {"Webcam", 79.0, "a built-in microphone"},
+    {"Laptop Stand", 59.0, "adjustable height"},
+    {"Cable", 19.0, "braided jacket and reinforced ends"},
+    {"Headset", 149.0, "surround sound"},
+    {"External Drive", 89.0, "2TB of storage"},
+    {"Charger", 34.0, "fast charging"},
+    {"Laptop Sleeve", 24.0, "padded protection"},
+    {"Speaker", 69.0, "deep bass"},
+    {"Microphone", 119.0, "a cardioid pickup pattern"},
+    {"Docking Station", 189.0, "dual display support"},
+    {"Router", 129.0, "Wi-Fi 6"},
+    {"Mouse Pad", 19.0, "a stitched edge"},
+};
+
+const char* const STYLES[] = {"Wireless", "Ergonomic", "Compact", "Pro", "Ultra", "Portable",
+                              "Slim", "Gaming", "Travel", "Studio", "Silent", "Premium"};
+
+const char* const FIRST_NAMES[] = {"Ada", "Grace", "Alan", "Edsger", "Barbara", "Donald", "Frances",
+                                   "Ken", "Margaret", "Dennis", "Radia", "Linus", "Sophie", "John"};
+const char* const LAST_NAMES[] = {"Lovelace", "Hopper", "Turing", "Dijkstra", "Liskov", "Knuth", "Allen",
+                                  "Thompson", "Hamilton", "Ritchie", "Perlman", "Torvalds", "Wilson"};
+const char* const BIOS[] = {
+    "Always upgrading my desk setup.",
+    "Remote developer, coffee enthusiast.",
+    "Buying gear for the whole team.",
+    "Gamer and part-time streamer. Reviews everything I buy.",
+    "Photographer who needs a lot of storage.",
+};
+
+template <typename T, size_t N>
+size_t countOf(const T (&)[N]) {
+    return N;
+}
+
+std::string productId(size_t index) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "ITEM%06zu", index + 1);
+    return buffer;
+}
+
+CatalogItem makeProduct(std::uint64_t seed, size_t index) {
+    Random random(seed, PRODUCT_STREAM, index);
+    const ProductKind& kind = KINDS[random.below(countOf(KINDS))];
+    const char* style = STYLES[random.below(countOf(STYLES))];
+    unsigned int model = 100 + static_cast<unsigned int>(random.below(900));
+
+    // Log-normal around the kind's base price, ending in .99
+    double price = kind.basePrice * std::exp(0.35 * random.normal());
+    price = std::max(1.0, std::floor(price)) + 0.99;
+
+    std::string name = std::string(style) + " " + kind.noun + " " + std::to_string(model);
+    std::string description = std::string(style) + " " + kind.noun + " with " + kind.feature;
+    return CatalogItem(productId(index), name, price, description);
+}
+
+unsigned int quantity(Random& random) {
+    return 1 + static_cast<unsigned int>(random.count(0.3));
+}
+
+} // namespace
+
+ZipfSampler::ZipfSampler(size_t n, double exponent) {
+    cumulative.reserve(n);
+    double total = 0.0;
+    for (size_t rank = 0; rank < n; ++rank) {
+        total += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+        cumulative.push_back(total);
+    }
+}
+
+size_t ZipfSampler::sample(double uniform) const {
+    if (cumulative.empty()) return 0;
+    double target = uniform * cumulative.back();
+    size_t rank = static_cast<size_t>(std::upper_bound(cumulative.begin(), cumulative.end(), target) -
+                                      cumulative.begin());
+    return std::min(rank, cumulative.size() - 1);
+}
+
+SyntheticData::SyntheticData(const SyntheticDataConfig& config)
+    : config(config), productPopularity(config.products, config.productSkew),
+      userActivity(config.users, config.userSkew) {
+    catalog.reserve(config.products);
+    for (size_t i = 0; i < config.products; ++i) {
+        catalog.push_back(makeProduct(config.seed, i));
+    }
+}
+
+const SyntheticDataConfig& SyntheticData::getConfig() const {
+    return config;
+}
+
+const std::vector<CatalogItem>& SyntheticData::getCatalog() const {
+    return catalog;
+}
+
+UserRef SyntheticData::user(size_t index) const {
+    Random random(config.seed, USER_STREAM, index);
+    std::string id = std::to_string(config.firstUserId + index);
+
+    UserProfile profile;
+    profile.id = id;
+    profile.username = "user" + id;
+    profile.email = profile.username + "@example.com";
+    profile.password = "pass" + id;
+    if (random.chance(0.6)) {
+        profile.fullName = std::string(FIRST_NAMES[random.below(countOf(FIRST_NAMES))]) + " " +
+                           LAST_NAMES[random.below(countOf(LAST_NAMES))];
+    }
+    if (random.chance(0.1)) {
+        profile.bio = BIOS[random.below(countOf(BIOS))];
+    }
+    UserRef user = UserSnapshot::create(std::move(profile));
+    if (catalog.empty()) return user;
+
+    std::vector<PurchaseRecord> purchases;
+    size_t pastOrders = random.count(config.meanPastOrders);
+    for (size_t order = 0; order < pastOrders; ++order) {
+        size_t lines = 1 + random.count(config.meanOrderLines - 1.0);
+        for (size_t line = 0; line < lines; ++line) {
+            const CatalogItem& product = catalog[productPopularity.sample(random.uniform())];
+            purchases.push_back(PurchaseRecord(product.id, product.name, product.price, quantity(random)));
+        }
+    }
+    if (!purchases.empty()) {
+        user = user->withPurchases(purchases);
+    }
+
+    if (random.chance(config.cartShare)) {
+        Cart cart;
+        size_t lines = 1 + random.count(config.meanCartLines - 1.0);
+        for (size_t line = 0; line < lines; ++line) {
+            size_t slot = productPopularity.sample(random.uniform());
+            const CatalogItem& product = catalog[slot];
+            CartItem item(product.id, product.name, product.price, quantity(random));
+            item.catalogSlot = static_cast<unsigned int>(slot);
+            cart.addItem(item);
+        }
+        // Unknown age: the cart sweeper never expires it
+        cart.setLastTouched(0);
+        user = user->withCart(std::move(cart));
+    }
+    return user;
+}
+
+SyntheticOrder SyntheticData::order(size_t index) const {
+    Random random(config.seed, ORDER_STREAM, index);
+    SyntheticOrder order;
+    order.orderId = index + 1;
+
+    std::string id = std::to_string(config.firstUserId + userActivity.sample(random.uniform()));
+    order.userId = id;
+    order.username = "user" + id;
+
+    double intervalMs = config.ordersPerSecond > 0.0 ? 1000.0 / config.ordersPerSecond : 0.0;
+    order.timestampMs = config.startMs + static_cast<long long>((static_cast<double>(index) + random.uniform()) * intervalMs);
+
+    if (!catalog.empty()) {
+        size_t lines = 1 + random.count(config.meanOrderLines - 1.0);
+        for (size_t line = 0; line < lines; ++line) {
+            size_t slot = productPopularity.sample(random.uniform());
+            const CatalogItem& product = catalog[slot];
+            CartItem item(product.id, product.name, product.price, quantity(random));
+            item.catalogSlot = static_cast<unsigned int>(slot);
+            order.lines.push_back(item);
+        }
+    }
+    return order;
+}
@@ -0,0 +1,86 @@
+/**
+ * SyntheticData - deterministic catalogs, users and orders for load tests
+ * Product popularity and how often a user orders both follow Zipf
+ * distributions, so a few products and users account for most of the traffic,
+ * as in a real shop. Every product, user and order is generated from the seed
+ * and its own index alone: any one of them can be regenerated without the
+ * others, and the same seed gives the same data on every platform.
+ * Used by the datagen tool (tools/datagen.cpp).
+ */
+
+#ifndef SYNTHETIC_DATA_H
+#define SYNTHETIC_DATA_H
+
+#include <string>
+#include <vector>
+#include "Catalog.h"
+#include "UserSnapshot.h"
+
+struct SyntheticDataConfig {
+    unsigned long long seed;
+    size_t products;
+    size_t users;
+    double productSkew;              // Zipf exponent of product popularity
+    double userSkew;                 // Zipf exponent of how often each user orders
+    double cartShare;                // fraction of users with items in their cart
+    double meanCartLines;            // lines in a non-empty cart
+    double meanPastOrders;           // orders already in each user's purchase history
+    double meanOrderLines;           // lines per order
+    unsigned long long firstUserId;  // the server seeds testuser as id 1
+    long long startMs;               // timestamp of the first order in the stream
+    double ordersPerSecond;          // arrival rate of the order stream
+
+    SyntheticDataConfig()
+        : seed(1), products(1000), users(10000), productSkew(1.0), userSkew(0.8), cartShare(0.3),
+          meanCartLines(2.5), meanPastOrders(3.0), meanOrderLines(2.0), firstUserId(2),
+          startMs(1767225600000LL), ordersPerSecond(100.0) {}
+};
+
+struct SyntheticOrder {
+    unsigned long long orderId; // 1-based position in the stream
+    std::string userId;
+    std::string username;
+    long long timestampMs;
+    std::vector<CartItem> lines;
+};
+
+// Samples ranks 0..n-1 with probability proportional to 1 / (rank + 1)^exponent
+class ZipfSampler {
+private:
+    std::vector<double> cumulative;
+
+public:
+    ZipfSampler(size_t n, double exponent);
+
+    // uniform is in [0, 1); rank 0 is the most likely
+    size_t sample(double uniform) const;
+};
+
+class SyntheticData {
+private:
+    SyntheticDataConfig config;
+    std::vector<CatalogItem> catalog; // by popularity: ITEM000001 is the best seller
+    ZipfSampler productPopularity;
+    ZipfSampler userActivity;
+
+public:
+    explicit SyntheticData(const SyntheticDataConfig& config);
+
+    const SyntheticDataConfig& getConfig() const;
+    const std::vector<CatalogItem>& getCatalog() const;
+
+    /**
+     * User `index` (0-based): id firstUserId + index, username "user<id>", password
+     * "pass<id>", email "user<id>@example.com", plus a cart and purchase history
+     * of products drawn by popularity
+     */
+    UserRef user(size_t index) const;
+
+    /**
+     * Order `index` of the stream: placed by a user drawn by activity, at an even
+     * rate of ordersPerSecond (with jitter) from startMs
+     */
+    SyntheticOrder order(size_t index) const;
+};
+
+#endif // SYNTHETIC_DATA_H
@@ -0,0 +1,214 @@
+/**
+ * ThreadAffinity - Implementation
+ */
+
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/types.h>
+#endif
+
+namespace {
+
+#if defined(__linux__)
+bool currentMask(std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) return false;
+    cpus.clear();
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+    return true;
+}
+
+// Directory entries of path, without "." and ".."
+std::vector<std::string> listDirectory(const std::string& path) {
+    std::vector<std::string> names;
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return names;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") names.push_back(name);
+    }
+    closedir(dir);
+    return names;
+}
+
+// Field 39 of /proc/<pid>/task/<tid>/stat: the CPU the thread last ran on
+int lastCpuOf(const std::string& tid) {
+    std::ifstream file("/proc/self/task/" + tid + "/stat");
+    std::string line;
+    if (!std::getline(file, line)) return -1;
+    size_t end = line.rfind(')'); // the thread name may contain spaces
+    if (end == std::string::npos) return -1;
+    std::istringstream fields(line.substr(end + 2));
+    std::string field;
+    for (int index = 3; fields >> field; ++index) {
+        if (index == 39) return std::atoi(field.c_str());
+    }
+    return -1;
+}
+
+std::string allowedCpusOf(const std::string& tid) {
+    std::ifstream file("/proc/self/task/" + tid + "/status");
+    std::string line;
+    const std::string key = "Cpus_allowed_list:";
+    while (std::getline(file, line)) {
+        if (line.compare(0, key.size(), key) == 0) {
+            size_t start = line.find_first_not_of(" \t", key.size());
+            return start == std::string::npos ? "" : line.substr(start);
+        }
+    }
+    return "";
+}
+#endif
+
+} // namespace
+
+bool ThreadAffinity::isSupported() {
+#if defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ThreadAffinity::parseCpuList(const std::string& text, std::vector<int>& cpus) {
+    std::vector<int> parsed;
+    std::stringstream ranges(text);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        range.erase(0, range.find_first_not_of(" \t"));
+        range.erase(range.find_last_not_of(" \t") + 1);
+        if (range.empty() || range.find_first_not_of("0123456789-") != std::string::npos) return false;
+        size_t dash = range.find('-');
+        std::string first = range.substr(0, dash);
+        std::string last = dash == std::string::npos ? first : range.substr(dash + 1);
+        if (first.empty() || last.empty() || last.find('-') != std::string::npos ||
+            first.size() > 5 || last.size() > 5) {
+            return false;
+        }
+        int low = std::atoi(first.c_str());
+        int high = std::atoi(last.c_str());
+        if (low > high) return false;
+        for (int cpu = low; cpu <= high; ++cpu) parsed.push_back(cpu);
+    }
+    if (parsed.empty()) return false;
+    std::sort(parsed.begin(), parsed.end());
+    parsed.erase(std::unique(parsed.begin(), parsed.end()), parsed.end());
+    cpus.swap(parsed);
+    return true;
+}
+
+std::string ThreadAffinity::formatCpuList(const std::vector<int>& cpus) {
+    std::ostringstream out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+        if (i > 0) out << ",";
+        out << cpus[i];
+        if (j > i) out << "-" << cpus[j];
+        i = j + 1;
+    }
+    return out.str();
+}
+
+bool ThreadAffinity::allowed(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    std::vector<int> mask;
+    if (cpus.empty() || !currentMask(mask)) return false;
+    for (int cpu : cpus) {
+        if (!std::binary_search(mask.begin(), mask.end(), cpu)) return false;
+    }
+    return true;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+bool ThreadAffinity::pinCurrentThread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+int ThreadAffinity::numaNodeOf(int cpu) {
+#if defined(__linux__)
+    // Each CPU directory links to its node as "node<N>"
+    for (const auto& name : listDirectory("/sys/devices/system/cpu/cpu" + std::to_string(cpu))) {
+        if (name.compare(0, 4, "node") == 0 && name.size() > 4 &&
+            name.find_first_not_of("0123456789", 4) == std::string::npos) {
+            return std::atoi(name.c_str() + 4);
+        }
+    }
+#else
+    (void)cpu;
+#endif
+    return -1;
+}
+
+std::vector<ThreadPlacementGroup> ThreadAffinity::currentPlacement() {
+    std::vector<ThreadPlacementGroup> groups;
+#if defined(__linux__)
+    std::map<std::string, ThreadPlacementGroup> byMask;
+    for (const auto& tid : listDirectory("/proc/self/task")) {
+        std::string allowed = allowedCpusOf(tid);
+        if (allowed.empty()) continue; // the thread exited meanwhile
+        ThreadPlacementGroup& group = byMask[allowed];
+        group.cpus = allowed;
+        group.threads++;
+        int cpu = lastCpuOf(tid);
+        if (cpu >= 0) group.lastCpu[cpu]++;
+    }
+    for (auto& entry : byMask) {
+        ThreadPlacementGroup& group = entry.second;
+        std::vector<int> cpus;
+        if (parseCpuList(group.cpus, cpus)) {
+            for (int cpu : cpus) {
+                int node = numaNodeOf(cpu);
+                if (node >= 0 && std::find(group.nodes.begin(), group.nodes.end(), node) == group.nodes.end()) {
+                    group.nodes.push_back(node);
+                }
+            }
+            std::sort(group.nodes.begin(), group.nodes.end());
+        }
+        groups.push_back(group);
+    }
+#endif
+    return groups;
+}
+
+ScopedAffinity::ScopedAffinity(const std::vector<int>& cpus) : active(false) {
+#if defined(__linux__)
+    if (!cpus.empty() && currentMask(saved)) {
+        active = ThreadAffinity::pinCurrentThread(cpus);
+    }
+#else
+    (void)cpus;
+#endif
+}
+
+ScopedAffinity::~ScopedAffinity() {
+    if (active) {
+        ThreadAffinity::pinCurrentThread(saved);
+    }
+}
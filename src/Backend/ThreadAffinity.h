@@ -0,0 +1,69 @@
+/**
+ * ThreadAffinity - CPU sets for the server's thread groups
+ * A Linux thread starts with the CPU mask of the thread that created it, so a
+ * group (HTTP workers, scheduler threads, ...) is placed by narrowing the
+ * creating thread's mask while it spawns them (ScopedAffinity). Memory a
+ * pinned thread touches first - its glibc malloc arena, a shard's tables - is
+ * then allocated on that CPU's NUMA node by the kernel's first-touch policy.
+ * Elsewhere pinning does nothing and placement reports are empty.
+ */
+
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Threads sharing one CPU mask, from /proc/self/task
+struct ThreadPlacementGroup {
+    std::string cpus;              // allowed CPUs, e.g. "0-3,8"
+    std::vector<int> nodes;        // NUMA nodes of those CPUs
+    size_t threads;
+    std::map<int, size_t> lastCpu; // CPU each thread last ran on -> threads
+
+    ThreadPlacementGroup() : threads(0) {}
+};
+
+class ThreadAffinity {
+public:
+    static bool isSupported();
+
+    /**
+     * Parse a CPU list such as "0-3,8,10-11" (sorted, duplicates dropped)
+     * @return false if the text is empty or malformed
+     */
+    static bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+    static std::string formatCpuList(const std::vector<int>& cpus);
+
+    // True if every CPU is in the calling thread's current mask (so it exists and may be used)
+    static bool allowed(const std::vector<int>& cpus);
+
+    // Restrict the calling thread to cpus; false if unsupported or rejected
+    static bool pinCurrentThread(const std::vector<int>& cpus);
+
+    // NUMA node of a CPU, or -1 if unknown
+    static int numaNodeOf(int cpu);
+
+    // Every thread of this process, grouped by CPU mask
+    static std::vector<ThreadPlacementGroup> currentPlacement();
+};
+
+/**
+ * Narrow the calling thread's CPU mask for as long as this lives, so the
+ * threads it starts meanwhile inherit it. An empty set changes nothing.
+ */
+class ScopedAffinity {
+private:
+    std::vector<int> saved;
+    bool active;
+
+public:
+    explicit ScopedAffinity(const std::vector<int>& cpus);
+    ~ScopedAffinity();
+
+    ScopedAffinity(const ScopedAffinity&) = delete;
+    ScopedAffinity& operator=(const ScopedAffinity&) = delete;
+};
+
+#endif // THREAD_AFFINITY_H
@@ -0,0 +1,201 @@
+/**
+ * Timestamp - Implementation
+ */
+
+#include "Timestamp.h"
+#include <charconv>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+const long long MS_PER_DAY = 24LL * 60 * 60 * 1000;
+
+// floor division for pre-1970 timestamps
+long long floorDiv(long long value, long long divisor) {
+    long long q = value / divisor;
+    if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) q--;
+    return q;
+}
+
+void writeDigits(char* out, unsigned value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+// Cached "YYYY-MM-DDTHH:MM:SS" for the last second formatted on this thread
+struct SecondPrefix {
+    long long second;
+    char text[19];
+    bool valid;
+};
+
+thread_local SecondPrefix cachedPrefix = {0, {}, false};
+
+void buildPrefix(long long second, char* out) {
+    long long days = floorDiv(second, 86400);
+    long long secondOfDay = second - days * 86400;
+    long long year;
+    unsigned month, day;
+    Timestamp::civilFromDays(days, year, month, day);
+
+    // Years outside 0000-9999 are clamped into four digits
+    unsigned yearDigits = year < 0 ? 0 : (year > 9999 ? 9999 : static_cast<unsigned>(year));
+    writeDigits(out, yearDigits, 4);
+    out[4] = '-';
+    writeDigits(out + 5, month, 2);
+    out[7] = '-';
+    writeDigits(out + 8, day, 2);
+    out[10] = 'T';
+    writeDigits(out + 11, static_cast<unsigned>(secondOfDay / 3600), 2);
+    out[13] = ':';
+    writeDigits(out + 14, static_cast<unsigned>((secondOfDay / 60) % 60), 2);
+    out[16] = ':';
+    writeDigits(out + 17, static_cast<unsigned>(secondOfDay % 60), 2);
+}
+
+// Exactly `count` ASCII digits (no sign, no whitespace)
+bool readDigits(const char*& p, const char* end, int count, int& value) {
+    if (end - p < count) return false;
+    value = 0;
+    for (int i = 0; i < count; ++i) {
+        if (p[i] < '0' || p[i] > '9') return false;
+        value = value * 10 + (p[i] - '0');
+    }
+    p += count;
+    return true;
+}
+
+bool expect(const char*& p, const char* end, char c) {
+    if (p >= end || *p != c) return false;
+    p++;
+    return true;
+}
+
+} // namespace
+
+namespace Timestamp {
+
+long long nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+size_t formatIso8601(long long epochMs, char* out) {
+    long long second = floorDiv(epochMs, 1000);
+    unsigned millis = static_cast<unsigned>(epochMs - second * 1000);
+
+    if (!cachedPrefix.valid || cachedPrefix.second != second) {
+        buildPrefix(second, cachedPrefix.text);
+        cachedPrefix.second = second;
+        cachedPrefix.valid = true;
+    }
+    std::memcpy(out, cachedPrefix.text, sizeof(cachedPrefix.text));
+
+    // ".mmmZ" - to_chars does not zero-pad, so pad the short values first
+    char* p = out + 19;
+    *p++ = '.';
+    if (millis < 100) *p++ = '0';
+    if (millis < 10) *p++ = '0';
+    p = std::to_chars(p, out + ISO_LENGTH, millis).ptr;
+    *p = 'Z';
+    return ISO_LENGTH;
+}
+
+std::string formatIso8601(long long epochMs) {
+    char buffer[ISO_LENGTH];
+    return std::string(buffer, formatIso8601(epochMs, buffer));
+}
+
+std::string now() {
+    return formatIso8601(nowMs());
+}
+
+bool parseIso8601(const std::string& text, long long& epochMs) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    int year, month, day, hour, minute, second;
+
+    if (!readDigits(p, end, 4, year) || !expect(p, end, '-') ||
+        !readDigits(p, end, 2, month) || !expect(p, end, '-') ||
+        !readDigits(p, end, 2, day)) {
+        return false;
+    }
+    if (p >= end || (*p != 'T' && *p != ' ')) return false;
+    p++;
+    if (!readDigits(p, end, 2, hour) || !expect(p, end, ':') ||
+        !readDigits(p, end, 2, minute) || !expect(p, end, ':') ||
+        !readDigits(p, end, 2, second)) {
+        return false;
+    }
+
+    // Fraction: keep milliseconds, ignore finer digits
+    int millis = 0;
+    if (p < end && *p == '.') {
+        p++;
+        int digits = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 3) millis = millis * 10 + (*p - '0');
+            digits++;
+            p++;
+        }
+        if (digits == 0) return false;
+        for (; digits < 3; ++digits) millis *= 10;
+    }
+
+    long long offsetMinutes = 0;
+    if (p < end) {
+        if (*p == 'Z' || *p == 'z') {
+            p++;
+        } else if (*p == '+' || *p == '-') {
+            int sign = *p == '-' ? -1 : 1;
+            p++;
+            int offsetHours, offsetMins;
+            if (!readDigits(p, end, 2, offsetHours)) return false;
+            if (p < end && *p == ':') p++;
+            if (!readDigits(p, end, 2, offsetMins)) return false;
+            if (offsetHours > 23 || offsetMins > 59) return false;
+            offsetMinutes = sign * (offsetHours * 60 + offsetMins);
+        }
+    }
+    if (p != end) return false;
+
+    if (month < 1 || month > 12 || day < 1 || hour > 23 || minute > 59 || second > 60) return false;
+    static const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    int maxDay = daysInMonth[month - 1] + (month == 2 && leap ? 1 : 0);
+    if (day > maxDay) return false;
+
+    long long days = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    epochMs = days * MS_PER_DAY
+            + ((hour * 60LL + minute - offsetMinutes) * 60 + second) * 1000
+            + millis;
+    return true;
+}
+
+long long daysFromCivil(long long y, unsigned m, unsigned d) {
+    // H. Hinnant's days_from_civil
+    y -= m <= 2;
+    const long long era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+void civilFromDays(long long z, long long& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const long long era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<long long>(yoe) + era * 400 + (m <= 2);
+}
+
+} // namespace Timestamp
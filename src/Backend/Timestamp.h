@@ -0,0 +1,42 @@
+/**
+ * Timestamp - ISO-8601 formatting and parsing for API responses
+ * All timestamps leave the server as UTC with millisecond precision,
+ * e.g. "2024-01-01T09:30:00.123Z". Formatting reuses a per-thread cache of the
+ * current "YYYY-MM-DDTHH:MM:SS" prefix, so consecutive calls within the same
+ * second only write the milliseconds.
+ */
+
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <cstddef>
+#include <string>
+
+namespace Timestamp {
+    // Length of a formatted timestamp ("YYYY-MM-DDTHH:MM:SS.mmmZ")
+    const size_t ISO_LENGTH = 24;
+
+    long long nowMs();
+
+    /**
+     * Format epoch milliseconds into `out` (at least ISO_LENGTH bytes, not null-terminated)
+     * @return number of bytes written (ISO_LENGTH)
+     */
+    size_t formatIso8601(long long epochMs, char* out);
+    std::string formatIso8601(long long epochMs);
+
+    // Current time as an ISO-8601 string
+    std::string now();
+
+    /**
+     * Parse "YYYY-MM-DD[T| ]HH:MM:SS[.fraction][Z|+HH:MM|-HH:MM]" (no offset = UTC)
+     * @return false if the text is not a valid timestamp
+     */
+    bool parseIso8601(const std::string& text, long long& epochMs);
+
+    // Proleptic Gregorian calendar helpers (days since 1970-01-01)
+    long long daysFromCivil(long long year, unsigned month, unsigned day);
+    void civilFromDays(long long days, long long& year, unsigned& month, unsigned& day);
+}
+
+#endif // TIMESTAMP_H
@@ -0,0 +1,26 @@
+/**
+ * User - account record shared by the server, the MongoDB service and the user cache
+ */
+
+#ifndef USER_H
+#define USER_H
+
+#include <string>
+#include "Cart.h"
+#include "PurchaseHistory.h"
+
+struct User {
+    std::string id;
+    std::string username;
+    std::string email;
+    std::string password; // In production, hash this with bcrypt
+    Cart cart;
+    PurchaseHistory history;
+    std::string fullName;
+    std::string bio;
+    long long version; // MongoDB document version, bumped by every write
+
+    User() : version(0) {}
+};
+
+#endif // USER_H
@@ -0,0 +1,158 @@
+/**
+ * UserCache - Implementation
+ */
+
+#include "UserCache.h"
+
+UserCache::UserCache(size_t capacity, long long ttlMs)
+    : capacity(capacity), ttl(ttlMs), hitCount(0), missCount(0) {
+}
+
+UserCache::~UserCache() = default;
+
+void UserCache::configure(size_t newCapacity, long long ttlMs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = newCapacity;
+    ttl = std::chrono::milliseconds(ttlMs);
+    evictOverflow();
+}
+
+bool UserCache::get(const std::string& userId, UserRef& user) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(userId);
+    if (it == entries.end()) {
+        missCount++;
+        return false;
+    }
+
+    // Short TTL bounds staleness when another instance writes the same user
+    if (std::chrono::steady_clock::now() - it->second.loadedAt > ttl) {
+        lru.erase(it->second.lruPosition);
+        entries.erase(it);
+        missCount++;
+        return false;
+    }
+
+    lru.splice(lru.begin(), lru, it->second.lruPosition);
+    user = it->second.user;
+    hitCount++;
+    return true;
+}
+
+bool UserCache::put(const UserRef& user) {
+    if (!user || user->getId().empty() || capacity == 0) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return store(user, std::chrono::steady_clock::now());
+}
+
+bool UserCache::store(const UserRef& user, std::chrono::steady_clock::time_point loadedAt) {
+    auto it = entries.find(user->getId());
+    if (it != entries.end()) {
+        // A concurrent request already stored a newer version - keep it
+        if (it->second.user->getVersion() > user->getVersion()) {
+            return false;
+        }
+        it->second.user = user;
+        it->second.loadedAt = loadedAt;
+        lru.splice(lru.begin(), lru, it->second.lruPosition);
+        return true;
+    }
+
+    lru.push_front(user->getId());
+    Entry entry;
+    entry.user = user;
+    entry.loadedAt = loadedAt;
+    entry.lruPosition = lru.begin();
+    entries.emplace(user->getId(), std::move(entry));
+    evictOverflow();
+    return true;
+}
+
+bool UserCache::writeThrough(const UserRef& base, const UserRef& updated) {
+    if (!base || !updated || updated->getId() != base->getId()) return false;
+    if (updated->getVersion() != base->getVersion() + 1) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(base->getId());
+    if (it == entries.end() || it->second.user->getVersion() != base->getVersion()) {
+        return false;
+    }
+    it->second.user = updated;
+    lru.splice(lru.begin(), lru, it->second.lruPosition);
+    return true;
+}
+
+std::vector<std::pair<UserRef, long long>> UserCache::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::pair<UserRef, long long>> live;
+    live.reserve(entries.size());
+    for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
+        const Entry& entry = entries.at(*it);
+        if (now - entry.loadedAt > ttl) continue;
+        auto age = std::chrono::duration_cast<std::chrono::milliseconds>(now - entry.loadedAt);
+        live.emplace_back(entry.user, age.count());
+    }
+    return live;
+}
+
+bool UserCache::restore(const UserRef& user, long long ageMs) {
+    if (!user || user->getId().empty() || capacity == 0 || ageMs < 0) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (std::chrono::milliseconds(ageMs) > ttl) return false;
+    return store(user, std::chrono::steady_clock::now() - std::chrono::milliseconds(ageMs));
+}
+
+void UserCache::invalidate(const std::string& userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(userId);
+    if (it == entries.end()) return;
+    lru.erase(it->second.lruPosition);
+    entries.erase(it);
+}
+
+size_t UserCache::purgeExpired() {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    size_t removed = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (now - it->second.loadedAt > ttl) {
+            lru.erase(it->second.lruPosition);
+            it = entries.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+void UserCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    lru.clear();
+}
+
+size_t UserCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+unsigned long long UserCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+unsigned long long UserCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
+
+void UserCache::evictOverflow() {
+    while (entries.size() > capacity && !lru.empty()) {
+        entries.erase(lru.back());
+        lru.pop_back();
+    }
+}
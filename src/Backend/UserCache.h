@@ -0,0 +1,99 @@
+/**
+ * UserCache - bounded in-process cache of decoded user documents
+ * Sits in front of MongoDBService::findUserById so repeated requests from the
+ * same session become memory lookups instead of database round trips.
+ * Entries are immutable snapshots, so a hit hands out a shared reference
+ * rather than copying the user.
+ */
+
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "UserSnapshot.h"
+
+class UserCache {
+private:
+    struct Entry {
+        UserRef user;
+        std::chrono::steady_clock::time_point loadedAt;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru; // most recently used at the front
+    size_t capacity;
+    std::chrono::milliseconds ttl;
+    unsigned long long hitCount;
+    unsigned long long missCount;
+
+    void evictOverflow();
+    bool store(const UserRef& user, std::chrono::steady_clock::time_point loadedAt); // caller holds mutex
+
+public:
+    UserCache(size_t capacity = 10000, long long ttlMs = 3000);
+    ~UserCache();
+
+    /**
+     * Reconfigure limits (entries above the new capacity are evicted)
+     */
+    void configure(size_t capacity, long long ttlMs);
+
+    /**
+     * Look up a user by id
+     * @return true and the cached snapshot if present and younger than the TTL
+     */
+    bool get(const std::string& userId, UserRef& user);
+
+    /**
+     * Insert or refresh a user (write-through after loads and mutations)
+     * Version-checked: ignored if the cached copy already has a newer version.
+     * @return true if the entry was stored
+     */
+    bool put(const UserRef& user);
+
+    /**
+     * Replace `base` with `updated` after a write moved the user from one to the other.
+     * Applies only while the cached entry is still at base's version and updated is exactly
+     * one version newer. The entry keeps its original load time, so it still expires on
+     * the schedule of the read it came from.
+     * @return false if nothing was replaced (the caller should invalidate)
+     */
+    bool writeThrough(const UserRef& base, const UserRef& updated);
+
+    /**
+     * Unexpired entries with their age in ms, least recently used first (hot restart)
+     */
+    std::vector<std::pair<UserRef, long long>> snapshot() const;
+
+    /**
+     * Store an entry loaded ageMs ago, so it still expires on its original schedule
+     * @return false if it is already past the TTL
+     */
+    bool restore(const UserRef& user, long long ageMs);
+
+    /**
+     * Drop a user from the cache (e.g. after a failed write)
+     */
+    void invalidate(const std::string& userId);
+
+    /**
+     * Remove all entries older than the TTL
+     * @return number of entries removed
+     */
+    size_t purgeExpired();
+
+    void clear();
+    size_t size() const;
+    unsigned long long hits() const;
+    unsigned long long misses() const;
+};
+
+#endif // USER_CACHE_H
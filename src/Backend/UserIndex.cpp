@@ -0,0 +1,61 @@
+/**
+ * UserIndex - Implementation
+ */
+
+#include "UserIndex.h"
+#include <algorithm>
+#include <cctype>
+
+void UserIndex::add(const UserProfile& user) {
+    if (!user.id.empty()) {
+        byId[user.id] = user.username;
+    }
+    std::string email = normalizeEmail(user.email);
+    if (!email.empty()) {
+        byEmail[email] = user.username;
+    }
+}
+
+void UserIndex::remove(const UserProfile& user) {
+    auto idIt = byId.find(user.id);
+    if (idIt != byId.end() && idIt->second == user.username) {
+        byId.erase(idIt);
+    }
+    auto emailIt = byEmail.find(normalizeEmail(user.email));
+    if (emailIt != byEmail.end() && emailIt->second == user.username) {
+        byEmail.erase(emailIt);
+    }
+}
+
+void UserIndex::clear() {
+    byId.clear();
+    byEmail.clear();
+}
+
+size_t UserIndex::size() const {
+    return byId.size();
+}
+
+bool UserIndex::findById(const std::string& userId, std::string& username) const {
+    auto it = byId.find(userId);
+    if (it == byId.end()) return false;
+    username = it->second;
+    return true;
+}
+
+bool UserIndex::findByEmail(const std::string& email, std::string& username) const {
+    auto it = byEmail.find(normalizeEmail(email));
+    if (it == byEmail.end()) return false;
+    username = it->second;
+    return true;
+}
+
+std::string UserIndex::normalizeEmail(const std::string& email) {
+    size_t start = email.find_first_not_of(" \t\n\r");
+    if (start == std::string::npos) return "";
+    size_t end = email.find_last_not_of(" \t\n\r");
+    std::string normalized = email.substr(start, end - start + 1);
+    std::transform(normalized.begin(), normalized.end(), normalized.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return normalized;
+}
@@ -0,0 +1,42 @@
+/**
+ * UserIndex - secondary indexes over a username-keyed user map
+ * Adds O(1) lookups by user id and by case-insensitive email to a map keyed by
+ * username. The server's in-memory store (CompactUserStore) keeps its own
+ * tables but uses normalizeEmail for the same email key.
+ * Not synchronized - callers hold the same lock that guards the user map.
+ */
+
+#ifndef USER_INDEX_H
+#define USER_INDEX_H
+
+#include <string>
+#include <unordered_map>
+#include "UserSnapshot.h"
+
+class UserIndex {
+private:
+    std::unordered_map<std::string, std::string> byId;    // id -> username
+    std::unordered_map<std::string, std::string> byEmail; // lowercase email -> username
+
+public:
+    void add(const UserProfile& user);
+    void remove(const UserProfile& user);
+    void clear();
+    size_t size() const;
+
+    /**
+     * @return true and the username (primary key) of the user with this id
+     */
+    bool findById(const std::string& userId, std::string& username) const;
+
+    /**
+     * Case-insensitive email lookup
+     * @return true and the username (primary key) of the user with this email
+     */
+    bool findByEmail(const std::string& email, std::string& username) const;
+
+    // Trimmed, lowercase form used as the email key
+    static std::string normalizeEmail(const std::string& email);
+};
+
+#endif // USER_INDEX_H
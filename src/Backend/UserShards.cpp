@@ -0,0 +1,287 @@
+/**
+ * UserShards - Implementation
+ */
+
+#include "UserShards.h"
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+const size_t INBOX_CAPACITY = 4;   // a caller waits for each call, so it never has more than one queued
+const size_t SPIN_ROUNDS = 64;     // idle polls before a shard thread sleeps
+const size_t WAIT_SPINS = 256;     // polls of a job before its caller blocks
+
+std::atomic<unsigned long long> nextGeneration(0);
+
+// The calling thread's producer slot in the UserShards instance it last used
+struct ProducerSlot {
+    unsigned long long generation;
+    size_t slot;
+};
+
+thread_local ProducerSlot currentSlot = {0, 0};
+
+} // namespace
+
+UserShards::UserShards()
+    : maxProducers(0), nextProducer(0), overflowCalls(0), running(false), generation(0) {}
+
+UserShards::~UserShards() {
+    stop();
+}
+
+void UserShards::start(size_t shardCount, size_t producers, const std::vector<int>& cpus) {
+    stop();
+    shards.clear();
+    maxProducers = producers;
+    nextProducer.store(0);
+    overflowCalls.store(0);
+    generation = ++nextGeneration;
+
+    for (size_t i = 0; i < std::max<size_t>(1, shardCount); ++i) {
+        std::unique_ptr<Shard> shard(new Shard());
+        for (size_t p = 0; p < maxProducers; ++p) {
+            shard->inbox.emplace_back(new SpscQueue<Job*>(INBOX_CAPACITY));
+        }
+        if (!cpus.empty()) {
+            shard->cpu = cpus[i % cpus.size()];
+        }
+        shards.push_back(std::move(shard));
+    }
+
+    running.store(true);
+    for (auto& shard : shards) {
+        Shard* owned = shard.get();
+        shard->thread = std::thread([this, owned] { loop(*owned); });
+    }
+}
+
+void UserShards::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->sleepMutex);
+        shard->wakeup.notify_one();
+    }
+    for (auto& shard : shards) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+}
+
+bool UserShards::enabled() const {
+    return running.load(std::memory_order_relaxed);
+}
+
+size_t UserShards::getShardCount() const {
+    return shards.size();
+}
+
+size_t UserShards::shardOf(const std::string& key) const {
+    return std::hash<std::string>()(key) % shards.size();
+}
+
+size_t UserShards::producerSlot() {
+    if (currentSlot.generation != generation) {
+        currentSlot.generation = generation;
+        currentSlot.slot = nextProducer.fetch_add(1);
+    }
+    return currentSlot.slot;
+}
+
+bool UserShards::hasWork(Shard& shard) const {
+    size_t producers = std::min(nextProducer.load(), maxProducers);
+    for (size_t p = 0; p < producers; ++p) {
+        if (!shard.inbox[p]->empty()) return true;
+    }
+    return shard.overflowSize.load() > 0;
+}
+
+void UserShards::runJob(Shard& shard, Job* job) {
+    try {
+        (*job->task)(shard.state);
+    } catch (...) {
+        job->error = std::current_exception();
+    }
+    shard.userCount.store(shard.state.users.size(), std::memory_order_relaxed);
+    CompactUserStoreStats storeStats = shard.state.users.getStats();
+    shard.userBytes.store(storeStats.recordBytes + storeStats.blobBytes + storeStats.indexBytes,
+                          std::memory_order_relaxed);
+    shard.sessionCount.store(shard.state.sessions.size(), std::memory_order_relaxed);
+    shard.calls.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->done.store(true, std::memory_order_release);
+    job->finished.notify_one();
+}
+
+bool UserShards::drain(Shard& shard) {
+    bool worked = false;
+    size_t producers = std::min(nextProducer.load(std::memory_order_acquire), maxProducers);
+    for (size_t p = 0; p < producers; ++p) {
+        Job* job = nullptr;
+        while (shard.inbox[p]->tryPop(job)) {
+            runJob(shard, job);
+            worked = true;
+        }
+    }
+    if (shard.overflowSize.load(std::memory_order_acquire) > 0) {
+        std::deque<Job*> pending;
+        {
+            std::lock_guard<std::mutex> lock(shard.overflowMutex);
+            pending.swap(shard.overflow);
+            shard.overflowSize.store(0);
+        }
+        for (Job* job : pending) {
+            runJob(shard, job);
+        }
+        worked = worked || !pending.empty();
+    }
+    return worked;
+}
+
+// Poll the inboxes, yield briefly when idle, then sleep until a caller wakes the shard
+void UserShards::loop(Shard& shard) {
+    int cpu = shard.cpu.load();
+    if (cpu >= 0 && !ThreadAffinity::pinCurrentThread(std::vector<int>(1, cpu))) {
+        shard.cpu.store(-1);
+    }
+    size_t idle = 0;
+    for (;;) {
+        if (drain(shard)) {
+            idle = 0;
+            continue;
+        }
+        if (!running.load()) {
+            break;
+        }
+        if (++idle < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(shard.sleepMutex);
+        shard.sleeping.store(true);
+        // Pairs with the fence in execute(): either the caller sees `sleeping` or we see its job
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!hasWork(shard) && running.load()) {
+            shard.wakeup.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        shard.sleeping.store(false);
+        idle = 0;
+    }
+}
+
+void UserShards::execute(size_t index, const Task& task) {
+    Shard& shard = *shards[index];
+    Job job;
+    job.task = &task;
+
+    size_t slot = producerSlot();
+    if (slot < maxProducers) {
+        while (!shard.inbox[slot]->tryPush(&job)) {
+            std::this_thread::yield();
+        }
+    } else {
+        overflowCalls.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(shard.overflowMutex);
+        shard.overflow.push_back(&job);
+        shard.overflowSize.fetch_add(1);
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (shard.sleeping.load()) {
+        std::lock_guard<std::mutex> lock(shard.sleepMutex);
+        shard.wakeup.notify_one();
+    }
+
+    for (size_t spin = 0; spin < WAIT_SPINS && !job.done.load(std::memory_order_acquire); ++spin) {
+        std::this_thread::yield();
+    }
+    {
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.finished.wait(lock, [&job] { return job.done.load(std::memory_order_acquire); });
+    }
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void UserShards::insert(const UserRef& user) {
+    Task task = [&user](UserShardState& state) { state.users.put(user); };
+    execute(shardOf(user->getId()), task);
+}
+
+bool UserShards::find(const std::string& userId, UserRef& user) {
+    Task task = [&userId, &user](UserShardState& state) {
+        user = state.users.findById(userId);
+    };
+    user = nullptr;
+    execute(shardOf(userId), task);
+    return user != nullptr;
+}
+
+UserRef UserShards::update(const std::string& userId, const std::function<UserRef(const UserRef&)>& change) {
+    UserRef result;
+    Task task = [&userId, &change, &result](UserShardState& state) {
+        UserRef current = state.users.findById(userId);
+        if (!current) return;
+        UserRef updated = change(current);
+        if (updated) {
+            // This thread is the only writer, so the swap cannot fail
+            state.users.replace(current, updated);
+            result = updated;
+        } else {
+            result = current;
+        }
+    };
+    execute(shardOf(userId), task);
+    return result;
+}
+
+void UserShards::addSession(const std::string& token, const std::string& userId) {
+    Task task = [&token, &userId](UserShardState& state) { state.sessions[token] = userId; };
+    execute(shardOf(token), task);
+}
+
+bool UserShards::findSession(const std::string& token, std::string& userId) {
+    bool found = false;
+    Task task = [&token, &userId, &found](UserShardState& state) {
+        auto it = state.sessions.find(token);
+        if (it != state.sessions.end()) {
+            userId = it->second;
+            found = true;
+        }
+    };
+    execute(shardOf(token), task);
+    return found;
+}
+
+void UserShards::visitUsers(size_t shard, const std::function<void(CompactUserStore&)>& visit) {
+    Task task = [&visit](UserShardState& state) { visit(state.users); };
+    execute(shard, task);
+}
+
+void UserShards::visitSessions(size_t shard,
+                               const std::function<void(std::unordered_map<std::string, std::string>&)>& visit) {
+    Task task = [&visit](UserShardState& state) { visit(state.sessions); };
+    execute(shard, task);
+}
+
+UserShardsStats UserShards::getStats() const {
+    UserShardsStats stats;
+    stats.producers = std::min(nextProducer.load(), maxProducers);
+    stats.overflowCalls = overflowCalls.load();
+    for (const auto& shard : shards) {
+        UserShardStats entry;
+        entry.users = shard->userCount.load(std::memory_order_relaxed);
+        entry.userBytes = shard->userBytes.load(std::memory_order_relaxed);
+        entry.cpu = shard->cpu.load(std::memory_order_relaxed);
+        entry.sessions = shard->sessionCount.load(std::memory_order_relaxed);
+        entry.calls = shard->calls.load(std::memory_order_relaxed);
+        stats.shards.push_back(entry);
+    }
+    return stats;
+}
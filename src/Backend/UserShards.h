@@ -0,0 +1,141 @@
+/**
+ * UserShards - shared-nothing partitioning of in-memory user state
+ * Users are hash-partitioned by id across shards, sessions by token. Each shard
+ * has one thread that owns its maps outright: nothing in a shard is locked or
+ * touched by another core. Callers hand work to the owning shard through a
+ * lock-free SPSC queue (one per calling thread and shard) and wait for it, so
+ * a user's carts and history are only ever read and written on one core and
+ * writers never need to retry.
+ */
+
+#ifndef USER_SHARDS_H
+#define USER_SHARDS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "CompactUserStore.h"
+#include "SpscQueue.h"
+#include "UserSnapshot.h"
+
+// The state one shard owns; only its thread touches it
+struct UserShardState {
+    CompactUserStore users;                                // packed users, in a per-shard blob
+    std::unordered_map<std::string, std::string> sessions; // token -> user id
+};
+
+struct UserShardStats {
+    size_t users;
+    size_t userBytes; // the shard's packed user store: records, blob and indexes
+    size_t sessions;
+    unsigned long long calls;
+    int cpu; // CPU the shard thread is pinned to, -1 if it floats
+};
+
+struct UserShardsStats {
+    size_t producers;                 // calling threads with their own queues
+    unsigned long long overflowCalls; // calls from threads beyond maxProducers (mutex path)
+    std::vector<UserShardStats> shards;
+};
+
+class UserShards {
+public:
+    typedef std::function<void(UserShardState&)> Task;
+
+private:
+    // One call in flight; lives on the caller's stack until the shard has run it
+    struct Job {
+        const Task* task;
+        std::exception_ptr error;
+        std::atomic<bool> done;
+        std::mutex mutex;  // held by the shard while it signals, so the caller never frees it early
+        std::condition_variable finished;
+
+        Job() : task(nullptr), done(false) {}
+    };
+
+    struct Shard {
+        UserShardState state;
+        std::vector<std::unique_ptr<SpscQueue<Job*>>> inbox; // one per producer slot
+        std::deque<Job*> overflow;
+        std::mutex overflowMutex;
+        std::atomic<size_t> overflowSize;
+        std::atomic<bool> sleeping;
+        std::mutex sleepMutex;
+        std::condition_variable wakeup;
+        std::atomic<size_t> userCount;
+        std::atomic<size_t> userBytes;
+        std::atomic<size_t> sessionCount;
+        std::atomic<unsigned long long> calls;
+        std::atomic<int> cpu; // -1 unpinned, or if pinning failed
+        std::thread thread;
+
+        Shard() : overflowSize(0), sleeping(false), userCount(0), userBytes(0), sessionCount(0), calls(0), cpu(-1) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t maxProducers;
+    std::atomic<size_t> nextProducer;
+    std::atomic<unsigned long long> overflowCalls;
+    std::atomic<bool> running;
+    unsigned long long generation; // tells this instance's producer slots from an earlier one's
+
+    size_t producerSlot();
+    bool hasWork(Shard& shard) const;
+    bool drain(Shard& shard);
+    void runJob(Shard& shard, Job* job);
+    void loop(Shard& shard);
+
+    // Run task on a shard's thread and wait for it (rethrows what the task threw)
+    void execute(size_t shard, const Task& task);
+
+public:
+    UserShards();
+    ~UserShards();
+
+    /**
+     * Start one thread per shard. maxProducers bounds the calling threads that
+     * get their own queues; any beyond that share a locked queue per shard.
+     * With cpus, shard i is pinned to cpus[i % cpus.size()] before it touches
+     * its state, so its tables live on that CPU's NUMA node.
+     */
+    void start(size_t shardCount, size_t maxProducers, const std::vector<int>& cpus = std::vector<int>());
+    void stop();
+
+    bool enabled() const;
+    size_t getShardCount() const;
+    size_t shardOf(const std::string& key) const;
+
+    // User snapshots, on the shard owning the user id
+    void insert(const UserRef& user);
+    bool find(const std::string& userId, UserRef& user);
+
+    /**
+     * Derive and store a new snapshot on the owning shard. `change` runs once, on
+     * the shard's thread, and returns nullptr to leave the user unchanged.
+     * @return the stored snapshot, the unchanged current one, or nullptr if no such user
+     */
+    UserRef update(const std::string& userId, const std::function<UserRef(const UserRef&)>& change);
+
+    // Sessions, on the shard owning the token
+    void addSession(const std::string& token, const std::string& userId);
+    bool findSession(const std::string& token, std::string& userId);
+
+    // Run task on one shard's thread with its user map (maintenance such as cart sweeps)
+    void visitUsers(size_t shard, const std::function<void(CompactUserStore&)>& task);
+
+    // Run task on one shard's thread with its session map (hot restart export)
+    void visitSessions(size_t shard, const std::function<void(std::unordered_map<std::string, std::string>&)>& task);
+
+    UserShardsStats getStats() const;
+};
+
+#endif // USER_SHARDS_H
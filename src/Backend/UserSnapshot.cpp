@@ -0,0 +1,118 @@
+/**
+ * UserSnapshot - Implementation
+ */
+
+#include "UserSnapshot.h"
+#include <utility>
+
+PurchaseSegment::PurchaseSegment(std::vector<PurchaseRecord> records,
+                                 std::shared_ptr<const PurchaseSegment> previous)
+    : records(std::move(records)), previous(std::move(previous)) {
+    totalCount = this->records.size() + (this->previous ? this->previous->size() : 0);
+}
+
+std::shared_ptr<const PurchaseSegment> PurchaseSegment::append(const std::shared_ptr<const PurchaseSegment>& history,
+                                                               const std::vector<PurchaseRecord>& newRecords) {
+    if (newRecords.empty()) return history;
+
+    // Fold in older segments that are no bigger than the run being added, like a
+    // binary counter carry; larger (older) segments stay shared untouched
+    std::vector<PurchaseRecord> merged(newRecords);
+    std::shared_ptr<const PurchaseSegment> older = history;
+    while (older && older->records.size() <= merged.size()) {
+        merged.insert(merged.begin(), older->records.begin(), older->records.end());
+        older = older->previous;
+    }
+    return std::make_shared<const PurchaseSegment>(std::move(merged), std::move(older));
+}
+
+const std::vector<PurchaseRecord>& PurchaseSegment::getRecords() const {
+    return records;
+}
+
+const std::shared_ptr<const PurchaseSegment>& PurchaseSegment::getPrevious() const {
+    return previous;
+}
+
+size_t PurchaseSegment::size() const {
+    return totalCount;
+}
+
+UserSnapshot::UserSnapshot(std::shared_ptr<const UserProfile> profile, std::shared_ptr<const Cart> cart,
+                           std::shared_ptr<const PurchaseSegment> history, long long version)
+    : profile(std::move(profile)), cart(std::move(cart)), history(std::move(history)), version(version) {
+}
+
+UserRef UserSnapshot::create(UserProfile profile) {
+    return std::make_shared<const UserSnapshot>(std::make_shared<const UserProfile>(std::move(profile)),
+                                                emptyCart(), nullptr, 0);
+}
+
+const std::shared_ptr<const Cart>& UserSnapshot::emptyCart() {
+    static const std::shared_ptr<const Cart> empty = std::make_shared<const Cart>();
+    return empty;
+}
+
+UserRef UserSnapshot::fromUser(User&& user) {
+    UserProfile profile;
+    profile.id = std::move(user.id);
+    profile.username = std::move(user.username);
+    profile.email = std::move(user.email);
+    profile.password = std::move(user.password);
+    profile.fullName = std::move(user.fullName);
+    profile.bio = std::move(user.bio);
+    return std::make_shared<const UserSnapshot>(std::make_shared<const UserProfile>(std::move(profile)),
+                                                std::make_shared<const Cart>(std::move(user.cart)),
+                                                PurchaseSegment::append(nullptr, user.history.getPurchases()),
+                                                user.version);
+}
+
+const UserProfile& UserSnapshot::getProfile() const {
+    return *profile;
+}
+
+const std::string& UserSnapshot::getId() const {
+    return profile->id;
+}
+
+const Cart& UserSnapshot::getCart() const {
+    return *cart;
+}
+
+const PurchaseSegment* UserSnapshot::getHistory() const {
+    return history.get();
+}
+
+std::shared_ptr<const Cart> UserSnapshot::shareCart() const {
+    return cart;
+}
+
+std::shared_ptr<const PurchaseSegment> UserSnapshot::shareHistory() const {
+    return history;
+}
+
+size_t UserSnapshot::getPurchaseCount() const {
+    return history ? history->size() : 0;
+}
+
+long long UserSnapshot::getVersion() const {
+    return version;
+}
+
+UserRef UserSnapshot::withProfile(UserProfile newProfile) const {
+    return std::make_shared<const UserSnapshot>(std::make_shared<const UserProfile>(std::move(newProfile)),
+                                                cart, history, version);
+}
+
+UserRef UserSnapshot::withCart(Cart newCart) const {
+    return std::make_shared<const UserSnapshot>(profile, std::make_shared<const Cart>(std::move(newCart)),
+                                                history, version);
+}
+
+UserRef UserSnapshot::withPurchases(const std::vector<PurchaseRecord>& purchases) const {
+    return std::make_shared<const UserSnapshot>(profile, cart, PurchaseSegment::append(history, purchases), version);
+}
+
+UserRef UserSnapshot::withVersion(long long newVersion) const {
+    return std::make_shared<const UserSnapshot>(profile, cart, history, newVersion);
+}
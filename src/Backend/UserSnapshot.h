@@ -0,0 +1,99 @@
+/**
+ * UserSnapshot - immutable, structurally shared view of a user
+ * A published snapshot is never modified. Changing a user builds a new snapshot
+ * that shares every part it did not touch: a cart change copies the (small) cart
+ * but keeps the profile and purchase history, a checkout appends a history
+ * segment in front of the existing ones. Readers hold a UserRef and never copy
+ * user data; writers publish the new UserRef with a single pointer swap.
+ */
+
+#ifndef USER_SNAPSHOT_H
+#define USER_SNAPSHOT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Cart.h"
+#include "PurchaseHistory.h"
+#include "User.h"
+
+struct UserProfile {
+    std::string id;
+    std::string username;
+    std::string email;
+    std::string password; // In production, hash this with bcrypt
+    std::string fullName;
+    std::string bio;
+};
+
+// Append-only purchase history shared between snapshots. Each segment holds a run
+// of records and points at the older segments. Appending merges the new records
+// with older segments no larger than them, so a user with n records has O(log n)
+// segments and an append copies O(log n) records amortized.
+class PurchaseSegment {
+private:
+    std::vector<PurchaseRecord> records;
+    std::shared_ptr<const PurchaseSegment> previous;
+    size_t totalCount;
+
+public:
+    PurchaseSegment(std::vector<PurchaseRecord> records, std::shared_ptr<const PurchaseSegment> previous);
+
+    static std::shared_ptr<const PurchaseSegment> append(const std::shared_ptr<const PurchaseSegment>& history,
+                                                         const std::vector<PurchaseRecord>& newRecords);
+
+    const std::vector<PurchaseRecord>& getRecords() const;
+    const std::shared_ptr<const PurchaseSegment>& getPrevious() const;
+    size_t size() const; // records in this and all older segments
+
+    // Every record, oldest first
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        std::vector<const PurchaseSegment*> chain;
+        for (const PurchaseSegment* segment = this; segment; segment = segment->previous.get()) {
+            chain.push_back(segment);
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            for (const auto& record : (*it)->records) visit(record);
+        }
+    }
+};
+
+class UserSnapshot;
+using UserRef = std::shared_ptr<const UserSnapshot>;
+
+class UserSnapshot {
+private:
+    std::shared_ptr<const UserProfile> profile;
+    std::shared_ptr<const Cart> cart;
+    std::shared_ptr<const PurchaseSegment> history; // null when there are no purchases
+    long long version; // MongoDB document version, bumped by every write
+
+public:
+    UserSnapshot(std::shared_ptr<const UserProfile> profile, std::shared_ptr<const Cart> cart,
+                 std::shared_ptr<const PurchaseSegment> history, long long version);
+
+    static UserRef create(UserProfile profile);
+    // The never-used cart every new user starts with, shared by all of them
+    static const std::shared_ptr<const Cart>& emptyCart();
+    // Adopt a user decoded from the database; its profile strings and cart are moved
+    static UserRef fromUser(User&& user);
+
+    const UserProfile& getProfile() const;
+    const std::string& getId() const;
+    const Cart& getCart() const;
+    const PurchaseSegment* getHistory() const;
+    // Shared handles, for stores that keep the parts apart (CompactUserStore)
+    std::shared_ptr<const Cart> shareCart() const;
+    std::shared_ptr<const PurchaseSegment> shareHistory() const;
+    size_t getPurchaseCount() const;
+    long long getVersion() const;
+
+    // New snapshots that share everything except the replaced part
+    UserRef withProfile(UserProfile newProfile) const;
+    UserRef withCart(Cart newCart) const;
+    UserRef withPurchases(const std::vector<PurchaseRecord>& purchases) const;
+    UserRef withVersion(long long newVersion) const;
+};
+
+#endif // USER_SNAPSHOT_H
@@ -0,0 +1,243 @@
+/**
+ * WarmState - Implementation
+ */
+
+#include "WarmState.h"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'W', 'A', 'R', 'M'};
+const unsigned char FORMAT_VERSION = 1;
+
+class Writer {
+private:
+    std::string& out;
+
+public:
+    explicit Writer(std::string& buffer) : out(buffer) {}
+
+    void varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    // Zigzag, so small negative values stay short
+    void signedVarint(long long value) {
+        varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void str(const std::string& value) {
+        varint(value.size());
+        out.append(value);
+    }
+
+    void f64(double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; ++i) {
+            out.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+        }
+    }
+};
+
+class Reader {
+private:
+    const std::string& in;
+    size_t pos;
+
+public:
+    explicit Reader(const std::string& buffer, size_t start) : in(buffer), pos(start) {}
+
+    bool done() const {
+        return pos == in.size();
+    }
+
+    bool varint(std::uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= in.size()) return false;
+            unsigned char byte = static_cast<unsigned char>(in[pos++]);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool signedVarint(long long& value) {
+        std::uint64_t raw;
+        if (!varint(raw)) return false;
+        value = static_cast<long long>((raw >> 1) ^ (~(raw & 1) + 1));
+        return true;
+    }
+
+    bool count(size_t& value) {
+        std::uint64_t raw;
+        // Every element takes at least one byte, which bounds what a corrupt count can allocate
+        if (!varint(raw) || raw > in.size() - pos) return false;
+        value = static_cast<size_t>(raw);
+        return true;
+    }
+
+    bool str(std::string& value) {
+        size_t length;
+        if (!count(length)) return false;
+        value.assign(in, pos, length);
+        pos += length;
+        return true;
+    }
+
+    bool f64(double& value) {
+        if (in.size() - pos < 8) return false;
+        std::uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+            bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[pos++])) << (8 * i);
+        }
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+};
+
+void writeUser(Writer& w, const UserRef& user) {
+    const UserProfile& profile = user->getProfile();
+    w.str(profile.id);
+    w.str(profile.username);
+    w.str(profile.email);
+    w.str(profile.password);
+    w.str(profile.fullName);
+    w.str(profile.bio);
+    w.signedVarint(user->getVersion());
+
+    const Cart& cart = user->getCart();
+    w.varint(cart.getItems().size());
+    for (const auto& item : cart.getItems()) {
+        w.str(item.productId);
+        w.str(item.name);
+        w.f64(item.price);
+        w.varint(item.quantity);
+    }
+    w.signedVarint(cart.getVersion());
+    w.signedVarint(cart.getLastTouched());
+
+    const PurchaseSegment* history = user->getHistory();
+    w.varint(history ? history->size() : 0);
+    if (history) {
+        history->forEach([&w](const PurchaseRecord& record) {
+            w.str(record.id);
+            w.str(record.name);
+            w.f64(record.price);
+            w.varint(record.quantity);
+        });
+    }
+}
+
+bool readUser(Reader& r, UserRef& user) {
+    UserProfile profile;
+    long long version;
+    if (!r.str(profile.id) || !r.str(profile.username) || !r.str(profile.email) || !r.str(profile.password) ||
+        !r.str(profile.fullName) || !r.str(profile.bio) || !r.signedVarint(version)) {
+        return false;
+    }
+
+    // Catalog slots are not carried over: the new binary's catalog may differ, and
+    // checkout looks up lines without a slot by product id
+    Cart cart;
+    size_t itemCount;
+    if (!r.count(itemCount)) return false;
+    for (size_t i = 0; i < itemCount; ++i) {
+        CartItem item;
+        std::uint64_t quantity;
+        if (!r.str(item.productId) || !r.str(item.name) || !r.f64(item.price) || !r.varint(quantity)) {
+            return false;
+        }
+        item.quantity = static_cast<unsigned int>(quantity);
+        cart.addItem(item);
+    }
+    long long cartVersion;
+    long long lastTouched;
+    if (!r.signedVarint(cartVersion) || !r.signedVarint(lastTouched)) return false;
+    cart.setVersion(cartVersion);
+    cart.setLastTouched(lastTouched);
+
+    std::vector<PurchaseRecord> purchases;
+    size_t recordCount;
+    if (!r.count(recordCount)) return false;
+    purchases.reserve(recordCount);
+    for (size_t i = 0; i < recordCount; ++i) {
+        PurchaseRecord record;
+        std::uint64_t quantity;
+        if (!r.str(record.id) || !r.str(record.name) || !r.f64(record.price) || !r.varint(quantity)) {
+            return false;
+        }
+        record.quantity = static_cast<unsigned int>(quantity);
+        purchases.push_back(record);
+    }
+
+    user = UserSnapshot::create(std::move(profile))->withCart(std::move(cart));
+    if (!purchases.empty()) {
+        user = user->withPurchases(purchases);
+    }
+    user = user->withVersion(version);
+    return true;
+}
+
+} // namespace
+
+std::string WarmStateCodec::encode(const WarmState& state) {
+    std::string out(MAGIC, sizeof(MAGIC));
+    out.push_back(static_cast<char>(FORMAT_VERSION));
+    Writer w(out);
+
+    w.varint(state.users.size());
+    for (const auto& user : state.users) {
+        writeUser(w, user);
+    }
+    w.varint(state.sessions.size());
+    for (const auto& session : state.sessions) {
+        w.str(session.first);
+        w.str(session.second);
+    }
+    w.varint(state.cachedUsers.size());
+    for (const auto& cached : state.cachedUsers) {
+        w.signedVarint(cached.ageMs);
+        writeUser(w, cached.user);
+    }
+    return out;
+}
+
+bool WarmStateCodec::decode(const std::string& bytes, WarmState& state) {
+    if (bytes.size() < sizeof(MAGIC) + 1 || bytes.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0 ||
+        static_cast<unsigned char>(bytes[sizeof(MAGIC)]) != FORMAT_VERSION) {
+        return false;
+    }
+    Reader r(bytes, sizeof(MAGIC) + 1);
+    WarmState decoded;
+
+    size_t count;
+    if (!r.count(count)) return false;
+    for (size_t i = 0; i < count; ++i) {
+        UserRef user;
+        if (!readUser(r, user)) return false;
+        decoded.users.push_back(user);
+    }
+    if (!r.count(count)) return false;
+    for (size_t i = 0; i < count; ++i) {
+        std::pair<std::string, std::string> session;
+        if (!r.str(session.first) || !r.str(session.second)) return false;
+        decoded.sessions.push_back(session);
+    }
+    if (!r.count(count)) return false;
+    for (size_t i = 0; i < count; ++i) {
+        CachedUserState cached;
+        if (!r.signedVarint(cached.ageMs) || !readUser(r, cached.user)) return false;
+        decoded.cachedUsers.push_back(cached);
+    }
+    if (!r.done()) return false;
+
+    state = std::move(decoded);
+    return true;
+}
@@ -0,0 +1,41 @@
+/**
+ * WarmState - in-memory state handed from a server to its replacement
+ * On a hot restart the old process serializes its session table, in-memory
+ * users (when MongoDB is off) and user cache into one compact binary stream,
+ * so the new process starts with warm state instead of empty maps.
+ */
+
+#ifndef WARM_STATE_H
+#define WARM_STATE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "UserSnapshot.h"
+
+struct CachedUserState {
+    UserRef user;
+    long long ageMs; // time since the entry was loaded, so it expires on schedule
+};
+
+struct WarmState {
+    std::vector<UserRef> users;                                 // in-memory users (MongoDB off)
+    std::vector<std::pair<std::string, std::string>> sessions;  // token -> user id
+    std::vector<CachedUserState> cachedUsers;                   // user cache entries (MongoDB on)
+};
+
+class WarmStateCodec {
+public:
+    /**
+     * Encode as "WARM", a format version, then length-prefixed strings and
+     * varint integers; purchase history is flattened oldest first
+     */
+    static std::string encode(const WarmState& state);
+
+    /**
+     * @return false if the bytes are truncated, corrupt or another format version
+     */
+    static bool decode(const std::string& bytes, WarmState& state);
+};
+
+#endif // WARM_STATE_H
@@ -0,0 +1,245 @@
+/**
+ * Admission Control Test Cases
+ * Using Catch2 Framework
+ * Tests route classification, weighted queueing, load shedding and the adaptive limit
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/AdmissionControl.h"
+
+static AdmissionConfig fixedLimit(size_t limit) {
+    AdmissionConfig config;
+    config.initialLimit = limit;
+    config.minLimit = limit;
+    config.maxLimit = limit;
+    return config;
+}
+
+static size_t queuedTotal(const AdmissionController& controller) {
+    size_t total = 0;
+    for (const auto& entry : controller.getStats().classes) total += entry.queued;
+    return total;
+}
+
+static void waitForQueued(const AdmissionController& controller, size_t expected) {
+    for (int i = 0; i < 2000 && queuedTotal(controller) < expected; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_CASE("Routes are classified by business value", "[admission]") {
+    REQUIRE(AdmissionController::classify("POST", "/api/cart/checkout") == RequestClass::Critical);
+    REQUIRE(AdmissionController::classify("POST", "/api/login") == RequestClass::Critical);
+    REQUIRE(AdmissionController::classify("POST", "/api/signup") == RequestClass::Critical);
+    REQUIRE(AdmissionController::classify("GET", "/api/cart") == RequestClass::Cart);
+    REQUIRE(AdmissionController::classify("PATCH", "/api/cart/ITEM001") == RequestClass::Cart);
+    REQUIRE(AdmissionController::classify("GET", "/api/purchase-history") == RequestClass::Cart);
+    REQUIRE(AdmissionController::classify("GET", "/api/catalog") == RequestClass::Browse);
+    REQUIRE(AdmissionController::classify("GET", "/api/search") == RequestClass::Browse);
+    REQUIRE(AdmissionController::classify("GET", "/store.js") == RequestClass::Static);
+    REQUIRE(AdmissionController::classify("GET", "/") == RequestClass::Static);
+    REQUIRE(AdmissionController::classify("GET", "/api/health") == RequestClass::Exempt);
+    REQUIRE(AdmissionController::classify("GET", "/api/admin/stats") == RequestClass::Exempt);
+}
+
+TEST_CASE("Requests under the limit are admitted at once", "[admission]") {
+    AdmissionController controller;
+    controller.configure(fixedLimit(2));
+    REQUIRE(controller.acquire(RequestClass::Browse));
+    REQUIRE(controller.acquire(RequestClass::Static));
+    REQUIRE(controller.getStats().inFlight == 2);
+
+    // Exempt requests never take a slot
+    REQUIRE(controller.acquire(RequestClass::Exempt));
+    REQUIRE(controller.getStats().inFlight == 2);
+
+    controller.release(1000);
+    controller.release(1000);
+    REQUIRE(controller.getStats().inFlight == 0);
+}
+
+TEST_CASE("Queued classes are served by weight, highest priority first", "[admission]") {
+    AdmissionController controller;
+    AdmissionConfig config = fixedLimit(1);
+    config.maxWaitMs[0] = config.maxWaitMs[1] = config.maxWaitMs[2] = config.maxWaitMs[3] = 10000;
+    controller.configure(config);
+    REQUIRE(controller.acquire(RequestClass::Cart)); // hold the only slot
+
+    std::mutex orderMutex;
+    std::vector<std::string> order;
+    std::atomic<int> rejected(0);
+    std::vector<std::thread> threads;
+    auto enqueue = [&](RequestClass requestClass, int count) {
+        for (int i = 0; i < count; ++i) {
+            threads.emplace_back([&, requestClass] {
+                if (!controller.acquire(requestClass)) {
+                    rejected++;
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(orderMutex);
+                    order.push_back(AdmissionController::className(requestClass));
+                }
+                controller.release(1000);
+            });
+        }
+    };
+    enqueue(RequestClass::Static, 3);
+    waitForQueued(controller, 3);
+    enqueue(RequestClass::Critical, 8);
+    waitForQueued(controller, 11);
+
+    controller.release(1000);
+    for (auto& thread : threads) thread.join();
+
+    // Weights 8:1 - the first static request is admitted only after most critical ones
+    REQUIRE(rejected == 0);
+    REQUIRE(order.size() == 11);
+    REQUIRE(order[0] == "critical");
+    size_t firstStatic = 0;
+    while (order[firstStatic] != "static") firstStatic++;
+    REQUIRE(firstStatic >= 4);
+}
+
+TEST_CASE("Overload sheds requests whose queue is full or that wait too long", "[admission]") {
+    AdmissionController controller;
+    AdmissionConfig config = fixedLimit(1);
+    config.queueCapacity[static_cast<size_t>(RequestClass::Static)] = 0;
+    config.maxWaitMs[static_cast<size_t>(RequestClass::Browse)] = 20;
+    controller.configure(config);
+    REQUIRE(controller.acquire(RequestClass::Critical));
+
+    REQUIRE_FALSE(controller.acquire(RequestClass::Static));  // no queue at all
+    REQUIRE_FALSE(controller.acquire(RequestClass::Browse));  // times out
+    AdmissionStats stats = controller.getStats();
+    REQUIRE(stats.classes[static_cast<size_t>(RequestClass::Static)].shed == 1);
+    REQUIRE(stats.classes[static_cast<size_t>(RequestClass::Browse)].shed == 1);
+    REQUIRE(stats.classes[static_cast<size_t>(RequestClass::Browse)].queued == 0);
+    controller.release(1000);
+}
+
+TEST_CASE("Queues fit in the spare workers and keep room for checkout", "[admission]") {
+    AdmissionConfig config = fixedLimit(2);
+    config.sizeQueues(10);
+    size_t background = 0;
+    for (size_t i = 1; i < REQUEST_CLASS_COUNT; ++i) background += config.queueCapacity[i];
+    REQUIRE(config.queueCapacity[0] >= 1);
+    REQUIRE(config.queueCapacity[0] + background <= 8);
+
+    // No workers to spare: nothing queues
+    AdmissionConfig saturated = fixedLimit(8);
+    saturated.sizeQueues(8);
+    for (size_t i = 0; i < REQUEST_CLASS_COUNT; ++i) REQUIRE(saturated.queueCapacity[i] == 0);
+
+    // Default config matches the default worker count
+    AdmissionConfig defaults;
+    AdmissionConfig sized;
+    sized.sizeQueues(64);
+    for (size_t i = 0; i < REQUEST_CLASS_COUNT; ++i) REQUIRE(defaults.queueCapacity[i] == sized.queueCapacity[i]);
+}
+
+TEST_CASE("Checkout is admitted while the background queues are full", "[admission]") {
+    const size_t workers = 10;
+    AdmissionController controller;
+    AdmissionConfig config = fixedLimit(2);
+    for (size_t i = 0; i < REQUEST_CLASS_COUNT; ++i) config.maxWaitMs[i] = 10000;
+    config.sizeQueues(workers);
+    controller.configure(config);
+    REQUIRE(controller.acquire(RequestClass::Browse));
+    REQUIRE(controller.acquire(RequestClass::Browse));
+
+    // Fill every background queue; each waiter stands for a blocked worker
+    std::atomic<int> released(0);
+    std::vector<std::thread> threads;
+    size_t background = 0;
+    for (RequestClass requestClass : {RequestClass::Cart, RequestClass::Browse, RequestClass::Static}) {
+        size_t capacity = config.queueCapacity[static_cast<size_t>(requestClass)];
+        for (size_t i = 0; i < capacity; ++i) {
+            threads.emplace_back([&, requestClass] {
+                if (controller.acquire(requestClass)) {
+                    controller.release(1000);
+                    released++;
+                }
+            });
+        }
+        background += capacity;
+    }
+    waitForQueued(controller, background);
+    REQUIRE(queuedTotal(controller) == background);
+    REQUIRE_FALSE(controller.acquire(RequestClass::Static, 0));
+    REQUIRE_FALSE(controller.acquire(RequestClass::Cart, 0));
+
+    // Running plus waiting requests leave a worker free to read the checkout
+    REQUIRE(2 + background < workers);
+    std::atomic<bool> checkedOut(false);
+    std::thread checkout([&] {
+        if (controller.acquire(RequestClass::Critical)) {
+            checkedOut = true;
+            controller.release(1000);
+        }
+    });
+    waitForQueued(controller, background + 1);
+
+    // The first free slot goes to checkout, ahead of the waiting background requests
+    controller.release(1000);
+    checkout.join();
+    REQUIRE(checkedOut);
+
+    controller.release(1000);
+    for (auto& thread : threads) thread.join();
+    REQUIRE(released == static_cast<int>(background));
+}
+
+TEST_CASE("A caller's own wait bound cuts the class's max wait short", "[admission]") {
+    AdmissionController controller;
+    controller.configure(fixedLimit(1));
+    REQUIRE(controller.acquire(RequestClass::Critical));
+
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(controller.acquire(RequestClass::Critical, 20));  // class allows 5 s
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+    REQUIRE(controller.getStats().classes[static_cast<size_t>(RequestClass::Critical)].shed == 1);
+    controller.release(1000);
+}
+
+TEST_CASE("The limit grows while saturated and fast, and backs off when slow", "[admission]") {
+    AdmissionController controller;
+    AdmissionConfig config;
+    config.initialLimit = 4;
+    config.minLimit = 2;
+    config.maxLimit = 8;
+    config.latencyTargetMs = 100;
+    controller.configure(config);
+
+    // Saturated and fast: additive increase of about one per limit's worth of completions
+    for (int round = 0; round < 40; ++round) {
+        for (int i = 0; i < 4; ++i) REQUIRE(controller.acquire(RequestClass::Browse));
+        for (int i = 0; i < 4; ++i) controller.release(10 * 1000);
+    }
+    double grown = controller.getStats().limit;
+    REQUIRE(grown > 4.0);
+    REQUIRE(grown <= 8.0);
+
+    // Slow completions: multiplicative decrease, down to the minimum
+    for (int round = 0; round < 100; ++round) {
+        REQUIRE(controller.acquire(RequestClass::Browse));
+        controller.release(500 * 1000);
+    }
+    REQUIRE(controller.getStats().limit == Approx(2.0));
+
+    // Idle, fast traffic does not inflate the limit
+    AdmissionController idle;
+    idle.configure(config);
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(idle.acquire(RequestClass::Browse));
+        idle.release(1000);
+    }
+    REQUIRE(idle.getStats().limit == Approx(4.0));
+}
@@ -0,0 +1,146 @@
+/**
+ * CartSweeper Test Cases
+ * Using Catch2 Framework
+ * Tests abandoned cart detection, incremental sweeping and the cart archive
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <map>
+#include <string>
+#include "../src/Backend/CartSweeper.h"
+
+TEST_CASE("Cart mutations stamp the last-touched time", "[cart_sweeper]") {
+    Cart cart;
+    REQUIRE(cart.getLastTouched() == 0);
+
+    long long before = CartSweeper::nowMs();
+    cart.addItem(CartItem("ITEM001", "Item", 10.0, 1));
+    REQUIRE(cart.getLastTouched() >= before);
+
+    SECTION("Failed mutations do not count as activity") {
+        cart.setLastTouched(1000);
+        REQUIRE_FALSE(cart.removeItem("MISSING"));
+        REQUIRE_FALSE(cart.updateQuantity("MISSING", 2));
+        REQUIRE(cart.getLastTouched() == 1000);
+    }
+
+    SECTION("Abandoned only when non-empty and older than the cutoff") {
+        cart.setLastTouched(1000);
+        REQUIRE(cart.isAbandoned(2000));
+        REQUIRE_FALSE(cart.isAbandoned(1000));
+
+        Cart empty;
+        empty.setLastTouched(1000);
+        REQUIRE_FALSE(empty.isAbandoned(2000));
+
+        cart.setLastTouched(0); // unknown age is never expired
+        REQUIRE_FALSE(cart.isAbandoned(2000));
+    }
+}
+
+TEST_CASE("CartArchive encodes items compactly", "[cart_sweeper]") {
+    std::vector<CartItem> items;
+    items.push_back(CartItem("ITEM001", "Laptop", 999.99, 1));
+    items.push_back(CartItem("ITEM002", "Mouse", 25.5, 3));
+
+    std::string encoded = CartArchive::encodeItems(items);
+    REQUIRE(encoded == "ITEM001*1@999.99;ITEM002*3@25.50;");
+
+    std::vector<CartItem> decoded = CartArchive::decodeItems(encoded + "garbage;");
+    REQUIRE(decoded.size() == 2);
+    REQUIRE(decoded[1].productId == "ITEM002");
+    REQUIRE(decoded[1].quantity == 3);
+    REQUIRE(decoded[1].price == Approx(25.5));
+
+    SECTION("Archive is bounded and returns newest first") {
+        CartArchive archive(2);
+        Cart cart;
+        cart.addItem(items[0]);
+        archive.add("1", cart, 100);
+        archive.add("2", cart, 200);
+        archive.add("3", cart, 300);
+        REQUIRE(archive.size() == 2);
+
+        std::vector<ArchivedCart> recent = archive.recent(5);
+        REQUIRE(recent.size() == 2);
+        REQUIRE(recent[0].userId == "3");
+        REQUIRE(recent[1].userId == "2");
+        REQUIRE(recent[0].items == "ITEM001*1@999.99;");
+    }
+}
+
+TEST_CASE("CartSweeper expires carts incrementally", "[cart_sweeper]") {
+    // Simulated user store: 25 carts, every other one stale
+    std::map<std::string, Cart> carts;
+    for (int i = 0; i < 25; ++i) {
+        Cart cart;
+        cart.addItem(CartItem("ITEM001", "Item", 1.0, 1));
+        cart.setLastTouched(i % 2 == 0 ? 1000 : 9000);
+        carts["user" + std::to_string(100 + i)] = cart;
+    }
+
+    std::string cursor;
+    long long seenCutoff = 0;
+    CartSweeper sweeper;
+    CartSweeperConfig config;
+    config.expiryMs = 5000;
+    config.batchSize = 10;
+    config.sliceBudgetUs = 1000000;
+    sweeper.configure(config);
+    sweeper.setBatchFunction([&](long long cutoffMs, size_t batchSize,
+                                 std::chrono::steady_clock::time_point, size_t& expired) {
+        seenCutoff = cutoffMs;
+        auto it = carts.upper_bound(cursor);
+        for (size_t n = 0; it != carts.end() && n < batchSize; ++it, ++n) {
+            if (it->second.isAbandoned(cutoffMs)) {
+                it->second = Cart();
+                expired++;
+            }
+            cursor = it->first;
+        }
+        if (it == carts.end()) {
+            cursor.clear();
+            return true;
+        }
+        return false;
+    });
+
+    REQUIRE_FALSE(sweeper.runBatch(10000));
+    REQUIRE(seenCutoff == 5000);
+    REQUIRE(sweeper.expired() == 5);
+    REQUIRE_FALSE(sweeper.runBatch(10000));
+    REQUIRE(sweeper.runBatch(10000));
+    REQUIRE(sweeper.expired() == 13);
+    REQUIRE(sweeper.batches() == 3);
+    REQUIRE(sweeper.passes() == 1);
+    REQUIRE(carts["user100"].isEmpty());
+    REQUIRE_FALSE(carts["user101"].isEmpty());
+
+    SECTION("Disabled expiry never runs the batch function") {
+        config.expiryMs = 0;
+        sweeper.configure(config);
+        REQUIRE(sweeper.runBatch(10000));
+        REQUIRE_FALSE(sweeper.tick(10000));
+        REQUIRE(sweeper.batches() == 3);
+    }
+
+    SECTION("Ticks run batches until a pass completes, then wait for the pass interval") {
+        for (auto& pair : carts) {
+            pair.second.addItem(CartItem("ITEM002", "Item", 1.0, 1));
+            pair.second.setLastTouched(1000);
+        }
+        config.passIntervalMs = 60000;
+        sweeper.configure(config);
+
+        REQUIRE(sweeper.tick(10000));
+        REQUIRE(sweeper.tick(10001));
+        REQUIRE(sweeper.tick(10002));
+        REQUIRE(sweeper.passes() == 2);
+        REQUIRE(sweeper.expired() == 38);
+
+        REQUIRE_FALSE(sweeper.tick(20000));
+        REQUIRE(sweeper.tick(70002));
+        REQUIRE(sweeper.batches() == 7);
+    }
+}
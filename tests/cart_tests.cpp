@@ -34,3 +34,29 @@ TEST_CASE("Cart updates quantity and removes items", "[cart]") {
 }
 
 
+
+TEST_CASE("Cart version counts every change and survives copies", "[cart]") {
+  Cart cart;
+  REQUIRE(cart.getVersion() == 0);
+
+  cart.addItem(CartItem("ITEM002", "Mouse", 25.00, 1));
+  cart.updateQuantity("ITEM002", 3);
+  REQUIRE(cart.getVersion() == 2);
+
+  // Failed changes leave the version alone
+  REQUIRE_FALSE(cart.updateQuantity("ITEM999", 1));
+  REQUIRE_FALSE(cart.removeItem("ITEM999"));
+  REQUIRE(cart.getVersion() == 2);
+
+  Cart copy = cart;
+  copy.clear();
+  REQUIRE(copy.getVersion() == 3);
+  REQUIRE(cart.getVersion() == 2);
+
+  cart.applyPrices({20.00}, {true});
+  REQUIRE(cart.getVersion() == 3);
+
+  cart.setVersion(41);
+  cart.removeItem("ITEM002");
+  REQUIRE(cart.getVersion() == 42);
+}
@@ -0,0 +1,181 @@
+/**
+ * Catalog Test Cases
+ * Using Catch2 Framework
+ * Tests catalog snapshots, interned product slots, checkout repricing and catalog files
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include "../src/Backend/Cart.h"
+#include "../src/Backend/Catalog.h"
+#include "../src/Backend/SearchService.h"
+
+static std::shared_ptr<const CatalogSnapshot> makeCatalog() {
+    std::vector<CatalogItem> items;
+    items.push_back(CatalogItem("ITEM001", "Laptop", 999.99));
+    items.push_back(CatalogItem("ITEM002", "Mouse", 29.99));
+    items.push_back(CatalogItem("ITEM003", "Keyboard", 79.99));
+    return std::make_shared<const CatalogSnapshot>(items, 1);
+}
+
+static CartItem makeLine(const std::shared_ptr<const CatalogSnapshot>& catalog, const std::string& id,
+                         unsigned int quantity) {
+    unsigned int slot = catalog->slotOf(id);
+    const CatalogItem& item = catalog->at(slot);
+    CartItem line(id, item.name, item.price, quantity);
+    line.catalogSlot = slot;
+    return line;
+}
+
+TEST_CASE("Product ids are interned to stable slots", "[catalog]") {
+    auto catalog = makeCatalog();
+    REQUIRE(catalog->size() == 3);
+    REQUIRE(catalog->slotOf("ITEM002") == 1);
+    REQUIRE(catalog->slotOf("ITEM999") == CatalogSnapshot::NO_SLOT);
+
+    SECTION("A matching hint is used, a stale or missing one falls back to a lookup") {
+        REQUIRE(catalog->resolve("ITEM003", 2) == 2);
+        REQUIRE(catalog->resolve("ITEM003", 0) == 2);
+        REQUIRE(catalog->resolve("ITEM003", CatalogSnapshot::NO_SLOT) == 2);
+        REQUIRE(catalog->resolve("ITEM999", 1) == CatalogSnapshot::NO_SLOT);
+    }
+
+    SECTION("A price change publishes a new snapshot with the same slots") {
+        auto updated = catalog->withPrice(1, 24.99);
+        REQUIRE(updated->getGeneration() == catalog->getGeneration() + 1);
+        REQUIRE(updated->slotOf("ITEM002") == 1);
+        REQUIRE(updated->at(1).price == Approx(24.99));
+        REQUIRE(catalog->at(1).price == Approx(29.99));
+    }
+}
+
+TEST_CASE("Carts are repriced against the current snapshot", "[catalog]") {
+    auto catalog = makeCatalog();
+    Cart cart;
+    cart.addItem(makeLine(catalog, "ITEM001", 1));
+    cart.addItem(makeLine(catalog, "ITEM002", 2));
+
+    SECTION("Unchanged prices report no changes") {
+        RepriceResult result;
+        catalog->reprice(cart.getItems(), result);
+        REQUIRE(result.changes.empty());
+        REQUIRE(result.total == Approx(cart.getTotal()));
+    }
+
+    SECTION("A raised price is reported and charged") {
+        auto updated = catalog->withPrice(catalog->slotOf("ITEM002"), 34.99);
+        RepriceResult result;
+        updated->reprice(cart.getItems(), result);
+
+        REQUIRE(result.changes.size() == 1);
+        REQUIRE(result.changes[0].productId == "ITEM002");
+        REQUIRE(result.changes[0].oldPrice == Approx(29.99));
+        REQUIRE(result.changes[0].newPrice == Approx(34.99));
+        REQUIRE(result.changes[0].available);
+        REQUIRE(result.total == Approx(999.99 + 2 * 34.99));
+
+        cart.applyPrices(result.prices, result.available);
+        REQUIRE(cart.getTotal() == Approx(result.total));
+        RepriceResult again;
+        updated->reprice(cart.getItems(), again);
+        REQUIRE(again.changes.empty());
+    }
+
+    SECTION("Lines without a slot (e.g. loaded from the database) are looked up") {
+        Cart stored;
+        stored.addItem(CartItem("ITEM003", "Keyboard", 59.99, 1));
+        RepriceResult result;
+        catalog->reprice(stored.getItems(), result);
+        REQUIRE(result.changes.size() == 1);
+        REQUIRE(result.total == Approx(79.99));
+    }
+
+    SECTION("Products missing from the catalog are reported and dropped") {
+        cart.addItem(CartItem("ITEM999", "Retired", 5.0, 1));
+        RepriceResult result;
+        catalog->reprice(cart.getItems(), result);
+        REQUIRE(result.changes.size() == 1);
+        REQUIRE_FALSE(result.changes[0].available);
+        REQUIRE(result.total == Approx(999.99 + 2 * 29.99));
+
+        cart.applyPrices(result.prices, result.available);
+        REQUIRE(cart.getItems().size() == 2);
+        REQUIRE(cart.getTotal() == Approx(result.total));
+    }
+
+    SECTION("Repricing keeps the cart's last-touched time") {
+        cart.setLastTouched(1000);
+        RepriceResult result;
+        catalog->withPrice(0, 899.99)->reprice(cart.getItems(), result);
+        cart.applyPrices(result.prices, result.available);
+        REQUIRE(cart.getLastTouched() == 1000);
+    }
+}
+
+TEST_CASE("SearchService publishes price changes as new snapshots", "[catalog]") {
+    SearchService service;
+    auto before = service.getCatalog();
+    CatalogItem item;
+    REQUIRE(service.getItemById("ITEM002", item));
+    double oldPrice = item.price;
+
+    REQUIRE(service.setItemPrice("ITEM002", oldPrice + 5.0));
+    REQUIRE(service.getItemById("ITEM002", item));
+    REQUIRE(item.price == Approx(oldPrice + 5.0));
+    // A held snapshot does not change underneath its reader
+    REQUIRE(before->at(before->slotOf("ITEM002")).price == Approx(oldPrice));
+    REQUIRE(service.getCatalog()->getGeneration() == before->getGeneration() + 1);
+
+    REQUIRE_FALSE(service.setItemPrice("ITEM999", 1.0));
+    REQUIRE_FALSE(service.setItemPrice("ITEM002", -1.0));
+    REQUIRE_FALSE(service.getItemById("ITEM999", item));
+}
+
+TEST_CASE("Catalog files round-trip and reject bad input", "[catalog]") {
+    std::vector<CatalogItem> items;
+    items.push_back(CatalogItem("ITEM001", "Laptop", 999.99, "16GB RAM"));
+    items.push_back(CatalogItem("ITEM002", "Mouse", 29.99));
+    std::string bytes = CatalogCodec::encode(items);
+
+    std::vector<CatalogItem> decoded;
+    REQUIRE(CatalogCodec::decode(bytes, decoded));
+    REQUIRE(decoded.size() == 2);
+    REQUIRE(decoded[0].id == "ITEM001");
+    REQUIRE(decoded[0].description == "16GB RAM");
+    REQUIRE(decoded[1].price == 29.99);
+
+    SECTION("Truncated or corrupt bytes are rejected") {
+        REQUIRE_FALSE(CatalogCodec::decode(bytes.substr(0, bytes.size() - 1), decoded));
+        REQUIRE(decoded.empty());
+        std::string wrongVersion = bytes;
+        wrongVersion[4] = 9;
+        REQUIRE_FALSE(CatalogCodec::decode(wrongVersion, decoded));
+        REQUIRE_FALSE(CatalogCodec::decode("", decoded));
+    }
+
+    SECTION("Repeated ids are rejected") {
+        items.push_back(CatalogItem("ITEM001", "Another laptop", 1.0));
+        REQUIRE_FALSE(CatalogCodec::decode(CatalogCodec::encode(items), decoded));
+    }
+}
+
+TEST_CASE("SearchService can replace the whole catalog", "[catalog]") {
+    SearchService service;
+    unsigned long long generation = service.getCatalog()->getGeneration();
+
+    std::vector<CatalogItem> items;
+    items.push_back(CatalogItem("ITEM900", "Desk Lamp", 24.99, "Warm LED desk lamp"));
+    REQUIRE(service.replaceCatalog(items));
+    REQUIRE(service.getCatalog()->size() == 1);
+    REQUIRE(service.getCatalog()->getGeneration() == generation + 1);
+    REQUIRE(service.searchCatalog("lamp").size() == 1);
+    CatalogItem item;
+    REQUIRE_FALSE(service.getItemById("ITEM001", item));
+
+    REQUIRE_FALSE(service.replaceCatalog(std::vector<CatalogItem>()));
+    items.push_back(CatalogItem("ITEM900", "Duplicate", 1.0));
+    REQUIRE_FALSE(service.replaceCatalog(items));
+    REQUIRE(service.getCatalog()->size() == 1);
+}
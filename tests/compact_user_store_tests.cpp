@@ -0,0 +1,201 @@
+/**
+ * Compact User Store Test Cases
+ * Using Catch2 Framework
+ * Tests the packed in-memory user table: lookups, compare-and-swap updates,
+ * index maintenance across renames, and side tables for carts and histories
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include "../src/Backend/CompactUserStore.h"
+
+static UserProfile makeProfile(const std::string& id) {
+    UserProfile profile;
+    profile.id = id;
+    profile.username = "user" + id;
+    profile.email = "User" + id + "@Example.com";
+    profile.password = "pw" + id;
+    return profile;
+}
+
+static UserRef makeUser(const std::string& id) {
+    return UserSnapshot::create(makeProfile(id));
+}
+
+static UserRef withPen(const UserRef& user) {
+    Cart cart = user->getCart();
+    cart.addItem(CartItem("P1", "Pen", 1.0, 1));
+    return user->withCart(std::move(cart));
+}
+
+TEST_CASE("Users are found by username, id and case-insensitive email", "[compact_user_store]") {
+    CompactUserStore store;
+    UserProfile profile = makeProfile("1");
+    profile.fullName = "Ada";                                    // inline
+    profile.bio = std::string(300, 'b') + "\nsecond line";       // blob
+    REQUIRE(store.insert(UserSnapshot::create(profile)));
+    REQUIRE(store.insert(makeUser("2")));
+    REQUIRE(store.size() == 2);
+
+    UserRef found = store.findByUsername("user1");
+    REQUIRE(found);
+    REQUIRE(found->getProfile().id == "1");
+    REQUIRE(found->getProfile().email == "User1@Example.com");
+    REQUIRE(found->getProfile().password == "pw1");
+    REQUIRE(found->getProfile().fullName == "Ada");
+    REQUIRE(found->getProfile().bio == profile.bio);
+
+    REQUIRE(store.findById("2")->getProfile().username == "user2");
+    REQUIRE(store.findByEmail("  user2@EXAMPLE.com ")->getId() == "2");
+    REQUIRE(store.containsUsername("user1"));
+    REQUIRE_FALSE(store.containsUsername("User1"));
+    REQUIRE(store.findByUsername("nobody") == nullptr);
+    REQUIRE(store.findById("3") == nullptr);
+    REQUIRE(store.findByEmail("") == nullptr);
+
+    // Usernames and ids are unique
+    UserProfile clash = makeProfile("3");
+    clash.username = "user1";
+    REQUIRE_FALSE(store.insert(UserSnapshot::create(clash)));
+    REQUIRE_FALSE(store.insert(makeUser("2")));
+    REQUIRE(store.size() == 2);
+}
+
+TEST_CASE("Only carts and histories in use take space", "[compact_user_store]") {
+    CompactUserStore store;
+    for (int i = 1; i <= 100; ++i) store.insert(makeUser(std::to_string(i)));
+
+    CompactUserStoreStats stats = store.getStats();
+    REQUIRE(stats.users == 100);
+    REQUIRE(stats.carts == 0);
+    REQUIRE(stats.histories == 0);
+    REQUIRE(store.cartAt(0) == nullptr);
+    REQUIRE(store.atSlot(0)->getCart().isEmpty());
+
+    UserRef before = store.findById("7");
+    UserRef after = withPen(before);
+    REQUIRE(store.replace(before, after));
+    REQUIRE(store.getStats().carts == 1);
+
+    // Lookups share the stored cart instead of copying it
+    UserRef found = store.findById("7");
+    REQUIRE(&found->getCart() == &after->getCart());
+    REQUIRE(store.cartAt(6) == &after->getCart());
+
+    PurchaseRecord record;
+    record.id = "P1";
+    record.name = "Pen";
+    record.price = 1.0;
+    record.quantity = 1;
+    Cart emptied = found->getCart();
+    emptied.clear();
+    UserRef bought = found->withCart(std::move(emptied))->withPurchases({record});
+    REQUIRE(store.replace(found, bought));
+    stats = store.getStats();
+    REQUIRE(stats.histories == 1);
+    // An emptied cart leaves the side table but keeps its version and time for conditional GETs
+    REQUIRE(stats.carts == 0);
+    REQUIRE(store.cartAt(6) == nullptr);
+    UserRef reloaded = store.findById("7");
+    REQUIRE(reloaded->getHistory() == bought->getHistory());
+    REQUIRE(reloaded->getCart().isEmpty());
+    REQUIRE(reloaded->getCart().getVersion() == bought->getCart().getVersion());
+    REQUIRE(reloaded->getCart().getLastTouched() == bought->getCart().getLastTouched());
+
+    // The compare-and-swap still sees a write to the empty cart
+    UserRef stale = store.findById("7");
+    REQUIRE(store.replace(reloaded, withPen(reloaded)));
+    REQUIRE_FALSE(store.replace(stale, withPen(stale)));
+    Cart cleared = store.findById("7")->getCart();
+    cleared.clear();
+    UserRef emptyAgain = store.findById("7")->withCart(std::move(cleared));
+    REQUIRE(store.replace(store.findById("7"), emptyAgain));
+    REQUIRE_FALSE(store.replace(reloaded, withPen(reloaded)));
+}
+
+TEST_CASE("replace is a compare-and-swap on the stored user", "[compact_user_store]") {
+    CompactUserStore store;
+    store.insert(makeUser("1"));
+
+    UserRef first = store.findById("1");
+    UserRef second = store.findById("1");
+    REQUIRE(first != second); // each lookup builds its own snapshot
+
+    REQUIRE(store.replace(first, withPen(first)));
+    // second was read before that write
+    REQUIRE_FALSE(store.replace(second, withPen(second)));
+    REQUIRE(store.findById("1")->getCart().getItems()[0].quantity == 1);
+
+    UserRef current = store.findById("1");
+    REQUIRE_FALSE(store.replace(current->withVersion(5), withPen(current)));
+    REQUIRE(store.replace(current, withPen(current)));
+    REQUIRE(store.findById("1")->getCart().getItems()[0].quantity == 2);
+    REQUIRE_FALSE(store.replace(makeUser("9"), makeUser("9")));
+}
+
+TEST_CASE("Renames and email changes move the index entries", "[compact_user_store]") {
+    CompactUserStore store;
+    const int count = 5000;
+    for (int i = 1; i <= count; ++i) REQUIRE(store.insert(makeUser(std::to_string(i))));
+
+    for (int i = 1; i <= count; i += 2) {
+        UserRef current = store.findById(std::to_string(i));
+        UserProfile renamed = current->getProfile();
+        renamed.username = "renamed" + renamed.id;
+        renamed.email = "new" + renamed.id + "@example.org";
+        REQUIRE(store.replace(current, current->withProfile(renamed)));
+    }
+
+    for (int i = 1; i <= count; ++i) {
+        std::string id = std::to_string(i);
+        bool renamed = i % 2 == 1;
+        UserRef byId = store.findById(id);
+        REQUIRE(byId);
+        REQUIRE(byId->getProfile().username == (renamed ? "renamed" : "user") + id);
+        REQUIRE(store.containsUsername("user" + id) == !renamed);
+        REQUIRE(store.containsUsername("renamed" + id) == renamed);
+        REQUIRE((store.findByEmail("user" + id + "@example.com") != nullptr) == !renamed);
+        REQUIRE((store.findByEmail("NEW" + id + "@example.org") != nullptr) == renamed);
+    }
+    REQUIRE(store.size() == count);
+}
+
+TEST_CASE("Rewritten long fields are compacted out of the blob", "[compact_user_store]") {
+    CompactUserStore store;
+    store.insert(makeUser("1"));
+    store.insert(makeUser("2"));
+
+    std::string bio;
+    for (int round = 0; round < 400; ++round) {
+        UserRef current = store.findById("1");
+        UserProfile profile = current->getProfile();
+        bio = "bio revision " + std::to_string(round) + " " + std::string(500, 'x');
+        profile.bio = bio;
+        REQUIRE(store.replace(current, current->withProfile(profile)));
+    }
+
+    // Without compaction the blob would hold every revision (over 200 KB)
+    CompactUserStoreStats stats = store.getStats();
+    REQUIRE(stats.blobBytes < 400 * 500 / 2);
+    REQUIRE(store.findById("1")->getProfile().bio == bio);
+    REQUIRE(store.findByEmail("user1@example.com")->getId() == "1");
+    REQUIRE(store.findByUsername("user2")->getProfile().email == "User2@Example.com");
+}
+
+TEST_CASE("put inserts or overwrites by id", "[compact_user_store]") {
+    CompactUserStore store;
+    store.put(makeUser("1"));
+    UserProfile changed = makeProfile("1");
+    changed.username = "other";
+    store.put(withPen(UserSnapshot::create(changed)));
+
+    REQUIRE(store.size() == 1);
+    REQUIRE_FALSE(store.containsUsername("user1"));
+    REQUIRE(store.findByUsername("other")->getCart().getItems().size() == 1);
+
+    store.clear();
+    REQUIRE(store.size() == 0);
+    REQUIRE(store.findById("1") == nullptr);
+}
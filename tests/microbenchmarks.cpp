@@ -0,0 +1,236 @@
+/**
+ * Microbenchmarks
+ * Using Catch2 Framework
+ * Times the real Cart, PurchaseHistory, SearchService and SettingsService at
+ * several sizes and writes the results as JSON, so a change to one of these
+ * classes can be compared against the previous numbers.
+ *
+ * The bundled Catch (v1) has no BENCHMARK macro, so measure() below does the
+ * timing: it picks an iteration count that runs for about a millisecond, then
+ * takes SAMPLES samples of that many calls. Catch still selects what runs, e.g.
+ * "[cart]" or "SearchService*".
+ *
+ * Build (from tests/):
+ *   g++ -O2 -std=c++17 -I. -I../src/Backend microbenchmarks.cpp ../src/Backend/Cart.cpp
+ *       ../src/Backend/PurchaseHistory.cpp ../src/Backend/SearchService.cpp ../src/Backend/Catalog.cpp
+ *       ../src/Backend/SettingsService.cpp ../src/Backend/SyntheticData.cpp ../src/Backend/UserSnapshot.cpp
+ *       -o microbenchmarks
+ * Run:
+ *   ./microbenchmarks [--json results.json] [catch test spec...]
+ */
+
+#define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_NO_POSIX_SIGNALS // the bundled Catch does not build against newer glibc otherwise
+#include "catch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../src/Backend/Cart.h"
+#include "../src/Backend/PurchaseHistory.h"
+#include "../src/Backend/SearchService.h"
+#include "../src/Backend/SettingsService.h"
+#include "../src/Backend/SyntheticData.h"
+#include "../src/Backend/json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+const int SAMPLES = 15;
+const double SAMPLE_TARGET_NS = 1e6;
+
+struct BenchmarkResult {
+    std::string name;
+    size_t size;
+    long long iterations; // calls per sample
+    double meanNs;        // per call
+    double medianNs;
+    double minNs;
+    double stddevNs;
+};
+
+std::vector<BenchmarkResult> results;
+
+// Keeps the optimizer from discarding the work being timed
+volatile size_t sink = 0;
+
+double elapsedNs(const std::function<void()>& body, long long iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < iterations; ++i) {
+        body();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+void measure(const std::string& name, size_t size, const std::function<void()>& body) {
+    long long iterations = 1;
+    double warmup = elapsedNs(body, iterations);
+    while (warmup < SAMPLE_TARGET_NS / 10 && iterations < (1LL << 30)) {
+        iterations *= 2;
+        warmup = elapsedNs(body, iterations);
+    }
+    iterations = std::max(1LL, static_cast<long long>(iterations * (SAMPLE_TARGET_NS / std::max(warmup, 1.0))));
+
+    std::vector<double> perCall;
+    for (int sample = 0; sample < SAMPLES; ++sample) {
+        perCall.push_back(elapsedNs(body, iterations) / static_cast<double>(iterations));
+    }
+    std::sort(perCall.begin(), perCall.end());
+    double mean = 0.0;
+    for (double value : perCall) mean += value;
+    mean /= perCall.size();
+    double variance = 0.0;
+    for (double value : perCall) variance += (value - mean) * (value - mean);
+
+    BenchmarkResult result = {name, size, iterations, mean, perCall[perCall.size() / 2], perCall.front(),
+                              std::sqrt(variance / perCall.size())};
+    results.push_back(result);
+    std::printf("%-40s %8zu %14.1f ns %14.1f ns\n", name.c_str(), size, result.meanNs, result.medianNs);
+}
+
+const size_t SIZES[] = {10, 100, 1000, 10000};
+
+std::string itemId(size_t index) {
+    return "ITEM" + std::to_string(index);
+}
+
+Cart makeCart(size_t lines) {
+    Cart cart;
+    for (size_t i = 0; i < lines; ++i) {
+        cart.addItem(CartItem(itemId(i), "Item " + std::to_string(i), 1.0 + i % 100, 1 + i % 3));
+    }
+    return cart;
+}
+
+PurchaseHistory makeHistory(size_t records) {
+    PurchaseHistory history;
+    for (size_t i = 0; i < records; ++i) {
+        history.recordPurchase(PurchaseRecord(itemId(i), "Item " + std::to_string(i), 1.0 + i % 100, 1 + i % 3));
+    }
+    return history;
+}
+
+} // namespace
+
+TEST_CASE("Cart benchmarks", "[benchmark][cart]") {
+    for (size_t size : SIZES) {
+        measure("Cart::addItem (build cart)", size, [size] {
+            Cart cart = makeCart(size);
+            sink += cart.getItems().size();
+        });
+
+        Cart cart = makeCart(size);
+        std::string last = itemId(size - 1);
+        unsigned int quantity = 1;
+        // findItem is private; updateQuantity is a lookup plus a small write
+        measure("Cart::updateQuantity (findItem, last)", size, [&cart, &last, &quantity] {
+            sink += cart.updateQuantity(last, quantity++ % 5 + 1);
+        });
+        measure("Cart::getTotal", size, [&cart] {
+            sink += static_cast<size_t>(cart.getTotal());
+        });
+    }
+}
+
+TEST_CASE("PurchaseHistory benchmarks", "[benchmark][history]") {
+    for (size_t size : SIZES) {
+        PurchaseHistory history = makeHistory(size);
+        std::string last = itemId(size - 1);
+        measure("PurchaseHistory::hasPurchase (last)", size, [&history, &last] {
+            sink += history.hasPurchase(last);
+        });
+        measure("PurchaseHistory::hasPurchase (miss)", size, [&history] {
+            sink += history.hasPurchase("NO-SUCH-ITEM");
+        });
+        measure("PurchaseHistory::getTotalSpent", size, [&history] {
+            sink += static_cast<size_t>(history.getTotalSpent());
+        });
+    }
+}
+
+TEST_CASE("SearchService benchmarks", "[benchmark][search]") {
+    for (size_t size : SIZES) {
+        SyntheticDataConfig config;
+        config.products = size;
+        config.users = 0;
+        SyntheticData data(config);
+        SearchService service;
+        REQUIRE(service.replaceCatalog(data.getCatalog()));
+
+        measure("SearchService::searchCatalog (common)", size, [&service] {
+            sink += service.searchCatalog("laptop").size();
+        });
+        measure("SearchService::searchCatalog (miss)", size, [&service] {
+            sink += service.searchCatalog("no such product").size();
+        });
+        measure("SearchService::searchCatalog (id)", size, [&service] {
+            sink += service.searchCatalog("ITEM000001").size();
+        });
+    }
+}
+
+TEST_CASE("SettingsService validator benchmarks", "[benchmark][settings]") {
+    SettingsService settings;
+    const size_t lengths[] = {8, 64, 256};
+    for (size_t length : lengths) {
+        std::string local(length, 'a');
+        std::string email = "  " + local + "@Example.com  ";
+        std::string username = "  " + std::string(std::min<size_t>(length, 30), 'u') + "  ";
+        std::string password(length, 'p');
+        std::string bio(std::min<size_t>(length, 160), 'b');
+
+        measure("SettingsService::validateUsername", length, [&settings, &username] {
+            sink += settings.validateUsername(username).valid;
+        });
+        measure("SettingsService::validateEmail", length, [&settings, &email] {
+            sink += settings.validateEmail(email).valid;
+        });
+        measure("SettingsService::validatePassword", length, [&settings, &password] {
+            sink += settings.validatePassword(password).valid;
+        });
+        measure("SettingsService::validateProfile", length, [&settings, &bio] {
+            sink += settings.validateProfile("Ada Lovelace", bio).valid;
+        });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // --json FILE is ours; everything else goes to Catch
+    std::string jsonPath;
+    std::vector<char*> catchArgs;
+    for (int i = 0; i < argc; ++i) {
+        if (std::string(argv[i]) == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            catchArgs.push_back(argv[i]);
+        }
+    }
+
+    std::printf("%-40s %8s %17s %17s\n", "benchmark", "size", "mean", "median");
+    Catch::Session session;
+    int status = session.applyCommandLine(static_cast<int>(catchArgs.size()), catchArgs.data());
+    if (status != 0) return status;
+    status = session.run();
+
+    if (!jsonPath.empty()) {
+        json list = json::array();
+        for (const auto& result : results) {
+            list.push_back({{"name", result.name}, {"size", result.size}, {"iterations", result.iterations},
+                            {"samples", SAMPLES}, {"meanNs", result.meanNs}, {"medianNs", result.medianNs},
+                            {"minNs", result.minNs}, {"stddevNs", result.stddevNs}});
+        }
+        std::ofstream out(jsonPath);
+        out << json{{"benchmarks", list}}.dump(2) << '\n';
+        if (!out) {
+            std::fprintf(stderr, "ERROR: cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+        std::printf("Wrote %zu results to %s\n", results.size(), jsonPath.c_str());
+    }
+    return status;
+}
@@ -0,0 +1,134 @@
+/**
+ * MongoDBService Operation Policy Test Cases
+ * Using Catch2 Framework
+ * Tests the per-operation read preference / write concern policy table
+ *
+ * NOTE: The replica set tests expect a local replica set (see run_mongodb_policy_tests.sh)
+ * and will skip if it is unavailable
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include "../src/Backend/MongoDBService.h"
+#include "../src/Backend/PurchaseHistory.h"
+#include "../src/Backend/User.h"
+
+TEST_CASE("Default operation policies", "[mongodb][policy]") {
+    MongoDBService service;
+
+    SECTION("Orders and account creation are durable") {
+        const OperationPolicy& order = service.getOperationPolicy(MongoOperation::OrderInsert);
+        REQUIRE(order.writeConcern == "majority");
+        REQUIRE(order.journal == true);
+
+        const OperationPolicy& create = service.getOperationPolicy(MongoOperation::UserCreate);
+        REQUIRE(create.writeConcern == "majority");
+        REQUIRE(create.journal == true);
+    }
+
+    SECTION("Cart and token writes only need primary acknowledgement") {
+        REQUIRE(service.getOperationPolicy(MongoOperation::CartWrite).writeConcern == "1");
+        REQUIRE(service.getOperationPolicy(MongoOperation::CartWrite).journal == false);
+        REQUIRE(service.getOperationPolicy(MongoOperation::TokenWrite).writeConcern == "1");
+        REQUIRE(service.getOperationPolicy(MongoOperation::TokenWrite).journal == false);
+    }
+
+    SECTION("Order history may be read from secondaries") {
+        REQUIRE(service.getOperationPolicy(MongoOperation::HistoryRead).readPreference == "secondaryPreferred");
+        REQUIRE(service.getOperationPolicy(MongoOperation::UserRead).readPreference == "primary");
+        REQUIRE(service.getOperationPolicy(MongoOperation::TokenRead).readPreference == "primary");
+    }
+}
+
+TEST_CASE("Operation policy parsing", "[mongodb][policy]") {
+    SECTION("Full spec") {
+        OperationPolicy policy;
+        REQUIRE(MongoDBService::parseOperationPolicy("w=majority,j=true,read=nearest,maxTimeMS=250", policy));
+        REQUIRE(policy.writeConcern == "majority");
+        REQUIRE(policy.journal == true);
+        REQUIRE(policy.readPreference == "nearest");
+        REQUIRE(policy.maxTimeMS == 250);
+    }
+
+    SECTION("Partial spec keeps existing fields") {
+        OperationPolicy policy("majority", true, "primary", 5000);
+        REQUIRE(MongoDBService::parseOperationPolicy(" maxTimeMS = 100 ", policy));
+        REQUIRE(policy.writeConcern == "majority");
+        REQUIRE(policy.journal == true);
+        REQUIRE(policy.maxTimeMS == 100);
+    }
+
+    SECTION("Invalid specs are rejected without modifying the policy") {
+        OperationPolicy policy("1", false, "primary", 1000);
+        REQUIRE_FALSE(MongoDBService::parseOperationPolicy("w=2", policy));
+        REQUIRE_FALSE(MongoDBService::parseOperationPolicy("read=fastest", policy));
+        REQUIRE_FALSE(MongoDBService::parseOperationPolicy("maxTimeMS=-5", policy));
+        REQUIRE_FALSE(MongoDBService::parseOperationPolicy("j=maybe", policy));
+        REQUIRE_FALSE(MongoDBService::parseOperationPolicy("w=1,colour=blue", policy));
+        REQUIRE(policy.writeConcern == "1");
+        REQUIRE(policy.maxTimeMS == 1000);
+    }
+
+    SECTION("Policies can be overridden per operation") {
+        MongoDBService service;
+        service.setOperationPolicy(MongoOperation::CartWrite, OperationPolicy("majority", true, "primary", 10));
+        REQUIRE(service.getOperationPolicy(MongoOperation::CartWrite).writeConcern == "majority");
+        REQUIRE(service.getOperationPolicy(MongoOperation::TokenWrite).writeConcern == "1");
+        REQUIRE(std::string(MongoDBService::operationName(MongoOperation::CartWrite)) == "CART_WRITE");
+    }
+}
+
+TEST_CASE("Operation policies against a replica set", "[mongodb][policy][replset]") {
+    const char* uriEnv = std::getenv("MONGODB_TEST_REPLSET_URI");
+    std::string uri = uriEnv ? uriEnv : "mongodb://localhost:27117/?replicaSet=rs0";
+
+    MongoDBService service;
+    if (!service.connect(uri, "policy_test_db")) {
+        WARN("Replica set not available - skipping replica set policy tests");
+        return;
+    }
+
+    SECTION("Token round trip with w:1 write and primary read") {
+        std::string token = "policy_token_" + std::to_string(time(nullptr));
+        REQUIRE(service.saveToken(token, "policy_user"));
+        REQUIRE(service.getUserIdFromToken(token) == "policy_user");
+    }
+
+    SECTION("Majority journaled order insert and secondaryPreferred history read") {
+        std::string userId = "policy_user_" + std::to_string(time(nullptr));
+        REQUIRE(service.createUser(userId, userId + "@example.com", "password123", userId));
+
+        std::vector<PurchaseRecord> purchases;
+        REQUIRE(service.addPurchase(userId, purchases, "ORD_" + userId, 0.0));
+
+        std::vector<std::string> history;
+        REQUIRE(service.getPurchaseHistory(userId, history));
+    }
+
+    SECTION("Cart writes from the same base version: the second is rejected") {
+        std::string userId = "policy_cart_user_" + std::to_string(time(nullptr));
+        REQUIRE(service.createUser(userId, userId + "@example.com", "password123", userId));
+
+        User base;
+        REQUIRE(service.findUserById(userId, base));
+
+        std::vector<CartItem> first = {CartItem("p1", "Widget", 9.99, 1)};
+        std::vector<CartItem> second = {CartItem("p2", "Gadget", 4.99, 2)};
+        long long version = 0;
+        REQUIRE(service.updateCart(userId, first, base.version, &version));
+        REQUIRE(version == base.version + 1);
+        REQUIRE_FALSE(service.updateCart(userId, second, base.version));
+
+        // The first write is kept; retrying from the reloaded version succeeds
+        User reloaded;
+        REQUIRE(service.findUserById(userId, reloaded));
+        REQUIRE(reloaded.version == version);
+        REQUIRE(reloaded.cart.getItems().size() == 1);
+        REQUIRE(reloaded.cart.getItems()[0].productId == "p1");
+        REQUIRE(service.updateCart(userId, second, reloaded.version));
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * Profiler Test Cases
+ * Using Catch2 Framework
+ * Tests the in-process sampling profiler behind /api/debug/profile
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/Profiler.h"
+
+static std::atomic<bool> keepBurning(false);
+
+double burnCpu() {
+    double value = 0;
+    while (keepBurning.load(std::memory_order_relaxed)) {
+        for (int i = 1; i < 10000; ++i) value += 1.0 / i;
+    }
+    return value;
+}
+
+TEST_CASE("Profile arguments are validated", "[profiler]") {
+    ProfileResult result;
+    REQUIRE_FALSE(Profiler::profile(0, 99, result));
+    REQUIRE_FALSE(result.error.empty());
+    REQUIRE_FALSE(Profiler::profile(Profiler::MAX_SECONDS + 1, 99, result));
+    REQUIRE_FALSE(Profiler::profile(1, 0, result));
+    REQUIRE_FALSE(Profiler::profile(1, Profiler::MAX_FREQUENCY_HZ + 1, result));
+    REQUIRE_FALSE(Profiler::isRunning());
+}
+
+TEST_CASE("Busy threads are sampled into folded stacks", "[profiler]") {
+    if (!Profiler::isSupported()) {
+        ProfileResult result;
+        REQUIRE_FALSE(Profiler::profile(1, 99, result));
+        return;
+    }
+
+    keepBurning = true;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 2; ++i) {
+        workers.emplace_back([] { burnCpu(); });
+    }
+
+    // A second profile is rejected while the first one runs
+    std::atomic<bool> secondRejected(false);
+    std::thread second([&secondRejected] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        ProfileResult other;
+        secondRejected = !Profiler::profile(1, 99, other) && !other.error.empty();
+    });
+
+    ProfileResult result;
+    bool ok = Profiler::profile(1, 199, result);
+    keepBurning = false;
+    for (auto& worker : workers) worker.join();
+    second.join();
+
+    REQUIRE(ok);
+    REQUIRE(secondRejected);
+    REQUIRE_FALSE(Profiler::isRunning());
+    REQUIRE(result.durationMs >= 1000);
+    REQUIRE(result.frequencyHz == 199);
+    // ~2 CPU-seconds at 199Hz; leave room for slow CI machines
+    REQUIRE(result.samples > 50);
+    REQUIRE(result.dropped == 0);
+
+    // Every line is "frame;frame;... count" and the counts add up to the samples
+    std::istringstream lines(result.folded);
+    std::string line;
+    size_t total = 0;
+    size_t stacks = 0;
+    while (std::getline(lines, line)) {
+        size_t space = line.find_last_of(' ');
+        REQUIRE(space != std::string::npos);
+        REQUIRE(space > 0);
+        std::string count = line.substr(space + 1);
+        REQUIRE(count.find_first_not_of("0123456789") == std::string::npos);
+        total += std::stoul(count);
+        stacks++;
+    }
+    REQUIRE(stacks > 0);
+    REQUIRE(total <= result.samples);
+    REQUIRE(total > 0);
+}
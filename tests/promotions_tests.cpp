@@ -0,0 +1,186 @@
+/**
+ * Promotions Test Cases
+ * Using Catch2 Framework
+ * Tests promotion rule parsing, compilation and cart evaluation
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/Cart.h"
+#include "../src/Backend/Promotions.h"
+
+static CatalogSnapshot makeCatalog() {
+    std::vector<CatalogItem> items;
+    items.push_back(CatalogItem("ITEM001", "Laptop", 1000.00));
+    items.push_back(CatalogItem("ITEM002", "Mouse", 30.00));
+    items.push_back(CatalogItem("ITEM003", "Keyboard", 80.00));
+    return CatalogSnapshot(items, 1);
+}
+
+static CartItem makeLine(const CatalogSnapshot& catalog, const std::string& id, unsigned int quantity) {
+    unsigned int slot = catalog.slotOf(id);
+    CartItem line(id, catalog.at(slot).name, catalog.at(slot).price, quantity);
+    line.catalogSlot = slot;
+    return line;
+}
+
+static PromotionResult price(const std::string& rulesText, const std::vector<CartItem>& lines) {
+    CatalogSnapshot catalog = makeCatalog();
+    std::vector<std::string> errors;
+    auto rules = PromotionEngine::compile(rulesText, catalog, errors);
+    REQUIRE(errors.empty());
+    PromotionResult result;
+    PromotionEngine::evaluate(rules, lines, catalog, result);
+    return result;
+}
+
+TEST_CASE("Rules are parsed and invalid lines are rejected", "[promotions]") {
+    CatalogSnapshot catalog = makeCatalog();
+    std::vector<std::string> errors;
+    auto rules = PromotionEngine::compile(
+        "# comment line\n"
+        "\n"
+        "percent_off id=MOUSE10 sku=ITEM002 percent=10   # trailing comment\n"
+        "buy_x_get_y id=KB21 sku=ITEM003 buy=2 get=1\n"
+        "cart_threshold id=SAVE20 min=200 amount=20\n"
+        "cart_threshold min=500 percent=5\n"
+        "percent_off id=BAD1 sku=ITEM999 percent=10\n"
+        "percent_off id=BAD2 sku=ITEM001 percent=150\n"
+        "buy_x_get_y id=BAD3 sku=ITEM001 buy=0 get=1\n"
+        "cart_threshold id=BAD4 min=10\n"
+        "free_shipping id=BAD5\n"
+        "percent_off id=BAD6 sku=ITEM001 percent\n",
+        catalog, errors);
+
+    REQUIRE(rules->ruleCount() == 4);
+    REQUIRE(rules->ruleIds[3] == "rule6"); // unnamed rules get their line number
+    REQUIRE(errors.size() == 6);
+    REQUIRE(errors[0].find("line 7") == 0);
+    REQUIRE(rules->skus.size() == catalog.size());
+}
+
+TEST_CASE("SKU rules discount their lines", "[promotions]") {
+    CatalogSnapshot catalog = makeCatalog();
+
+    SECTION("Percent off a SKU") {
+        auto result = price("percent_off id=MOUSE10 sku=ITEM002 percent=10\n",
+                            {makeLine(catalog, "ITEM002", 3), makeLine(catalog, "ITEM003", 1)});
+        REQUIRE(result.subtotal == Approx(170.0));
+        REQUIRE(result.discount == Approx(9.0));
+        REQUIRE(result.total == Approx(161.0));
+        REQUIRE(result.applied.size() == 1);
+        REQUIRE(result.ruleId(result.applied[0]) == "MOUSE10");
+        REQUIRE(result.applied[0].line == 0);
+    }
+
+    SECTION("Buy X get Y counts complete groups only") {
+        std::string rules = "buy_x_get_y id=MICE21 sku=ITEM002 buy=2 get=1\n";
+        REQUIRE(price(rules, {makeLine(catalog, "ITEM002", 2)}).discount == Approx(0.0));
+        REQUIRE(price(rules, {makeLine(catalog, "ITEM002", 3)}).discount == Approx(30.0));
+        REQUIRE(price(rules, {makeLine(catalog, "ITEM002", 7)}).discount == Approx(60.0));
+    }
+
+    SECTION("A line gets its best rule, not the sum") {
+        std::string rules =
+            "percent_off id=P5 sku=ITEM002 percent=5\n"
+            "percent_off id=P20 sku=ITEM002 percent=20\n"
+            "buy_x_get_y id=B21 sku=ITEM002 buy=2 get=1\n"
+            "buy_x_get_y id=B11 sku=ITEM002 buy=1 get=1\n";
+        auto small = price(rules, {makeLine(catalog, "ITEM002", 1)});
+        REQUIRE(small.discount == Approx(6.0));
+        REQUIRE(small.ruleId(small.applied[0]) == "P20");
+
+        auto large = price(rules, {makeLine(catalog, "ITEM002", 4)});
+        REQUIRE(large.discount == Approx(60.0));
+        REQUIRE(large.ruleId(large.applied[0]) == "B11");
+    }
+
+    SECTION("Lines without a remembered slot are resolved through the catalog") {
+        CartItem stored("ITEM002", "Mouse", 30.0, 2);
+        auto result = price("percent_off id=MOUSE10 sku=ITEM002 percent=10\n", {stored});
+        REQUIRE(result.discount == Approx(6.0));
+    }
+}
+
+TEST_CASE("Cart thresholds apply to the discounted subtotal", "[promotions]") {
+    CatalogSnapshot catalog = makeCatalog();
+    std::string rules =
+        "percent_off id=KB50 sku=ITEM003 percent=50\n"
+        "cart_threshold id=SAVE10 min=100 amount=10\n"
+        "cart_threshold id=SAVE25 min=300 amount=25\n"
+        "cart_threshold id=PCT5 min=1000 percent=5\n";
+
+    // 2 keyboards = 160, 80 after the SKU discount: below every threshold
+    auto below = price(rules, {makeLine(catalog, "ITEM003", 2)});
+    REQUIRE(below.discount == Approx(80.0));
+    REQUIRE(below.applied.size() == 1);
+
+    // 4 keyboards = 160 after discount: SAVE10
+    auto first = price(rules, {makeLine(catalog, "ITEM003", 4)});
+    REQUIRE(first.discount == Approx(170.0));
+    REQUIRE(first.ruleId(first.applied.back()) == "SAVE10");
+    REQUIRE(first.applied.back().line == -1);
+
+    // 1000 + 40 = 1040: 5% (52) beats the 25 amount
+    auto top = price(rules, {makeLine(catalog, "ITEM001", 1), makeLine(catalog, "ITEM003", 1)});
+    REQUIRE(top.ruleId(top.applied.back()) == "PCT5");
+    REQUIRE(top.discount == Approx(40.0 + 52.0));
+    REQUIRE(top.total == Approx(1080.0 - 92.0));
+
+    SECTION("A later threshold with a smaller amount does not lower the discount") {
+        auto result = price("cart_threshold id=BIG min=100 amount=50\ncart_threshold id=SMALL min=200 amount=5\n",
+                            {makeLine(catalog, "ITEM001", 1)});
+        REQUIRE(result.discount == Approx(50.0));
+        REQUIRE(result.ruleId(result.applied.back()) == "BIG");
+    }
+
+    SECTION("An amount never takes the total below zero") {
+        auto result = price("cart_threshold id=ALL min=0 amount=5000\n", {makeLine(catalog, "ITEM002", 1)});
+        REQUIRE(result.total == Approx(0.0));
+        REQUIRE(result.discount == Approx(30.0));
+    }
+}
+
+TEST_CASE("Rules are swapped whole and reloaded when the file changes", "[promotions]") {
+    CatalogSnapshot catalog = makeCatalog();
+    std::vector<CartItem> lines = {makeLine(catalog, "ITEM002", 1)};
+    const std::string path = "promotions_test_rules.txt";
+    std::remove(path.c_str());
+
+    PromotionEngine engine;
+    std::vector<std::string> errors;
+    REQUIRE(engine.load(path, catalog, errors)); // a missing file means no promotions
+    REQUIRE(engine.current()->ruleCount() == 0);
+
+    {
+        std::ofstream file(path);
+        file << "percent_off id=MOUSE10 sku=ITEM002 percent=10\n";
+    }
+    REQUIRE(engine.reloadIfChanged(catalog, errors));
+    REQUIRE_FALSE(engine.reloadIfChanged(catalog, errors));
+    PromotionResult before;
+    engine.evaluate(lines, catalog, before);
+    REQUIRE(before.discount == Approx(3.0));
+
+    // Readers holding a result keep the rules they were priced with
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100)); // mtime has 1s resolution
+    {
+        std::ofstream file(path);
+        file << "percent_off id=MOUSE50 sku=ITEM002 percent=50\n";
+    }
+    REQUIRE(engine.reloadIfChanged(catalog, errors));
+    PromotionResult after;
+    engine.evaluate(lines, catalog, after);
+    REQUIRE(after.discount == Approx(15.0));
+    REQUIRE(before.ruleId(before.applied[0]) == "MOUSE10");
+    REQUIRE(after.ruleId(after.applied[0]) == "MOUSE50");
+    REQUIRE(errors.empty());
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,173 @@
+/**
+ * Query Analytics Test Cases
+ * Using Catch2 Framework
+ * Tests the lock-free query ring, Space-Saving heavy hitters, the saved top
+ * queries file, and warming the search cache from it
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/QueryAnalytics.h"
+#include "../src/Backend/SearchService.h"
+
+TEST_CASE("Recorded queries are aggregated into counts", "[analytics]") {
+    QueryAnalytics analytics(16, 8);
+    for (int i = 0; i < 5; ++i) REQUIRE(analytics.record("laptop"));
+    for (int i = 0; i < 3; ++i) REQUIRE(analytics.record("mouse"));
+    REQUIRE(analytics.record("hdmi"));
+
+    // Nothing is counted until the background job drains the ring
+    REQUIRE(analytics.top(10).empty());
+    REQUIRE(analytics.aggregate() == 9);
+    REQUIRE(analytics.aggregate() == 0);
+
+    std::vector<QueryCount> top = analytics.top(2);
+    REQUIRE(top.size() == 2);
+    REQUIRE(top[0].query == "laptop");
+    REQUIRE(top[0].count == 5);
+    REQUIRE(top[0].error == 0);
+    REQUIRE(top[1].query == "mouse");
+    REQUIRE(top[1].count == 3);
+
+    REQUIRE_FALSE(analytics.record(""));
+    REQUIRE_FALSE(analytics.record(std::string(QueryAnalytics::MAX_QUERY_BYTES + 1, 'q')));
+    REQUIRE(analytics.record(std::string(QueryAnalytics::MAX_QUERY_BYTES, 'q')));
+
+    QueryAnalyticsStats stats = analytics.getStats();
+    REQUIRE(stats.recorded == 10);
+    REQUIRE(stats.skipped == 2);
+    REQUIRE(stats.dropped == 0);
+    REQUIRE(stats.tracked == 3);
+}
+
+TEST_CASE("A full ring drops queries instead of blocking", "[analytics]") {
+    QueryAnalytics analytics(4, 8);
+    for (int i = 0; i < 4; ++i) REQUIRE(analytics.record("q" + std::to_string(i)));
+    REQUIRE_FALSE(analytics.record("overflow"));
+    REQUIRE(analytics.getStats().dropped == 1);
+
+    // Draining frees every slot for the next lap
+    REQUIRE(analytics.aggregate() == 4);
+    for (int i = 0; i < 4; ++i) REQUIRE(analytics.record("again"));
+    REQUIRE(analytics.aggregate() == 4);
+    REQUIRE(analytics.top(1)[0].query == "again");
+    REQUIRE(analytics.top(1)[0].count == 4);
+}
+
+TEST_CASE("Space-Saving keeps the heavy hitters in a fixed number of counters", "[analytics]") {
+    QueryAnalytics analytics(1024, 4);
+    // Two heavy queries among many that are each searched once
+    for (int round = 0; round < 50; ++round) {
+        analytics.record("usb-c hub");
+        analytics.record("usb-c hub");
+        analytics.record("monitor");
+        analytics.record("rare " + std::to_string(round));
+        analytics.aggregate();
+    }
+    QueryAnalyticsStats stats = analytics.getStats();
+    REQUIRE(stats.tracked == 4);
+    REQUIRE(stats.aggregated == 200);
+
+    std::vector<QueryCount> top = analytics.top(2);
+    REQUIRE(top[0].query == "usb-c hub");
+    REQUIRE(top[0].count == 100);
+    REQUIRE(top[1].query == "monitor");
+    REQUIRE(top[1].count == 50);
+    // A query that took over a counter carries its predecessor's count as error
+    for (const auto& query : analytics.top(4)) {
+        REQUIRE(query.count - query.error <= 100);
+    }
+}
+
+TEST_CASE("Concurrent recorders lose nothing while the ring has room", "[analytics]") {
+    QueryAnalytics analytics(1 << 14, 16);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&analytics, t] {
+            for (int i = 0; i < 2000; ++i) {
+                analytics.record("query " + std::to_string(t));
+            }
+        });
+    }
+    // Drain while the writers are running
+    size_t drained = 0;
+    for (int i = 0; i < 20; ++i) drained += analytics.aggregate();
+    for (auto& thread : threads) thread.join();
+    drained += analytics.aggregate();
+
+    REQUIRE(drained == 8000);
+    REQUIRE(analytics.getStats().dropped == 0);
+    for (const auto& query : analytics.top(4)) {
+        REQUIRE(query.count == 2000);
+    }
+}
+
+TEST_CASE("Top queries are saved, loaded and seeded into a new run", "[analytics]") {
+    const std::string path = "query_analytics_test_top.txt";
+    QueryAnalytics first(64, 16);
+    for (int i = 0; i < 3; ++i) first.record("keyboard");
+    first.record("webcam");
+    first.aggregate();
+    REQUIRE(first.save(path, 10));
+
+    std::vector<QueryCount> loaded;
+    REQUIRE(QueryAnalytics::load(path, loaded));
+    REQUIRE(loaded.size() == 2);
+    REQUIRE(loaded[0].query == "keyboard");
+    REQUIRE(loaded[0].count == 3);
+    REQUIRE(loaded[1].query == "webcam");
+
+    QueryAnalytics second(64, 16);
+    second.seed(loaded);
+    second.record("webcam");
+    second.aggregate();
+    REQUIRE(second.top(1)[0].count == 3);
+    REQUIRE(second.top(2)[1].count == 2);
+
+    // Malformed lines are skipped
+    {
+        std::ofstream file(path);
+        file << "5\tlaptop\nnot a count\tx\n\tmissing\n7\n0\tzero\n2\tusb hub\r\n";
+    }
+    REQUIRE(QueryAnalytics::load(path, loaded));
+    REQUIRE(loaded.size() == 2);
+    REQUIRE(loaded[1].query == "usb hub");
+    std::remove(path.c_str());
+    REQUIRE_FALSE(QueryAnalytics::load(path, loaded));
+}
+
+TEST_CASE("The search cache is warmed and follows catalog changes", "[analytics][search]") {
+    SearchService service;
+    // Disabled by default
+    service.searchCatalog("laptop");
+    REQUIRE(service.warmCache(std::vector<std::string>({"laptop"})) == 0);
+    REQUIRE(service.getCacheStats().entries == 0);
+
+    service.setCacheCapacity(2);
+    REQUIRE(SearchService::normalizeQuery("  USB-C ") == "usb-c");
+    REQUIRE(service.warmCache(std::vector<std::string>({"USB-C", "laptop", "mouse"})) == 2);
+    SearchCacheStats stats = service.getCacheStats();
+    REQUIRE(stats.entries == 2);
+    REQUIRE(stats.warmed == 2);
+
+    // A warmed query is a hit on its first search
+    std::vector<CatalogItem> results = service.searchCatalog(" usb-c");
+    REQUIRE(results.size() == 2);
+    REQUIRE(service.getCacheStats().hits == 1);
+    REQUIRE(service.searchCatalog("mouse").size() == 2);
+    REQUIRE(service.getCacheStats().misses == 1);
+    REQUIRE(service.getCacheStats().entries == 2);
+
+    // A new price publishes a new catalog generation; cached results are recomputed
+    REQUIRE(service.setItemPrice("ITEM005", 10.0));
+    results = service.searchCatalog("usb-c");
+    REQUIRE(service.getCacheStats().misses == 2);
+    bool repriced = false;
+    for (const auto& item : results) repriced = repriced || (item.id == "ITEM005" && item.price == 10.0);
+    REQUIRE(repriced);
+}
@@ -0,0 +1,111 @@
+/**
+ * Request Deadline Test Cases
+ * Using Catch2 Framework
+ * Tests deadline budgets, client timeout headers, expiry and stage checks
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <chrono>
+#include <climits>
+#include <map>
+#include <string>
+#include <thread>
+#include "../src/Backend/RequestDeadline.h"
+
+TEST_CASE("Routes get their own budget, others the default", "[deadline]") {
+    DeadlinePolicy policy;
+    std::map<std::string, long long> routes;
+    routes["POST /api/cart/checkout"] = 15000;
+    routes["GET /api/cart/.*"] = 2000;
+    REQUIRE(policy.configure(5000, routes));
+
+    REQUIRE(policy.budgetFor("POST", "/api/cart/checkout", "") == 15000);
+    REQUIRE(policy.budgetFor("GET", "/api/cart/items", "") == 2000);
+    REQUIRE(policy.budgetFor("GET", "/api/cart/checkout", "") == 2000);
+    REQUIRE(policy.budgetFor("GET", "/api/catalog", "") == 5000);
+}
+
+TEST_CASE("The timeout header can only shorten the budget", "[deadline]") {
+    DeadlinePolicy policy;
+    REQUIRE(policy.configure(5000, std::map<std::string, long long>()));
+
+    REQUIRE(policy.budgetFor("GET", "/api/me", "800") == 800);
+    REQUIRE(policy.budgetFor("GET", "/api/me", "60000") == 5000);
+    REQUIRE(policy.budgetFor("GET", "/api/me", "0") == 5000);
+    REQUIRE(policy.budgetFor("GET", "/api/me", "-5") == 5000);
+    REQUIRE(policy.budgetFor("GET", "/api/me", "soon") == 5000);
+    REQUIRE(policy.budgetFor("GET", "/api/me", "99999999999999999999") == 5000);
+
+    // With no default deadline the client's header is the only one
+    REQUIRE(policy.configure(0, std::map<std::string, long long>()));
+    REQUIRE(policy.budgetFor("GET", "/api/me", "") == 0);
+    REQUIRE(policy.budgetFor("GET", "/api/me", "250") == 250);
+}
+
+TEST_CASE("An invalid route pattern leaves the policy unchanged", "[deadline]") {
+    DeadlinePolicy policy;
+    std::map<std::string, long long> routes;
+    routes["GET /api/(unclosed"] = 100;
+    REQUIRE_FALSE(policy.configure(3000, routes));
+    REQUIRE(policy.getDefaultMs() == 10000);
+    REQUIRE(policy.budgetFor("GET", "/api/(unclosed", "") == 10000);
+}
+
+TEST_CASE("Without a deadline nothing expires", "[deadline]") {
+    RequestDeadline::clear();
+    REQUIRE_FALSE(RequestDeadline::active());
+    REQUIRE(RequestDeadline::remainingMs() == LLONG_MAX);
+    REQUIRE(RequestDeadline::check("stage"));
+    REQUIRE(RequestDeadline::exceededAt() == nullptr);
+
+    RequestDeadline::start(0);
+    REQUIRE_FALSE(RequestDeadline::active());
+}
+
+TEST_CASE("Checks fail once the deadline passes and remember the first stage", "[deadline]") {
+    RequestDeadline::start(30);
+    REQUIRE(RequestDeadline::active());
+    REQUIRE(RequestDeadline::remainingMs() > 0);
+    REQUIRE(RequestDeadline::remainingMs() <= 30);
+    REQUIRE(RequestDeadline::check("load-user"));
+    REQUIRE(RequestDeadline::exceededAt() == nullptr);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(RequestDeadline::expired());
+    REQUIRE(RequestDeadline::remainingMs() == 0);
+    REQUIRE_FALSE(RequestDeadline::check("reprice"));
+    REQUIRE_FALSE(RequestDeadline::check("persist"));
+    REQUIRE(std::string(RequestDeadline::exceededAt()) == "reprice");
+
+    RequestDeadline::clear();
+    REQUIRE(RequestDeadline::exceededAt() == nullptr);
+    REQUIRE(RequestDeadline::check("next-request"));
+}
+
+TEST_CASE("Deadlines are per thread and can be handed to another thread", "[deadline]") {
+    RequestDeadline::start(60000);
+    RequestDeadline::TimePoint deadline = RequestDeadline::at();
+
+    bool otherHadDeadline = true;
+    bool adopted = false;
+    long long adoptedRemaining = 0;
+    std::thread worker([&] {
+        otherHadDeadline = RequestDeadline::active();
+        RequestDeadline::startAt(deadline);
+        adopted = RequestDeadline::active() && RequestDeadline::at() == deadline;
+        adoptedRemaining = RequestDeadline::remainingMs();
+    });
+    worker.join();
+
+    REQUIRE_FALSE(otherHadDeadline);
+    REQUIRE(adopted);
+    REQUIRE(adoptedRemaining > 59000);
+
+    // Starting a new deadline forgets a stage that failed under the old one
+    RequestDeadline::startAt(std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+    REQUIRE_FALSE(RequestDeadline::check("old"));
+    RequestDeadline::startAt(deadline);
+    REQUIRE(RequestDeadline::exceededAt() == nullptr);
+    RequestDeadline::clear();
+}
@@ -0,0 +1,76 @@
+/**
+ * Response Encoding Test Cases
+ * Using Catch2 Framework
+ * Tests Accept header negotiation and MessagePack/CBOR encoding of response bodies
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include "../src/Backend/ResponseEncoding.h"
+
+using json = nlohmann::json;
+
+static json decode(const std::string& body, BodyEncoding encoding) {
+    std::vector<std::uint8_t> bytes(body.begin(), body.end());
+    switch (encoding) {
+        case BodyEncoding::MsgPack: return json::from_msgpack(bytes);
+        case BodyEncoding::Cbor: return json::from_cbor(bytes);
+        default: return json::parse(body);
+    }
+}
+
+TEST_CASE("Accept headers are negotiated", "[encoding]") {
+    SECTION("JSON is the default") {
+        REQUIRE(ResponseEncoding::negotiate("") == BodyEncoding::Json);
+        REQUIRE(ResponseEncoding::negotiate("*/*") == BodyEncoding::Json);
+        REQUIRE(ResponseEncoding::negotiate("text/html") == BodyEncoding::Json);
+        REQUIRE(ResponseEncoding::negotiate("application/json") == BodyEncoding::Json);
+    }
+
+    SECTION("Binary media types") {
+        REQUIRE(ResponseEncoding::negotiate("application/msgpack") == BodyEncoding::MsgPack);
+        REQUIRE(ResponseEncoding::negotiate("application/x-msgpack") == BodyEncoding::MsgPack);
+        REQUIRE(ResponseEncoding::negotiate("Application/CBOR") == BodyEncoding::Cbor);
+    }
+
+    SECTION("Quality values pick the preferred type") {
+        REQUIRE(ResponseEncoding::negotiate("application/json;q=0.5, application/cbor") == BodyEncoding::Cbor);
+        REQUIRE(ResponseEncoding::negotiate("application/msgpack;q=0.2, application/json;q=0.9") == BodyEncoding::Json);
+        REQUIRE(ResponseEncoding::negotiate("application/msgpack; q=0") == BodyEncoding::Json);
+    }
+
+    SECTION("Ties go to the first listed type") {
+        REQUIRE(ResponseEncoding::negotiate("application/cbor, application/msgpack") == BodyEncoding::Cbor);
+        REQUIRE(ResponseEncoding::negotiate("application/msgpack, */*") == BodyEncoding::MsgPack);
+        REQUIRE(ResponseEncoding::negotiate("application/json, application/msgpack") == BodyEncoding::Json);
+    }
+}
+
+TEST_CASE("Every encoding carries the same document", "[encoding]") {
+    json body = {{"success", true},
+                 {"items", {{{"id", "ITEM001"}, {"name", "Laptop \"Pro\""}, {"price", 999.99}, {"quantity", 2}}}},
+                 {"total", 1999.98}};
+
+    EncodedBodies bodies = ResponseEncoding::encodeAll(body);
+    REQUIRE(decode(bodies.get(BodyEncoding::Json), BodyEncoding::Json) == body);
+    REQUIRE(decode(bodies.get(BodyEncoding::MsgPack), BodyEncoding::MsgPack) == body);
+    REQUIRE(decode(bodies.get(BodyEncoding::Cbor), BodyEncoding::Cbor) == body);
+    REQUIRE(bodies.msgpack.size() < bodies.json.size());
+
+    REQUIRE(std::string(ResponseEncoding::contentType(BodyEncoding::MsgPack)) == "application/msgpack");
+    REQUIRE(std::string(ResponseEncoding::contentType(BodyEncoding::Cbor)) == "application/cbor");
+}
+
+TEST_CASE("JSON text bodies are transcoded", "[encoding]") {
+    std::string encoded;
+    REQUIRE(ResponseEncoding::transcode("{\"success\":false,\"message\":\"Unauthorized\"}", BodyEncoding::Cbor, encoded));
+    json decoded = decode(encoded, BodyEncoding::Cbor);
+    REQUIRE(decoded["success"] == false);
+    REQUIRE(decoded["message"] == "Unauthorized");
+
+    encoded = "unchanged";
+    REQUIRE_FALSE(ResponseEncoding::transcode("{not json", BodyEncoding::MsgPack, encoded));
+    REQUIRE(encoded == "unchanged");
+}
@@ -0,0 +1,38 @@
+#!/bin/sh
+# Runs the MongoDB operation policy tests against a throwaway single-node replica set.
+# Requires mongod and mongosh on PATH; the replica set tests are skipped if they are missing.
+
+PORT=27117
+DBPATH=$(mktemp -d)
+
+cd "$(dirname "$0")"
+
+if command -v mongod >/dev/null 2>&1 && command -v mongosh >/dev/null 2>&1; then
+    echo "Starting replica set rs0 on port $PORT..."
+    mongod --replSet rs0 --port $PORT --bind_ip 127.0.0.1 --dbpath "$DBPATH" \
+           --logpath "$DBPATH/mongod.log" --fork >/dev/null
+    mongosh --quiet --port $PORT --eval \
+        "rs.initiate({_id: 'rs0', members: [{_id: 0, host: '127.0.0.1:$PORT'}]})" >/dev/null
+    # Wait for the node to become primary
+    for i in 1 2 3 4 5 6 7 8 9 10; do
+        if mongosh --quiet --port $PORT --eval "db.hello().isWritablePrimary" | grep -q true; then
+            break
+        fi
+        sleep 1
+    done
+    export MONGODB_TEST_REPLSET_URI="mongodb://127.0.0.1:$PORT/?replicaSet=rs0"
+    EXTRA_FLAGS="-DHAS_MONGODB $(pkg-config --cflags --libs libmongocxx 2>/dev/null)"
+else
+    echo "mongod/mongosh not found - replica set tests will be skipped"
+fi
+
+g++ -std=c++17 -I. -I../src/Backend mongodb_policy_tests.cpp ../src/Backend/MongoDBService.cpp \
+    ../src/Backend/Cart.cpp ../src/Backend/PurchaseHistory.cpp ../src/Backend/RequestDeadline.cpp $EXTRA_FLAGS -o mongodb_policy_tests
+./mongodb_policy_tests
+RESULT=$?
+
+if [ -n "$MONGODB_TEST_REPLSET_URI" ]; then
+    mongosh --quiet --port $PORT --eval "db.getSiblingDB('admin').shutdownServer()" >/dev/null 2>&1
+fi
+rm -rf "$DBPATH"
+exit $RESULT
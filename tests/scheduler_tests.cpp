@@ -0,0 +1,174 @@
+/**
+ * Scheduler Test Cases
+ * Using Catch2 Framework
+ * Tests fixed-rate and cron jobs, overrun detection and job metrics
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "../src/Backend/Scheduler.h"
+
+// 2024-01-01T00:00:00Z (a Monday)
+static const long long JAN_1_2024 = 1704067200000LL;
+static const long long MINUTE = 60 * 1000LL;
+static const long long HOUR = 60 * MINUTE;
+static const long long DAY = 24 * HOUR;
+
+static const JobStats* findJob(const std::vector<JobStats>& stats, const std::string& name) {
+    for (const auto& job : stats) {
+        if (job.name == name) return &job;
+    }
+    return nullptr;
+}
+
+static void waitFor(const std::function<bool()>& condition, int timeoutMs = 2000) {
+    for (int waited = 0; waited < timeoutMs && !condition(); waited += 5) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+TEST_CASE("Cron expression parsing", "[scheduler]") {
+    CronSpec spec;
+
+    SECTION("Valid expressions") {
+        REQUIRE(Scheduler::parseCron("* * * * *", spec));
+        REQUIRE(Scheduler::parseCron("*/15 0-6,22 1 */2 1-5", spec));
+        REQUIRE(Scheduler::parseCron("0 9 * * 7", spec));
+        REQUIRE(spec.weekdays == 1); // 7 is Sunday
+    }
+
+    SECTION("Invalid expressions are rejected") {
+        REQUIRE_FALSE(Scheduler::parseCron("61 * * * *", spec));
+        REQUIRE_FALSE(Scheduler::parseCron("* * *", spec));
+        REQUIRE_FALSE(Scheduler::parseCron("a b c d e", spec));
+        REQUIRE_FALSE(Scheduler::parseCron("5-1 * * * *", spec));
+        REQUIRE_FALSE(Scheduler::parseCron("*/0 * * * *", spec));
+        REQUIRE_FALSE(Scheduler::parseCron("* * 0 * *", spec));
+    }
+}
+
+TEST_CASE("Cron next run times", "[scheduler]") {
+    CronSpec spec;
+
+    SECTION("Every 15 minutes") {
+        REQUIRE(Scheduler::parseCron("*/15 * * * *", spec));
+        REQUIRE(Scheduler::nextCronTime(spec, JAN_1_2024 + 7 * MINUTE) == JAN_1_2024 + 15 * MINUTE);
+        REQUIRE(Scheduler::nextCronTime(spec, JAN_1_2024 + 15 * MINUTE) == JAN_1_2024 + 30 * MINUTE);
+        REQUIRE(Scheduler::nextCronTime(spec, JAN_1_2024 + 59 * MINUTE) == JAN_1_2024 + HOUR);
+    }
+
+    SECTION("Weekdays at 09:00 skip the weekend") {
+        REQUIRE(Scheduler::parseCron("0 9 * * 1-5", spec));
+        long long saturday = JAN_1_2024 + 5 * DAY + 10 * HOUR;
+        REQUIRE(Scheduler::nextCronTime(spec, saturday) == JAN_1_2024 + 7 * DAY + 9 * HOUR);
+    }
+
+    SECTION("Month rollover and leap day") {
+        REQUIRE(Scheduler::parseCron("30 12 29 2 *", spec));
+        long long feb29 = JAN_1_2024 + (31 + 28) * DAY + 12 * HOUR + 30 * MINUTE;
+        REQUIRE(Scheduler::nextCronTime(spec, JAN_1_2024) == feb29);
+    }
+
+    SECTION("Day-of-month and day-of-week are OR'ed when both are restricted") {
+        REQUIRE(Scheduler::parseCron("0 0 15 * 3", spec));
+        // First Wednesday after Jan 1 2024 is Jan 3
+        REQUIRE(Scheduler::nextCronTime(spec, JAN_1_2024) == JAN_1_2024 + 2 * DAY);
+    }
+
+    SECTION("Impossible dates never match") {
+        REQUIRE(Scheduler::parseCron("0 0 31 2 *", spec));
+        REQUIRE(Scheduler::nextCronTime(spec, JAN_1_2024) == -1);
+    }
+}
+
+TEST_CASE("Fixed-rate jobs", "[scheduler]") {
+    Scheduler scheduler;
+    std::atomic<int> runs(0);
+    Scheduler::JobId id = scheduler.scheduleFixedRate("tick", 10, [&] { runs++; }, 0, 0);
+    REQUIRE(id != 0);
+    REQUIRE(scheduler.scheduleFixedRate("bad", 0, [] {}) == 0);
+
+    scheduler.start(2);
+    waitFor([&] { return runs.load() >= 3; });
+    REQUIRE(runs.load() >= 3);
+
+    std::vector<JobStats> all = scheduler.stats();
+    const JobStats* stats = findJob(all, "tick");
+    REQUIRE(stats != nullptr);
+    REQUIRE(stats->runs >= 3);
+    REQUIRE(stats->schedule == "every 10ms");
+
+    SECTION("Cancelled jobs stop running") {
+        REQUIRE(scheduler.cancel(id));
+        REQUIRE_FALSE(scheduler.cancel(id));
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        int after = runs.load();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(runs.load() == after);
+        REQUIRE(findJob(scheduler.stats(), "tick") == nullptr);
+    }
+
+    scheduler.stop();
+    REQUIRE_FALSE(scheduler.isRunning());
+}
+
+TEST_CASE("Overruns are detected and runs never overlap", "[scheduler]") {
+    Scheduler scheduler;
+    std::atomic<int> active(0);
+    std::atomic<int> maxActive(0);
+    std::atomic<int> runs(0);
+    scheduler.scheduleFixedRate("slow", 5, [&] {
+        int now = ++active;
+        if (now > maxActive) maxActive = now;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --active;
+        runs++;
+    }, 0, 0);
+
+    scheduler.start(4);
+    waitFor([&] { return runs.load() >= 3; });
+    scheduler.stop();
+
+    std::vector<JobStats> all = scheduler.stats();
+    const JobStats* stats = findJob(all, "slow");
+    REQUIRE(stats != nullptr);
+    REQUIRE(maxActive.load() == 1);
+    REQUIRE(stats->overruns >= 2);
+    REQUIRE(stats->maxRunUs >= 20000);
+    REQUIRE(stats->lastRunUs > 0);
+}
+
+TEST_CASE("Failing jobs are counted and keep their schedule", "[scheduler]") {
+    Scheduler scheduler;
+    std::atomic<int> attempts(0);
+    scheduler.scheduleFixedRate("flaky", 5, [&] {
+        attempts++;
+        throw std::runtime_error("boom");
+    }, 2, 0);
+
+    scheduler.start(1);
+    waitFor([&] { return attempts.load() >= 3; });
+    scheduler.stop();
+
+    std::vector<JobStats> all = scheduler.stats();
+    const JobStats* stats = findJob(all, "flaky");
+    REQUIRE(stats != nullptr);
+    REQUIRE(stats->failures == stats->runs);
+    REQUIRE(stats->runs >= 3);
+}
+
+TEST_CASE("Cron jobs register with their next run time", "[scheduler]") {
+    Scheduler scheduler;
+    REQUIRE(scheduler.scheduleCron("hourly", "0 * * * *", [] {}) != 0);
+    REQUIRE(scheduler.scheduleCron("broken", "0 * *", [] {}) == 0);
+
+    std::vector<JobStats> all = scheduler.stats();
+    const JobStats* stats = findJob(all, "hourly");
+    REQUIRE(stats != nullptr);
+    REQUIRE(stats->schedule == "cron 0 * * * *");
+    REQUIRE(stats->nextRunInMs <= HOUR);
+}
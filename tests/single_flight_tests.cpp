@@ -0,0 +1,117 @@
+/**
+ * SingleFlight Test Cases
+ * Using Catch2 Framework
+ * Tests coalescing of identical concurrent computations
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/SingleFlight.h"
+
+// Wait until the flight has gathered the expected number of waiting callers
+static void waitForShared(const SingleFlight& flight, unsigned long long expected) {
+    for (int i = 0; i < 2000 && flight.getStats().shared < expected; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_CASE("Concurrent callers with the same key share one execution", "[singleflight]") {
+    SingleFlight flight;
+    std::atomic<int> runs(0);
+    std::atomic<bool> release(false);
+    auto compute = [&] {
+        runs++;
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return std::string("catalog body");
+    };
+
+    const int callers = 8;
+    std::vector<std::string> results(callers);
+    std::vector<std::thread> threads;
+    threads.emplace_back([&] { results[0] = flight.run("catalog", compute); });
+    while (runs == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    for (int i = 1; i < callers; ++i) {
+        threads.emplace_back([&, i] { results[i] = flight.run("catalog", compute); });
+    }
+    waitForShared(flight, callers - 1);
+    REQUIRE(flight.getStats().inFlight == 1);
+    release = true;
+    for (auto& thread : threads) thread.join();
+
+    REQUIRE(runs == 1);
+    for (const auto& result : results) REQUIRE(result == "catalog body");
+    SingleFlightStats stats = flight.getStats();
+    REQUIRE(stats.executions == 1);
+    REQUIRE(stats.shared == callers - 1);
+    REQUIRE(stats.inFlight == 0);
+}
+
+TEST_CASE("Finished results are not reused and keys do not interfere", "[singleflight]") {
+    SingleFlight flight;
+    int runs = 0;
+    auto compute = [&runs] { return "run " + std::to_string(++runs); };
+
+    REQUIRE(flight.run("search:usb", compute) == "run 1");
+    REQUIRE(flight.run("search:usb", compute) == "run 2");
+    REQUIRE(flight.run("search:hdmi", compute) == "run 3");
+    REQUIRE(flight.getStats().shared == 0);
+}
+
+TEST_CASE("Errors reach every caller of the shared run", "[singleflight]") {
+    SingleFlight flight;
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    auto failing = [&]() -> std::string {
+        started = true;
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        throw std::runtime_error("database unavailable");
+    };
+
+    std::atomic<int> failures(0);
+    auto call = [&] {
+        try {
+            flight.run("history:u1", failing);
+        } catch (const std::runtime_error&) {
+            failures++;
+        }
+    };
+    std::thread leader(call);
+    while (!started) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::thread follower(call);
+    waitForShared(flight, 1);
+    release = true;
+    leader.join();
+    follower.join();
+
+    REQUIRE(failures == 2);
+    REQUIRE(flight.run("history:u1", [] { return std::string("recovered"); }) == "recovered");
+}
+
+TEST_CASE("Forgetting a key makes later callers start a fresh run", "[singleflight]") {
+    SingleFlight flight;
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    std::string stale;
+    std::thread before([&] {
+        stale = flight.run("history:u1", [&] {
+            started = true;
+            while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return std::string("before checkout");
+        });
+    });
+    while (!started) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    flight.forget("history:u1");
+    REQUIRE(flight.run("history:u1", [] { return std::string("after checkout"); }) == "after checkout");
+
+    release = true;
+    before.join();
+    REQUIRE(stale == "before checkout");
+    REQUIRE(flight.getStats().inFlight == 0);
+}
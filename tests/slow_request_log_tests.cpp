@@ -0,0 +1,232 @@
+/**
+ * SlowRequestLog Test Cases
+ * Using Catch2 Framework
+ * Tests per-route SLO budgets, tail-sampled recording, burn rates and log rotation
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/SlowRequestLog.h"
+
+static const long long NOW_MS = 1704067200000LL;
+
+static const RouteSloStats* findRoute(const std::vector<RouteSloStats>& stats, const std::string& route) {
+    for (const auto& entry : stats) {
+        if (entry.route == route) return &entry;
+    }
+    return nullptr;
+}
+
+static SlowRequestLogConfig memoryOnlyConfig() {
+    SlowRequestLogConfig config;
+    config.defaultBudgetMs = 100;
+    config.routeBudgetsMs["POST /api/cart/checkout"] = 1000;
+    config.ringCapacity = 3;
+    return config;
+}
+
+TEST_CASE("Route budgets parse from config", "[slow_request_log]") {
+    std::map<std::string, long long> budgets;
+    REQUIRE(SlowRequestLog::parseRouteBudgets("POST /api/cart/checkout:1000, GET /api/search:200", budgets));
+    REQUIRE(budgets.size() == 2);
+    REQUIRE(budgets["POST /api/cart/checkout"] == 1000);
+    REQUIRE(budgets["GET /api/search"] == 200);
+
+    REQUIRE(SlowRequestLog::parseRouteBudgets("PATCH /api/cart/.*:150", budgets));
+    REQUIRE(budgets["PATCH /api/cart/.*"] == 150);
+    REQUIRE(SlowRequestLog::parseRouteBudgets("", budgets));
+    REQUIRE(budgets.empty());
+
+    SECTION("Malformed entries leave budgets untouched") {
+        budgets["GET /api/cart"] = 50;
+        REQUIRE_FALSE(SlowRequestLog::parseRouteBudgets("GET /api/search", budgets));
+        REQUIRE_FALSE(SlowRequestLog::parseRouteBudgets("/api/search:200", budgets));
+        REQUIRE_FALSE(SlowRequestLog::parseRouteBudgets("GET /api/search:-5", budgets));
+        REQUIRE_FALSE(SlowRequestLog::parseRouteBudgets("GET /api/search:fast", budgets));
+        REQUIRE(budgets.size() == 1);
+    }
+}
+
+TEST_CASE("Only over-budget requests are recorded", "[slow_request_log]") {
+    SlowRequestLog log;
+    log.configure(memoryOnlyConfig());
+    std::vector<SlowRequestStage> stages = {{"auth", 200}, {"handler", 1500000}};
+
+    REQUIRE_FALSE(log.record("POST", "/api/cart/checkout", "/api/cart/checkout", 200, 900000, "user_1",
+                             120, 300, stages, NOW_MS));
+    REQUIRE(log.record("POST", "/api/cart/checkout", "/api/cart/checkout", 200, 1500200, "user_1",
+                       120, 300, stages, NOW_MS));
+    REQUIRE(log.recorded() == 1);
+
+    std::vector<SlowRequest> recent = log.recent(10);
+    REQUIRE(recent.size() == 1);
+    REQUIRE(recent[0].route == "POST /api/cart/checkout");
+    REQUIRE(recent[0].budgetUs == 1000000);
+    REQUIRE(recent[0].requestBytes == 120);
+    REQUIRE(recent[0].responseBytes == 300);
+    REQUIRE(recent[0].stages.size() == 2);
+    REQUIRE(recent[0].userHash == SlowRequestLog::hashUserId("user_1"));
+    REQUIRE(recent[0].userHash.find("user_1") == std::string::npos);
+
+    SECTION("Routes without their own budget use the default") {
+        REQUIRE(log.record("GET", "/api/search", "/api/search", 200, 150000, "", 0, 10, {}, NOW_MS));
+        REQUIRE(log.recent(1)[0].budgetUs == 100000);
+        REQUIRE(log.recent(1)[0].userHash.empty());
+        REQUIRE_FALSE(log.record("GET", "/api/search", "/api/search", 200, 50000, "", 0, 10, {}, NOW_MS));
+    }
+
+    SECTION("Unmatched paths are labelled by path") {
+        REQUIRE(log.record("GET", "", "/index.html", 200, 150000, "", 0, 10, {}, NOW_MS));
+        REQUIRE(log.recent(1)[0].route == "GET /index.html");
+    }
+
+    SECTION("The ring keeps the newest entries") {
+        for (int i = 0; i < 5; ++i) {
+            log.record("GET", "/api/cart", "/api/cart/" + std::to_string(i), 200, 200000, "", 0, 0, {}, NOW_MS);
+        }
+        recent = log.recent(10);
+        REQUIRE(recent.size() == 3);
+        REQUIRE(recent[0].path == "/api/cart/4");
+        REQUIRE(recent[2].path == "/api/cart/2");
+        REQUIRE(log.recorded() == 6);
+    }
+}
+
+TEST_CASE("Burn rate compares the slow fraction to the error budget", "[slow_request_log]") {
+    SlowRequestLog log;
+    SlowRequestLogConfig config = memoryOnlyConfig();
+    config.objective = 0.99;
+    log.configure(config);
+
+    // 2 slow out of 100 in the current minute: 2% against a 1% budget
+    for (int i = 0; i < 98; ++i) {
+        log.record("GET", "/api/cart", "/api/cart", 200, 1000, "", 0, 0, {}, NOW_MS);
+    }
+    log.record("GET", "/api/cart", "/api/cart", 200, 500000, "", 0, 0, {}, NOW_MS);
+    log.record("GET", "/api/cart", "/api/cart", 200, 500000, "", 0, 0, {}, NOW_MS);
+
+    std::vector<RouteSloStats> stats = log.stats(NOW_MS);
+    const RouteSloStats* route = findRoute(stats, "*");
+    REQUIRE(route != nullptr);
+    REQUIRE(route->requests5m == 100);
+    REQUIRE(route->slow5m == 2);
+    REQUIRE(route->burnRate5m == Approx(2.0));
+    REQUIRE(route->burnRate1h == Approx(2.0));
+
+    const RouteSloStats* checkout = findRoute(stats, "POST /api/cart/checkout");
+    REQUIRE(checkout != nullptr);
+    REQUIRE(checkout->requests == 0);
+    REQUIRE(checkout->burnRate5m == 0.0);
+
+    SECTION("Old minutes leave the short window first") {
+        stats = log.stats(NOW_MS + 10 * 60000);
+        route = findRoute(stats, "*");
+        REQUIRE(route->requests5m == 0);
+        REQUIRE(route->burnRate5m == 0.0);
+        REQUIRE(route->requests1h == 100);
+        REQUIRE(route->burnRate1h == Approx(2.0));
+
+        stats = log.stats(NOW_MS + 61 * 60000);
+        REQUIRE(findRoute(stats, "*")->requests1h == 0);
+        REQUIRE(findRoute(stats, "*")->requests == 100);
+    }
+
+    SECTION("A reused bucket starts from zero") {
+        log.record("GET", "/api/cart", "/api/cart", 200, 1000, "", 0, 0, {}, NOW_MS + 60 * 60000);
+        stats = log.stats(NOW_MS + 60 * 60000);
+        REQUIRE(findRoute(stats, "*")->requests1h == 1);
+        REQUIRE(findRoute(stats, "*")->slow1h == 0);
+    }
+}
+
+TEST_CASE("Thread traces time requests end to end", "[slow_request_log]") {
+    SlowRequestLog log;
+    SlowRequestLogConfig config = memoryOnlyConfig();
+    config.defaultBudgetMs = 5;
+    log.configure(config);
+
+    SlowRequestLog::begin();
+    SlowRequestLog::setUser("user_7");
+    SlowRequestLog::mark("auth");
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    SlowRequestLog::mark("load-user");
+    REQUIRE(log.finish("GET", "/api/me", "/api/me", 200, 0, 42));
+
+    SlowRequest entry = log.recent(1)[0];
+    REQUIRE(entry.durationUs >= 15000);
+    REQUIRE(entry.userHash == SlowRequestLog::hashUserId("user_7"));
+    REQUIRE(entry.stages.size() == 3);
+    REQUIRE(std::string(entry.stages[0].name) == "auth");
+    REQUIRE(std::string(entry.stages[1].name) == "load-user");
+    REQUIRE(entry.stages[1].durationUs >= 15000);
+    REQUIRE(std::string(entry.stages[2].name) == "handler");
+
+    SECTION("Fast requests are only counted") {
+        SlowRequestLog::begin();
+        REQUIRE_FALSE(log.finish("GET", "/api/me", "/api/me", 200, 0, 42));
+        REQUIRE(log.recorded() == 1);
+    }
+
+    SECTION("finish without begin is ignored") {
+        REQUIRE_FALSE(log.finish("GET", "/api/me", "/api/me", 200, 0, 42));
+    }
+}
+
+TEST_CASE("Slow requests are written as rotating JSON lines", "[slow_request_log]") {
+    const std::string path = "slow_request_log_test.log";
+    std::remove(path.c_str());
+    std::remove((path + ".1").c_str());
+    std::remove((path + ".2").c_str());
+
+    SlowRequestLog log;
+    SlowRequestLogConfig config = memoryOnlyConfig();
+    config.filePath = path;
+    config.maxFileBytes = 600;
+    config.maxFiles = 1;
+    log.configure(config);
+
+    SlowRequest sample;
+    sample.timestampMs = NOW_MS;
+    sample.method = "GET";
+    sample.path = "/api/search";
+    sample.route = "GET /api/\"search\"";
+    sample.status = 200;
+    sample.durationUs = 150000;
+    sample.budgetUs = 100000;
+    sample.requestBytes = 0;
+    sample.responseBytes = 10;
+    sample.stages = {{"auth", 1500}};
+    std::string line = SlowRequestLog::toJsonLine(sample);
+    REQUIRE(line.find("\"timestamp\":\"2024-01-01T00:00:00.000Z\"") != std::string::npos);
+    REQUIRE(line.find("\"route\":\"GET /api/\\\"search\\\"\"") != std::string::npos);
+    REQUIRE(line.find("\"durationMs\":150.000") != std::string::npos);
+    REQUIRE(line.find("{\"name\":\"auth\",\"ms\":1.500}") != std::string::npos);
+
+    for (int i = 0; i < 10; ++i) {
+        log.record("GET", "/api/search", "/api/search", 200, 150000, "user_1", 0, 10, {}, NOW_MS);
+    }
+    REQUIRE(log.fileErrors() == 0);
+
+    std::ifstream current(path);
+    std::ifstream rotated(path + ".1");
+    std::ifstream dropped(path + ".2");
+    REQUIRE(current.is_open());
+    REQUIRE(rotated.is_open());
+    REQUIRE_FALSE(dropped.is_open());
+
+    std::string first;
+    REQUIRE(std::getline(current, first));
+    REQUIRE(first.find("\"path\":\"/api/search\"") != std::string::npos);
+    current.seekg(0, std::ios::end);
+    REQUIRE(static_cast<long long>(current.tellg()) <= 600);
+
+    current.close();
+    rotated.close();
+    std::remove(path.c_str());
+    std::remove((path + ".1").c_str());
+}
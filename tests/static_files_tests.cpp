@@ -0,0 +1,124 @@
+/**
+ * Static Files Test Cases
+ * Using Catch2 Framework
+ * Tests io_uring whole-file reads, the mmap fallback for large files and
+ * kernels without io_uring, directory redirects and path validation
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <cerrno>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../src/Backend/IoUring.h"
+#include "../src/Backend/StaticFiles.h"
+
+static const std::string ROOT = "static_files_test_root";
+
+static void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+}
+
+// ROOT/index.html, ROOT/app.js (small), ROOT/big.bin (larger than a 4 KB buffer), ROOT/docs/index.html
+static void makeRoot() {
+    mkdir(ROOT.c_str(), 0755);
+    mkdir((ROOT + "/docs").c_str(), 0755);
+    writeFile(ROOT + "/index.html", "<html>home</html>");
+    writeFile(ROOT + "/app.js", "console.log('app');");
+    writeFile(ROOT + "/big.bin", std::string(10000, 'x'));
+    writeFile(ROOT + "/docs/index.html", "<html>docs</html>");
+}
+
+static void removeRoot() {
+    const char* names[] = {"/index.html", "/app.js", "/big.bin", "/docs/index.html"};
+    for (const char* name : names) unlink((ROOT + name).c_str());
+    rmdir((ROOT + "/docs").c_str());
+    rmdir(ROOT.c_str());
+}
+
+TEST_CASE("Files are looked up under the root", "[static]") {
+    makeRoot();
+    for (bool ioUring : {false, true}) {
+        StaticFiles files;
+        files.configure(ROOT, ioUring, 4096);
+        REQUIRE(files.isIoUringActive() == (ioUring && IoUring::isSupported()));
+
+        StaticFile file = files.lookup("/app.js");
+        REQUIRE(file.path == ROOT + "/app.js");
+        if (files.isIoUringActive()) {
+            REQUIRE(file.status == StaticFileStatus::Loaded);
+            REQUIRE(file.body == "console.log('app');");
+        } else {
+            REQUIRE(file.status == StaticFileStatus::Mapped);
+            REQUIRE(file.body.empty());
+        }
+
+        // "/" and directory paths ending in a slash serve index.html
+        file = files.lookup("/");
+        REQUIRE(file.path == ROOT + "/index.html");
+        REQUIRE(file.status != StaticFileStatus::NotFound);
+        REQUIRE(files.lookup("/docs/").path == ROOT + "/docs/index.html");
+        REQUIRE(files.lookup("/docs").status == StaticFileStatus::Directory);
+
+        // Larger than the buffer: left to the mmap path either way
+        file = files.lookup("/big.bin");
+        REQUIRE(file.status == StaticFileStatus::Mapped);
+        REQUIRE(file.path == ROOT + "/big.bin");
+
+        REQUIRE(files.lookup("/missing.css").status == StaticFileStatus::NotFound);
+        REQUIRE(files.lookup("/docs/../app.js").status == StaticFileStatus::NotFound);
+        REQUIRE(files.lookup("/..").status == StaticFileStatus::NotFound);
+        REQUIRE(files.lookup("/a\\b").status == StaticFileStatus::NotFound);
+        REQUIRE(files.lookup("app.js").status == StaticFileStatus::NotFound);
+
+        StaticFilesStats stats = files.getStats();
+        REQUIRE(stats.notFound == 5);
+        if (files.isIoUringActive()) {
+            REQUIRE(stats.mode.compare(0, 8, "io_uring") == 0);
+            REQUIRE(stats.loaded == 3);
+            REQUIRE(stats.mapped == 1);
+            REQUIRE(stats.rings == 1);
+            // One io_uring_enter per file read (the missing file's open fails in the same call)
+            REQUIRE(stats.enters == 6);
+        } else {
+            REQUIRE(stats.mode == "mmap");
+            REQUIRE(stats.loaded == 0);
+            REQUIRE(stats.mapped == 4);
+            REQUIRE(stats.enters == 0);
+        }
+    }
+    removeRoot();
+}
+
+TEST_CASE("An io_uring ring reads files and reports errors", "[static]") {
+    if (!IoUring::isSupported()) {
+        WARN("io_uring is not supported here; skipping");
+        IoUring ring;
+        REQUIRE_FALSE(ring.open(4096));
+        return;
+    }
+    makeRoot();
+    IoUring ring;
+    REQUIRE(ring.open(4096));
+    REQUIRE(ring.isOpen());
+
+    const char* data = nullptr;
+    long bytes = ring.readFile(ROOT + "/index.html", data);
+    REQUIRE(bytes == 17);
+    REQUIRE(std::string(data, bytes) == "<html>home</html>");
+
+    // The file slot is freed after every read, so the ring can be reused indefinitely
+    for (int i = 0; i < 50; ++i) {
+        REQUIRE(ring.readFile(ROOT + "/app.js", data) == 19);
+    }
+    REQUIRE(ring.readFile(ROOT + "/big.bin", data) == 4096);
+    REQUIRE(ring.readFile(ROOT + "/missing", data) == -ENOENT);
+    REQUIRE(data == nullptr);
+    REQUIRE(ring.readFile(ROOT + "/docs", data) == -EISDIR);
+    REQUIRE(ring.readFile(ROOT + "/index.html", data) == 17);
+    REQUIRE(ring.getEnters() == 55);
+    removeRoot();
+}
@@ -0,0 +1,104 @@
+/**
+ * Synthetic Data Test Cases
+ * Using Catch2 Framework
+ * Tests the load-test data generator: determinism from the seed, Zipf-skewed
+ * product popularity, and users and orders that match the generated catalog
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include "../src/Backend/SyntheticData.h"
+
+static SyntheticDataConfig smallConfig(unsigned long long seed) {
+    SyntheticDataConfig config;
+    config.seed = seed;
+    config.products = 200;
+    config.users = 500;
+    return config;
+}
+
+TEST_CASE("Zipf sampler favours low ranks", "[synthetic]") {
+    ZipfSampler sampler(100, 1.0);
+    REQUIRE(sampler.sample(0.0) == 0);
+    REQUIRE(sampler.sample(0.999999) == 99);
+
+    // Rank 0 holds 1 / H(100), about 19%, of the probability mass
+    size_t top = 0;
+    const size_t draws = 10000;
+    for (size_t i = 0; i < draws; ++i) {
+        if (sampler.sample((i + 0.5) / draws) == 0) top++;
+    }
+    REQUIRE(top > draws * 18 / 100);
+    REQUIRE(top < draws * 21 / 100);
+
+    ZipfSampler uniform(10, 0.0);
+    REQUIRE(uniform.sample(0.55) == 5);
+}
+
+TEST_CASE("The same seed generates the same data", "[synthetic]") {
+    SyntheticData first(smallConfig(7));
+    SyntheticData second(smallConfig(7));
+    SyntheticData other(smallConfig(8));
+
+    REQUIRE(first.getCatalog().size() == 200);
+    bool catalogDiffers = false;
+    for (size_t i = 0; i < first.getCatalog().size(); ++i) {
+        REQUIRE(first.getCatalog()[i].name == second.getCatalog()[i].name);
+        REQUIRE(first.getCatalog()[i].price == second.getCatalog()[i].price);
+        catalogDiffers = catalogDiffers || first.getCatalog()[i].name != other.getCatalog()[i].name;
+    }
+    REQUIRE(catalogDiffers);
+
+    // Any user or order can be regenerated on its own, in any order
+    UserRef later = first.user(42);
+    first.user(7);
+    REQUIRE(first.user(42)->getCart().getItems().size() == later->getCart().getItems().size());
+    REQUIRE(second.user(42)->getPurchaseCount() == later->getPurchaseCount());
+    REQUIRE(second.user(42)->getProfile().fullName == later->getProfile().fullName);
+    REQUIRE(second.order(3).userId == first.order(3).userId);
+    REQUIRE(second.order(3).lines.size() == first.order(3).lines.size());
+}
+
+TEST_CASE("Generated users and orders reference the catalog", "[synthetic]") {
+    SyntheticData data(smallConfig(1));
+    const auto& catalog = data.getCatalog();
+    REQUIRE(catalog[0].id == "ITEM000001");
+
+    UserRef user = data.user(0);
+    REQUIRE(user->getId() == "2");
+    REQUIRE(user->getProfile().username == "user2");
+    REQUIRE(user->getProfile().password == "pass2");
+    REQUIRE(user->getProfile().email == "user2@example.com");
+
+    size_t carts = 0;
+    size_t purchases = 0;
+    for (size_t i = 0; i < 500; ++i) {
+        UserRef generated = data.user(i);
+        purchases += generated->getPurchaseCount();
+        if (generated->getCart().isEmpty()) continue;
+        carts++;
+        // Generated carts have no age, so the cart sweeper leaves them alone
+        REQUIRE(generated->getCart().getLastTouched() == 0);
+        for (const auto& line : generated->getCart().getItems()) {
+            REQUIRE(line.catalogSlot < catalog.size());
+            REQUIRE(catalog[line.catalogSlot].id == line.productId);
+        }
+    }
+    // About 30% of users have a cart, and about three past orders on average
+    REQUIRE(carts > 100);
+    REQUIRE(carts < 200);
+    REQUIRE(purchases > 500 * 3);
+
+    long long previous = 0;
+    for (size_t i = 0; i < 100; ++i) {
+        SyntheticOrder order = data.order(i);
+        REQUIRE(order.orderId == i + 1);
+        REQUIRE_FALSE(order.lines.empty());
+        REQUIRE(std::stoull(order.userId) >= 2);
+        REQUIRE(std::stoull(order.userId) < 502);
+        REQUIRE(order.timestampMs >= previous);
+        previous = order.timestampMs;
+    }
+}
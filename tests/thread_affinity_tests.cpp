@@ -0,0 +1,93 @@
+/**
+ * Thread Affinity Test Cases
+ * Using Catch2 Framework
+ * Tests CPU list parsing, pinning, CPU sets inherited by new threads, and the
+ * placement report (Linux)
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/ThreadAffinity.h"
+#include "../src/Backend/UserShards.h"
+
+TEST_CASE("CPU lists parse and format as ranges", "[affinity]") {
+    std::vector<int> cpus;
+    REQUIRE(ThreadAffinity::parseCpuList("0-3, 8,10-11,2", cpus));
+    REQUIRE(cpus == std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+    REQUIRE(ThreadAffinity::formatCpuList(cpus) == "0-3,8,10-11");
+    REQUIRE(ThreadAffinity::formatCpuList(std::vector<int>()) == "");
+
+    REQUIRE(ThreadAffinity::parseCpuList("5", cpus));
+    REQUIRE(cpus == std::vector<int>({5}));
+
+    // Invalid lists leave the previous value alone
+    REQUIRE_FALSE(ThreadAffinity::parseCpuList("", cpus));
+    REQUIRE_FALSE(ThreadAffinity::parseCpuList("3-1", cpus));
+    REQUIRE_FALSE(ThreadAffinity::parseCpuList("1-2-3", cpus));
+    REQUIRE_FALSE(ThreadAffinity::parseCpuList("a,b", cpus));
+    REQUIRE_FALSE(ThreadAffinity::parseCpuList("1,,2", cpus));
+    REQUIRE(cpus == std::vector<int>({5}));
+}
+
+#if defined(__linux__)
+// First CPU this thread may run on
+static int firstAllowedCpu() {
+    for (int cpu = 0; cpu < 1024; ++cpu) {
+        if (ThreadAffinity::allowed(std::vector<int>(1, cpu))) return cpu;
+    }
+    return -1;
+}
+
+TEST_CASE("Threads started under a ScopedAffinity inherit its CPU set", "[affinity]") {
+    int cpu = firstAllowedCpu();
+    REQUIRE(cpu >= 0);
+    std::vector<int> one(1, cpu);
+    REQUIRE_FALSE(ThreadAffinity::allowed(std::vector<int>(1, 100000)));
+
+    bool childPinned = false;
+    bool childWider = false;
+    {
+        ScopedAffinity placement(one);
+        REQUIRE(ThreadAffinity::allowed(one));
+        std::thread child([&] {
+            childPinned = ThreadAffinity::allowed(one);
+            childWider = ThreadAffinity::allowed(std::vector<int>({cpu, cpu + 1}));
+        });
+        child.join();
+    }
+    REQUIRE(childPinned);
+    REQUIRE_FALSE(childWider);
+
+    // The placement report sees this process's threads and their CPU sets
+    std::vector<ThreadPlacementGroup> groups = ThreadAffinity::currentPlacement();
+    size_t threads = 0;
+    for (const auto& group : groups) {
+        REQUIRE_FALSE(group.cpus.empty());
+        threads += group.threads;
+    }
+    REQUIRE(threads >= 1);
+}
+
+TEST_CASE("User shards pin their threads to the given CPUs", "[affinity]") {
+    int cpu = firstAllowedCpu();
+    REQUIRE(cpu >= 0);
+    UserShards shards;
+    shards.start(2, 2, std::vector<int>(1, cpu));
+    UserProfile profile;
+    profile.id = "1";
+    shards.insert(UserSnapshot::create(profile));
+
+    UserShardsStats stats = shards.getStats();
+    REQUIRE(stats.shards.size() == 2);
+    REQUIRE(stats.shards[0].cpu == cpu);
+    REQUIRE(stats.shards[1].cpu == cpu);
+    shards.stop();
+
+    shards.start(1, 1);
+    REQUIRE(shards.getStats().shards[0].cpu == -1);
+    shards.stop();
+}
+#endif
@@ -0,0 +1,105 @@
+/**
+ * Timestamp Test Cases
+ * Using Catch2 Framework
+ * Tests ISO-8601 formatting/parsing used for purchasedAt and other API timestamps
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/Timestamp.h"
+
+TEST_CASE("Timestamps format as UTC ISO-8601 with milliseconds", "[timestamp]") {
+    REQUIRE(Timestamp::formatIso8601(0) == "1970-01-01T00:00:00.000Z");
+    REQUIRE(Timestamp::formatIso8601(1704067200123LL) == "2024-01-01T00:00:00.123Z");
+    REQUIRE(Timestamp::formatIso8601(1709164800007LL) == "2024-02-29T00:00:00.007Z");
+    REQUIRE(Timestamp::formatIso8601(1735689599999LL) == "2024-12-31T23:59:59.999Z");
+    REQUIRE(Timestamp::formatIso8601(-1) == "1969-12-31T23:59:59.999Z");
+
+    SECTION("Cached prefix is reused within a second and refreshed across seconds") {
+        REQUIRE(Timestamp::formatIso8601(1704067200000LL) == "2024-01-01T00:00:00.000Z");
+        REQUIRE(Timestamp::formatIso8601(1704067200999LL) == "2024-01-01T00:00:00.999Z");
+        REQUIRE(Timestamp::formatIso8601(1704067201000LL) == "2024-01-01T00:00:01.000Z");
+        REQUIRE(Timestamp::formatIso8601(1704067200050LL) == "2024-01-01T00:00:00.050Z");
+    }
+
+    SECTION("Raw buffer overload writes exactly ISO_LENGTH bytes") {
+        char buffer[Timestamp::ISO_LENGTH + 1];
+        buffer[Timestamp::ISO_LENGTH] = '#';
+        REQUIRE(Timestamp::formatIso8601(1704067200123LL, buffer) == Timestamp::ISO_LENGTH);
+        REQUIRE(buffer[Timestamp::ISO_LENGTH] == '#');
+        REQUIRE(std::string(buffer, Timestamp::ISO_LENGTH) == "2024-01-01T00:00:00.123Z");
+    }
+}
+
+TEST_CASE("Timestamps parse back without loss", "[timestamp]") {
+    long long ms = 0;
+
+    REQUIRE(Timestamp::parseIso8601("2024-01-01T00:00:00.123Z", ms));
+    REQUIRE(ms == 1704067200123LL);
+
+    SECTION("Fractions, offsets and separators") {
+        REQUIRE(Timestamp::parseIso8601("2024-01-01T00:00:00Z", ms));
+        REQUIRE(ms == 1704067200000LL);
+        REQUIRE(Timestamp::parseIso8601("2024-01-01T00:00:00.5", ms));
+        REQUIRE(ms == 1704067200500LL);
+        REQUIRE(Timestamp::parseIso8601("2024-01-01T00:00:00.123456789Z", ms));
+        REQUIRE(ms == 1704067200123LL);
+        REQUIRE(Timestamp::parseIso8601("2024-01-01T05:30:00+05:30", ms));
+        REQUIRE(ms == 1704067200000LL);
+        REQUIRE(Timestamp::parseIso8601("2023-12-31T19:00:00-0500", ms));
+        REQUIRE(ms == 1704067200000LL);
+        REQUIRE(Timestamp::parseIso8601("2024-01-01 00:00:00", ms));
+        REQUIRE(ms == 1704067200000LL);
+    }
+
+    SECTION("Round trip") {
+        for (long long value : {0LL, 951782400001LL, 1704067200123LL, 4102444799999LL}) {
+            REQUIRE(Timestamp::parseIso8601(Timestamp::formatIso8601(value), ms));
+            REQUIRE(ms == value);
+        }
+    }
+
+    SECTION("Invalid text is rejected") {
+        REQUIRE_FALSE(Timestamp::parseIso8601("", ms));
+        REQUIRE_FALSE(Timestamp::parseIso8601("1704067200", ms));
+        REQUIRE_FALSE(Timestamp::parseIso8601("2024-13-01T00:00:00Z", ms));
+        REQUIRE_FALSE(Timestamp::parseIso8601("2023-02-29T00:00:00Z", ms));
+        REQUIRE_FALSE(Timestamp::parseIso8601("2024-01-01T24:00:00Z", ms));
+        REQUIRE_FALSE(Timestamp::parseIso8601("2024-01-01T00:00:00.Z", ms));
+        REQUIRE_FALSE(Timestamp::parseIso8601("2024-01-01T00:00:00Zjunk", ms));
+        REQUIRE_FALSE(Timestamp::parseIso8601("2024-01-0-T00:00:00Z", ms));
+    }
+}
+
+TEST_CASE("Per-thread prefix caches do not interfere", "[timestamp]") {
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t, &mismatches] {
+            long long base = 1704067200000LL + t * 86400000LL;
+            for (int i = 0; i < 5000; ++i) {
+                long long value = base + i * 7;
+                long long parsed = 0;
+                if (!Timestamp::parseIso8601(Timestamp::formatIso8601(value), parsed) || parsed != value) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int count : mismatches) {
+        REQUIRE(count == 0);
+    }
+}
+
+TEST_CASE("Current time is formatted", "[timestamp]") {
+    std::string now = Timestamp::now();
+    long long ms = 0;
+    REQUIRE(now.size() == Timestamp::ISO_LENGTH);
+    REQUIRE(Timestamp::parseIso8601(now, ms));
+    REQUIRE(ms <= Timestamp::nowMs());
+    REQUIRE(Timestamp::nowMs() - ms < 60000);
+}
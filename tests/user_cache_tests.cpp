@@ -0,0 +1,165 @@
+/**
+ * UserCache Test Cases
+ * Using Catch2 Framework
+ * Tests the read-through user cache used on the MongoDB path
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <thread>
+#include "../src/Backend/UserCache.h"
+
+static User makeRecord(const std::string& id, long long version) {
+    User user;
+    user.id = id;
+    user.username = "user_" + id;
+    user.email = id + "@example.com";
+    user.version = version;
+    return user;
+}
+
+static UserRef makeUser(const std::string& id, long long version) {
+    return UserSnapshot::fromUser(makeRecord(id, version));
+}
+
+TEST_CASE("UserCache returns stored users", "[user_cache]") {
+    UserCache cache(10, 60000);
+    UserRef loaded;
+
+    REQUIRE_FALSE(cache.get("1", loaded));
+    REQUIRE(cache.put(makeUser("1", 3)));
+    REQUIRE(cache.get("1", loaded));
+    REQUIRE(loaded->getProfile().username == "user_1");
+    REQUIRE(loaded->getVersion() == 3);
+    REQUIRE(cache.hits() == 1);
+    REQUIRE(cache.misses() == 1);
+
+    SECTION("Hits share the cached snapshot instead of copying it") {
+        UserRef again;
+        REQUIRE(cache.get("1", again));
+        REQUIRE(again.get() == loaded.get());
+    }
+}
+
+TEST_CASE("UserCache rejects stale write-backs", "[user_cache]") {
+    UserCache cache(10, 60000);
+    UserRef loaded;
+
+    User newer = makeRecord("1", 5);
+    newer.cart.addItem(CartItem("ITEM001", "Laptop", 999.99, 1));
+    REQUIRE(cache.put(UserSnapshot::fromUser(std::move(newer))));
+
+    // An older load finishing late must not overwrite the newer cart
+    REQUIRE_FALSE(cache.put(makeUser("1", 4)));
+    REQUIRE(cache.get("1", loaded));
+    REQUIRE(loaded->getVersion() == 5);
+    REQUIRE(loaded->getCart().getItems().size() == 1);
+
+    // Same or newer versions replace the entry
+    REQUIRE(cache.put(makeUser("1", 6)));
+    REQUIRE(cache.get("1", loaded));
+    REQUIRE(loaded->getCart().isEmpty());
+}
+
+TEST_CASE("UserCache write-through only follows the cached version", "[user_cache]") {
+    UserCache cache(10, 60);
+    UserRef loaded;
+
+    UserRef base = makeUser("1", 4);
+    REQUIRE(cache.put(base));
+
+    // A write skipping a version (another writer in between) is not published
+    REQUIRE_FALSE(cache.writeThrough(base, base->withVersion(6)));
+
+    SECTION("The next version replaces the entry without refreshing its TTL") {
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        Cart cart;
+        cart.addItem(CartItem("ITEM001", "Laptop", 999.99, 1));
+        REQUIRE(cache.writeThrough(base, base->withCart(std::move(cart))->withVersion(5)));
+        REQUIRE(cache.get("1", loaded));
+        REQUIRE(loaded->getVersion() == 5);
+        REQUIRE(loaded->getCart().getItems().size() == 1);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        REQUIRE_FALSE(cache.get("1", loaded));
+    }
+
+    SECTION("A base the cache has moved past is not published") {
+        REQUIRE(cache.put(makeUser("1", 5)));
+        REQUIRE_FALSE(cache.writeThrough(base, base->withVersion(5)));
+        REQUIRE(cache.get("1", loaded));
+        REQUIRE(loaded->getCart().isEmpty());
+    }
+
+    SECTION("Nothing is inserted for a user that is not cached") {
+        cache.invalidate("1");
+        REQUIRE_FALSE(cache.writeThrough(base, base->withVersion(5)));
+        REQUIRE(cache.size() == 0);
+    }
+}
+
+TEST_CASE("UserCache evicts least recently used entries", "[user_cache]") {
+    UserCache cache(2, 60000);
+    UserRef loaded;
+
+    cache.put(makeUser("1", 1));
+    cache.put(makeUser("2", 1));
+    REQUIRE(cache.get("1", loaded)); // 1 is now most recently used
+    cache.put(makeUser("3", 1));
+
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.get("1", loaded));
+    REQUIRE_FALSE(cache.get("2", loaded));
+    REQUIRE(cache.get("3", loaded));
+}
+
+TEST_CASE("UserCache expires entries after the TTL", "[user_cache]") {
+    UserCache cache(10, 20);
+    UserRef loaded;
+
+    cache.put(makeUser("1", 1));
+    cache.put(makeUser("2", 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+
+    REQUIRE_FALSE(cache.get("1", loaded));
+    REQUIRE(cache.purgeExpired() == 1);
+    REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("UserCache invalidation", "[user_cache]") {
+    UserCache cache(10, 60000);
+    UserRef loaded;
+
+    cache.put(makeUser("1", 1));
+    cache.invalidate("1");
+    REQUIRE_FALSE(cache.get("1", loaded));
+
+    cache.put(makeUser("2", 1));
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("UserCache snapshots and restores entries with their age", "[user_cache]") {
+    UserCache cache(10, 1000);
+    UserRef loaded;
+
+    cache.put(makeUser("1", 1));
+    cache.put(makeUser("2", 1));
+    auto entries = cache.snapshot();
+    REQUIRE(entries.size() == 2);
+    REQUIRE(entries[0].first->getId() == "1"); // least recently used first
+    REQUIRE(entries[1].first->getId() == "2");
+    REQUIRE(entries[0].second >= 0);
+
+    UserCache restored(10, 1000);
+    REQUIRE(restored.restore(entries[0].first, 0));
+    REQUIRE(restored.get("1", loaded));
+
+    // An entry restored near the end of its TTL still expires on schedule
+    REQUIRE(restored.restore(makeUser("3", 1), 980));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    REQUIRE_FALSE(restored.get("3", loaded));
+    REQUIRE_FALSE(restored.restore(makeUser("4", 1), 1001));
+    REQUIRE(restored.size() == 1);
+}
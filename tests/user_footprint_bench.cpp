@@ -0,0 +1,211 @@
+/**
+ * User Footprint Benchmark
+ * Loads synthetic in-memory users (10 million by default) and reports bytes per
+ * user and lookup latency for two layouts:
+ *   snapshots - the previous store: a std::map of UserSnapshots by username, a
+ *               separate Cart per user, and UserIndex for id and email lookups
+ *   compact   - CompactUserStore
+ * Heap bytes are counted by replacing operator new; resident bytes come from
+ * /proc/self/statm (Linux only) and include allocator overhead.
+ *
+ * Build (from tests/):
+ *   g++ -O2 -std=c++17 -I../src/Backend user_footprint_bench.cpp ../src/Backend/CompactUserStore.cpp
+ *       ../src/Backend/UserIndex.cpp ../src/Backend/UserSnapshot.cpp ../src/Backend/Cart.cpp
+ *       ../src/Backend/PurchaseHistory.cpp -o user_footprint_bench
+ * Run:
+ *   ./user_footprint_bench [users] [both|snapshots|compact]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "CompactUserStore.h"
+#include "UserIndex.h"
+
+// --- Heap accounting --------------------------------------------------------
+
+static std::atomic<long long> heapBytes(0);
+
+// Each block carries its size in front, so delete can subtract it
+static void* countedAlloc(std::size_t size) {
+    void* block = std::malloc(size + 16);
+    if (!block) throw std::bad_alloc();
+    *static_cast<std::size_t*>(block) = size;
+    heapBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+    return static_cast<char*>(block) + 16;
+}
+
+static void countedFree(void* pointer) {
+    if (!pointer) return;
+    void* block = static_cast<char*>(pointer) - 16;
+    heapBytes.fetch_sub(static_cast<long long>(*static_cast<std::size_t*>(block)), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void operator delete(void* pointer) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { countedFree(pointer); }
+
+static long long residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    long long pages = 0;
+    long long resident = 0;
+    if (!(statm >> pages >> resident)) return -1;
+    return resident * 4096;
+}
+
+// --- Synthetic users --------------------------------------------------------
+
+// Deterministic idle accounts: every user has an id, username, email and password;
+// about a third set a full name and one in twenty a bio. None have carts or orders.
+static UserProfile syntheticProfile(size_t index, std::mt19937_64& random) {
+    static const char* firstNames[] = {"Ada", "Grace", "Alan", "Edsger", "Barbara", "Donald", "Frances", "Ken"};
+    static const char* lastNames[] = {"Lovelace", "Hopper", "Turing", "Dijkstra", "Liskov", "Knuth", "Allen"};
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+    UserProfile profile;
+    profile.id = std::to_string(index + 1);
+    profile.username = "user" + std::to_string(index + 1);
+    profile.email = profile.username + "@example.com";
+    for (int i = 0; i < 12; ++i) {
+        profile.password.push_back(alphabet[random() % (sizeof(alphabet) - 1)]);
+    }
+    if (random() % 3 == 0) {
+        profile.fullName = std::string(firstNames[random() % 8]) + " " + lastNames[random() % 7];
+    }
+    if (random() % 20 == 0) {
+        profile.bio = "Shopping for keyboards, mice and the occasional monitor. Reviews everything I buy.";
+    }
+    return profile;
+}
+
+struct Result {
+    const char* layout;
+    size_t users;
+    double heapPerUser;
+    double residentPerUser;
+    double loadSeconds;
+    double idLookupNs;
+    double usernameLookupNs;
+};
+
+template <typename Lookup>
+static double timeLookups(const std::vector<std::string>& keys, Lookup lookup) {
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& key : keys) {
+        if (lookup(key)) found++;
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (found != keys.size()) std::printf("WARNING: %zu of %zu lookups missed\n", keys.size() - found, keys.size());
+    return elapsed / static_cast<double>(keys.size());
+}
+
+static void sampleKeys(size_t users, std::vector<std::string>& ids, std::vector<std::string>& usernames) {
+    std::mt19937_64 random(7);
+    const size_t samples = 1000000;
+    ids.clear();
+    usernames.clear();
+    ids.reserve(samples);
+    usernames.reserve(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        size_t index = random() % users;
+        ids.push_back(std::to_string(index + 1));
+        usernames.push_back("user" + std::to_string(index + 1));
+    }
+}
+
+static Result runSnapshots(size_t users, const std::vector<std::string>& ids, const std::vector<std::string>& usernames) {
+    Result result = {"snapshots", users, 0, 0, 0, 0, 0};
+    long long heapBefore = heapBytes.load();
+    long long residentBefore = residentBytes();
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::map<std::string, UserRef> byUsername;
+        UserIndex index;
+        std::mt19937_64 random(42);
+        for (size_t i = 0; i < users; ++i) {
+            UserProfile profile = syntheticProfile(i, random);
+            index.add(profile);
+            std::string username = profile.username;
+            byUsername[username] = std::make_shared<const UserSnapshot>(
+                std::make_shared<const UserProfile>(std::move(profile)), std::make_shared<const Cart>(), nullptr, 0);
+        }
+        result.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.heapPerUser = static_cast<double>(heapBytes.load() - heapBefore) / users;
+        result.residentPerUser = static_cast<double>(residentBytes() - residentBefore) / users;
+
+        result.idLookupNs = timeLookups(ids, [&](const std::string& id) {
+            std::string username;
+            if (!index.findById(id, username)) return false;
+            auto it = byUsername.find(username);
+            UserRef user = it != byUsername.end() ? it->second : nullptr;
+            return user != nullptr;
+        });
+        result.usernameLookupNs = timeLookups(usernames, [&](const std::string& username) {
+            auto it = byUsername.find(username);
+            UserRef user = it != byUsername.end() ? it->second : nullptr;
+            return user != nullptr;
+        });
+    }
+    return result;
+}
+
+static Result runCompact(size_t users, const std::vector<std::string>& ids, const std::vector<std::string>& usernames) {
+    Result result = {"compact", users, 0, 0, 0, 0, 0};
+    long long heapBefore = heapBytes.load();
+    long long residentBefore = residentBytes();
+    auto start = std::chrono::steady_clock::now();
+    {
+        CompactUserStore store;
+        std::mt19937_64 random(42);
+        for (size_t i = 0; i < users; ++i) {
+            store.insert(UserSnapshot::create(syntheticProfile(i, random)));
+        }
+        result.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.heapPerUser = static_cast<double>(heapBytes.load() - heapBefore) / users;
+        result.residentPerUser = static_cast<double>(residentBytes() - residentBefore) / users;
+
+        result.idLookupNs = timeLookups(ids, [&](const std::string& id) { return store.findById(id) != nullptr; });
+        result.usernameLookupNs =
+            timeLookups(usernames, [&](const std::string& username) { return store.findByUsername(username) != nullptr; });
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    size_t users = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    std::string mode = argc > 2 ? argv[2] : "both";
+    if (users == 0 || (mode != "both" && mode != "snapshots" && mode != "compact")) {
+        std::printf("usage: %s [users] [both|snapshots|compact]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> ids;
+    std::vector<std::string> usernames;
+    sampleKeys(users, ids, usernames);
+
+    // Compact first: it is the smaller one, so a run that runs out of memory still reports it
+    std::vector<Result> results;
+    if (mode != "snapshots") results.push_back(runCompact(users, ids, usernames));
+    if (mode != "compact") results.push_back(runSnapshots(users, ids, usernames));
+
+    std::printf("%-10s %10s %12s %14s %8s %14s %20s\n", "layout", "users", "heap B/user", "resident B/user",
+                "load s", "by id ns", "by username ns");
+    for (const auto& result : results) {
+        std::printf("%-10s %10zu %12.1f %14.1f %8.2f %14.1f %20.1f\n", result.layout, result.users,
+                    result.heapPerUser, result.residentPerUser, result.loadSeconds, result.idLookupNs,
+                    result.usernameLookupNs);
+    }
+    return 0;
+}
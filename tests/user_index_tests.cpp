@@ -0,0 +1,81 @@
+/**
+ * UserIndex Test Cases
+ * Using Catch2 Framework
+ * Tests id / email lookups used for profile uniqueness checks in in-memory mode
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include "../src/Backend/UserIndex.h"
+
+static UserProfile makeUser(const std::string& id, const std::string& username, const std::string& email) {
+    UserProfile user;
+    user.id = id;
+    user.username = username;
+    user.email = email;
+    return user;
+}
+
+TEST_CASE("Users are found by id and by email", "[user_index]") {
+    UserIndex index;
+    index.add(makeUser("user_1", "alice", "Alice@Example.com"));
+    index.add(makeUser("user_2", "bob", "bob@example.com"));
+    REQUIRE(index.size() == 2);
+
+    std::string username;
+    REQUIRE(index.findById("user_1", username));
+    REQUIRE(username == "alice");
+    REQUIRE_FALSE(index.findById("user_3", username));
+
+    SECTION("Email lookup is case-insensitive and ignores surrounding whitespace") {
+        REQUIRE(index.findByEmail("alice@example.com", username));
+        REQUIRE(username == "alice");
+        REQUIRE(index.findByEmail("  BOB@EXAMPLE.COM ", username));
+        REQUIRE(username == "bob");
+        REQUIRE_FALSE(index.findByEmail("carol@example.com", username));
+        REQUIRE_FALSE(index.findByEmail("", username));
+    }
+
+    SECTION("Clear drops every entry") {
+        index.clear();
+        REQUIRE(index.size() == 0);
+        REQUIRE_FALSE(index.findById("user_1", username));
+        REQUIRE_FALSE(index.findByEmail("bob@example.com", username));
+    }
+}
+
+TEST_CASE("Renames and email changes keep the index consistent", "[user_index]") {
+    UserIndex index;
+    UserProfile alice = makeUser("user_1", "alice", "alice@example.com");
+    index.add(alice);
+
+    UserProfile renamed = alice;
+    renamed.username = "alice2";
+    renamed.email = "new@example.com";
+    index.remove(alice);
+    index.add(renamed);
+
+    std::string username;
+    REQUIRE(index.size() == 1);
+    REQUIRE(index.findById("user_1", username));
+    REQUIRE(username == "alice2");
+    REQUIRE(index.findByEmail("new@example.com", username));
+    REQUIRE_FALSE(index.findByEmail("alice@example.com", username));
+
+    SECTION("Removing a stale record does not drop entries now owned by another user") {
+        UserProfile other = makeUser("user_2", "carol", "alice@example.com");
+        index.add(other);
+        index.remove(alice);
+        REQUIRE(index.findByEmail("alice@example.com", username));
+        REQUIRE(username == "carol");
+        REQUIRE(index.findById("user_1", username));
+        REQUIRE(username == "alice2");
+    }
+}
+
+TEST_CASE("Emails are normalized to trimmed lowercase", "[user_index]") {
+    REQUIRE(UserIndex::normalizeEmail(" Test@Example.COM\n") == "test@example.com");
+    REQUIRE(UserIndex::normalizeEmail("   ") == "");
+    REQUIRE(UserIndex::normalizeEmail("a@b.c") == "a@b.c");
+}
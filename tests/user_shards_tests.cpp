@@ -0,0 +1,185 @@
+/**
+ * User Shards Test Cases
+ * Using Catch2 Framework
+ * Tests the SPSC queue and per-shard ownership of users and sessions
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/Backend/SpscQueue.h"
+#include "../src/Backend/UserShards.h"
+
+static UserRef makeUser(const std::string& id) {
+    UserProfile profile;
+    profile.id = id;
+    profile.username = "user" + id;
+    profile.email = "user" + id + "@example.com";
+    return UserSnapshot::create(profile);
+}
+
+// One more unit of P1 in the user's cart
+static UserRef addOne(const UserRef& user) {
+    Cart cart = user->getCart();
+    cart.addItem(CartItem("P1", "Pen", 1.0, 1));
+    return user->withCart(std::move(cart));
+}
+
+static unsigned int penCount(const UserRef& user) {
+    for (const auto& item : user->getCart().getItems()) {
+        if (item.productId == "P1") return item.quantity;
+    }
+    return 0;
+}
+
+TEST_CASE("The SPSC queue is FIFO, bounded and wraps around", "[shards]") {
+    SpscQueue<int> queue(3);
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE(queue.empty());
+
+    int value = 0;
+    REQUIRE_FALSE(queue.tryPop(value));
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i) REQUIRE(queue.tryPush(round * 10 + i));
+        REQUIRE_FALSE(queue.tryPush(99));
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(queue.tryPop(value));
+            REQUIRE(value == round * 10 + i);
+        }
+        REQUIRE(queue.empty());
+    }
+}
+
+TEST_CASE("The SPSC queue hands every item across threads in order", "[shards]") {
+    SpscQueue<int> queue(64);
+    const int count = 200000;
+    std::atomic<int> outOfOrder(0);
+    std::thread consumer([&] {
+        int expected = 0;
+        int value = 0;
+        while (expected < count) {
+            if (queue.tryPop(value)) {
+                if (value != expected) outOfOrder++;
+                expected++;
+            }
+        }
+    });
+    for (int i = 0; i < count; ++i) {
+        while (!queue.tryPush(i)) std::this_thread::yield();
+    }
+    consumer.join();
+    REQUIRE(outOfOrder == 0);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("Users and sessions live on the shard that owns their key", "[shards]") {
+    UserShards shards;
+    shards.start(4, 8);
+    REQUIRE(shards.enabled());
+    REQUIRE(shards.getShardCount() == 4);
+
+    for (int i = 1; i <= 40; ++i) shards.insert(makeUser(std::to_string(i)));
+    shards.addSession("token_a", "7");
+
+    UserRef user;
+    REQUIRE(shards.find("7", user));
+    REQUIRE(user->getProfile().username == "user7");
+    REQUIRE_FALSE(shards.find("41", user));
+
+    std::string userId;
+    REQUIRE(shards.findSession("token_a", userId));
+    REQUIRE(userId == "7");
+    REQUIRE_FALSE(shards.findSession("token_b", userId));
+
+    UserShardsStats stats = shards.getStats();
+    size_t users = 0;
+    size_t owning = 0;
+    for (size_t i = 0; i < stats.shards.size(); ++i) {
+        users += stats.shards[i].users;
+        if (stats.shards[i].users > 0) owning++;
+    }
+    REQUIRE(users == 40);
+    REQUIRE(owning > 1);
+    REQUIRE(stats.shards[shards.shardOf("token_a")].sessions == 1);
+
+    // Each shard only sees its own users
+    for (size_t i = 0; i < shards.getShardCount(); ++i) {
+        bool foreign = false;
+        shards.visitUsers(i, [&](CompactUserStore& owned) {
+            for (size_t slot = 0; slot < owned.slotCount(); ++slot) {
+                if (shards.shardOf(owned.atSlot(slot)->getId()) != i) foreign = true;
+            }
+        });
+        REQUIRE_FALSE(foreign);
+    }
+    shards.stop();
+    REQUIRE_FALSE(shards.enabled());
+}
+
+TEST_CASE("Updates run once on the owning shard and none are lost", "[shards]") {
+    UserShards shards;
+    shards.start(2, 16);
+    shards.insert(makeUser("1"));
+
+    REQUIRE(shards.update("missing", addOne) == nullptr);
+    UserRef unchanged = shards.update("1", [](const UserRef&) { return UserRef(); });
+    REQUIRE(unchanged);
+    REQUIRE(penCount(unchanged) == 0);
+
+    const int threads = 8;
+    const int perThread = 500;
+    std::atomic<int> calls(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < perThread; ++i) {
+                shards.update("1", [&calls](const UserRef& user) {
+                    calls++;
+                    return addOne(user);
+                });
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    UserRef user;
+    REQUIRE(shards.find("1", user));
+    REQUIRE(penCount(user) == threads * perThread);
+    REQUIRE(calls == threads * perThread);
+}
+
+TEST_CASE("Callers beyond maxProducers share the locked overflow queue", "[shards]") {
+    UserShards shards;
+    shards.start(2, 1);
+    shards.insert(makeUser("1"));
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < 100; ++i) shards.update("1", addOne);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    UserRef user;
+    REQUIRE(shards.find("1", user));
+    REQUIRE(penCount(user) == 400);
+    UserShardsStats stats = shards.getStats();
+    REQUIRE(stats.producers == 1);
+    REQUIRE(stats.overflowCalls >= 300);
+}
+
+TEST_CASE("Exceptions thrown on a shard reach the caller", "[shards]") {
+    UserShards shards;
+    shards.start(1, 4);
+    shards.insert(makeUser("1"));
+
+    REQUIRE_THROWS_AS(shards.update("1", [](const UserRef&) -> UserRef { throw std::runtime_error("boom"); }),
+                      const std::runtime_error&);
+    UserRef user;
+    REQUIRE(shards.find("1", user));
+}
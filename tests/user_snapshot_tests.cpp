@@ -0,0 +1,133 @@
+/**
+ * UserSnapshot Test Cases
+ * Using Catch2 Framework
+ * Tests the immutable user snapshots and their structurally shared purchase history
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include "../src/Backend/UserSnapshot.h"
+
+static UserProfile makeProfile(const std::string& id, const std::string& username) {
+    UserProfile profile;
+    profile.id = id;
+    profile.username = username;
+    profile.email = username + "@example.com";
+    profile.password = "secret";
+    return profile;
+}
+
+static std::vector<PurchaseRecord> makeRecords(int first, int count) {
+    std::vector<PurchaseRecord> records;
+    for (int i = first; i < first + count; ++i) {
+        records.push_back(PurchaseRecord("item_" + std::to_string(i), "Item", 2.5, 1));
+    }
+    return records;
+}
+
+static size_t segmentCount(const UserRef& user) {
+    size_t count = 0;
+    for (const PurchaseSegment* segment = user->getHistory(); segment; segment = segment->getPrevious().get()) {
+        count++;
+    }
+    return count;
+}
+
+TEST_CASE("New snapshots share the parts they do not change", "[user_snapshot]") {
+    UserRef original = UserSnapshot::create(makeProfile("user_1", "alice"));
+    REQUIRE(original->getId() == "user_1");
+    REQUIRE(original->getCart().isEmpty());
+    REQUIRE(original->getHistory() == nullptr);
+    REQUIRE(original->getPurchaseCount() == 0);
+
+    SECTION("A cart change keeps the profile and leaves the original untouched") {
+        Cart cart = original->getCart();
+        cart.addItem(CartItem("item_1", "Laptop", 999.99, 1));
+        UserRef updated = original->withCart(cart);
+
+        REQUIRE(&updated->getProfile() == &original->getProfile());
+        REQUIRE(updated->getCart().getItems().size() == 1);
+        REQUIRE(original->getCart().isEmpty());
+    }
+
+    SECTION("Purchases keep the profile and cart") {
+        UserRef updated = original->withPurchases(makeRecords(0, 3));
+        REQUIRE(&updated->getProfile() == &original->getProfile());
+        REQUIRE(&updated->getCart() == &original->getCart());
+        REQUIRE(updated->getPurchaseCount() == 3);
+        REQUIRE(original->getPurchaseCount() == 0);
+
+        // Older history is shared by the next snapshot, not copied
+        UserRef renamed = updated->withProfile(makeProfile("user_1", "alice2"));
+        REQUIRE(renamed->getHistory() == updated->getHistory());
+        REQUIRE(renamed->getProfile().username == "alice2");
+        REQUIRE(updated->getProfile().username == "alice");
+    }
+
+    SECTION("A version bump shares everything else") {
+        UserRef updated = original->withVersion(7);
+        REQUIRE(updated->getVersion() == 7);
+        REQUIRE(original->getVersion() == 0);
+        REQUIRE(&updated->getProfile() == &original->getProfile());
+        REQUIRE(&updated->getCart() == &original->getCart());
+    }
+
+    SECTION("An empty purchase list does not add a segment") {
+        UserRef updated = original->withPurchases({});
+        REQUIRE(updated->getHistory() == nullptr);
+    }
+}
+
+TEST_CASE("Purchase history stays a logarithmic number of segments", "[user_snapshot]") {
+    UserRef user = UserSnapshot::create(makeProfile("user_1", "alice"));
+    for (int i = 0; i < 1000; ++i) {
+        user = user->withPurchases(makeRecords(i, 1));
+        REQUIRE(segmentCount(user) <= 11);
+    }
+    REQUIRE(user->getPurchaseCount() == 1000);
+
+    // Records come back oldest first across segments
+    std::vector<std::string> ids;
+    user->getHistory()->forEach([&ids](const PurchaseRecord& record) { ids.push_back(record.id); });
+    REQUIRE(ids.size() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(ids[i] == "item_" + std::to_string(i));
+    }
+}
+
+TEST_CASE("Appending does not change the snapshot it started from", "[user_snapshot]") {
+    UserRef base = UserSnapshot::create(makeProfile("user_1", "alice"))->withPurchases(makeRecords(0, 4));
+    UserRef left = base->withPurchases(makeRecords(4, 4));
+    UserRef right = base->withPurchases(makeRecords(100, 1));
+
+    REQUIRE(base->getPurchaseCount() == 4);
+    REQUIRE(left->getPurchaseCount() == 8);
+    REQUIRE(right->getPurchaseCount() == 5);
+
+    std::vector<std::string> ids;
+    right->getHistory()->forEach([&ids](const PurchaseRecord& record) { ids.push_back(record.id); });
+    REQUIRE(ids.back() == "item_100");
+    REQUIRE(ids.front() == "item_0");
+}
+
+TEST_CASE("Database users are adopted into a snapshot", "[user_snapshot]") {
+    User user;
+    user.id = "user_9";
+    user.username = "bob";
+    user.email = "bob@example.com";
+    user.fullName = "Bob";
+    user.version = 3;
+    user.cart.addItem(CartItem("item_2", "Mouse", 25.5, 2));
+    user.history.recordPurchases(makeRecords(0, 2));
+
+    UserRef snapshot = UserSnapshot::fromUser(std::move(user));
+    REQUIRE(snapshot->getId() == "user_9");
+    REQUIRE(snapshot->getProfile().username == "bob");
+    REQUIRE(snapshot->getProfile().fullName == "Bob");
+    REQUIRE(snapshot->getVersion() == 3);
+    REQUIRE(snapshot->getCart().getItems().size() == 1);
+    REQUIRE(snapshot->getCart().getTotal() == Approx(51.0));
+    REQUIRE(snapshot->getPurchaseCount() == 2);
+}
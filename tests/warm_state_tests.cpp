@@ -0,0 +1,125 @@
+/**
+ * Warm State Test Cases
+ * Using Catch2 Framework
+ * Tests the binary stream a server hands to its replacement on a hot restart
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <string>
+#include "../src/Backend/WarmState.h"
+
+static UserRef makeUser(const std::string& id) {
+    UserProfile profile;
+    profile.id = id;
+    profile.username = "user" + id;
+    profile.email = "user" + id + "@example.com";
+    profile.password = "secret";
+    profile.fullName = "User " + id;
+    profile.bio = "Ünïcode bio\nwith a newline";
+
+    Cart cart;
+    cart.addItem(CartItem("P1", "Pen", 1.25, 3));
+    cart.addItem(CartItem("P2", "Notebook", 4.5, 1));
+    cart.setVersion(7);
+    cart.setLastTouched(1700000000123LL);
+
+    std::vector<PurchaseRecord> purchases;
+    PurchaseRecord first;
+    first.id = "P1";
+    first.name = "Pen";
+    first.price = 1.25;
+    first.quantity = 2;
+    purchases.push_back(first);
+    PurchaseRecord second = first;
+    second.id = "P3";
+    second.name = "Stapler";
+    second.price = 12.0;
+    second.quantity = 1;
+    purchases.push_back(second);
+
+    return UserSnapshot::create(profile)->withCart(std::move(cart))->withPurchases(purchases)->withVersion(42);
+}
+
+static WarmState makeState() {
+    WarmState state;
+    state.users.push_back(makeUser("1"));
+    state.users.push_back(UserSnapshot::create(UserProfile()));
+    state.sessions.push_back(std::make_pair("token_1", "1"));
+    state.cachedUsers.push_back(CachedUserState{makeUser("9"), 1500});
+    return state;
+}
+
+TEST_CASE("Warm state survives an encode/decode round trip", "[warm_state]") {
+    WarmState decoded;
+    REQUIRE(WarmStateCodec::decode(WarmStateCodec::encode(makeState()), decoded));
+
+    REQUIRE(decoded.users.size() == 2);
+    const UserRef& user = decoded.users[0];
+    REQUIRE(user->getProfile().username == "user1");
+    REQUIRE(user->getProfile().password == "secret");
+    REQUIRE(user->getProfile().bio == "Ünïcode bio\nwith a newline");
+    REQUIRE(user->getVersion() == 42);
+
+    const Cart& cart = user->getCart();
+    REQUIRE(cart.getItems().size() == 2);
+    REQUIRE(cart.getItems()[0].productId == "P1");
+    REQUIRE(cart.getItems()[0].price == 1.25);
+    REQUIRE(cart.getItems()[0].quantity == 3);
+    REQUIRE(cart.getVersion() == 7);
+    REQUIRE(cart.getLastTouched() == 1700000000123LL);
+
+    REQUIRE(user->getHistory() != nullptr);
+    REQUIRE(user->getHistory()->size() == 2);
+    std::vector<std::string> order;
+    user->getHistory()->forEach([&order](const PurchaseRecord& record) { order.push_back(record.id); });
+    REQUIRE(order.size() == 2);
+    REQUIRE(order[0] == "P1");
+    REQUIRE(order[1] == "P3");
+
+    REQUIRE(decoded.users[1]->getCart().getItems().empty());
+    REQUIRE(decoded.users[1]->getHistory() == nullptr);
+
+    REQUIRE(decoded.sessions.size() == 1);
+    REQUIRE(decoded.sessions[0].first == "token_1");
+    REQUIRE(decoded.sessions[0].second == "1");
+    REQUIRE(decoded.cachedUsers.size() == 1);
+    REQUIRE(decoded.cachedUsers[0].ageMs == 1500);
+    REQUIRE(decoded.cachedUsers[0].user->getId() == "9");
+}
+
+TEST_CASE("An empty warm state is a few bytes", "[warm_state]") {
+    std::string bytes = WarmStateCodec::encode(WarmState());
+    REQUIRE(bytes.size() == 8);
+    WarmState decoded = makeState();
+    REQUIRE(WarmStateCodec::decode(bytes, decoded));
+    REQUIRE(decoded.users.empty());
+    REQUIRE(decoded.sessions.empty());
+    REQUIRE(decoded.cachedUsers.empty());
+}
+
+TEST_CASE("Truncated or corrupt warm state is rejected", "[warm_state]") {
+    std::string bytes = WarmStateCodec::encode(makeState());
+    WarmState decoded;
+
+    // Every prefix is incomplete
+    for (size_t length = 0; length < bytes.size(); ++length) {
+        REQUIRE_FALSE(WarmStateCodec::decode(bytes.substr(0, length), decoded));
+    }
+    REQUIRE_FALSE(WarmStateCodec::decode(bytes + "x", decoded));
+
+    std::string wrongMagic = bytes;
+    wrongMagic[0] = 'X';
+    REQUIRE_FALSE(WarmStateCodec::decode(wrongMagic, decoded));
+
+    std::string wrongVersion = bytes;
+    wrongVersion[4] = 2;
+    REQUIRE_FALSE(WarmStateCodec::decode(wrongVersion, decoded));
+
+    // A huge user count must fail cleanly rather than allocate
+    std::string hugeCount = bytes.substr(0, 5) + std::string(9, '\xff') + '\x01';
+    REQUIRE_FALSE(WarmStateCodec::decode(hugeCount, decoded));
+
+    // A failed decode leaves the output untouched
+    REQUIRE(decoded.users.empty());
+}
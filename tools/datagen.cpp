@@ -0,0 +1,212 @@
+/**
+ * datagen - synthetic catalogs, users and orders for load tests
+ * Generates a Zipf-distributed catalog, users with carts and purchase histories,
+ * and an order stream (see SyntheticData.h), deterministically from --seed.
+ *
+ * Formats:
+ *   ndjson - catalog.ndjson, users.ndjson and orders.ndjson in --out, one JSON
+ *            object per line, written as they are generated
+ *   binary - catalog.bin (CatalogCodec, load with CATALOG_FILE) and users.bin
+ *            (WarmStateCodec, load with SEED_USERS_FILE); orders as NDJSON
+ *   memory - load the users straight into a CompactUserStore and report its
+ *            size and the load time; nothing is written
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++17 -I src/Backend tools/datagen.cpp src/Backend/SyntheticData.cpp src/Backend/Catalog.cpp
+ *       src/Backend/CompactUserStore.cpp src/Backend/UserIndex.cpp src/Backend/UserSnapshot.cpp
+ *       src/Backend/Cart.cpp src/Backend/PurchaseHistory.cpp src/Backend/WarmState.cpp -o datagen
+ * Run:
+ *   ./datagen --seed 7 --products 50000 --users 1000000 --orders 100000 --format binary --out data
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "CompactUserStore.h"
+#include "SyntheticData.h"
+#include "WarmState.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+void usage() {
+    std::cout << "usage: datagen [--seed N] [--products N] [--users N] [--orders N]\n"
+                 "               [--format ndjson|binary|memory] [--out DIR]\n"
+                 "               [--product-skew S] [--user-skew S] [--cart-share F]\n"
+                 "               [--past-orders MEAN] [--order-lines MEAN] [--cart-lines MEAN]\n"
+                 "               [--first-user-id N] [--start-ms MS] [--rate ORDERS_PER_S]\n";
+}
+
+json itemsJson(const std::vector<CartItem>& items) {
+    json lines = json::array();
+    for (const auto& item : items) {
+        lines.push_back({{"productId", item.productId}, {"name", item.name}, {"price", item.price},
+                         {"quantity", item.quantity}});
+    }
+    return lines;
+}
+
+json userJson(const UserRef& user) {
+    const UserProfile& profile = user->getProfile();
+    json purchases = json::array();
+    if (user->getHistory()) {
+        user->getHistory()->forEach([&purchases](const PurchaseRecord& record) {
+            purchases.push_back({{"id", record.id}, {"name", record.name}, {"price", record.price},
+                                 {"quantity", record.quantity}});
+        });
+    }
+    return {{"id", profile.id}, {"username", profile.username}, {"email", profile.email},
+            {"password", profile.password}, {"fullName", profile.fullName}, {"bio", profile.bio},
+            {"cart", itemsJson(user->getCart().getItems())}, {"purchases", purchases}};
+}
+
+bool openOutput(std::ofstream& file, const std::string& path, bool binary) {
+    file.open(path, binary ? std::ios::out | std::ios::binary | std::ios::trunc : std::ios::out | std::ios::trunc);
+    if (!file) {
+        std::cerr << "ERROR: cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool writeOrders(const SyntheticData& data, size_t orders, const std::string& path) {
+    std::ofstream file;
+    if (!openOutput(file, path, false)) return false;
+    for (size_t i = 0; i < orders; ++i) {
+        SyntheticOrder order = data.order(i);
+        file << json{{"orderId", order.orderId}, {"userId", order.userId}, {"username", order.username},
+                     {"timestamp", order.timestampMs}, {"items", itemsJson(order.lines)}}.dump()
+             << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+bool writeNdjson(const SyntheticData& data, size_t orders, const std::string& dir) {
+    std::ofstream catalog;
+    if (!openOutput(catalog, dir + "/catalog.ndjson", false)) return false;
+    for (const auto& item : data.getCatalog()) {
+        catalog << json{{"id", item.id}, {"name", item.name}, {"price", item.price},
+                        {"description", item.description}}.dump()
+                << '\n';
+    }
+
+    std::ofstream users;
+    if (!openOutput(users, dir + "/users.ndjson", false)) return false;
+    for (size_t i = 0; i < data.getConfig().users; ++i) {
+        users << userJson(data.user(i)).dump() << '\n';
+    }
+    return catalog && users && writeOrders(data, orders, dir + "/orders.ndjson");
+}
+
+bool writeBinary(const SyntheticData& data, size_t orders, const std::string& dir) {
+    std::ofstream catalog;
+    if (!openOutput(catalog, dir + "/catalog.bin", true)) return false;
+    catalog << CatalogCodec::encode(data.getCatalog());
+
+    // The whole user set is encoded at once; use ndjson for sets larger than memory
+    WarmState state;
+    state.users.reserve(data.getConfig().users);
+    for (size_t i = 0; i < data.getConfig().users; ++i) {
+        state.users.push_back(data.user(i));
+    }
+    std::ofstream users;
+    if (!openOutput(users, dir + "/users.bin", true)) return false;
+    users << WarmStateCodec::encode(state);
+    return catalog && users && writeOrders(data, orders, dir + "/orders.ndjson");
+}
+
+void loadIntoMemory(const SyntheticData& data) {
+    auto start = std::chrono::steady_clock::now();
+    CatalogSnapshot catalog(data.getCatalog(), 1);
+    CompactUserStore store;
+    size_t cartLines = 0;
+    size_t purchases = 0;
+    for (size_t i = 0; i < data.getConfig().users; ++i) {
+        UserRef user = data.user(i);
+        cartLines += user->getCart().getItems().size();
+        purchases += user->getPurchaseCount();
+        store.insert(user);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CompactUserStoreStats stats = store.getStats();
+    std::cout << "Loaded " << catalog.size() << " products and " << stats.users << " users in " << seconds << "s"
+              << std::endl;
+    std::cout << "  carts: " << stats.carts << " (" << cartLines << " lines), histories: " << stats.histories
+              << " (" << purchases << " purchases)" << std::endl;
+    std::cout << "  records: " << stats.recordBytes << " B, blob: " << stats.blobBytes
+              << " B, indexes: " << stats.indexBytes << " B" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SyntheticDataConfig config;
+    size_t orders = 0;
+    std::string format = "ndjson";
+    std::string out = ".";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--help" || option == "-h") {
+            usage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        try {
+            if (option == "--seed") config.seed = std::stoull(value);
+            else if (option == "--products") config.products = std::stoul(value);
+            else if (option == "--users") config.users = std::stoul(value);
+            else if (option == "--orders") orders = std::stoul(value);
+            else if (option == "--format") format = value;
+            else if (option == "--out") out = value;
+            else if (option == "--product-skew") config.productSkew = std::stod(value);
+            else if (option == "--user-skew") config.userSkew = std::stod(value);
+            else if (option == "--cart-share") config.cartShare = std::stod(value);
+            else if (option == "--past-orders") config.meanPastOrders = std::stod(value);
+            else if (option == "--order-lines") config.meanOrderLines = std::stod(value);
+            else if (option == "--cart-lines") config.meanCartLines = std::stod(value);
+            else if (option == "--first-user-id") config.firstUserId = std::stoull(value);
+            else if (option == "--start-ms") config.startMs = std::stoll(value);
+            else if (option == "--rate") config.ordersPerSecond = std::stod(value);
+            else {
+                std::cerr << "ERROR: unknown option " << option << std::endl;
+                usage();
+                return 1;
+            }
+        } catch (...) {
+            std::cerr << "ERROR: invalid value '" << value << "' for " << option << std::endl;
+            return 1;
+        }
+    }
+    if (format != "ndjson" && format != "binary" && format != "memory") {
+        usage();
+        return 1;
+    }
+    if (config.products == 0 || (orders > 0 && config.users == 0)) {
+        std::cerr << "ERROR: need at least one product, and a user to place orders" << std::endl;
+        return 1;
+    }
+
+    SyntheticData data(config);
+    if (format == "memory") {
+        loadIntoMemory(data);
+        return 0;
+    }
+    bool written = format == "ndjson" ? writeNdjson(data, orders, out) : writeBinary(data, orders, out);
+    if (!written) {
+        std::cerr << "ERROR: writing to " << out << " failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << config.products << " products, " << config.users << " users and " << orders
+              << " orders to " << out << " (seed " << config.seed << ")" << std::endl;
+    return 0;
+}